@@ -844,6 +844,19 @@ void TriggerStage::add_match(shared_ptr<Channel> channel,
 	add_match(move(channel), type, NAN);
 }
 
+void TriggerStage::add_match(shared_ptr<Channel> channel,
+	const TriggerMatchType *type, float value, float hysteresis,
+	int num_samples)
+{
+	check(sr_trigger_analog_match_add(_structure,
+		channel->_structure, type->id(), value, hysteresis, num_samples));
+	GSList *const last = g_slist_last(_structure->matches);
+	unique_ptr<TriggerMatch> match {new TriggerMatch{
+			static_cast<struct sr_trigger_match *>(last->data),
+			move(channel)}};
+	_matches.push_back(move(match));
+}
+
 TriggerMatch::TriggerMatch(struct sr_trigger_match *structure,
 		shared_ptr<Channel> channel) :
 	_structure(structure),
@@ -870,6 +883,16 @@ float TriggerMatch::value() const
 	return _structure->value;
 }
 
+float TriggerMatch::hysteresis() const
+{
+	return _structure->hysteresis;
+}
+
+int TriggerMatch::num_samples() const
+{
+	return _structure->num_samples;
+}
+
 DatafeedCallbackData::DatafeedCallbackData(Session *session,
 		DatafeedCallbackFunction callback) :
 	_callback(move(callback)),
@@ -1051,6 +1074,103 @@ shared_ptr<Context> Session::context()
 	return _context;
 }
 
+void Session::set_metrics_enabled(bool enable)
+{
+	check(sr_session_metrics_enable(_structure, enable));
+}
+
+void Session::reset_metrics()
+{
+	check(sr_session_metrics_reset(_structure));
+}
+
+vector<shared_ptr<MetricsStage>> Session::metrics()
+{
+	GSList *stages;
+	check(sr_session_metrics_get(_structure, &stages));
+	vector<shared_ptr<MetricsStage>> result;
+	for (GSList *l = stages; l; l = l->next) {
+		auto *const stage = static_cast<struct sr_metrics_stage *>(l->data);
+		result.push_back(shared_ptr<MetricsStage>{
+			new MetricsStage{stage}, default_delete<MetricsStage>{}});
+	}
+	sr_session_metrics_free(stages);
+	return result;
+}
+
+MetricsStage::MetricsStage(const struct sr_metrics_stage *structure) :
+	_structure(*structure),
+	_name(valid_string(structure->name))
+{
+	/* The name is owned by the snapshot, keep only our copy. */
+	_structure.name = nullptr;
+}
+
+MetricsStage::~MetricsStage()
+{
+}
+
+const MetricsStageType *MetricsStage::type() const
+{
+	return MetricsStageType::get(_structure.type);
+}
+
+int MetricsStage::index() const
+{
+	return _structure.index;
+}
+
+string MetricsStage::name() const
+{
+	return _name;
+}
+
+uint64_t MetricsStage::packets() const
+{
+	return _structure.packets;
+}
+
+uint64_t MetricsStage::bytes() const
+{
+	return _structure.bytes;
+}
+
+uint64_t MetricsStage::time_total() const
+{
+	return _structure.time_total;
+}
+
+uint64_t MetricsStage::time_max() const
+{
+	return _structure.time_max;
+}
+
+vector<uint64_t> MetricsStage::histogram() const
+{
+	return vector<uint64_t>(_structure.histogram,
+		_structure.histogram + SR_METRICS_HIST_BUCKETS);
+}
+
+uint64_t MetricsStage::usb_transfers() const
+{
+	return _structure.usb_transfers;
+}
+
+uint64_t MetricsStage::usb_empty_transfers() const
+{
+	return _structure.usb_empty_transfers;
+}
+
+uint64_t MetricsStage::usb_resubmit_failures() const
+{
+	return _structure.usb_resubmit_failures;
+}
+
+uint64_t MetricsStage::frames_dropped() const
+{
+	return _structure.frames_dropped;
+}
+
 Packet::Packet(shared_ptr<Device> device,
 	const struct sr_datafeed_packet *structure) :
 	_structure(structure),
@@ -1212,11 +1332,26 @@ void *Analog::data_pointer()
 	return _structure->data;
 }
 
+void Analog::get_data_as_float(float *dest)
+{
+	check(sr_analog_to_float(_structure, dest));
+}
+
 unsigned int Analog::num_samples() const
 {
 	return _structure->num_samples;
 }
 
+unsigned int Analog::unit_size() const
+{
+	return _structure->encoding->unitsize;
+}
+
+bool Analog::is_floating_point() const
+{
+	return _structure->encoding->is_float;
+}
+
 vector<shared_ptr<Channel>> Analog::channels()
 {
 	vector<shared_ptr<Channel>> result;
@@ -1324,6 +1459,11 @@ void Input::send(void *data, size_t length)
 	check(ret);
 }
 
+void Input::load_file(string filename)
+{
+	check(sr_input_load_file(_structure, filename.c_str()));
+}
+
 void Input::end()
 {
 	check(sr_input_end(_structure));
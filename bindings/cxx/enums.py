@@ -44,7 +44,8 @@ mapping = dict([
     ('sr_datatype', ('DataType', 'Configuration data type')),
     ('sr_channeltype', ('ChannelType', 'Channel type')),
     ('sr_trigger_matches', ('TriggerMatchType', 'Trigger match type')),
-    ('sr_output_flag', ('OutputFlag', 'Flag applied to output modules'))])
+    ('sr_output_flag', ('OutputFlag', 'Flag applied to output modules')),
+    ('sr_metrics_stage_type', ('MetricsStageType', 'Type of session metrics stage'))])
 
 index = ElementTree.parse(index_file)
 
@@ -121,6 +121,8 @@ class SR_API Output;
 class SR_API DataType;
 class SR_API Option;
 class SR_API UserDevice;
+class SR_API MetricsStage;
+class SR_API MetricsStageType;
 
 /** Exception thrown when an error code is returned by any libsigrok call. */
 class SR_API Error: public exception
@@ -538,6 +540,14 @@ public:
 	 * @param type TriggerMatchType to apply.
 	 * @param value Threshold value. */
 	void add_match(shared_ptr<Channel> channel, const TriggerMatchType *type, float value);
+	/** Add a new match condition on an analog channel to this stage.
+	 * @param channel Channel to match on.
+	 * @param type TriggerMatchType to apply.
+	 * @param value Threshold value, or minimum change for slopes.
+	 * @param hysteresis Hysteresis of edges.
+	 * @param num_samples Number of samples slopes are measured over. */
+	void add_match(shared_ptr<Channel> channel, const TriggerMatchType *type,
+		float value, float hysteresis, int num_samples);
 private:
 	struct sr_trigger_stage *_structure;
 	vector<unique_ptr<TriggerMatch> > _matches;
@@ -558,6 +568,10 @@ public:
 	const TriggerMatchType *type() const;
 	/** Threshold value. */
 	float value() const;
+	/** Hysteresis of analog edges. */
+	float hysteresis() const;
+	/** Number of samples analog slopes are measured over. */
+	int num_samples() const;
 private:
 	TriggerMatch(struct sr_trigger_match *structure, shared_ptr<Channel> channel);
 	~TriggerMatch();
@@ -637,6 +651,14 @@ public:
 	void set_trigger(shared_ptr<Trigger> trigger);
 	/** Get filename this session was loaded from. */
 	string filename() const;
+	/** Enable or disable collection of datafeed metrics.
+	 * @param enable Whether to collect metrics. */
+	void set_metrics_enabled(bool enable);
+	/** Discard all metrics collected so far. */
+	void reset_metrics();
+	/** Get a snapshot of the collected metrics, one entry per device,
+	 * transform and datafeed callback. May be called while running. */
+	vector<shared_ptr<MetricsStage> > metrics();
 private:
 	explicit Session(shared_ptr<Context> context);
 	Session(shared_ptr<Context> context, string filename);
@@ -657,6 +679,44 @@ private:
 	friend struct std::default_delete<Session>;
 };
 
+/** Metrics snapshot of one stage of the session datafeed */
+class SR_API MetricsStage : public UserOwned<MetricsStage>
+{
+public:
+	/** Type of this stage. */
+	const MetricsStageType *type() const;
+	/** Position of the device, transform or callback in the session. */
+	int index() const;
+	/** Driver name, transform module ID, or "callback". */
+	string name() const;
+	/** Number of packets passed to this stage. */
+	uint64_t packets() const;
+	/** Number of sample data bytes in these packets. */
+	uint64_t bytes() const;
+	/** Total time spent in this stage, in microseconds. */
+	uint64_t time_total() const;
+	/** Longest time spent in one call, in microseconds. */
+	uint64_t time_max() const;
+	/** Latency histogram, see SR_METRICS_HIST_BUCKETS. */
+	vector<uint64_t> histogram() const;
+	/** Number of completed USB transfers. */
+	uint64_t usb_transfers() const;
+	/** Number of USB transfers which completed without data. */
+	uint64_t usb_empty_transfers() const;
+	/** Number of failed USB transfer resubmissions. */
+	uint64_t usb_resubmit_failures() const;
+	/** Number of frames dropped because the bus fell behind. */
+	uint64_t frames_dropped() const;
+private:
+	explicit MetricsStage(const struct sr_metrics_stage *structure);
+	~MetricsStage();
+	struct sr_metrics_stage _structure;
+	string _name;
+
+	friend class Session;
+	friend struct std::default_delete<MetricsStage>;
+};
+
 /** A packet on the session datafeed */
 class SR_API Packet : public UserOwned<Packet>
 {
@@ -765,10 +825,18 @@ class SR_API Analog :
 	public PacketPayload
 {
 public:
-	/** Pointer to data. */
+	/** Pointer to data, in the encoding given by unit_size() and
+	 * is_floating_point(). */
 	void *data_pointer();
+	/** Fill a buffer with the data converted to float values.
+	 * @param dest Buffer for num_samples() values per channel. */
+	void get_data_as_float(float *dest);
 	/** Number of samples in this packet. */
 	unsigned int num_samples() const;
+	/** Size of each sample in bytes. */
+	unsigned int unit_size() const;
+	/** Whether the samples are floating point rather than integer values. */
+	bool is_floating_point() const;
 	/** Channels for which this packet contains data. */
 	vector<shared_ptr<Channel> > channels();
 	/** Measured quantity of the samples in this packet. */
@@ -826,6 +894,9 @@ public:
 	 * @param data Next stream data.
 	 * @param length Length of data. */
 	void send(void *data, size_t length);
+	/** Load the contents of a file, without copying where possible.
+	 * @param filename File to load. */
+	void load_file(string filename);
 	/** Signal end of input data. */
 	void end();
 	void reset();
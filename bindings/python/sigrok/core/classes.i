@@ -538,8 +538,21 @@ std::map<std::string, Glib::VariantBase> dict_to_map_options(PyObject *dict,
         dims[0] = $self->channels().size();
         dims[1] = $self->num_samples();
         int typenum = NPY_FLOAT;
-        void *data = $self->data_pointer();
-        return PyArray_SimpleNewFromData(nd, dims, typenum, data);
+        /* Native float data is shared, anything else is converted. */
+        if ($self->is_floating_point() && $self->unit_size() == sizeof(float)) {
+            void *data = $self->data_pointer();
+            return PyArray_SimpleNewFromData(nd, dims, typenum, data);
+        }
+        PyObject *array = PyArray_SimpleNew(nd, dims, typenum);
+        if (!array)
+            return NULL;
+        try {
+            $self->get_data_as_float((float *) PyArray_DATA((PyArrayObject *) array));
+        } catch (...) {
+            Py_DECREF(array);
+            throw;
+        }
+        return array;
     }
 
 %pythoncode
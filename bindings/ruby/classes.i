@@ -414,7 +414,8 @@ int convert_option_by_key(VALUE key, VALUE val, VALUE in) {
     {
         int num_channels = $self->channels().size();
         int num_samples  = $self->num_samples();
-        float *data = (float *) $self->data_pointer();
+        std::vector<float> data(num_channels * num_samples);
+        $self->get_data_as_float(data.data());
         VALUE channels = rb_ary_new2(num_channels);
         for(int i = 0; i < num_channels; i++) {
             VALUE samples = rb_ary_new2(num_samples);
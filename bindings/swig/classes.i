@@ -75,6 +75,7 @@ template< class T > class enable_shared_from_this;
 %shared_ptr(sigrok::TriggerStage);
 %shared_ptr(sigrok::TriggerMatch);
 %shared_ptr(sigrok::UserDevice);
+%shared_ptr(sigrok::MetricsStage);
 
 #define SR_API
 #define SR_PRIV
@@ -199,6 +200,26 @@ typedef std::map<const sigrok::ConfigKey *, Glib::VariantBase>
 
 %attributestring(sigrok::Session, std::string, filename, filename);
 
+%attributevector(Session,
+    std::vector<std::shared_ptr<sigrok::MetricsStage> >,
+    metrics, metrics);
+
+%attribute(sigrok::MetricsStage,
+    const sigrok::MetricsStageType *, type, type);
+%attribute(sigrok::MetricsStage, int, index, index);
+%attributestring(sigrok::MetricsStage, std::string, name, name);
+%attribute(sigrok::MetricsStage, uint64_t, packets, packets);
+%attribute(sigrok::MetricsStage, uint64_t, bytes, bytes);
+%attribute(sigrok::MetricsStage, uint64_t, time_total, time_total);
+%attribute(sigrok::MetricsStage, uint64_t, time_max, time_max);
+%attributevector(MetricsStage, std::vector<uint64_t>, histogram, histogram);
+%attribute(sigrok::MetricsStage, uint64_t, usb_transfers, usb_transfers);
+%attribute(sigrok::MetricsStage, uint64_t,
+    usb_empty_transfers, usb_empty_transfers);
+%attribute(sigrok::MetricsStage, uint64_t,
+    usb_resubmit_failures, usb_resubmit_failures);
+%attribute(sigrok::MetricsStage, uint64_t, frames_dropped, frames_dropped);
+
 %attribute(sigrok::Packet,
     const sigrok::PacketType *, type, type);
 
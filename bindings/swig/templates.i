@@ -22,6 +22,7 @@
 using namespace std;
 %}
 
+%include "stdint.i"
 %include "std_string.i"
 %include "std_shared_ptr.i"
 %include "std_vector.i"
@@ -94,3 +95,9 @@ namespace std {
 
 %template(TriggerMatchVector)
  std::vector<std::shared_ptr<sigrok::TriggerMatch> >;
+
+%template(MetricsStageVector)
+ std::vector<std::shared_ptr<sigrok::MetricsStage> >;
+
+%template(UInt64Vector)
+ std::vector<uint64_t>;
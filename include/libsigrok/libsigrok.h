@@ -146,6 +146,7 @@ enum sr_datatype {
 	SR_T_DOUBLE_RANGE,
 	SR_T_INT32,
 	SR_T_MQ,
+	SR_T_INT64_ARRAY,
 
 	/* Update sr_variant_type_get() (hwdriver.c) upon changes! */
 };
@@ -398,6 +399,8 @@ enum sr_trigger_matches {
 	SR_TRIGGER_EDGE,
 	SR_TRIGGER_OVER,
 	SR_TRIGGER_UNDER,
+	SR_TRIGGER_SLOPE_UP,
+	SR_TRIGGER_SLOPE_DOWN,
 };
 
 /** The representation of a trigger, consisting of one or more stages
@@ -433,14 +436,26 @@ struct sr_trigger_match {
 	 * For analog channels, only these matches may be used:
 	 * SR_TRIGGER_RISING
 	 * SR_TRIGGER_FALLING
+	 * SR_TRIGGER_EDGE
 	 * SR_TRIGGER_OVER
 	 * SR_TRIGGER_UNDER
+	 * SR_TRIGGER_SLOPE_UP
+	 * SR_TRIGGER_SLOPE_DOWN
 	 *
+	 * A window can be matched with SR_TRIGGER_OVER and SR_TRIGGER_UNDER
+	 * on the same channel in one stage.
 	 */
 	int match;
 	/** If the trigger match is one of SR_TRIGGER_OVER or SR_TRIGGER_UNDER,
-	 * this contains the value to compare against. */
+	 * this contains the value to compare against. For analog edges, this
+	 * is the level to cross, and for slopes the minimum change of the
+	 * value over num_samples samples. */
 	float value;
+	/** For analog edges, how far the value must have been on the other
+	 * side of the level before crossing it. */
+	float hysteresis;
+	/** For slopes, the number of samples the change is measured over. */
+	int num_samples;
 };
 
 /**
@@ -463,6 +478,55 @@ struct sr_context;
  */
 struct sr_session;
 
+/** Type of a stage in the session datafeed path, see sr_metrics_stage. */
+enum sr_metrics_stage_type {
+	/** Packets sent by a device (including the time spent in all
+	 * transforms and datafeed callbacks). */
+	SR_METRICS_DEVICE = 10000,
+	/** A transform module's receive() call. */
+	SR_METRICS_TRANSFORM,
+	/** A datafeed callback. */
+	SR_METRICS_CALLBACK,
+};
+
+/**
+ * Number of latency histogram buckets in struct sr_metrics_stage.
+ *
+ * Bucket 0 counts calls which took less than 1us, bucket n (n > 0) counts
+ * calls which took at least 2^(n-1)us and less than 2^n us. The last
+ * bucket also counts all longer calls.
+ */
+#define SR_METRICS_HIST_BUCKETS 24
+
+/** Snapshot of the counters of one stage in the session datafeed path. */
+struct sr_metrics_stage {
+	/** Stage type, enum sr_metrics_stage_type. */
+	int type;
+	/** Position of the transform or datafeed callback in the session,
+	 * or of the device in the session's device list. */
+	int index;
+	/** Device driver, transform module id, or "callback". */
+	char *name;
+	/** Number of packets passed to this stage. */
+	uint64_t packets;
+	/** Number of sample data bytes in these packets. */
+	uint64_t bytes;
+	/** Total time spent in this stage, in microseconds. */
+	uint64_t time_total;
+	/** Longest time spent in one call, in microseconds. */
+	uint64_t time_max;
+	/** Latency histogram, see SR_METRICS_HIST_BUCKETS. */
+	uint64_t histogram[SR_METRICS_HIST_BUCKETS];
+	/** Number of completed USB transfers (devices only). */
+	uint64_t usb_transfers;
+	/** Number of USB transfers which completed without data. */
+	uint64_t usb_empty_transfers;
+	/** Number of failed USB transfer resubmissions. */
+	uint64_t usb_resubmit_failures;
+	/** Number of frames dropped because the bus fell behind. */
+	uint64_t frames_dropped;
+};
+
 struct sr_rational {
 	/** Numerator of the rational number. */
 	int64_t p;
@@ -575,10 +639,25 @@ enum sr_output_flag {
 	SR_OUTPUT_INTERNAL_IO_HANDLING = 0x01,
 };
 
+/** Output writer flags. */
+enum sr_output_writer_flag {
+	/**
+	 * Drop data packets while the queue is full, instead of blocking
+	 * the sender until the writer thread catches up.
+	 */
+	SR_OUTPUT_WRITER_DROP = 0x01,
+	/**
+	 * Bypass the page cache where the platform supports it. Meant for
+	 * large binary captures, which are written in aligned blocks.
+	 */
+	SR_OUTPUT_WRITER_DIRECT = 0x02,
+};
+
 struct sr_input;
 struct sr_input_module;
 struct sr_output;
 struct sr_output_module;
+struct sr_output_writer;
 struct sr_transform;
 struct sr_transform_module;
 
@@ -1053,6 +1132,60 @@ enum sr_configkey {
 	/** Self test mode. */
 	SR_CONF_TEST_MODE,
 
+	/**
+	 * Free-running (non-realtime) acquisition. Data is produced as fast
+	 * as the session accepts it instead of being paced to the samplerate.
+	 */
+	SR_CONF_FREE_RUNNING,
+
+	/**
+	 * Maximum number of readings sent in one analog packet. Readings of
+	 * the same quantity on the same channels are collected and sent
+	 * together, with a host timestamp for each of them, see
+	 * SR_CONF_ANALOG_TIMESTAMPS. 0 or 1 sends every reading right away.
+	 */
+	SR_CONF_ANALOG_BATCH_SAMPLES,
+
+	/**
+	 * Maximum time span of readings sent in one analog packet, in ms.
+	 * 0 means no time limit.
+	 */
+	SR_CONF_ANALOG_BATCH_MSEC,
+
+	/**
+	 * Host time each sample of the next SR_DF_ANALOG packet was taken
+	 * at, in µs since the Unix epoch, as an array of int64 ("ax"). Sent
+	 * in an SR_DF_META packet ahead of batched readings, see
+	 * SR_CONF_ANALOG_BATCH_SAMPLES.
+	 */
+	SR_CONF_ANALOG_TIMESTAMPS,
+
+	/**
+	 * Logic samples only hold the enabled logic channels, packed in
+	 * channel order from bit 0 into the smallest unitsize. Sent in an
+	 * SR_DF_META packet by the "repack" transform module.
+	 */
+	SR_CONF_LOGIC_PACKED,
+
+	/**
+	 * Number of the current frame since the acquisition started. Sent
+	 * in an SR_DF_META packet right after SR_DF_FRAME_BEGIN. Dropped
+	 * frames are counted, so a gap means frames were lost.
+	 */
+	SR_CONF_FRAME_INDEX,
+
+	/**
+	 * Host time the current frame was captured at, in µs since the Unix
+	 * epoch. Sent along with SR_CONF_FRAME_INDEX.
+	 */
+	SR_CONF_FRAME_TIMESTAMP,
+
+	/**
+	 * Sample the trigger fired at, counted from the start of the current
+	 * frame. Sent along with SR_CONF_FRAME_INDEX, if known.
+	 */
+	SR_CONF_FRAME_TRIGGER_OFFSET,
+
 	/* Update sr_key_info_config[] (hwdriver.c) upon changes! */
 };
 
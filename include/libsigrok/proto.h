@@ -84,6 +84,12 @@ SR_API struct sr_dev_inst *sr_dev_inst_user_new(const char *vendor,
 		const char *model, const char *version);
 SR_API int sr_dev_inst_channel_add(struct sr_dev_inst *sdi, int index, int type, const char *name);
 
+/*--- device_cache.c --------------------------------------------------------*/
+
+SR_API int sr_dev_cache_save(const char *filename, GSList *devices);
+SR_API GSList *sr_dev_cache_reconnect(struct sr_context *ctx,
+		const char *filename);
+
 /*--- hwdriver.c ------------------------------------------------------------*/
 
 SR_API struct sr_dev_driver **sr_driver_list(const struct sr_context *ctx);
@@ -99,6 +105,7 @@ SR_API int sr_config_set(const struct sr_dev_inst *sdi,
 		const struct sr_channel_group *cg,
 		uint32_t key, GVariant *data);
 SR_API int sr_config_commit(const struct sr_dev_inst *sdi);
+SR_API int sr_config_cache_enable(struct sr_dev_inst *sdi, gboolean enable);
 SR_API int sr_config_list(const struct sr_dev_driver *driver,
 		const struct sr_dev_inst *sdi,
 		const struct sr_channel_group *cg,
@@ -140,6 +147,15 @@ SR_API int sr_session_is_running(struct sr_session *session);
 SR_API int sr_session_stopped_callback_set(struct sr_session *session,
 		sr_session_stopped_callback cb, void *cb_data);
 
+/*--- session_metrics.c -----------------------------------------------------*/
+
+SR_API int sr_session_metrics_enable(struct sr_session *session,
+		gboolean enable);
+SR_API int sr_session_metrics_reset(struct sr_session *session);
+SR_API int sr_session_metrics_get(struct sr_session *session,
+		GSList **stages);
+SR_API void sr_session_metrics_free(GSList *stages);
+
 /*--- input/input.c ---------------------------------------------------------*/
 
 SR_API const struct sr_input_module **sr_input_list(void);
@@ -159,6 +175,7 @@ SR_API int sr_input_scan_buffer(GString *buf, const struct sr_input **in);
 SR_API int sr_input_scan_file(const char *filename, const struct sr_input **in);
 SR_API struct sr_dev_inst *sr_input_dev_inst_get(const struct sr_input *in);
 SR_API int sr_input_send(const struct sr_input *in, GString *buf);
+SR_API int sr_input_load_file(const struct sr_input *in, const char *filename);
 SR_API int sr_input_end(const struct sr_input *in);
 SR_API int sr_input_reset(const struct sr_input *in);
 SR_API void sr_input_free(const struct sr_input *in);
@@ -181,6 +198,14 @@ SR_API int sr_output_send(const struct sr_output *o,
 		const struct sr_datafeed_packet *packet, GString **out);
 SR_API int sr_output_free(const struct sr_output *o);
 
+/*--- output/writer.c -------------------------------------------------------*/
+
+SR_API struct sr_output_writer *sr_output_writer_new(const struct sr_output *o,
+		const char *filename, unsigned int max_packets, int flags);
+SR_API int sr_output_writer_send(struct sr_output_writer *w,
+		const struct sr_datafeed_packet *packet);
+SR_API int sr_output_writer_free(struct sr_output_writer *w);
+
 /*--- transform/transform.c -------------------------------------------------*/
 
 SR_API const struct sr_transform_module **sr_transform_list(void);
@@ -201,6 +226,9 @@ SR_API void sr_trigger_free(struct sr_trigger *trig);
 SR_API struct sr_trigger_stage *sr_trigger_stage_add(struct sr_trigger *trig);
 SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
 		struct sr_channel *ch, int trigger_match, float value);
+SR_API int sr_trigger_analog_match_add(struct sr_trigger_stage *stage,
+		struct sr_channel *ch, int trigger_match, float value,
+		float hysteresis, int num_samples);
 
 /*--- serial.c --------------------------------------------------------------*/
 
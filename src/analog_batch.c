@@ -0,0 +1,401 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * Analog reading batching helper functions
+ * @internal
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "analog_batch"
+
+/* Upper bound for a packet, in case only a time limit is set. */
+#define MAX_BATCH_SAMPLES (64 * 1024)
+
+/* Pending readings of one quantity on one set of channels. */
+struct batch_stream {
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	/* num_channels values per sample, as in the received packets. */
+	float *data;
+	int64_t *timestamps;
+	unsigned int num_channels;
+	unsigned int num_samples;
+	unsigned int size;
+	/* Time [µs] the first pending reading was added. */
+	int64_t start_time;
+};
+
+static gboolean same_channels(const GSList *a, const GSList *b)
+{
+	while (a && b && a->data == b->data) {
+		a = a->next;
+		b = b->next;
+	}
+
+	return !a && !b;
+}
+
+static gboolean same_format(const struct batch_stream *stream,
+		const struct sr_datafeed_analog *analog)
+{
+	return stream->meaning.unit == analog->meaning->unit
+		&& stream->meaning.mqflags == analog->meaning->mqflags
+		&& stream->encoding.digits == analog->encoding->digits
+		&& stream->spec.spec_digits == analog->spec->spec_digits;
+}
+
+static void stream_free(void *data)
+{
+	struct batch_stream *stream;
+
+	stream = data;
+	g_slist_free(stream->meaning.channels);
+	g_free(stream->data);
+	g_free(stream->timestamps);
+	g_free(stream);
+}
+
+/* Announce the timestamps of the next analog packet. */
+static int send_timestamps(const struct sr_dev_inst *sdi,
+		const int64_t *timestamps, unsigned int num_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+	int ret;
+
+	src = sr_config_new(SR_CONF_ANALOG_TIMESTAMPS,
+		g_variant_new_fixed_array(G_VARIANT_TYPE_INT64, timestamps,
+			num_samples, sizeof(int64_t)));
+	meta.config = g_slist_append(NULL, src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	ret = sr_session_send(sdi, &packet);
+	g_slist_free(meta.config);
+	sr_config_free(src);
+
+	return ret;
+}
+
+static void stream_flush(struct batch_stream *stream,
+		const struct sr_dev_inst *sdi)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+
+	if (!stream->num_samples)
+		return;
+
+	send_timestamps(sdi, stream->timestamps, stream->num_samples);
+
+	memset(&analog, 0, sizeof(analog));
+	analog.data = stream->data;
+	analog.num_samples = stream->num_samples;
+	analog.encoding = &stream->encoding;
+	analog.meaning = &stream->meaning;
+	analog.spec = &stream->spec;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	sr_session_send(sdi, &packet);
+
+	stream->num_samples = 0;
+}
+
+static gboolean stream_expired(const struct sr_analog_batch *batch,
+		const struct batch_stream *stream, int64_t now)
+{
+	return batch->limit_msec && stream->num_samples
+		&& now - stream->start_time >= (int64_t)batch->limit_msec * 1000;
+}
+
+/*
+ * Send the batches which span the time limit, for when no further
+ * readings arrive to do so. The timer stops once nothing is pending,
+ * and is started again with the next batch.
+ */
+static int batch_timeout(int fd, int revents, void *cb_data)
+{
+	struct sr_analog_batch *batch;
+	struct batch_stream *stream;
+	GSList *l;
+	int64_t now;
+	gboolean pending;
+
+	(void)fd;
+	(void)revents;
+
+	batch = cb_data;
+	now = g_get_monotonic_time();
+	pending = FALSE;
+	for (l = batch->streams; l; l = l->next) {
+		stream = l->data;
+		if (stream_expired(batch, stream, now))
+			stream_flush(stream, batch->sdi);
+		pending |= stream->num_samples > 0;
+	}
+	if (!pending)
+		batch->timer_running = FALSE;
+
+	return pending;
+}
+
+static void timer_start(struct sr_analog_batch *batch,
+		const struct sr_dev_inst *sdi)
+{
+	if (batch->timer_running || !batch->limit_msec || !sdi->session)
+		return;
+
+	batch->sdi = sdi;
+	if (sr_session_fd_source_add(sdi->session, batch, -1, 0,
+			MIN(batch->limit_msec, G_MAXINT), batch_timeout,
+			batch) != SR_OK) {
+		sr_warn("Failed to add batch timer, batches are only sent "
+			"as readings arrive.");
+		return;
+	}
+	batch->timer_running = TRUE;
+}
+
+/**
+ * Initialize an analog batch instance
+ *
+ * Must be called before any other operations are performed on a struct
+ * sr_analog_batch. Batching is disabled until configured.
+ *
+ * @param batch the analog batch instance to initialize
+ */
+SR_PRIV void sr_analog_batch_init(struct sr_analog_batch *batch)
+{
+	batch->limit_samples = 0;
+	batch->limit_msec = 0;
+	batch->streams = NULL;
+	batch->sdi = NULL;
+	batch->timer_running = FALSE;
+}
+
+/**
+ * Get analog batch configuration
+ *
+ * Should be called from the drivers config_get() callback.
+ *
+ * @param batch analog batch instance
+ * @param key config item key
+ * @param data config item data
+ * @return SR_ERR_NA if @p key is not a batch setting, SR_OK otherwise
+ */
+SR_PRIV int sr_analog_batch_config_get(struct sr_analog_batch *batch,
+	uint32_t key, GVariant **data)
+{
+	switch (key) {
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+		*data = g_variant_new_uint64(batch->limit_samples);
+		break;
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		*data = g_variant_new_uint64(batch->limit_msec);
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Set analog batch configuration
+ *
+ * Should be called from the drivers config_set() callback.
+ *
+ * @param batch analog batch instance
+ * @param key config item key
+ * @param data config item data
+ * @return SR_ERR_NA if @p key is not a batch setting, SR_OK otherwise
+ */
+SR_PRIV int sr_analog_batch_config_set(struct sr_analog_batch *batch,
+	uint32_t key, GVariant *data)
+{
+	switch (key) {
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+		batch->limit_samples = g_variant_get_uint64(data);
+		break;
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		batch->limit_msec = g_variant_get_uint64(data);
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Check whether readings are batched
+ *
+ * @param batch analog batch instance
+ * @returns TRUE if readings passed to sr_analog_batch_send() may be held
+ *               back and sent later as part of a larger packet.
+ */
+SR_PRIV gboolean sr_analog_batch_enabled(const struct sr_analog_batch *batch)
+{
+	return batch->limit_samples > 1 || batch->limit_msec > 0;
+}
+
+/**
+ * Send an analog reading, or add it to the current batch
+ *
+ * Readings are collected per set of channels and measured quantity. A
+ * batch is sent as one packet, once it holds the configured number of
+ * readings or spans the configured time, or when the unit, flags or digits
+ * of a reading change. A session timer sends batches which reach the time
+ * limit while no further readings arrive. Readings which are not single
+ * precision floats are always sent immediately. Readings on several
+ * channels hold one value per channel and sample, and are batched as
+ * they are.
+ *
+ * Batched packets are preceded by an SR_DF_META packet, which holds the
+ * host time of each sample in SR_CONF_ANALOG_TIMESTAMPS.
+ *
+ * @param batch analog batch instance
+ * @param sdi the device instance the reading belongs to
+ * @param analog the reading
+ * @param timestamps host time of each sample, in µs since the Unix epoch,
+ *        or NULL to use the current time. If readings are sent right away,
+ *        they are only announced if given.
+ * @return the result of sr_session_send() if the reading was sent right
+ *         away, SR_OK otherwise
+ */
+SR_PRIV int sr_analog_batch_send(struct sr_analog_batch *batch,
+	const struct sr_dev_inst *sdi, const struct sr_datafeed_analog *analog,
+	const int64_t *timestamps)
+{
+	struct sr_datafeed_packet packet;
+	struct batch_stream *stream;
+	GSList *l;
+	int64_t now, timestamp;
+	unsigned int i;
+	int ret;
+
+	if (!sr_analog_batch_enabled(batch) || !analog->encoding->is_float
+			|| analog->encoding->unitsize != sizeof(float)) {
+		if (timestamps && (ret = send_timestamps(sdi, timestamps,
+				analog->num_samples)) != SR_OK)
+			return ret;
+		packet.type = SR_DF_ANALOG;
+		packet.payload = analog;
+		return sr_session_send(sdi, &packet);
+	}
+
+	now = g_get_monotonic_time();
+
+	stream = NULL;
+	for (l = batch->streams; l; l = l->next) {
+		stream = l->data;
+		if (stream->meaning.mq == analog->meaning->mq && same_channels(
+				stream->meaning.channels, analog->meaning->channels))
+			break;
+		stream = NULL;
+	}
+	if (!stream) {
+		stream = g_malloc0(sizeof(struct batch_stream));
+		stream->meaning.channels = g_slist_copy(analog->meaning->channels);
+		stream->num_channels = MAX(g_slist_length(stream->meaning.channels), 1);
+		batch->streams = g_slist_append(batch->streams, stream);
+	} else if (!same_format(stream, analog)) {
+		stream_flush(stream, sdi);
+	}
+
+	if (!stream->num_samples) {
+		memcpy(&stream->encoding, analog->encoding, sizeof(stream->encoding));
+		stream->meaning.mq = analog->meaning->mq;
+		stream->meaning.unit = analog->meaning->unit;
+		stream->meaning.mqflags = analog->meaning->mqflags;
+		memcpy(&stream->spec, analog->spec, sizeof(stream->spec));
+		stream->start_time = now;
+	}
+
+	if (stream->num_samples + analog->num_samples > stream->size) {
+		stream->size = MAX(stream->size * 2,
+			MIN(MAX(batch->limit_samples, 16), MAX_BATCH_SAMPLES));
+		stream->size = MAX(stream->size,
+			stream->num_samples + analog->num_samples);
+		stream->data = g_renew(float, stream->data,
+			stream->size * stream->num_channels);
+		stream->timestamps = g_renew(int64_t, stream->timestamps,
+			stream->size);
+	}
+	memcpy(stream->data + stream->num_samples * stream->num_channels,
+		analog->data,
+		analog->num_samples * stream->num_channels * sizeof(float));
+	timestamp = g_get_real_time();
+	for (i = 0; i < analog->num_samples; i++) {
+		stream->timestamps[stream->num_samples + i] = timestamps
+			? timestamps[i] : timestamp;
+	}
+	stream->num_samples += analog->num_samples;
+
+	/* Send whatever batch is full or old enough. */
+	for (l = batch->streams; l; l = l->next) {
+		stream = l->data;
+		if (!stream->num_samples)
+			continue;
+		if ((batch->limit_samples > 1
+				&& stream->num_samples >= batch->limit_samples)
+				|| stream->num_samples >= MAX_BATCH_SAMPLES
+				|| stream_expired(batch, stream, now))
+			stream_flush(stream, sdi);
+		else
+			timer_start(batch, sdi);
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Send all pending readings
+ *
+ * Must be called when the acquisition stops, before SR_DF_END is sent.
+ * Stops the batch timer, and releases all memory held by the batch
+ * instance.
+ *
+ * @param batch analog batch instance
+ * @param sdi the device instance the readings belong to
+ */
+SR_PRIV void sr_analog_batch_flush(struct sr_analog_batch *batch,
+	const struct sr_dev_inst *sdi)
+{
+	GSList *l;
+
+	if (batch->timer_running) {
+		sr_session_source_remove_internal(sdi->session, batch);
+		batch->timer_running = FALSE;
+	}
+
+	for (l = batch->streams; l; l = l->next)
+		stream_flush(l->data, sdi);
+
+	g_slist_free_full(batch->streams, stream_free);
+	batch->streams = NULL;
+}
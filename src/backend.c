@@ -562,6 +562,9 @@ SR_API int sr_exit(struct sr_context *ctx)
 	g_free(sr_driver_list(ctx));
 	g_free(ctx);
 
+	/* Write out all queued messages and stop the log writer. */
+	sr_log_stop();
+
 	return SR_OK;
 }
 
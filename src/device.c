@@ -374,6 +374,7 @@ SR_PRIV void sr_dev_inst_free(struct sr_dev_inst *sdi)
 	g_free(sdi->version);
 	g_free(sdi->serial_num);
 	g_free(sdi->connection_id);
+	sr_config_cache_free(sdi);
 	g_free(sdi);
 }
 
@@ -548,6 +549,7 @@ SR_API int sr_dev_open(struct sr_dev_inst *sdi)
 		return SR_ERR;
 
 	ret = sdi->driver->dev_open(sdi);
+	sr_config_cache_clear(sdi, TRUE);
 
 	return ret;
 }
@@ -569,6 +571,7 @@ SR_API int sr_dev_close(struct sr_dev_inst *sdi)
 		return SR_ERR;
 
 	ret = sdi->driver->dev_close(sdi);
+	sr_config_cache_clear(sdi, TRUE);
 
 	return ret;
 }
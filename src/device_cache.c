@@ -0,0 +1,475 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "device-cache"
+/** @endcond */
+
+/**
+ * @file
+ *
+ * On-disk cache of previously found devices.
+ */
+
+/**
+ * @addtogroup grp_devices
+ *
+ * @{
+ */
+
+/* A device as recorded in the cache file. */
+struct cache_entry {
+	char *driver;
+	char *conn;
+	char *serialcomm;
+	char *vendor;
+	char *model;
+	char *serial_num;
+	char *connection_id;
+};
+
+static void entry_clear(struct cache_entry *entry)
+{
+	g_free(entry->driver);
+	g_free(entry->conn);
+	g_free(entry->serialcomm);
+	g_free(entry->vendor);
+	g_free(entry->model);
+	g_free(entry->serial_num);
+	g_free(entry->connection_id);
+}
+
+static void set_string(GKeyFile *kf, const char *group, const char *key,
+		const char *value)
+{
+	if (value && *value)
+		g_key_file_set_string(kf, group, key, value);
+}
+
+static gboolean has_scan_option(const struct sr_dev_driver *driver,
+		uint32_t key)
+{
+	GArray *opts;
+	gboolean found;
+	unsigned int i;
+
+	if (!(opts = sr_driver_scan_options_list(driver)))
+		return FALSE;
+
+	found = FALSE;
+	for (i = 0; i < opts->len && !found; i++)
+		found = g_array_index(opts, uint32_t, i) == key;
+	g_array_free(opts, TRUE);
+
+	return found;
+}
+
+/*
+ * Record the options which let the driver find this particular device
+ * again, without probing every port it knows of.
+ */
+static void save_scan_options(GKeyFile *kf, const char *group,
+		struct sr_dev_inst *sdi)
+{
+	const char *connid;
+	char **res;
+#ifdef HAVE_LIBUSB_1_0
+	struct sr_usb_dev_inst *usb;
+	char *conn;
+
+	/*
+	 * USB devices are found by bus and address. Skip those which are
+	 * still waiting to renumerate after a firmware upload.
+	 */
+	if (sdi->inst_type == SR_INST_USB) {
+		usb = sdi->conn;
+		if (!usb || usb->address == 0xff)
+			return;
+		conn = g_strdup_printf("%d.%d", usb->bus, usb->address);
+		g_key_file_set_string(kf, group, "conn", conn);
+		g_free(conn);
+		return;
+	}
+#endif
+
+	if (sdi->inst_type != SR_INST_SERIAL && sdi->inst_type != SR_INST_SCPI)
+		return;
+	if (!(connid = sr_dev_inst_connid_get(sdi)))
+		return;
+
+	/* SCPI resources may carry the serial parameters after a colon. */
+	res = g_strsplit(connid, ":", 2);
+	set_string(kf, group, "conn", res[0]);
+	if (sdi->inst_type == SR_INST_SCPI)
+		set_string(kf, group, "serialcomm", res[1]);
+	g_strfreev(res);
+}
+
+/**
+ * Save a list of devices to a cache file.
+ *
+ * The cache records the driver, connection and identity of each device,
+ * so that sr_dev_cache_reconnect() can find them again without scanning
+ * with all drivers. Devices which were not found by a driver scan are
+ * skipped.
+ *
+ * @param filename The name of the cache file. An existing file is
+ *                 replaced. Must not be NULL.
+ * @param devices A list of struct sr_dev_inst pointers, as returned by
+ *                sr_driver_scan() or sr_dev_cache_reconnect().
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR_IO The file could not be written.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_dev_cache_save(const char *filename, GSList *devices)
+{
+	GKeyFile *kf;
+	GError *error;
+	struct sr_dev_inst *sdi;
+	GSList *l;
+	char *group, *data;
+	gsize len;
+	unsigned int n;
+	int ret;
+
+	if (!filename) {
+		sr_err("%s: filename was NULL", __func__);
+		return SR_ERR_ARG;
+	}
+
+	kf = g_key_file_new();
+	n = 0;
+	for (l = devices; l; l = l->next) {
+		sdi = l->data;
+		if (!sdi->driver || sdi->inst_type == SR_INST_USER)
+			continue;
+
+		group = g_strdup_printf("device %u", ++n);
+		g_key_file_set_string(kf, group, "driver", sdi->driver->name);
+		save_scan_options(kf, group, sdi);
+		set_string(kf, group, "vendor", sdi->vendor);
+		set_string(kf, group, "model", sdi->model);
+		set_string(kf, group, "serial_num", sdi->serial_num);
+		set_string(kf, group, "connection_id", sr_dev_inst_connid_get(sdi));
+		g_free(group);
+	}
+
+	data = g_key_file_to_data(kf, &len, NULL);
+	g_key_file_free(kf);
+
+	error = NULL;
+	ret = SR_OK;
+	if (!g_file_set_contents(filename, data, len, &error)) {
+		sr_err("Failed to write device cache: %s", error->message);
+		g_error_free(error);
+		ret = SR_ERR_IO;
+	}
+	g_free(data);
+
+	sr_dbg("Saved %u devices to %s.", n, filename);
+
+	return ret;
+}
+
+static struct sr_dev_driver *driver_find(const struct sr_context *ctx,
+		const char *name)
+{
+	struct sr_dev_driver **drivers;
+	int i;
+
+	drivers = sr_driver_list(ctx);
+	for (i = 0; drivers && drivers[i]; i++) {
+		if (!strcmp(drivers[i]->name, name))
+			return drivers[i];
+	}
+
+	return NULL;
+}
+
+static gboolean entry_matches(const struct cache_entry *entry,
+		struct sr_dev_inst *sdi)
+{
+	if (entry->vendor && g_strcmp0(entry->vendor, sdi->vendor))
+		return FALSE;
+	if (entry->model && g_strcmp0(entry->model, sdi->model))
+		return FALSE;
+
+	/*
+	 * A serial number identifies the device wherever it's plugged in,
+	 * otherwise it has to be the one on the same connection.
+	 */
+	if (entry->serial_num)
+		return !g_strcmp0(entry->serial_num, sdi->serial_num);
+	if (entry->connection_id)
+		return !g_strcmp0(entry->connection_id,
+				sr_dev_inst_connid_get(sdi));
+
+	return TRUE;
+}
+
+/*
+ * Whether a device was already reconnected, possibly as another instance
+ * found by an earlier scan of the same driver.
+ */
+static gboolean already_found(struct sr_dev_inst *sdi, GSList *devices)
+{
+	struct sr_dev_inst *prev;
+	const char *connid;
+	GSList *l;
+
+	if (g_slist_find(devices, sdi))
+		return TRUE;
+	if (!(connid = sr_dev_inst_connid_get(sdi)))
+		return FALSE;
+
+	for (l = devices; l; l = l->next) {
+		prev = l->data;
+		if (prev->driver == sdi->driver
+				&& !g_strcmp0(connid, sr_dev_inst_connid_get(prev)))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static struct sr_dev_inst *entry_find(const struct cache_entry *entry,
+		GSList *found, GSList *devices)
+{
+	GSList *l;
+
+	for (l = found; l; l = l->next) {
+		if (!already_found(l->data, devices) && entry_matches(entry, l->data))
+			return l->data;
+	}
+
+	return NULL;
+}
+
+/*
+ * Free the instances which scans added to the driver while reconnecting,
+ * but which didn't turn out to be one of the cached devices. The driver's
+ * own dev_clear() is run on just those, so that their private state is
+ * freed the way the driver does it.
+ */
+static void discard_unused(struct sr_dev_driver *driver, GSList *previous,
+		GSList *devices)
+{
+	struct drv_context *drvc;
+	GSList *l, *keep, *unused;
+
+	drvc = driver->context;
+	keep = unused = NULL;
+	for (l = drvc->instances; l; l = l->next) {
+		if (g_slist_find(previous, l->data) || g_slist_find(devices, l->data))
+			keep = g_slist_append(keep, l->data);
+		else
+			unused = g_slist_append(unused, l->data);
+	}
+
+	g_slist_free(drvc->instances);
+	if (unused) {
+		sr_dbg("Freeing %u unused instances of driver '%s'.",
+			g_slist_length(unused), driver->name);
+		drvc->instances = unused;
+		sr_dev_clear(driver);
+	}
+	drvc->instances = keep;
+}
+
+/* Scan for the device on its cached connection only. */
+static struct sr_dev_inst *entry_scan(struct sr_dev_driver *driver,
+		const struct cache_entry *entry, GSList *devices)
+{
+	struct sr_config conn, serialcomm;
+	struct sr_dev_inst *sdi;
+	GSList *options, *found;
+
+	if (!entry->conn || !has_scan_option(driver, SR_CONF_CONN))
+		return NULL;
+
+	conn.key = SR_CONF_CONN;
+	conn.data = g_variant_ref_sink(g_variant_new_string(entry->conn));
+	options = g_slist_append(NULL, &conn);
+	if (entry->serialcomm && has_scan_option(driver, SR_CONF_SERIALCOMM)) {
+		serialcomm.key = SR_CONF_SERIALCOMM;
+		serialcomm.data = g_variant_ref_sink(
+				g_variant_new_string(entry->serialcomm));
+		options = g_slist_append(options, &serialcomm);
+	}
+
+	found = sr_driver_scan(driver, options);
+	sdi = entry_find(entry, found, devices);
+
+	g_slist_free(found);
+	g_variant_unref(conn.data);
+	if (options->next)
+		g_variant_unref(serialcomm.data);
+	g_slist_free(options);
+
+	return sdi;
+}
+
+static char *get_string(GKeyFile *kf, const char *group, const char *key)
+{
+	char *value;
+
+	value = g_key_file_get_string(kf, group, key, NULL);
+	if (value && !*value) {
+		g_free(value);
+		value = NULL;
+	}
+
+	return value;
+}
+
+/**
+ * Reconnect to the devices recorded in a cache file.
+ *
+ * Each cached device is looked for on its cached connection first, if
+ * its driver supports that. This only probes the one port or resource
+ * the device was found on before. Devices which aren't found there, or
+ * turn out to be different devices, and devices of drivers which can't
+ * scan a given connection, are looked for with a full scan of their
+ * driver. Each driver is fully scanned at most once, and drivers which
+ * have no device in the cache aren't scanned at all.
+ *
+ * Drivers are initialized as needed. Firmware is only uploaded to
+ * devices which don't already run it, as in any other scan. Instances
+ * which these scans create for other devices are freed again, so that
+ * only the returned devices are added to the drivers' device lists.
+ *
+ * @param ctx The libsigrok context. Must not be NULL.
+ * @param filename The name of a cache file written by sr_dev_cache_save().
+ *                 Must not be NULL.
+ *
+ * @return A GSList * of 'struct sr_dev_inst' for the cached devices that
+ *         were found, in cache order, or NULL if none were found or the
+ *         cache couldn't be read. The list must be freed by the caller
+ *         using g_slist_free(), but without freeing the data pointed to
+ *         in the list.
+ *
+ * @since 0.6.0
+ */
+SR_API GSList *sr_dev_cache_reconnect(struct sr_context *ctx,
+		const char *filename)
+{
+	GKeyFile *kf;
+	GError *error;
+	GHashTable *scanned, *previous;
+	GHashTableIter iter;
+	GSList *devices, *found;
+	struct sr_dev_driver *driver;
+	struct drv_context *drvc;
+	gpointer key, value;
+	struct sr_dev_inst *sdi;
+	struct cache_entry entry;
+	char **groups;
+	unsigned int i;
+
+	if (!ctx || !filename) {
+		sr_err("%s: invalid argument", __func__);
+		return NULL;
+	}
+
+	kf = g_key_file_new();
+	error = NULL;
+	if (!g_key_file_load_from_file(kf, filename, G_KEY_FILE_NONE, &error)) {
+		sr_dbg("Failed to read device cache: %s", error->message);
+		g_error_free(error);
+		g_key_file_free(kf);
+		return NULL;
+	}
+
+	/* Results of full driver scans, by driver. */
+	scanned = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)g_slist_free);
+	/* Instances each driver had before it was scanned here, by driver. */
+	previous = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, (GDestroyNotify)g_slist_free);
+
+	devices = NULL;
+	groups = g_key_file_get_groups(kf, NULL);
+	for (i = 0; groups[i]; i++) {
+		memset(&entry, 0, sizeof(entry));
+		entry.driver = get_string(kf, groups[i], "driver");
+		entry.conn = get_string(kf, groups[i], "conn");
+		entry.serialcomm = get_string(kf, groups[i], "serialcomm");
+		entry.vendor = get_string(kf, groups[i], "vendor");
+		entry.model = get_string(kf, groups[i], "model");
+		entry.serial_num = get_string(kf, groups[i], "serial_num");
+		entry.connection_id = get_string(kf, groups[i], "connection_id");
+
+		driver = entry.driver ? driver_find(ctx, entry.driver) : NULL;
+		if (!driver) {
+			sr_warn("Skipping cached device of unknown driver '%s'.",
+				entry.driver ? entry.driver : "");
+			entry_clear(&entry);
+			continue;
+		}
+		if (!driver->context && sr_driver_init(ctx, driver) != SR_OK) {
+			entry_clear(&entry);
+			continue;
+		}
+		if (!g_hash_table_contains(previous, driver)) {
+			drvc = driver->context;
+			g_hash_table_insert(previous, driver,
+					g_slist_copy(drvc->instances));
+		}
+
+		sdi = entry_scan(driver, &entry, devices);
+		if (!sdi) {
+			if (!g_hash_table_contains(scanned, driver)) {
+				sr_dbg("Full scan of driver '%s'.", driver->name);
+				found = sr_driver_scan(driver, NULL);
+				g_hash_table_insert(scanned, driver, found);
+			}
+			found = g_hash_table_lookup(scanned, driver);
+			sdi = entry_find(&entry, found, devices);
+		}
+
+		if (sdi)
+			devices = g_slist_append(devices, sdi);
+		else
+			sr_info("Cached device %s %s of driver '%s' not found.",
+				entry.vendor ? entry.vendor : "",
+				entry.model ? entry.model : "", driver->name);
+		entry_clear(&entry);
+	}
+	g_strfreev(groups);
+	g_hash_table_destroy(scanned);
+
+	g_hash_table_iter_init(&iter, previous);
+	while (g_hash_table_iter_next(&iter, &key, &value))
+		discard_unused(key, value, devices);
+	g_hash_table_destroy(previous);
+	g_key_file_free(kf);
+
+	return devices;
+}
+
+/** @} */
@@ -30,6 +30,14 @@
 
 #define LOG_PREFIX "brymen-bm25x"
 
+/* Packets start with STX (0x02). */
+SR_PRIV const struct sr_packet_sync sr_brymen_bm25x_packet_sync = {
+	.packet_size = BRYMEN_BM25X_PACKET_SIZE,
+	.sync_offset = 0,
+	.sync_mask = 0xff,
+	.sync = "\x02",
+};
+
 #define MAX_DIGITS 4
 
 SR_PRIV gboolean sr_brymen_bm25x_packet_valid(const uint8_t *buf)
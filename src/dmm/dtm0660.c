@@ -40,6 +40,14 @@
 
 #define LOG_PREFIX "dtm0660"
 
+/* The upper nibble of byte n is n + 1, so the first one is 0x1. */
+SR_PRIV const struct sr_packet_sync sr_dtm0660_packet_sync = {
+	.packet_size = DTM0660_PACKET_SIZE,
+	.sync_offset = 0,
+	.sync_mask = 0xf0,
+	.sync = "\x10",
+};
+
 static int parse_digit(uint8_t b)
 {
 	switch (b) {
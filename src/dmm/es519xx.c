@@ -35,6 +35,19 @@
 
 #define LOG_PREFIX "es519xx"
 
+/* Both chip variants end their packets with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_es519xx_11b_packet_sync = {
+	.packet_size = ES519XX_11B_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
+SR_PRIV const struct sr_packet_sync sr_es519xx_14b_packet_sync = {
+	.packet_size = ES519XX_14B_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 /* Exponents for the respective measurement mode. */
 static const int exponents_2400_11b[9][8] = {
 	{  -4,  -3,  -2, -1,  0,  0,  0,  0 }, /* V */
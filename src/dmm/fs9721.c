@@ -41,6 +41,14 @@
 
 #define LOG_PREFIX "fs9721"
 
+/* The upper nibble of byte n is n + 1, so the first one is 0x1. */
+SR_PRIV const struct sr_packet_sync sr_fs9721_packet_sync = {
+	.packet_size = FS9721_PACKET_SIZE,
+	.sync_offset = 0,
+	.sync_mask = 0xf0,
+	.sync = "\x10",
+};
+
 static int parse_digit(uint8_t b)
 {
 	switch (b) {
@@ -32,6 +32,15 @@
 
 #define LOG_PREFIX "fs9922"
 
+/* Packets start with the sign and end with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_fs9922_packet_sync = {
+	.packet_size = FS9922_PACKET_SIZE,
+	.sync_offset = 0,
+	.sync_mask = 0xff,
+	.sync = "+-",
+	.terminator = "\r\n",
+};
+
 static gboolean flags_valid(const struct fs9922_info *info)
 {
 	int count;
@@ -34,6 +34,13 @@
 
 #define LOG_PREFIX "m2110"
 
+/* Packets are text lines ending with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_m2110_packet_sync = {
+	.packet_size = BBCGM_M2110_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 SR_PRIV gboolean sr_m2110_packet_valid(const uint8_t *buf)
 {
 	float val;
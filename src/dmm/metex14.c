@@ -41,6 +41,13 @@
 
 #define LOG_PREFIX "metex14"
 
+/* Packets are text lines ending with CR only. */
+SR_PRIV const struct sr_packet_sync sr_metex14_packet_sync = {
+	.packet_size = METEX14_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r",
+};
+
 /** Parse value from buf, byte 2-8. */
 static int parse_value(const uint8_t *buf, struct metex14_info *info,
 			float *result, int *exponent)
@@ -38,6 +38,12 @@
 
 #define LOG_PREFIX "rs9lcd"
 
+/* No fixed bytes, only the checksum tells packets apart. */
+SR_PRIV const struct sr_packet_sync sr_rs9lcd_packet_sync = {
+	.packet_size = RS9LCD_PACKET_SIZE,
+	.sync_mask = 0xff,
+};
+
 /* Byte 1 of the packet, and the modes it represents */
 #define IND1_HZ		(1 << 7)
 #define IND1_OHM	(1 << 6)
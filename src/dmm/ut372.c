@@ -31,6 +31,13 @@
 
 #define LOG_PREFIX "ut372"
 
+/* Packets end with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_ut372_packet_sync = {
+	.packet_size = UT372_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 static const uint8_t lookup[] = {
 	0x7B,
 	0x60,
@@ -34,6 +34,13 @@
 
 #define LOG_PREFIX "ut71x"
 
+/* Packets end with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_ut71x_packet_sync = {
+	.packet_size = UT71X_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 /*
  * Exponents for the respective measurement mode.
  *
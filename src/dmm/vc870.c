@@ -28,6 +28,13 @@
 
 #define LOG_PREFIX "vc870"
 
+/* Packets end with CR/LF. */
+SR_PRIV const struct sr_packet_sync sr_vc870_packet_sync = {
+	.packet_size = VC870_PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 /* Exponents for the respective measurement mode. */
 static const int exponents[][8] = {
 	{  -4,  -3,  -2, -1,  0,  0,  0,  0 }, /* DCV */
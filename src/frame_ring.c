@@ -0,0 +1,443 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * Frame acquisition helper functions
+ * @internal
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "frame_ring"
+
+static void frames_free(struct sr_frame_ring *ring)
+{
+	struct sr_frame *frame;
+	unsigned int i, j;
+
+	for (i = 0; i < ring->num_frames; i++) {
+		frame = &ring->frames[i];
+		for (j = 0; j < ring->num_channels; j++) {
+			g_free(frame->channels[j].data);
+			g_slist_free(frame->channels[j].meaning.channels);
+		}
+		g_free(frame->channels);
+	}
+	g_free(ring->frames);
+	ring->frames = NULL;
+	ring->num_frames = 0;
+	ring->num_channels = 0;
+}
+
+static gboolean limit_reached(const struct sr_frame_ring *ring)
+{
+	return ring->limit_frames && ring->frames_committed >= ring->limit_frames;
+}
+
+/* Announce the index, time and trigger position of a frame. */
+static void frame_info_send(const struct sr_dev_inst *sdi,
+		const struct sr_frame_info *info)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+
+	meta.config = g_slist_append(NULL, sr_config_new(SR_CONF_FRAME_INDEX,
+		g_variant_new_uint64(info->index)));
+	meta.config = g_slist_append(meta.config,
+		sr_config_new(SR_CONF_FRAME_TIMESTAMP,
+		g_variant_new_uint64(info->timestamp)));
+	if (info->trigger_offset >= 0)
+		meta.config = g_slist_append(meta.config,
+			sr_config_new(SR_CONF_FRAME_TRIGGER_OFFSET,
+			g_variant_new_uint64(info->trigger_offset)));
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	sr_session_send(sdi, &packet);
+
+	g_slist_free_full(meta.config, (GDestroyNotify)sr_config_free);
+}
+
+static void frame_send(const struct sr_dev_inst *sdi,
+		const struct sr_frame_ring *ring, struct sr_frame *frame)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	struct sr_frame_channel *fch;
+	unsigned int i;
+
+	packet.type = SR_DF_FRAME_BEGIN;
+	packet.payload = NULL;
+	sr_session_send(sdi, &packet);
+	frame_info_send(sdi, &frame->info);
+
+	for (i = 0; i < ring->num_channels && frame->num_samples; i++) {
+		fch = &frame->channels[i];
+		memset(&analog, 0, sizeof(analog));
+		analog.data = fch->data;
+		analog.num_samples = frame->num_samples;
+		analog.encoding = &fch->encoding;
+		analog.meaning = &fch->meaning;
+		analog.spec = &fch->spec;
+		packet.type = SR_DF_ANALOG;
+		packet.payload = &analog;
+		sr_session_send(sdi, &packet);
+	}
+
+	packet.type = SR_DF_FRAME_END;
+	packet.payload = NULL;
+	sr_session_send(sdi, &packet);
+}
+
+/**
+ * Initialize a frame ring instance
+ *
+ * Must be called before any other operations are performed on a struct
+ * sr_frame_ring. The frame limit is disabled until configured.
+ *
+ * @param ring the frame ring instance to initialize
+ */
+SR_PRIV void sr_frame_ring_init(struct sr_frame_ring *ring)
+{
+	memset(ring, 0, sizeof(*ring));
+	g_mutex_init(&ring->mutex);
+	g_cond_init(&ring->cond);
+}
+
+/**
+ * Release all resources of a frame ring instance
+ *
+ * @param ring the frame ring instance
+ */
+SR_PRIV void sr_frame_ring_clear(struct sr_frame_ring *ring)
+{
+	frames_free(ring);
+	g_mutex_clear(&ring->mutex);
+	g_cond_clear(&ring->cond);
+}
+
+/**
+ * Get frame ring configuration
+ *
+ * Should be called from the drivers config_get() callback.
+ *
+ * @param ring frame ring instance
+ * @param key config item key
+ * @param data config item data
+ * @return SR_ERR_NA if @p key is not a frame ring setting, SR_OK otherwise
+ */
+SR_PRIV int sr_frame_ring_config_get(struct sr_frame_ring *ring,
+	uint32_t key, GVariant **data)
+{
+	switch (key) {
+	case SR_CONF_LIMIT_FRAMES:
+		*data = g_variant_new_uint64(ring->limit_frames);
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Set frame ring configuration
+ *
+ * Should be called from the drivers config_set() callback.
+ *
+ * @param ring frame ring instance
+ * @param key config item key
+ * @param data config item data
+ * @return SR_ERR_NA if @p key is not a frame ring setting, SR_OK otherwise
+ */
+SR_PRIV int sr_frame_ring_config_set(struct sr_frame_ring *ring,
+	uint32_t key, GVariant *data)
+{
+	switch (key) {
+	case SR_CONF_LIMIT_FRAMES:
+		ring->limit_frames = g_variant_get_uint64(data);
+		break;
+	default:
+		return SR_ERR_NA;
+	}
+
+	return SR_OK;
+}
+
+/**
+ * Allocate the frames of an acquisition
+ *
+ * Each frame has a buffer of @p max_samples samples for every channel,
+ * and is sent as one analog packet per channel. The encoding of each
+ * channel is initialized for samples of @p unitsize bytes, the filler
+ * completes it.
+ *
+ * The buffers are kept when the next acquisition uses the same layout.
+ *
+ * @param ring frame ring instance
+ * @param num_frames number of frames in the ring
+ * @param channels the enabled channels, in the order they are sent
+ * @param max_samples capacity of a frame, in samples per channel
+ * @param unitsize size of a sample, in bytes
+ * @param drop_frames if TRUE, frames are dropped while the ring is full,
+ *                    otherwise sr_frame_ring_begin() waits for a free frame
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid arguments.
+ * @retval SR_ERR_MALLOC Out of memory.
+ */
+SR_PRIV int sr_frame_ring_acquisition_start(struct sr_frame_ring *ring,
+	unsigned int num_frames, const GSList *channels,
+	unsigned int max_samples, unsigned int unitsize, gboolean drop_frames)
+{
+	struct sr_datafeed_analog analog;
+	struct sr_frame_channel *fch;
+	struct sr_frame *frame;
+	const GSList *l;
+	unsigned int num_channels, i, j;
+
+	num_channels = g_slist_length((GSList *)channels);
+	if (!num_frames || !num_channels || !max_samples || !unitsize)
+		return SR_ERR_ARG;
+
+	if (ring->num_frames != num_frames || ring->num_channels != num_channels
+			|| ring->max_samples != max_samples
+			|| ring->unitsize != unitsize) {
+		frames_free(ring);
+		ring->frames = g_try_malloc0(sizeof(struct sr_frame) * num_frames);
+		if (!ring->frames)
+			return SR_ERR_MALLOC;
+		ring->num_frames = num_frames;
+		ring->num_channels = num_channels;
+		for (i = 0; i < num_frames; i++) {
+			frame = &ring->frames[i];
+			frame->channels = g_malloc0(sizeof(struct sr_frame_channel)
+				* num_channels);
+			for (j = 0; j < num_channels; j++) {
+				fch = &frame->channels[j];
+				if (!(fch->data = g_try_malloc(max_samples * unitsize))) {
+					frames_free(ring);
+					return SR_ERR_MALLOC;
+				}
+			}
+		}
+		ring->max_samples = max_samples;
+		ring->unitsize = unitsize;
+	}
+
+	for (i = 0; i < num_frames; i++) {
+		frame = &ring->frames[i];
+		for (l = channels, j = 0; l; l = l->next, j++) {
+			fch = &frame->channels[j];
+			g_slist_free(fch->meaning.channels);
+			sr_analog_init(&analog, &fch->encoding, &fch->meaning,
+				&fch->spec, 0);
+			fch->encoding.unitsize = unitsize;
+			fch->encoding.is_float = FALSE;
+			fch->meaning.channels = g_slist_append(NULL, l->data);
+		}
+	}
+
+	ring->drop_frames = drop_frames;
+	ring->read = ring->pending = 0;
+	ring->frames_started = ring->frames_committed = 0;
+	ring->frames_sent = ring->frames_dropped = 0;
+	ring->running = TRUE;
+
+	return SR_OK;
+}
+
+/**
+ * Stop the acquisition
+ *
+ * Wakes up a producer waiting for a free frame. Frames which were not
+ * sent yet are discarded.
+ *
+ * @param ring frame ring instance
+ */
+SR_PRIV void sr_frame_ring_acquisition_stop(struct sr_frame_ring *ring)
+{
+	g_mutex_lock(&ring->mutex);
+	ring->running = FALSE;
+	ring->pending = 0;
+	g_cond_broadcast(&ring->cond);
+	g_mutex_unlock(&ring->mutex);
+
+	sr_dbg("%" PRIu64 " frames sent, %" PRIu64 " dropped.",
+		ring->frames_sent, ring->frames_dropped);
+}
+
+/**
+ * Get a frame to fill
+ *
+ * Sets up the frame information for a frame captured now. Once filled,
+ * the frame is queued with sr_frame_ring_commit(). A frame which isn't
+ * committed is reused by the next call.
+ *
+ * If all frames are queued, and frames are not dropped, this waits for
+ * sr_frame_ring_send() to release one. Drivers which fill frames in the
+ * session thread should send them right after committing, so the ring
+ * never fills up.
+ *
+ * @param ring frame ring instance
+ * @param sdi the device instance the frame belongs to
+ * @return the frame to fill, or NULL if the frame limit was reached, the
+ *         acquisition was stopped, or the frame was dropped
+ */
+SR_PRIV struct sr_frame *sr_frame_ring_begin(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi)
+{
+	struct sr_frame *frame;
+	uint64_t index;
+
+	g_mutex_lock(&ring->mutex);
+	while (ring->running && !limit_reached(ring) && !ring->drop_frames
+			&& ring->pending == ring->num_frames)
+		g_cond_wait(&ring->cond, &ring->mutex);
+
+	if (!ring->running || limit_reached(ring)) {
+		g_mutex_unlock(&ring->mutex);
+		return NULL;
+	}
+
+	index = ring->frames_started++;
+	if (ring->pending == ring->num_frames) {
+		ring->frames_dropped++;
+		g_mutex_unlock(&ring->mutex);
+		sr_spew("Dropping frame %" PRIu64 ".", index);
+		sr_session_metrics_frame_dropped(sdi);
+		return NULL;
+	}
+	frame = &ring->frames[(ring->read + ring->pending) % ring->num_frames];
+	g_mutex_unlock(&ring->mutex);
+
+	frame->info.index = index;
+	frame->info.timestamp = g_get_real_time();
+	frame->info.trigger_offset = -1;
+	frame->num_samples = 0;
+
+	return frame;
+}
+
+/**
+ * Queue a filled frame for sending
+ *
+ * @param ring frame ring instance
+ * @param frame the frame returned by sr_frame_ring_begin()
+ */
+SR_PRIV void sr_frame_ring_commit(struct sr_frame_ring *ring,
+	struct sr_frame *frame)
+{
+	g_mutex_lock(&ring->mutex);
+	if (ring->running && frame == &ring->frames[(ring->read + ring->pending)
+			% ring->num_frames]) {
+		ring->pending++;
+		ring->frames_committed++;
+	}
+	g_mutex_unlock(&ring->mutex);
+}
+
+/**
+ * Fill a frame and queue it for sending
+ *
+ * @param ring frame ring instance
+ * @param sdi the device instance the frame belongs to
+ * @param fill the callback filling the frame. The frame is only queued
+ *             if it returns SR_OK.
+ * @param cb_data opaque pointer passed to @p fill
+ * @return the result of @p fill, or SR_OK if no frame was filled, see
+ *         sr_frame_ring_begin()
+ */
+SR_PRIV int sr_frame_ring_fill(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi, sr_frame_fill_callback fill,
+	void *cb_data)
+{
+	struct sr_frame *frame;
+	int ret;
+
+	if (!(frame = sr_frame_ring_begin(ring, sdi)))
+		return SR_OK;
+
+	if ((ret = fill(sdi, frame, cb_data)) == SR_OK)
+		sr_frame_ring_commit(ring, frame);
+
+	return ret;
+}
+
+/**
+ * Send all queued frames
+ *
+ * Must be called from the session thread. Each frame is sent as an
+ * SR_DF_FRAME_BEGIN packet, an SR_DF_META packet with the frame
+ * information, one analog packet per channel and an SR_DF_FRAME_END packet.
+ *
+ * @param ring frame ring instance
+ * @param sdi the device instance the frames belong to
+ * @return the number of frames sent
+ */
+SR_PRIV unsigned int sr_frame_ring_send(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi)
+{
+	struct sr_frame *frame;
+	unsigned int sent;
+
+	for (sent = 0; ; sent++) {
+		g_mutex_lock(&ring->mutex);
+		if (!ring->pending) {
+			g_mutex_unlock(&ring->mutex);
+			break;
+		}
+		frame = &ring->frames[ring->read];
+		g_mutex_unlock(&ring->mutex);
+
+		/* The frame stays queued while it's sent, so it isn't refilled. */
+		frame_send(sdi, ring, frame);
+
+		g_mutex_lock(&ring->mutex);
+		if (ring->pending) {
+			ring->read = (ring->read + 1) % ring->num_frames;
+			ring->pending--;
+		}
+		ring->frames_sent++;
+		g_cond_signal(&ring->cond);
+		g_mutex_unlock(&ring->mutex);
+	}
+
+	return sent;
+}
+
+/**
+ * Check whether the frame limit was reached
+ *
+ * @param ring frame ring instance
+ * @returns TRUE if the configured number of frames was acquired and sent.
+ */
+SR_PRIV gboolean sr_frame_ring_limit_reached(struct sr_frame_ring *ring)
+{
+	gboolean ret;
+
+	g_mutex_lock(&ring->mutex);
+	ret = limit_reached(ring) && !ring->pending;
+	g_mutex_unlock(&ring->mutex);
+
+	return ret;
+}
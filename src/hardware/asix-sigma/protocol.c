@@ -678,6 +678,46 @@ static uint16_t sigma_dram_cluster_ts(struct sigma_dram_cluster *cluster)
 	return (cluster->timestamp_hi << 8) | cluster->timestamp_lo;
 }
 
+/* Send the collected samples to the session bus. */
+static void sigma_flush_samples(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc = sdi->priv;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+
+	if (devc->sample_count == 0)
+		return;
+
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+	logic.unitsize = 2;
+	logic.length = devc->sample_count * logic.unitsize;
+	logic.data = devc->sample_buf;
+	sr_session_send(sdi, &packet);
+
+	devc->sample_count = 0;
+}
+
+/*
+ * Append a sample (repeated @a count times) to the sample buffer. Full
+ * buffers are sent, so the session gets few large packets instead of
+ * one per DRAM cluster.
+ */
+static void sigma_add_samples(struct sr_dev_inst *sdi, uint16_t sample,
+			      size_t count)
+{
+	struct dev_context *devc = sdi->priv;
+	uint8_t *p;
+
+	while (count--) {
+		p = devc->sample_buf + 2 * devc->sample_count;
+		p[0] = sample & 0xff;
+		p[1] = sample >> 8;
+		if (++devc->sample_count == SAMPLE_BUF_SAMPLES)
+			sigma_flush_samples(sdi);
+	}
+}
+
 static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 				      unsigned int events_in_cluster,
 				      unsigned int triggered,
@@ -686,20 +726,15 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 	struct dev_context *devc = sdi->priv;
 	struct sigma_state *ss = &devc->state;
 	struct sr_datafeed_packet packet;
-	struct sr_datafeed_logic logic;
-	uint16_t tsdiff, ts;
-	uint8_t samples[2048];
-	unsigned int i;
+	uint16_t tsdiff, ts, sample;
+	/* get_trigger_offset() looks at one more sample than a cluster has. */
+	uint8_t samples[2 * (EVENTS_PER_CLUSTER + 1)] = { 0 };
+	unsigned int i, trigger_offset;
 
 	ts = sigma_dram_cluster_ts(dram_cluster);
 	tsdiff = ts - ss->lastts;
 	ss->lastts = ts;
 
-	packet.type = SR_DF_LOGIC;
-	packet.payload = &logic;
-	logic.unitsize = 2;
-	logic.data = samples;
-
 	/*
 	 * First of all, send Sigrok a copy of the last sample from
 	 * previous cluster as many times as needed to make up for
@@ -711,21 +746,9 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 	 * sample in the cluster happens at the time of the timestamp
 	 * and the remaining samples happen at timestamp +1...+6 .
 	 */
-	for (ts = 0; ts < tsdiff - (EVENTS_PER_CLUSTER - 1); ts++) {
-		i = ts % 1024;
-		samples[2 * i + 0] = ss->lastsample & 0xff;
-		samples[2 * i + 1] = ss->lastsample >> 8;
-
-		/*
-		 * If we have 1024 samples ready or we're at the
-		 * end of submitting the padding samples, submit
-		 * the packet to Sigrok.
-		 */
-		if ((i == 1023) || (ts == (tsdiff - EVENTS_PER_CLUSTER))) {
-			logic.length = (i + 1) * logic.unitsize;
-			sr_session_send(sdi, &packet);
-		}
-	}
+	if (tsdiff > EVENTS_PER_CLUSTER - 1)
+		sigma_add_samples(sdi, ss->lastsample,
+				  tsdiff - (EVENTS_PER_CLUSTER - 1));
 
 	/*
 	 * Parse the samples in current cluster and prepare them
@@ -737,7 +760,7 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 	}
 
 	/* Send data up to trigger point (if triggered). */
-	int trigger_offset = 0;
+	trigger_offset = 0;
 	if (triggered) {
 		/*
 		 * Trigger is not always accurate to sample because of
@@ -747,32 +770,23 @@ static void sigma_decode_dram_cluster(struct sigma_dram_cluster *dram_cluster,
 		 */
 		trigger_offset = get_trigger_offset(samples,
 					ss->lastsample, &devc->trigger);
+	}
 
-		if (trigger_offset > 0) {
-			packet.type = SR_DF_LOGIC;
-			logic.length = trigger_offset * logic.unitsize;
-			sr_session_send(sdi, &packet);
-			events_in_cluster -= trigger_offset;
-		}
-
+	for (i = 0; i <= events_in_cluster; i++) {
 		/* Only send trigger if explicitly enabled. */
-		if (devc->use_triggers) {
+		if (triggered && devc->use_triggers &&
+		    i == MIN(trigger_offset, events_in_cluster)) {
+			sigma_flush_samples(sdi);
 			packet.type = SR_DF_TRIGGER;
+			packet.payload = NULL;
 			sr_session_send(sdi, &packet);
 		}
+		if (i == events_in_cluster)
+			break;
+		sample = samples[2 * i] | (samples[2 * i + 1] << 8);
+		sigma_add_samples(sdi, sample, 1);
+		ss->lastsample = sample;
 	}
-
-	if (events_in_cluster > 0) {
-		packet.type = SR_DF_LOGIC;
-		logic.length = events_in_cluster * logic.unitsize;
-		logic.data = samples + (trigger_offset * logic.unitsize);
-		sr_session_send(sdi, &packet);
-	}
-
-	ss->lastsample =
-		samples[2 * (events_in_cluster - 1) + 0] |
-		(samples[2 * (events_in_cluster - 1) + 1] << 8);
-
 }
 
 /*
@@ -828,23 +842,80 @@ static int decode_chunk_ts(struct sigma_dram_line *dram_line,
 	return SR_OK;
 }
 
+/* DRAM lines read in one go, and number of such batches in flight. */
+#define DRAM_LINES_PER_READ	32
+#define DRAM_BATCHES		2
+
+/* A batch of DRAM lines, passed between the download worker and decoder. */
+struct sigma_dram_batch {
+	struct sigma_dram_line lines[DRAM_LINES_PER_READ];
+	uint32_t first_line;
+	uint32_t num_lines;
+	int ret;
+};
+
+struct sigma_download {
+	struct dev_context *devc;
+	uint32_t lines_total;
+	/* Batches ready to be filled by the worker. */
+	GAsyncQueue *free_batches;
+	/* Batches filled by the worker, ready to be decoded. */
+	GAsyncQueue *full_batches;
+};
+
+/*
+ * Read the DRAM contents batch by batch. This runs in its own thread,
+ * so USB transfers of the next batch overlap with decoding of the
+ * previous one. The FTDI context is used by this thread exclusively
+ * until it terminates.
+ */
+static gpointer sigma_download_worker(gpointer data)
+{
+	struct sigma_download *dl = data;
+	struct sigma_dram_batch *batch;
+	uint32_t line;
+	int ret;
+
+	for (line = 0; line < dl->lines_total; line += batch->num_lines) {
+		batch = g_async_queue_pop(dl->free_batches);
+		batch->first_line = line;
+		batch->num_lines = MIN(DRAM_LINES_PER_READ, dl->lines_total - line);
+		ret = sigma_read_dram(line, batch->num_lines,
+				      (uint8_t *)batch->lines, dl->devc);
+		if (ret >= 0 && (size_t)ret < batch->num_lines * CHUNK_SIZE)
+			sr_warn("Short DRAM read: %d bytes.", ret);
+		batch->ret = ret < 0 ? SR_ERR_IO : SR_OK;
+		g_async_queue_push(dl->full_batches, batch);
+		if (batch->ret != SR_OK)
+			break;
+	}
+
+	return NULL;
+}
+
 static int download_capture(struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc = sdi->priv;
-	const uint32_t chunks_per_read = 32;
-	struct sigma_dram_line *dram_line;
-	int bufsz;
+	struct sigma_download dl;
+	struct sigma_dram_batch *batches, *batch;
+	GThread *worker;
 	uint32_t stoppos, triggerpos;
 	uint8_t modestatus;
 
-	uint32_t i;
-	uint32_t dl_lines_total, dl_lines_curr, dl_lines_done;
-	uint32_t dl_events_in_line = 64 * 7;
+	uint32_t i, line;
+	uint32_t dl_lines_done;
+	uint32_t dl_events_in_line;
 	uint32_t trg_line = ~0, trg_event = ~0;
 
-	dram_line = g_try_malloc0(chunks_per_read * sizeof(*dram_line));
-	if (!dram_line)
+	batches = g_try_malloc0(DRAM_BATCHES * sizeof(*batches));
+	devc->sample_buf = g_try_malloc(SAMPLE_BUF_SAMPLES * 2);
+	if (!batches || !devc->sample_buf) {
+		g_free(batches);
+		g_free(devc->sample_buf);
+		devc->sample_buf = NULL;
 		return FALSE;
+	}
+	devc->sample_count = 0;
 
 	sr_info("Downloading sample data.");
 
@@ -869,49 +940,67 @@ static int download_capture(struct sr_dev_inst *sdi)
 	 * Sigma so we have a complete set of samples. Note that the last
 	 * line can be only partial, containing less than 64 clusters.
 	 */
-	dl_lines_total = (stoppos >> 9) + 1;
+	dl.devc = devc;
+	dl.lines_total = (stoppos >> 9) + 1;
+	dl.free_batches = g_async_queue_new();
+	dl.full_batches = g_async_queue_new();
+	for (i = 0; i < DRAM_BATCHES; i++)
+		g_async_queue_push(dl.free_batches, &batches[i]);
 
-	dl_lines_done = 0;
+	worker = g_thread_new("asix-sigma-dl", sigma_download_worker, &dl);
 
-	while (dl_lines_total > dl_lines_done) {
-		/* We can download only up-to 32 DRAM lines in one go! */
-		dl_lines_curr = MIN(chunks_per_read, dl_lines_total);
-
-		bufsz = sigma_read_dram(dl_lines_done, dl_lines_curr,
-					(uint8_t *)dram_line, devc);
-		/* TODO: Check bufsz. For now, just avoid compiler warnings. */
-		(void)bufsz;
+	dl_lines_done = 0;
+	while (dl.lines_total > dl_lines_done) {
+		batch = g_async_queue_pop(dl.full_batches);
+		if (batch->ret != SR_OK) {
+			sr_err("Failed to read DRAM lines %u to %u.",
+			       batch->first_line,
+			       batch->first_line + batch->num_lines - 1);
+			break;
+		}
 
 		/* This is the first DRAM line, so find the initial timestamp. */
 		if (dl_lines_done == 0) {
 			devc->state.lastts =
-				sigma_dram_cluster_ts(&dram_line[0].cluster[0]);
+				sigma_dram_cluster_ts(&batch->lines[0].cluster[0]);
 			devc->state.lastsample = 0;
 		}
 
-		for (i = 0; i < dl_lines_curr; i++) {
+		for (i = 0; i < batch->num_lines; i++) {
 			uint32_t trigger_event = ~0;
+
+			line = batch->first_line + i;
 			/* The last "DRAM line" can be only partially full. */
-			if (dl_lines_done + i == dl_lines_total - 1)
+			if (line == dl.lines_total - 1)
 				dl_events_in_line = stoppos & 0x1ff;
+			else
+				dl_events_in_line = 64 * 7;
 
 			/* Test if the trigger happened on this line. */
-			if (dl_lines_done + i == trg_line)
+			if (line == trg_line)
 				trigger_event = trg_event;
 
-			decode_chunk_ts(dram_line + i, dl_events_in_line,
+			decode_chunk_ts(&batch->lines[i], dl_events_in_line,
 					trigger_event, sdi);
 		}
 
-		dl_lines_done += dl_lines_curr;
+		dl_lines_done += batch->num_lines;
+		g_async_queue_push(dl.free_batches, batch);
 	}
 
+	g_thread_join(worker);
+	g_async_queue_unref(dl.free_batches);
+	g_async_queue_unref(dl.full_batches);
+	g_free(batches);
+
+	sigma_flush_samples(sdi);
+	g_free(devc->sample_buf);
+	devc->sample_buf = NULL;
+
 	std_session_send_df_end(sdi);
 
 	sdi->driver->dev_acquisition_stop(sdi);
 
-	g_free(dram_line);
-
 	return TRUE;
 }
 
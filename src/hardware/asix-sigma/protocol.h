@@ -89,6 +89,9 @@ enum sigma_read_register {
 
 #define CHUNK_SIZE		1024
 
+/* Number of samples collected before sending a packet. */
+#define SAMPLE_BUF_SAMPLES	(64 * 1024)
+
 /*
  * The entire ASIX Sigma DRAM is an array of struct sigma_dram_line[1024];
  */
@@ -218,6 +221,9 @@ struct dev_context {
 	struct sigma_trigger trigger;
 	int use_triggers;
 	struct sigma_state state;
+	/* Decoded samples not yet sent, during download. */
+	uint8_t *sample_buf;
+	size_t sample_count;
 };
 
 extern SR_PRIV const uint64_t samplerates[];
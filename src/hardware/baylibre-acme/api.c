@@ -19,6 +19,8 @@
 
 #include <config.h>
 #include "protocol.h"
+#include <errno.h>
+#include <fcntl.h>
 #include <time.h>
 #include <sys/timerfd.h>
 
@@ -26,6 +28,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_LIMIT_MSEC | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_SAMPLES | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_MSEC | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 };
 
@@ -61,6 +65,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	(void)options;
 
 	devc = g_malloc0(sizeof(struct dev_context));
+	sr_analog_batch_init(&devc->batch);
 	devc->samplerate = SR_HZ(10);
 
 	sdi = g_malloc0(sizeof(struct sr_dev_inst));
@@ -161,6 +166,10 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_LIMIT_MSEC:
 		ret = sr_sw_limits_config_get(&devc->limits, key, data);
 		break;
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		ret = sr_analog_batch_config_get(&devc->batch, key, data);
+		break;
 	case SR_CONF_SAMPLERATE:
 		*data = g_variant_new_uint64(devc->samplerate);
 		break;
@@ -204,6 +213,10 @@ static int config_set(uint32_t key, GVariant *data,
 	case SR_CONF_LIMIT_MSEC:
 		ret = sr_sw_limits_config_set(&devc->limits, key, data);
 		break;
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		ret = sr_analog_batch_config_set(&devc->batch, key, data);
+		break;
 	case SR_CONF_SAMPLERATE:
 		samplerate = g_variant_get_uint64(data);
 		if (samplerate > MAX_SAMPLE_RATE) {
@@ -308,9 +321,36 @@ static int dev_acquisition_open(const struct sr_dev_inst *sdi)
 	return 0;
 }
 
+static int open_wakeup_pipe(struct dev_context *devc)
+{
+	int i;
+
+	if (pipe(devc->wakeup_fds) < 0) {
+		sr_err("Error creating pipe: %s", g_strerror(errno));
+		return SR_ERR;
+	}
+
+	/* The sampling thread must never block on a slow main loop. */
+	for (i = 0; i < 2; i++)
+		fcntl(devc->wakeup_fds[i], F_SETFL,
+		      fcntl(devc->wakeup_fds[i], F_GETFL) | O_NONBLOCK);
+
+	return SR_OK;
+}
+
+static void close_wakeup_pipe(struct dev_context *devc)
+{
+	close(devc->wakeup_fds[0]);
+	close(devc->wakeup_fds[1]);
+}
+
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
+	struct sr_channel *ch;
+	GSList *chl;
+	GError *err;
+	uint64_t period;
 	struct itimerspec tspec = {
 		.it_interval = { 0, 0 },
 		.it_value = { 0, 0 }
@@ -324,51 +364,103 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 	devc = sdi->priv;
 	devc->samples_missed = 0;
+
+	devc->enabled = g_malloc(devc->num_channels * sizeof(struct sr_channel *));
+	devc->num_enabled = 0;
+	for (chl = sdi->channels; chl; chl = chl->next) {
+		ch = chl->data;
+		if (ch->enabled)
+			devc->enabled[devc->num_enabled++] = ch;
+	}
+	devc->block_size = MAX(devc->samplerate / BLOCKS_PER_SEC, 1);
+
 	devc->timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
 	if (devc->timer_fd < 0) {
 		sr_err("Error creating timer fd");
-		return SR_ERR;
+		goto err_close;
 	}
 
-	tspec.it_interval.tv_sec = 0;
-	tspec.it_interval.tv_nsec = SR_HZ_TO_NS(devc->samplerate);
+	period = SR_HZ_TO_NS(devc->samplerate);
+	tspec.it_interval.tv_sec = period / SR_GHZ(1);
+	tspec.it_interval.tv_nsec = period % SR_GHZ(1);
 	tspec.it_value = tspec.it_interval;
 
 	if (timerfd_settime(devc->timer_fd, 0, &tspec, NULL)) {
 		sr_err("Failed to set timer");
-		close(devc->timer_fd);
-		return SR_ERR;
+		goto err_close_timer;
 	}
 
-	devc->channel = g_io_channel_unix_new(devc->timer_fd);
-	g_io_channel_set_flags(devc->channel, G_IO_FLAG_NONBLOCK, NULL);
-	g_io_channel_set_encoding(devc->channel, NULL, NULL);
-	g_io_channel_set_buffered(devc->channel, FALSE);
+	if (open_wakeup_pipe(devc) != SR_OK)
+		goto err_close_timer;
 
-	sr_session_source_add_channel(sdi->session, devc->channel,
-		G_IO_IN | G_IO_ERR, 1000, bl_acme_receive_data, (void *)sdi);
+	g_mutex_init(&devc->mutex);
+	g_queue_init(&devc->blocks);
 
 	std_session_send_df_header(sdi);
 	sr_sw_limits_acquisition_start(&devc->limits);
 
+	sr_session_source_add(sdi->session, devc->wakeup_fds[0],
+		G_IO_IN | G_IO_ERR, 1000, bl_acme_receive_data, (void *)sdi);
+
+	g_atomic_int_set(&devc->running, 1);
+	err = NULL;
+	devc->thread = g_thread_try_new("baylibre-acme",
+		bl_acme_sampling_thread, (void *)sdi, &err);
+	if (!devc->thread) {
+		sr_err("Failed to start sampling thread: %s", err->message);
+		g_error_free(err);
+		sr_session_source_remove(sdi->session, devc->wakeup_fds[0]);
+		std_session_send_df_end(sdi);
+		g_mutex_clear(&devc->mutex);
+		close_wakeup_pipe(devc);
+		goto err_close_timer;
+	}
+
 	return SR_OK;
+
+err_close_timer:
+	close(devc->timer_fd);
+err_close:
+	g_free(devc->enabled);
+	devc->enabled = NULL;
+	dev_acquisition_close(sdi);
+
+	return SR_ERR;
 }
 
 static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
+	struct sample_block *block;
 
 	devc = sdi->priv;
 
 	if (sdi->status != SR_ST_ACTIVE)
 		return SR_ERR_DEV_CLOSED;
 
+	/* Already stopped after reaching a limit. */
+	if (!devc->thread)
+		return SR_OK;
+
+	g_atomic_int_set(&devc->running, 0);
+	g_thread_join(devc->thread);
+	devc->thread = NULL;
+	sr_session_source_remove(sdi->session, devc->wakeup_fds[0]);
+
+	/* Send what was sampled before the thread stopped, up to the limit. */
+	while ((block = g_queue_pop_head(&devc->blocks))) {
+		bl_acme_send_block(sdi, block);
+		bl_acme_block_free(block);
+	}
+	g_mutex_clear(&devc->mutex);
+
+	close_wakeup_pipe(devc);
+	close(devc->timer_fd);
+	g_free(devc->enabled);
+	devc->enabled = NULL;
 	dev_acquisition_close(sdi);
-	sr_session_source_remove_channel(sdi->session, devc->channel);
-	g_io_channel_shutdown(devc->channel, FALSE, NULL);
-	g_io_channel_unref(devc->channel);
-	devc->channel = NULL;
 
+	sr_analog_batch_flush(&devc->batch, sdi);
 	std_session_send_df_end(sdi);
 
 	if (devc->samples_missed > 0)
@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <glib/gstdio.h>
 #include "protocol.h"
@@ -52,7 +53,8 @@ struct channel_priv {
 	int ch_type;
 	int fd;
 	int digits;
-	float val;
+	float scale;
+	gboolean failed;
 	struct channel_group_priv *probe;
 };
 
@@ -104,6 +106,18 @@ static const uint32_t revB_pws_gpios[] = {
 #define MOHM_TO_UOHM(x) ((x) * 1000)
 #define UOHM_TO_MOHM(x) ((x) / 1000)
 
+/* Where sysfs is mounted. */
+static const char *sysfs_root = "/sys";
+
+/*
+ * Run the driver against a fake sysfs tree at root, or against the real
+ * one again if root is NULL. Only for the tests.
+ */
+SR_PRIV void bl_acme_set_sysfs_root(const char *root)
+{
+	sysfs_root = root ? root : "/sys";
+}
+
 SR_PRIV uint8_t bl_acme_get_enrg_addr(int index)
 {
 	return enrg_i2c_addrs[index];
@@ -123,9 +137,10 @@ SR_PRIV gboolean bl_acme_is_sane(void)
 	 * tmp435 sensors detected by the system and their appropriate
 	 * drivers loaded and functional.
 	 */
-	status = g_file_test("/sys", G_FILE_TEST_IS_DIR);
+	status = g_file_test(sysfs_root, G_FILE_TEST_IS_DIR);
 	if (!status) {
-		sr_err("/sys/ directory not found - sysfs not mounted?");
+		sr_err("%s/ directory not found - sysfs not mounted?",
+		       sysfs_root);
 		return FALSE;
 	}
 
@@ -134,8 +149,8 @@ SR_PRIV gboolean bl_acme_is_sane(void)
 
 static void probe_name_path(unsigned int addr, GString *path)
 {
-	g_string_printf(path,
-			"/sys/class/i2c-adapter/i2c-1/1-00%02x/name", addr);
+	g_string_printf(path, "%s/class/i2c-adapter/i2c-1/1-00%02x/name",
+			sysfs_root, addr);
 }
 
 /*
@@ -143,15 +158,15 @@ static void probe_name_path(unsigned int addr, GString *path)
  */
 static void probe_hwmon_path(unsigned int addr, GString *path)
 {
-	g_string_printf(path,
-			"/sys/class/i2c-adapter/i2c-1/1-00%02x/hwmon", addr);
+	g_string_printf(path, "%s/class/i2c-adapter/i2c-1/1-00%02x/hwmon",
+			sysfs_root, addr);
 }
 
 static void probe_eeprom_path(unsigned int addr, GString *path)
 {
 	g_string_printf(path,
-			"/sys/class/i2c-dev/i2c-1/device/1-00%02x/eeprom",
-			addr + 0x10);
+			"%s/class/i2c-dev/i2c-1/device/1-00%02x/eeprom",
+			sysfs_root, addr + 0x10);
 }
 
 SR_PRIV gboolean bl_acme_detect_probe(unsigned int addr,
@@ -415,8 +430,8 @@ static int get_shunt_path(const struct sr_channel_group *cg, GString *path)
 	}
 
 	g_string_append_printf(path,
-			       "/sys/class/hwmon/hwmon%d/shunt_resistor",
-			       cgp->hwmon_num);
+			       "%s/class/hwmon/hwmon%d/shunt_resistor",
+			       sysfs_root, cgp->hwmon_num);
 
 	/*
 	 * The shunt_resistor sysfs attribute is available
@@ -452,8 +467,8 @@ SR_PRIV void bl_acme_maybe_set_update_interval(const struct sr_dev_inst *sdi,
 
 		hwmon = g_string_sized_new(64);
 		g_string_append_printf(hwmon,
-				"/sys/class/hwmon/hwmon%d/update_interval",
-				cgp->hwmon_num);
+				"%s/class/hwmon/hwmon%d/update_interval",
+				sysfs_root, cgp->hwmon_num);
 
 		if (g_file_test(hwmon->str, G_FILE_TEST_EXISTS)) {
 			fd = g_fopen(hwmon->str, "w");
@@ -635,29 +650,30 @@ static float read_sample(struct sr_channel *ch)
 	struct channel_priv *chp;
 	char buf[16];
 	ssize_t len;
-	int fd;
 
 	chp = ch->priv;
-	fd = chp->fd;
 
-	lseek(fd, 0, SEEK_SET);
+	/* Failed channels get disabled, see bl_acme_send_block(). */
+	if (g_atomic_int_get(&chp->failed))
+		return NAN;
 
-	len = read(fd, buf, sizeof(buf));
+	/* The attribute stays open, pread() saves seeking back first. */
+	len = pread(chp->fd, buf, sizeof(buf) - 1, 0);
 	if (len < 0) {
 		sr_err("Error reading from channel %s (hwmon: %d): %s",
 			ch->name, chp->probe->hwmon_num, g_strerror(errno));
-		ch->enabled = FALSE;
-		return -1.0;
+		g_atomic_int_set(&chp->failed, TRUE);
+		return NAN;
 	}
+	buf[len] = '\0';
 
-	chp->digits = type_digits(chp->ch_type);
-	return strtol(buf, NULL, 10) * powf(10, -chp->digits);
+	return strtol(buf, NULL, 10) * chp->scale;
 }
 
 SR_PRIV int bl_acme_open_channel(struct sr_channel *ch)
 {
 	struct channel_priv *chp;
-	char path[64];
+	GString *path;
 	const char *file;
 	int fd;
 
@@ -674,17 +690,23 @@ SR_PRIV int bl_acme_open_channel(struct sr_channel *ch)
 		return SR_ERR;
 	}
 
-	snprintf(path, sizeof(path), "/sys/class/hwmon/hwmon%d/%s",
-		 chp->probe->hwmon_num, file);
+	path = g_string_sized_new(64);
+	g_string_printf(path, "%s/class/hwmon/hwmon%d/%s",
+			sysfs_root, chp->probe->hwmon_num, file);
 
-	fd = open(path, O_RDONLY);
+	fd = open(path->str, O_RDONLY);
 	if (fd < 0) {
-		sr_err("Error opening %s: %s", path, g_strerror(errno));
+		sr_err("Error opening %s: %s", path->str, g_strerror(errno));
+		g_string_free(path, TRUE);
 		ch->enabled = FALSE;
 		return SR_ERR;
 	}
+	g_string_free(path, TRUE);
 
 	chp->fd = fd;
+	chp->failed = FALSE;
+	chp->digits = type_digits(chp->ch_type);
+	chp->scale = powf(10, -chp->digits);
 
 	return 0;
 }
@@ -698,104 +720,249 @@ SR_PRIV void bl_acme_close_channel(struct sr_channel *ch)
 	chp->fd = -1;
 }
 
-SR_PRIV int bl_acme_receive_data(int fd, int revents, void *cb_data)
+SR_PRIV struct sample_block *bl_acme_block_new(const struct dev_context *devc)
+{
+	struct sample_block *block;
+
+	block = g_malloc0(sizeof(struct sample_block));
+	block->timestamps = g_malloc(devc->block_size * sizeof(int64_t));
+	block->data = g_malloc(devc->num_enabled * devc->block_size
+			       * sizeof(float));
+
+	return block;
+}
+
+SR_PRIV void bl_acme_block_free(void *data)
+{
+	struct sample_block *block;
+
+	block = data;
+	g_free(block->timestamps);
+	g_free(block->data);
+	g_free(block);
+}
+
+static void queue_block(struct dev_context *devc, struct sample_block *block)
+{
+	uint8_t wakeup;
+
+	g_mutex_lock(&devc->mutex);
+	g_queue_push_tail(&devc->blocks, block);
+	g_mutex_unlock(&devc->mutex);
+
+	/*
+	 * If the pipe is full, the main loop has plenty of wakeups pending
+	 * already, so a failing write doesn't matter.
+	 */
+	wakeup = 0;
+	if (write(devc->wakeup_fds[1], &wakeup, 1) < 0 && errno != EAGAIN)
+		sr_warn("Failed to wake up main loop: %s", g_strerror(errno));
+}
+
+/*
+ * Sample all enabled channels on every timer tick.
+ *
+ * Reading sysfs attributes takes long enough to make the main loop miss
+ * ticks at high sample rates, so this runs on a thread of its own. The
+ * readings are collected in blocks of samples, which are handed over to
+ * the main loop via devc->blocks, see bl_acme_send_block().
+ */
+SR_PRIV gpointer bl_acme_sampling_thread(gpointer data)
+{
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	struct sample_block *block;
+	struct pollfd pfd;
+	uint64_t nrexpiration, i;
+	int64_t now, period;
+	unsigned int c, n;
+	float *values;
+
+	sdi = data;
+	devc = sdi->priv;
+
+	period = 1000000 / devc->samplerate;
+	values = g_malloc(MAX(devc->num_enabled, 1) * sizeof(float));
+	block = bl_acme_block_new(devc);
+
+	pfd.fd = devc->timer_fd;
+	pfd.events = POLLIN;
+	while (g_atomic_int_get(&devc->running)) {
+		/* Wake up now and then to see whether we have to stop. */
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+		if (read(devc->timer_fd, &nrexpiration, sizeof(nrexpiration))
+				!= sizeof(nrexpiration)) {
+			sr_warn("Failed to read timer information");
+			continue;
+		}
+		now = g_get_real_time();
+
+		for (c = 0; c < devc->num_enabled; c++)
+			values[c] = read_sample(devc->enabled[c]);
+
+		/*
+		 * We were not able to read the samples of the previous timer
+		 * expiration(s) on time, we are overloaded. Repeat the current
+		 * readings for the missed ticks, so the number of samples still
+		 * matches the sample rate, and timestamp them when they should
+		 * have been taken.
+		 */
+		if (nrexpiration > 1)
+			devc->samples_missed += nrexpiration - 1;
+
+		for (i = 0; i < nrexpiration; i++) {
+			n = block->num_samples;
+			block->timestamps[n] = now
+				- (int64_t)(nrexpiration - 1 - i) * period;
+			for (c = 0; c < devc->num_enabled; c++)
+				block->data[c * devc->block_size + n] = values[c];
+			if (++block->num_samples < devc->block_size)
+				continue;
+			queue_block(devc, block);
+			block = bl_acme_block_new(devc);
+		}
+	}
+
+	if (block->num_samples)
+		queue_block(devc, block);
+	else
+		bl_acme_block_free(block);
+	g_free(values);
+
+	return NULL;
+}
+
+/*
+ * Send num_samples samples of a block, starting at the given one, as one
+ * packet per channel.
+ */
+static void send_samples(const struct sr_dev_inst *sdi,
+			 const struct sample_block *block,
+			 unsigned int start, unsigned int num_samples)
 {
-	uint64_t nrexpiration;
-	struct sr_datafeed_packet packet, framep;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
-	struct sr_dev_inst *sdi;
 	struct sr_channel *ch;
 	struct channel_priv *chp;
 	struct dev_context *devc;
-	GSList *chl, chonly;
-	unsigned i;
-
-	(void)fd;
-	(void)revents;
-
-	sdi = cb_data;
-	if (!sdi)
-		return TRUE;
+	GSList chonly;
+	unsigned int c;
 
 	devc = sdi->priv;
-	if (!devc)
-		return TRUE;
 
-	packet.type = SR_DF_ANALOG;
-	packet.payload = &analog;
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
-
-	if (read(devc->timer_fd, &nrexpiration, sizeof(nrexpiration)) < 0) {
-		sr_warn("Failed to read timer information");
-		return TRUE;
-	}
+	analog.num_samples = num_samples;
 
 	/*
-	 * We were not able to process the previous timer expiration, we are
-	 * overloaded.
+	 * Due to different units used in each channel we're sending
+	 * samples channel-by-channel.
 	 */
-	if (nrexpiration > 1)
-		devc->samples_missed += nrexpiration - 1;
-
-	/*
-	 * XXX This is a nasty workaround...
-	 *
-	 * At high sampling rates and maximum channels we are not able to
-	 * acquire samples fast enough, even though frontends still think
-	 * that samples arrive on time. This causes shifts in frontend
-	 * plots.
-	 *
-	 * To compensate for the delay we check if any clock events were
-	 * missed and - if so - don't really read the next value, but send
-	 * the same sample as fast as possible. We do it until we are back
-	 * on schedule.
-	 *
-	 * At high sampling rate this doesn't seem to visibly reduce the
-	 * accuracy.
-	 */
-	for (i = 0; i < nrexpiration; i++) {
-		framep.type = SR_DF_FRAME_BEGIN;
-		sr_session_send(sdi, &framep);
+	for (c = 0; c < devc->num_enabled; c++) {
+		ch = devc->enabled[c];
+		chp = ch->priv;
 
 		/*
-		 * Due to different units used in each channel we're sending
-		 * samples one-by-one.
+		 * A channel which failed to read gets disabled, and its
+		 * samples are dropped. The sampling thread must not touch
+		 * ch->enabled, so this is done here.
 		 */
-		for (chl = sdi->channels; chl; chl = chl->next) {
-			ch = chl->data;
-			chp = ch->priv;
-
-			if (!ch->enabled)
-				continue;
-			chonly.next = NULL;
-			chonly.data = ch;
-			analog.num_samples = 1;
-			analog.meaning->channels = &chonly;
-			analog.meaning->mq = channel_to_mq(chl->data);
-			analog.meaning->unit = channel_to_unit(ch);
-
-			if (i < 1)
-				chp->val = read_sample(ch);
-
-			analog.encoding->digits  = chp->digits;
-			analog.spec->spec_digits = chp->digits;
-			analog.data = &chp->val;
-			sr_session_send(sdi, &packet);
+		if (g_atomic_int_get(&chp->failed)) {
+			ch->enabled = FALSE;
+			continue;
 		}
 
-		framep.type = SR_DF_FRAME_END;
-		sr_session_send(sdi, &framep);
+		chonly.next = NULL;
+		chonly.data = ch;
+		analog.meaning->channels = &chonly;
+		analog.meaning->mq = channel_to_mq(ch);
+		analog.meaning->unit = channel_to_unit(ch);
+		analog.encoding->digits = chp->digits;
+		analog.spec->spec_digits = chp->digits;
+		analog.data = block->data + c * devc->block_size + start;
+		sr_analog_batch_send(&devc->batch, sdi, &analog,
+				     block->timestamps + start);
 	}
+}
 
-	sr_sw_limits_update_samples_read(&devc->limits, 1);
+/*
+ * Send a block of samples. Returns TRUE if the sample limit of the
+ * acquisition has been reached.
+ */
+SR_PRIV gboolean bl_acme_send_block(const struct sr_dev_inst *sdi,
+				    const struct sample_block *block)
+{
+	struct sr_datafeed_packet framep;
+	struct dev_context *devc;
+	uint64_t num_samples;
+	unsigned int i;
 
-	if (sr_sw_limits_check(&devc->limits)) {
-		sdi->driver->dev_acquisition_stop(sdi);
+	devc = sdi->priv;
+
+	if (sr_sw_limits_check(&devc->limits))
 		return TRUE;
+
+	num_samples = block->num_samples;
+	if (devc->limits.limit_samples)
+		num_samples = MIN(num_samples, devc->limits.limit_samples
+				  - devc->limits.samples_read);
+
+	if (sr_analog_batch_enabled(&devc->batch)) {
+		/* Batched readings span many frames, so don't mark them. */
+		send_samples(sdi, block, 0, num_samples);
+	} else {
+		/* Each timer tick is a frame of its own. */
+		for (i = 0; i < num_samples; i++) {
+			framep.type = SR_DF_FRAME_BEGIN;
+			sr_session_send(sdi, &framep);
+			send_samples(sdi, block, i, 1);
+			framep.type = SR_DF_FRAME_END;
+			sr_session_send(sdi, &framep);
+		}
+	}
+
+	sr_sw_limits_update_samples_read(&devc->limits, num_samples);
+
+	return sr_sw_limits_check(&devc->limits);
+}
+
+SR_PRIV int bl_acme_receive_data(int fd, int revents, void *cb_data)
+{
+	struct sr_dev_inst *sdi;
+	struct dev_context *devc;
+	struct sample_block *block;
+	uint8_t buf[64];
+	gboolean done;
+
+	(void)revents;
+
+	sdi = cb_data;
+	if (!sdi)
+		return TRUE;
+
+	devc = sdi->priv;
+	if (!devc)
+		return TRUE;
+
+	/* The queue tells how much there is to do, not the wakeups. */
+	while (read(fd, buf, sizeof(buf)) > 0)
+		;
+
+	done = FALSE;
+	while (!done) {
+		g_mutex_lock(&devc->mutex);
+		block = g_queue_pop_head(&devc->blocks);
+		g_mutex_unlock(&devc->mutex);
+		if (!block)
+			break;
+		done = bl_acme_send_block(sdi, block);
+		bl_acme_block_free(block);
 	}
 
+	if (done || sr_sw_limits_check(&devc->limits))
+		sdi->driver->dev_acquisition_stop(sdi);
+
 	return TRUE;
 }
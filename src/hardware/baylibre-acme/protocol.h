@@ -44,6 +44,9 @@
 /* For the user we number the probes starting from 1. */
 #define PROBE_NUM(n) ((n) + 1)
 
+/* The sampling thread hands over about this many blocks per second. */
+#define BLOCKS_PER_SEC		10
+
 enum probe_type {
 	PROBE_ENRG = 1,
 	PROBE_TEMP,
@@ -53,13 +56,33 @@ enum probe_type {
 struct dev_context {
 	uint64_t samplerate;
 	struct sr_sw_limits limits;
+	struct sr_analog_batch batch;
 
 	uint32_t num_channels;
 	uint64_t samples_missed;
 	int timer_fd;
-	GIOChannel *channel;
+
+	/* Sampling thread, see bl_acme_sampling_thread(). */
+	GThread *thread;
+	gint running;
+	int wakeup_fds[2];
+	GMutex mutex;
+	GQueue blocks;
+	struct sr_channel **enabled;
+	unsigned int num_enabled;
+	unsigned int block_size;
+};
+
+/* Readings of all enabled channels, taken on consecutive timer ticks. */
+struct sample_block {
+	unsigned int num_samples;
+	/* Host time of each tick [µs since the epoch]. */
+	int64_t *timestamps;
+	/* block_size samples per enabled channel. */
+	float *data;
 };
 
+SR_PRIV void bl_acme_set_sysfs_root(const char *root);
 SR_PRIV uint8_t bl_acme_get_enrg_addr(int index);
 SR_PRIV uint8_t bl_acme_get_temp_addr(int index);
 
@@ -85,6 +108,11 @@ SR_PRIV int bl_acme_read_power_state(const struct sr_channel_group *cg,
 SR_PRIV int bl_acme_set_power_off(const struct sr_channel_group *cg,
 				  gboolean off);
 
+SR_PRIV struct sample_block *bl_acme_block_new(const struct dev_context *devc);
+SR_PRIV void bl_acme_block_free(void *data);
+SR_PRIV gpointer bl_acme_sampling_thread(gpointer data);
+SR_PRIV gboolean bl_acme_send_block(const struct sr_dev_inst *sdi,
+				    const struct sample_block *block);
 SR_PRIV int bl_acme_receive_data(int fd, int revents, void *cb_data);
 
 SR_PRIV int bl_acme_open_channel(struct sr_channel *ch);
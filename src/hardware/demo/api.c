@@ -60,6 +60,22 @@ static const uint32_t devopts[] = {
 	SR_CONF_SAMPLERATE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_AVERAGING | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_AVG_SAMPLES | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_BUFFERSIZE | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_FREE_RUNNING | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_TRIGGER_MATCH | SR_CONF_LIST,
+	SR_CONF_CAPTURE_RATIO | SR_CONF_GET | SR_CONF_SET,
+};
+
+static const int32_t soft_trigger_matches[] = {
+	SR_TRIGGER_ZERO,
+	SR_TRIGGER_ONE,
+	SR_TRIGGER_RISING,
+	SR_TRIGGER_FALLING,
+	SR_TRIGGER_EDGE,
+	SR_TRIGGER_OVER,
+	SR_TRIGGER_UNDER,
+	SR_TRIGGER_SLOPE_UP,
+	SR_TRIGGER_SLOPE_DOWN,
 };
 
 static const uint32_t devopts_cg_logic[] = {
@@ -116,6 +132,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	devc->num_logic_channels = num_logic_channels;
 	devc->logic_unitsize = (devc->num_logic_channels + 7) / 8;
 	devc->logic_pattern = PATTERN_SIGROK;
+	devc->logic_bufsize = LOGIC_BUFSIZE;
 	devc->num_analog_channels = num_analog_channels;
 
 	if (num_logic_channels > 0) {
@@ -197,6 +214,9 @@ static void clear_helper(void *priv)
 
 	devc = priv;
 
+	g_free(devc->logic_data);
+	g_free(devc->logic_pattern_data);
+
 	/* Analog generators. */
 	g_hash_table_iter_init(&iter, devc->ch_ag);
 	while (g_hash_table_iter_next(&iter, NULL, &value))
@@ -238,6 +258,15 @@ static int config_get(uint32_t key, GVariant **data, const struct sr_dev_inst *s
 	case SR_CONF_AVG_SAMPLES:
 		*data = g_variant_new_uint64(devc->avg_samples);
 		break;
+	case SR_CONF_BUFFERSIZE:
+		*data = g_variant_new_uint64(devc->logic_bufsize);
+		break;
+	case SR_CONF_FREE_RUNNING:
+		*data = g_variant_new_boolean(devc->free_running);
+		break;
+	case SR_CONF_CAPTURE_RATIO:
+		*data = g_variant_new_uint64(devc->capture_ratio);
+		break;
 	case SR_CONF_PATTERN_MODE:
 		if (!cg)
 			return SR_ERR_CHANNEL_GROUP;
@@ -280,6 +309,7 @@ static int config_set(uint32_t key, GVariant *data, const struct sr_dev_inst *sd
 	int logic_pattern, analog_pattern, ret;
 	unsigned int i;
 	const char *stropt;
+	uint64_t bufsize;
 
 	devc = sdi->priv;
 
@@ -307,6 +337,22 @@ static int config_set(uint32_t key, GVariant *data, const struct sr_dev_inst *sd
 		devc->avg_samples = g_variant_get_uint64(data);
 		sr_dbg("Setting averaging rate to %" PRIu64, devc->avg_samples);
 		break;
+	case SR_CONF_BUFFERSIZE:
+		bufsize = g_variant_get_uint64(data);
+		if (bufsize < MAX(devc->logic_unitsize, 1) || bufsize > LOGIC_BUFSIZE_MAX)
+			return SR_ERR_ARG;
+		devc->logic_bufsize = bufsize;
+		demo_generate_logic_pattern(devc);
+		break;
+	case SR_CONF_FREE_RUNNING:
+		devc->free_running = g_variant_get_boolean(data);
+		sr_dbg("%s free-running mode",
+			devc->free_running ? "Enabling" : "Disabling");
+		break;
+	case SR_CONF_CAPTURE_RATIO:
+		devc->capture_ratio = g_variant_get_uint64(data);
+		ret = (devc->capture_ratio > 100) ? SR_ERR : SR_OK;
+		break;
 	case SR_CONF_PATTERN_MODE:
 		if (!cg)
 			return SR_ERR_CHANNEL_GROUP;
@@ -334,11 +380,7 @@ static int config_set(uint32_t key, GVariant *data, const struct sr_dev_inst *sd
 				sr_dbg("Setting logic pattern to %s",
 						logic_pattern_str[logic_pattern]);
 				devc->logic_pattern = logic_pattern;
-				/* Might as well do this now, these are static. */
-				if (logic_pattern == PATTERN_ALL_LOW)
-					memset(devc->logic_data, 0x00, LOGIC_BUFSIZE);
-				else if (logic_pattern == PATTERN_ALL_HIGH)
-					memset(devc->logic_data, 0xff, LOGIC_BUFSIZE);
+				demo_generate_logic_pattern(devc);
 			} else if (ch->type == SR_CHANNEL_ANALOG) {
 				if (analog_pattern == -1)
 					return SR_ERR_ARG;
@@ -403,6 +445,11 @@ static int config_list(uint32_t key, GVariant **data, const struct sr_dev_inst *
 			g_variant_builder_add(&gvb, "{sv}", "samplerate-steps", gvar);
 			*data = g_variant_builder_end(&gvb);
 			break;
+		case SR_CONF_TRIGGER_MATCH:
+			*data = g_variant_new_fixed_array(G_VARIANT_TYPE_INT32,
+					soft_trigger_matches, ARRAY_SIZE(soft_trigger_matches),
+					sizeof(int32_t));
+			break;
 		default:
 			return SR_ERR_NA;
 		}
@@ -449,23 +496,71 @@ static int config_list(uint32_t key, GVariant **data, const struct sr_dev_inst *
 	return SR_OK;
 }
 
+static gboolean trigger_has_analog(const struct sr_trigger *trigger)
+{
+	struct sr_trigger_stage *stage;
+	struct sr_trigger_match *match;
+	GSList *l, *m;
+
+	for (l = trigger->stages; l; l = l->next) {
+		stage = l->data;
+		for (m = stage->matches; m; m = m->next) {
+			match = m->data;
+			if (match->channel->type == SR_CHANNEL_ANALOG
+					&& match->channel->enabled)
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
+	struct sr_trigger *trigger;
 	GHashTableIter iter;
 	void *value;
+	int pre_trigger_samples;
 
 	if (sdi->status != SR_ST_ACTIVE)
 		return SR_ERR_DEV_CLOSED;
 
 	devc = sdi->priv;
 	devc->sent_samples = 0;
+	devc->generated_samples = 0;
+
+	trigger = sr_session_trigger_get(sdi->session);
+	pre_trigger_samples = 0;
+	if (devc->limit_samples > 0)
+		pre_trigger_samples = devc->capture_ratio * devc->limit_samples / 100;
+	if (trigger && trigger_has_analog(trigger) && devc->avg) {
+		sr_warn("Analog triggers don't work with averaging, ignoring.");
+		devc->trigger_fired = TRUE;
+	} else if (trigger && trigger_has_analog(trigger)) {
+		devc->sta = soft_trigger_analog_new(sdi, trigger, pre_trigger_samples);
+		if (!devc->sta)
+			return SR_ERR_MALLOC;
+		devc->trigger_fired = FALSE;
+	} else if (trigger && devc->num_logic_channels > 0) {
+		devc->stl = soft_trigger_logic_new(sdi, trigger, pre_trigger_samples);
+		if (!devc->stl)
+			return SR_ERR_MALLOC;
+		devc->pool = soft_trigger_pool_new(devc->logic_bufsize
+			/ devc->logic_unitsize * devc->logic_unitsize);
+		devc->trigger_fired = FALSE;
+	} else
+		devc->trigger_fired = TRUE;
+
+	demo_generate_logic_pattern(devc);
 
 	g_hash_table_iter_init(&iter, devc->ch_ag);
 	while (g_hash_table_iter_next(&iter, NULL, &value))
 		demo_generate_analog_pattern(value, devc->cur_samplerate);
 
-	sr_session_source_add(sdi->session, -1, 0, 100,
+	/* In free-running mode, get called again as soon as possible. */
+	sr_session_source_add(sdi->session, -1, 0,
+			devc->free_running ? 0 : 100,
 			demo_prepare_data, (struct sr_dev_inst *)sdi);
 
 	std_session_send_df_header(sdi);
@@ -479,10 +574,25 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 
 static int dev_acquisition_stop(struct sr_dev_inst *sdi)
 {
+	struct dev_context *devc;
+
+	devc = sdi->priv;
+
 	sr_dbg("Stopping acquisition.");
 	sr_session_source_remove(sdi->session, -1);
 	std_session_send_df_end(sdi);
 
+	if (devc->stl) {
+		soft_trigger_logic_free(devc->stl);
+		devc->stl = NULL;
+	}
+	soft_trigger_pool_free(devc->pool);
+	devc->pool = NULL;
+	if (devc->sta) {
+		soft_trigger_analog_free(devc->sta);
+		devc->sta = NULL;
+	}
+
 	return SR_OK;
 }
 
@@ -115,50 +115,172 @@ SR_PRIV void demo_generate_analog_pattern(struct analog_gen *ag, uint64_t sample
 	}
 }
 
-static void logic_generator(struct sr_dev_inst *sdi, uint64_t size)
+/* xorshift64*, plenty good enough for test patterns and cheap per byte. */
+static inline uint64_t prng_next(uint64_t *state)
 {
-	struct dev_context *devc;
-	uint64_t i, j;
-	uint8_t pat;
+	uint64_t x;
 
-	devc = sdi->priv;
+	x = *state;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+
+	return x * UINT64_C(0x2545f4914f6cdd1d);
+}
+
+SR_PRIV void demo_generate_logic_pattern(struct dev_context *devc)
+{
+	uint64_t num_samples, i, j;
+	uint8_t pat, *p;
+
+	if (devc->logic_unitsize == 0)
+		return;
 
 	switch (devc->logic_pattern) {
 	case PATTERN_SIGROK:
-		memset(devc->logic_data, 0x00, size);
-		for (i = 0; i < size; i += devc->logic_unitsize) {
-			for (j = 0; j < devc->logic_unitsize; j++) {
-				pat = pattern_sigrok[(devc->step + j) % sizeof(pattern_sigrok)] >> 1;
-				devc->logic_data[i + j] = ~pat;
-			}
-			devc->step++;
-		}
-		break;
-	case PATTERN_RANDOM:
-		for (i = 0; i < size; i++)
-			devc->logic_data[i] = (uint8_t)(rand() & 0xff);
+		devc->logic_period = sizeof(pattern_sigrok);
 		break;
 	case PATTERN_INC:
-		for (i = 0; i < size; i++) {
-			for (j = 0; j < devc->logic_unitsize; j++) {
-				devc->logic_data[i + j] = devc->step;
-			}
-			devc->step++;
-		}
+		devc->logic_period = 256;
 		break;
 	case PATTERN_ALL_LOW:
 	case PATTERN_ALL_HIGH:
-		/* These were set when the pattern mode was selected. */
+		devc->logic_period = 1;
 		break;
 	default:
-		sr_err("Unknown pattern: %d.", devc->logic_pattern);
+		/* Random data is generated on the fly. */
+		devc->logic_period = 0;
 		break;
 	}
+
+	num_samples = devc->logic_bufsize / devc->logic_unitsize;
+	g_free(devc->logic_data);
+	devc->logic_data = g_malloc(num_samples * devc->logic_unitsize);
+	num_samples += devc->logic_period;
+	g_free(devc->logic_pattern_data);
+	devc->logic_pattern_data = g_malloc(num_samples * devc->logic_unitsize);
+	if (!devc->prng_state)
+		devc->prng_state = UINT64_C(0x9e3779b97f4a7c15);
+
+	p = devc->logic_pattern_data;
+	for (i = 0; i < num_samples; i++) {
+		for (j = 0; j < devc->logic_unitsize; j++) {
+			switch (devc->logic_pattern) {
+			case PATTERN_SIGROK:
+				pat = pattern_sigrok[(i + j) % sizeof(pattern_sigrok)] >> 1;
+				*p++ = ~pat;
+				break;
+			case PATTERN_INC:
+				*p++ = i;
+				break;
+			case PATTERN_ALL_HIGH:
+				*p++ = 0xff;
+				break;
+			default:
+				*p++ = 0x00;
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Fill the send buffer with the next num_samples samples of the logic
+ * pattern. Periodic patterns are replayed from the precomputed buffer
+ * with a single copy, only the random pattern needs work per packet.
+ */
+static void logic_generator(struct dev_context *devc, uint64_t num_samples)
+{
+	uint64_t size, i, r;
+
+	size = num_samples * devc->logic_unitsize;
+
+	if (devc->logic_period == 0) {
+		for (i = 0; i < size; i += sizeof(r)) {
+			r = prng_next(&devc->prng_state);
+			memcpy(devc->logic_data + i, &r, MIN(sizeof(r), size - i));
+		}
+		return;
+	}
+
+	i = (devc->step % devc->logic_period) * devc->logic_unitsize;
+	memcpy(devc->logic_data, devc->logic_pattern_data + i, size);
+	devc->step += num_samples;
+}
+
+/*
+ * Feed a packet to the soft trigger. When the trigger fires, the
+ * pre-trigger data has been sent already, and the packet is trimmed to
+ * start at the trigger position. Until then, the packet is emptied.
+ * Given the position of the packet in this round and the size of the
+ * round, the number of samples sent in this round is updated. This
+ * includes all of the pre-trigger samples, which may stem from earlier
+ * rounds.
+ */
+static void soft_trigger_check(struct dev_context *devc,
+		struct sr_datafeed_packet *packet, uint64_t round_pos,
+		uint64_t round_todo, uint64_t *round_sent)
+{
+	struct sr_datafeed_logic *logic;
+	struct sr_datafeed_analog *analog;
+	GBytes *bytes;
+	int trigger_offset, pre_trigger_samples;
+	uint64_t pos;
+
+	logic = NULL;
+	analog = NULL;
+	if (packet->type == SR_DF_LOGIC)
+		logic = (struct sr_datafeed_logic *)packet->payload;
+	else
+		analog = (struct sr_datafeed_analog *)packet->payload;
+
+	if (devc->sta)
+		trigger_offset = soft_trigger_analog_check(devc->sta, packet,
+				&pre_trigger_samples);
+	else if (logic) {
+		/*
+		 * The soft trigger keeps the send buffer for the pre-trigger
+		 * data rather than copying it, so continue with another one.
+		 * The buffer stays valid in the pool for sending the packet.
+		 */
+		bytes = soft_trigger_pool_wrap(devc->pool, devc->logic_data,
+				logic->length);
+		devc->logic_data = soft_trigger_pool_get(devc->pool);
+		trigger_offset = soft_trigger_logic_check_bytes(devc->stl,
+				bytes, &pre_trigger_samples);
+		g_bytes_unref(bytes);
+	} else
+		trigger_offset = -1;
+
+	if (trigger_offset < 0) {
+		if (logic)
+			logic->length = 0;
+		else
+			analog->num_samples = 0;
+		return;
+	}
+
+	devc->trigger_fired = TRUE;
+	if (logic) {
+		logic->data = (uint8_t *)logic->data
+				+ trigger_offset * logic->unitsize;
+		logic->length -= trigger_offset * logic->unitsize;
+	} else {
+		analog->data = (uint8_t *)analog->data + trigger_offset
+				* analog->encoding->unitsize
+				* g_slist_length(analog->meaning->channels);
+		analog->num_samples -= trigger_offset;
+	}
+
+	pos = round_pos + trigger_offset;
+	*round_sent = pre_trigger_samples + (round_todo - pos);
 }
 
 static void send_analog_packet(struct analog_gen *ag,
 		struct sr_dev_inst *sdi, uint64_t *analog_sent,
-		uint64_t analog_pos, uint64_t analog_todo)
+		uint64_t analog_pos, uint64_t analog_todo,
+		uint64_t *round_sent)
 {
 	struct sr_datafeed_packet packet;
 	struct dev_context *devc;
@@ -175,7 +297,13 @@ static void send_analog_packet(struct analog_gen *ag,
 		sending_now = MIN(analog_todo, ag->num_samples-ag_pattern_pos);
 		ag->packet.data = ag->pattern_data + ag_pattern_pos;
 		ag->packet.num_samples = sending_now;
-		sr_session_send(sdi, &packet);
+		if (!devc->trigger_fired)
+			soft_trigger_check(devc, &packet,
+				analog_pos - devc->generated_samples,
+				analog_pos - devc->generated_samples + analog_todo,
+				round_sent);
+		if (ag->packet.num_samples > 0)
+			sr_session_send(sdi, &packet);
 
 		/* Whichever channel group gets there first. */
 		*analog_sent = MAX(*analog_sent, sending_now);
@@ -225,6 +353,7 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 	GHashTableIter iter;
 	void *value;
 	uint64_t samples_todo, logic_done, analog_done, analog_sent, sending_now;
+	uint64_t packet_samples, round_sent;
 	int64_t elapsed_us, limit_us, todo_us;
 
 	(void)fd;
@@ -241,17 +370,34 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 		return G_SOURCE_CONTINUE;
 	}
 
-	/* What time span should we send samples for? */
+	packet_samples = devc->logic_bufsize / MAX(devc->logic_unitsize, 1);
 	elapsed_us = g_get_monotonic_time() - devc->start_us;
 	limit_us = 1000 * devc->limit_msec;
-	if (limit_us > 0 && limit_us < elapsed_us)
-		todo_us = MAX(0, limit_us - devc->spent_us);
-	else
-		todo_us = MAX(0, elapsed_us - devc->spent_us);
 
-	/* How many samples are outstanding since the last round? */
-	samples_todo = (todo_us * devc->cur_samplerate + G_USEC_PER_SEC - 1)
-			/ G_USEC_PER_SEC;
+	if (devc->free_running) {
+		/*
+		 * Don't pace against the wall clock, just send a batch of
+		 * full packets and get called again right away. A time limit
+		 * refers to the sample time in this mode.
+		 */
+		samples_todo = FREE_RUNNING_PACKETS * packet_samples;
+		if (limit_us > 0) {
+			todo_us = MAX(0, limit_us - devc->spent_us);
+			samples_todo = MIN(samples_todo,
+				(todo_us * devc->cur_samplerate + G_USEC_PER_SEC - 1)
+				/ G_USEC_PER_SEC);
+		}
+	} else {
+		/* What time span should we send samples for? */
+		if (limit_us > 0 && limit_us < elapsed_us)
+			todo_us = MAX(0, limit_us - devc->spent_us);
+		else
+			todo_us = MAX(0, elapsed_us - devc->spent_us);
+
+		/* How many samples are outstanding since the last round? */
+		samples_todo = (todo_us * devc->cur_samplerate + G_USEC_PER_SEC - 1)
+				/ G_USEC_PER_SEC;
+	}
 	if (devc->limit_samples > 0) {
 		if (devc->limit_samples < devc->sent_samples)
 			samples_todo = 0;
@@ -266,22 +412,35 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 
 	logic_done  = devc->num_logic_channels  > 0 ? 0 : samples_todo;
 	analog_done = devc->num_analog_channels > 0 ? 0 : samples_todo;
+	round_sent = devc->trigger_fired ? samples_todo : 0;
 
 	while (logic_done < samples_todo || analog_done < samples_todo) {
-		/* Logic */
-		if (logic_done < samples_todo) {
-			sending_now = MIN(samples_todo - logic_done,
-					LOGIC_BUFSIZE / devc->logic_unitsize);
-			logic_generator(sdi, sending_now * devc->logic_unitsize);
+		/*
+		 * Logic. While an analog trigger is pending, don't get more
+		 * than a packet ahead of the analog data, so the trigger
+		 * still has the logic data around the trigger position.
+		 */
+		if (logic_done < samples_todo && (devc->trigger_fired
+				|| !devc->sta || logic_done <= analog_done)) {
+			sending_now = MIN(samples_todo - logic_done, packet_samples);
 			packet.type = SR_DF_LOGIC;
 			packet.payload = &logic;
 			logic.length = sending_now * devc->logic_unitsize;
 			logic.unitsize = devc->logic_unitsize;
+			logic_generator(devc, sending_now);
 			logic.data = devc->logic_data;
-			sr_session_send(sdi, &packet);
+			if (!devc->trigger_fired)
+				soft_trigger_check(devc, &packet, logic_done,
+					samples_todo, &round_sent);
+			if (devc->trigger_fired && logic.length > 0)
+				sr_session_send(sdi, &packet);
 			logic_done += sending_now;
 		}
 
+		/* No analog data before a logic trigger has fired. */
+		if (!devc->trigger_fired && !devc->sta)
+			analog_done = logic_done;
+
 		/* Analog, one channel at a time */
 		if (analog_done < samples_todo) {
 			analog_sent = 0;
@@ -289,8 +448,9 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 			g_hash_table_iter_init(&iter, devc->ch_ag);
 			while (g_hash_table_iter_next(&iter, NULL, &value)) {
 				send_analog_packet(value, sdi, &analog_sent,
-						devc->sent_samples + analog_done,
-						samples_todo - analog_done);
+						devc->generated_samples + analog_done,
+						samples_todo - analog_done,
+						&round_sent);
 			}
 			analog_done += analog_sent;
 		}
@@ -302,7 +462,8 @@ SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data)
 		sr_err("BUG: Sample count mismatch.");
 		return G_SOURCE_REMOVE;
 	}
-	devc->sent_samples += samples_todo;
+	devc->sent_samples += round_sent;
+	devc->generated_samples += samples_todo;
 	devc->spent_us += todo_us;
 
 	if ((devc->limit_samples > 0 && devc->sent_samples >= devc->limit_samples)
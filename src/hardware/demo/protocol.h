@@ -30,8 +30,12 @@
 
 #define LOG_PREFIX "demo"
 
-/* The size in bytes of chunks to send through the session bus. */
+/* The default size in bytes of chunks to send through the session bus. */
 #define LOGIC_BUFSIZE			4096
+/* Upper limit for the user configurable logic packet size. */
+#define LOGIC_BUFSIZE_MAX		(16 * 1024 * 1024)
+/* Number of packets sent per invocation in free-running mode. */
+#define FREE_RUNNING_PACKETS		16
 /* Size of the analog pattern space per channel. */
 #define ANALOG_BUFSIZE			4096
 
@@ -41,15 +45,36 @@ struct dev_context {
 	uint64_t limit_samples;
 	uint64_t limit_msec;
 	uint64_t sent_samples;
+	/* Samples generated so far, including those before the trigger. */
+	uint64_t generated_samples;
 	int64_t start_us;
 	int64_t spent_us;
 	uint64_t step;
+	/* Send as fast as the session accepts data, ignoring wall-clock time. */
+	gboolean free_running;
 	/* Logic */
 	int32_t num_logic_channels;
 	unsigned int logic_unitsize;
 	/* There is only ever one logic channel group, so its pattern goes here. */
 	uint8_t logic_pattern;
-	unsigned char logic_data[LOGIC_BUFSIZE];
+	/* Logic packet size in bytes. */
+	uint64_t logic_bufsize;
+	/*
+	 * Precomputed logic pattern: one packet worth of samples plus one
+	 * pattern period, so that any phase can be replayed in one go.
+	 */
+	uint8_t *logic_pattern_data;
+	uint64_t logic_period;
+	/* Packets are sent from here, transforms may modify them in place. */
+	uint8_t *logic_data;
+	uint64_t prng_state;
+	/* Soft trigger */
+	uint64_t capture_ratio;
+	struct soft_trigger_logic *stl;
+	/* Send buffers the logic soft trigger may hold on to. */
+	struct soft_trigger_pool *pool;
+	struct soft_trigger_analog *sta;
+	gboolean trigger_fired;
 	/* Analog */
 	int32_t num_analog_channels;
 	GHashTable *ch_ag;
@@ -115,6 +140,7 @@ struct analog_gen {
 };
 
 SR_PRIV void demo_generate_analog_pattern(struct analog_gen *ag, uint64_t sample_rate);
+SR_PRIV void demo_generate_logic_pattern(struct dev_context *devc);
 SR_PRIV int demo_prepare_data(int fd, int revents, void *cb_data);
 
 #endif
@@ -827,6 +827,8 @@ static int start_transfers(const struct sr_dev_inst *sdi)
 
 	size = fx2lafw_get_buffer_size(devc);
 	devc->submitted_transfers = 0;
+	if (devc->stl)
+		devc->pool = soft_trigger_pool_new(size);
 
 	devc->transfers = g_try_malloc0(sizeof(*devc->transfers) * num_transfers);
 	if (!devc->transfers) {
@@ -888,6 +890,8 @@ static void LIBUSB_CALL dslogic_trigger_receive(struct libusb_transfer *transfer
 			soft_trigger_logic_free(devc->stl);
 			devc->stl = NULL;
 		}
+		soft_trigger_pool_free(devc->pool);
+		devc->pool = NULL;
 	} else if (transfer->status == LIBUSB_TRANSFER_COMPLETED
 			&& transfer->actual_length == sizeof(struct dslogic_trigger_pos)) {
 		tpos = (struct dslogic_trigger_pos *)transfer->buffer;
@@ -1015,8 +1019,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		if (devc->profile->dev_caps & DEV_CAPS_AX_ANALOG) {
 			/* We need a buffer half the size of a transfer. */
 			devc->logic_buffer = g_try_malloc(size / 2);
-			devc->analog_buffer = g_try_malloc(
-				sizeof(float) * size / 2);
+			devc->analog_buffer = g_try_malloc(size / 2);
 		}
 		start_transfers(sdi);
 		if ((ret = fx2lafw_command_start_acquisition(sdi)) != SR_OK) {
@@ -346,6 +346,8 @@ static void finish_acquisition(struct sr_dev_inst *sdi)
 		soft_trigger_logic_free(devc->stl);
 		devc->stl = NULL;
 	}
+	soft_trigger_pool_free(devc->pool);
+	devc->pool = NULL;
 }
 
 static void free_transfer(struct libusb_transfer *transfer)
@@ -381,6 +383,7 @@ static void resubmit_transfer(struct libusb_transfer *transfer)
 		return;
 
 	sr_err("%s: %s", __func__, libusb_error_name(ret));
+	sr_session_metrics_usb_resubmit_failed(transfer->user_data);
 	free_transfer(transfer);
 
 }
@@ -404,8 +407,7 @@ SR_PRIV void mso_send_data_proc(struct sr_dev_inst *sdi,
 	/* Send the logic */
 	for (i = 0; i < length; i++) {
 		devc->logic_buffer[i] = data[i * 2];
-		/* Rescale to -10V - +10V from 0-255. */
-		devc->analog_buffer[i] = (data[i * 2 + 1] - 128.0f) / 12.8f;
+		devc->analog_buffer[i] = data[i * 2 + 1];
 	};
 
 	const struct sr_datafeed_logic logic = {
@@ -429,6 +431,13 @@ SR_PRIV void mso_send_data_proc(struct sr_dev_inst *sdi,
 	analog.num_samples = length;
 	analog.data = devc->analog_buffer;
 
+	/* Rescale to -10V - +10V from 0-255: (code - 128) / 12.8. */
+	analog.encoding->unitsize = 1;
+	analog.encoding->is_float = FALSE;
+	analog.encoding->is_signed = FALSE;
+	sr_rational_set(&analog.encoding->scale, 5, 64);
+	sr_rational_set(&analog.encoding->offset, -10, 1);
+
 	const struct sr_datafeed_packet analog_packet = {
 		.type = SR_DF_ANALOG,
 		.payload = &analog
@@ -460,6 +469,7 @@ SR_PRIV void LIBUSB_CALL fx2lafw_receive_transfer(struct libusb_transfer *transf
 	struct dev_context *devc;
 	gboolean packet_has_error = FALSE;
 	struct sr_datafeed_packet packet;
+	GBytes *bytes;
 	unsigned int num_samples;
 	int trigger_offset, cur_sample_count, unitsize;
 	int pre_trigger_samples;
@@ -496,6 +506,9 @@ SR_PRIV void LIBUSB_CALL fx2lafw_receive_transfer(struct libusb_transfer *transf
 		break;
 	}
 
+	sr_session_metrics_usb_transfer(sdi,
+			transfer->actual_length == 0 || packet_has_error);
+
 	if (transfer->actual_length == 0 || packet_has_error) {
 		devc->empty_transfer_count++;
 		if (devc->empty_transfer_count > MAX_EMPTY_TRANSFERS) {
@@ -545,8 +558,15 @@ SR_PRIV void LIBUSB_CALL fx2lafw_receive_transfer(struct libusb_transfer *transf
 			}
 		}
 	} else {
-		trigger_offset = soft_trigger_logic_check(devc->stl,
-			transfer->buffer, transfer->actual_length, &pre_trigger_samples);
+		/*
+		 * The soft trigger keeps the buffer for the pre-trigger data
+		 * rather than copying it, so continue with another one.
+		 */
+		bytes = soft_trigger_pool_wrap(devc->pool, transfer->buffer,
+			transfer->actual_length);
+		transfer->buffer = soft_trigger_pool_get(devc->pool);
+		trigger_offset = soft_trigger_logic_check_bytes(devc->stl,
+			bytes, &pre_trigger_samples);
 		if (trigger_offset > -1) {
 			devc->sent_samples += pre_trigger_samples;
 			num_samples = cur_sample_count - trigger_offset;
@@ -554,13 +574,15 @@ SR_PRIV void LIBUSB_CALL fx2lafw_receive_transfer(struct libusb_transfer *transf
 					num_samples > devc->limit_samples - devc->sent_samples)
 				num_samples = devc->limit_samples - devc->sent_samples;
 
-			devc->send_data_proc(sdi, (uint8_t *)transfer->buffer
+			devc->send_data_proc(sdi,
+					(uint8_t *)g_bytes_get_data(bytes, NULL)
 					+ trigger_offset * unitsize,
 					num_samples * unitsize, unitsize);
 			devc->sent_samples += num_samples;
 
 			devc->trigger_fired = TRUE;
 		}
+		g_bytes_unref(bytes);
 	}
 
 	if (devc->limit_samples && devc->sent_samples >= devc->limit_samples) {
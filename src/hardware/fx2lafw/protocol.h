@@ -118,6 +118,8 @@ struct dev_context {
 	gboolean acq_aborted;
 	gboolean sample_wide;
 	struct soft_trigger_logic *stl;
+	/* Buffers for transfers the soft trigger may hold on to. */
+	struct soft_trigger_pool *pool;
 
 	unsigned int sent_samples;
 	int submitted_transfers;
@@ -129,7 +131,7 @@ struct dev_context {
 	void (*send_data_proc)(struct sr_dev_inst *sdi,
 		uint8_t *data, size_t length, size_t sample_width);
 	uint8_t *logic_buffer;
-	float *analog_buffer;
+	uint8_t *analog_buffer;
 
 	/* Is this a DSLogic? */
 	gboolean dslogic;
@@ -54,7 +54,7 @@ static const uint32_t drvopts[] = {
 
 static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
-	SR_CONF_LIMIT_FRAMES | SR_CONF_SET,
+	SR_CONF_LIMIT_FRAMES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_CONN | SR_CONF_GET,
 	SR_CONF_TIMEBASE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
 	SR_CONF_BUFFERSIZE | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
@@ -205,6 +205,7 @@ static struct sr_dev_inst *dso_dev_new(const struct dso_profile *prof)
 	devc->triggerslope = SLOPE_POSITIVE;
 	devc->triggersource = g_strdup(DEFAULT_TRIGGER_SOURCE);
 	devc->triggerposition = DEFAULT_HORIZ_TRIGGERPOS;
+	sr_frame_ring_init(&devc->frames);
 	sdi->priv = devc;
 
 	return sdi;
@@ -241,7 +242,7 @@ static void clear_dev_context(void *priv)
 	devc = priv;
 	g_free(devc->triggersource);
 	g_slist_free(devc->enabled_channels);
-
+	sr_frame_ring_clear(&devc->frames);
 }
 
 static int dev_clear(const struct sr_dev_driver *di)
@@ -456,6 +457,8 @@ static int config_get(uint32_t key, GVariant **data, const struct sr_dev_inst *s
 		case SR_CONF_HORIZ_TRIGGERPOS:
 			*data = g_variant_new_double(devc->triggerposition);
 			break;
+		case SR_CONF_LIMIT_FRAMES:
+			return sr_frame_ring_config_get(&devc->frames, key, data);
 		default:
 			return SR_ERR_NA;
 		}
@@ -501,8 +504,7 @@ static int config_set(uint32_t key, GVariant *data, const struct sr_dev_inst *sd
 	if (!cg) {
 		switch (key) {
 		case SR_CONF_LIMIT_FRAMES:
-			devc->limit_frames = g_variant_get_uint64(data);
-			break;
+			return sr_frame_ring_config_set(&devc->frames, key, data);
 		case SR_CONF_TRIGGER_SLOPE:
 			tmp_str = g_variant_get_string(data, NULL);
 			if (!tmp_str || !(tmp_str[0] == 'f' || tmp_str[0] == 'r'))
@@ -685,78 +687,63 @@ static int config_list(uint32_t key, GVariant **data, const struct sr_dev_inst *
 	return SR_OK;
 }
 
-static void send_chunk(struct sr_dev_inst *sdi, unsigned char *buf,
-		int num_samples)
+static void set_encodings(const struct sr_dev_inst *sdi,
+		struct sr_frame *frame)
 {
-	struct sr_datafeed_packet packet;
-	struct sr_datafeed_analog analog;
-	struct sr_analog_encoding encoding;
-	struct sr_analog_meaning meaning;
-	struct sr_analog_spec spec;
-	struct dev_context *devc = sdi->priv;
-	GSList *channels = devc->enabled_channels;
-
-	packet.type = SR_DF_ANALOG;
-	packet.payload = &analog;
-	/* TODO: support for 5xxx series 9-bit samples */
-	sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
-	analog.num_samples = num_samples;
-	analog.meaning->mq = SR_MQ_VOLTAGE;
-	analog.meaning->unit = SR_UNIT_VOLT;
-	analog.meaning->mqflags = 0;
-	/* TODO: Check malloc return value. */
-	analog.data = g_try_malloc(num_samples * sizeof(float));
-
-	for (int ch = 0; ch < 2; ch++) {
-		if (!devc->ch_enabled[ch])
-			continue;
+	struct dev_context *devc;
+	struct sr_frame_channel *fch;
+	struct sr_channel *ch;
+	const uint64_t *vdiv;
+	GSList *l;
+	unsigned int i;
 
-		float range = ((float)vdivs[devc->voltage[ch]][0] / vdivs[devc->voltage[ch]][1]) * 8;
+	devc = sdi->priv;
+	for (l = devc->enabled_channels, i = 0; l; l = l->next, i++) {
+		ch = l->data;
+		fch = &frame->channels[i];
+		vdiv = vdivs[devc->voltage[ch->index]];
+		float range = ((float)vdiv[0] / vdiv[1]) * 8;
 		float vdivlog = log10f(range / 255);
 		int digits = -(int)vdivlog + (vdivlog < 0.0);
-		analog.encoding->digits = digits;
-		analog.spec->spec_digits = digits;
-		analog.meaning->channels = g_slist_append(NULL, channels->data);
-
-		for (int i = 0; i < num_samples; i++) {
-			/*
-			 * The device always sends data for both channels. If a channel
-			 * is disabled, it contains a copy of the enabled channel's
-			 * data. However, we only send the requested channels to
-			 * the bus.
-			 *
-			 * Voltage values are encoded as a value 0-255 (0-512 on the
-			 * DSO-5200*), where the value is a point in the range
-			 * represented by the vdiv setting. There are 8 vertical divs,
-			 * so e.g. 500mV/div represents 4V peak-to-peak where 0 = -2V
-			 * and 255 = +2V.
-			 */
-			/* TODO: Support for DSO-5xxx series 9-bit samples. */
-			((float *)analog.data)[i] = range / 255 * *(buf + i * 2 + 1 - ch) - range / 2;
-		}
-		sr_session_send(sdi, &packet);
-		g_slist_free(analog.meaning->channels);
+		fch->encoding.digits = digits;
+		fch->spec.spec_digits = digits;
+		fch->meaning.mq = SR_MQ_VOLTAGE;
+		fch->meaning.unit = SR_UNIT_VOLT;
+		fch->meaning.mqflags = 0;
 
-		channels = channels->next;
+		/*
+		 * Voltage values are encoded as a value 0-255 (0-512 on the
+		 * DSO-5200*), where the value is a point in the range
+		 * represented by the vdiv setting. There are 8 vertical divs,
+		 * so e.g. 500mV/div represents 4V peak-to-peak where 0 = -2V
+		 * and 255 = +2V. The ADC codes are sent as they are, the
+		 * encoding scales them to volts.
+		 */
+		sr_rational_set(&fch->encoding.scale, 8 * vdiv[0], 255 * vdiv[1]);
+		sr_rational_set(&fch->encoding.offset, -4 * (int64_t)vdiv[0],
+				vdiv[1]);
 	}
-	g_free(analog.data);
 }
 
 /*
  * Called by libusb (as triggered by handle_event()) when a transfer comes in.
  * Only channel data comes in asynchronously, and all transfers for this are
- * queued up beforehand, so this just needs to chuck the incoming data onto
- * the libsigrok session bus.
+ * queued up beforehand, so this just needs to put the incoming data into
+ * the frame, and send the frame up the session bus once it's complete.
  */
 static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 {
-	struct sr_datafeed_packet packet;
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
-	int num_samples, pre;
+	struct sr_channel *ch;
+	struct sr_frame *frame;
+	GSList *l;
+	uint8_t *dst;
+	unsigned int num_samples, pos, i, j;
 
 	sdi = transfer->user_data;
 	devc = sdi->priv;
+	frame = devc->frame;
 	sr_spew("receive_transfer(): status %s received %d bytes.",
 		libusb_error_name(transfer->status), transfer->actual_length);
 
@@ -765,6 +752,7 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 		return;
 
 	num_samples = transfer->actual_length / 2;
+	num_samples = MIN(num_samples, devc->framesize - devc->samp_received);
 
 	sr_spew("Got %d-%d/%d samples in frame.", devc->samp_received + 1,
 		devc->samp_received + num_samples, devc->framesize);
@@ -772,81 +760,64 @@ static void LIBUSB_CALL receive_transfer(struct libusb_transfer *transfer)
 	/*
 	 * The device always sends a full frame, but the beginning of the frame
 	 * doesn't represent the trigger point. The offset at which the trigger
-	 * happened came in with the capture state, so we need to start sending
-	 * from there up the session bus. The samples in the frame buffer
-	 * before that trigger point came after the end of the device's frame
-	 * buffer was reached, and it wrapped around to overwrite up until the
-	 * trigger point.
+	 * happened came in with the capture state, so the frame starts from
+	 * there. The samples before that trigger point came after the end of
+	 * the device's frame buffer was reached, and it wrapped around to
+	 * overwrite up until the trigger point.
+	 *
+	 * The device always sends data for both channels. If a channel
+	 * is disabled, it contains a copy of the enabled channel's
+	 * data. However, we only send the requested channels to
+	 * the bus.
 	 */
-	if (devc->samp_received < devc->trigger_offset) {
-		/* Trigger point not yet reached. */
-		if (devc->samp_received + num_samples < devc->trigger_offset) {
-			/* The entire chunk is before the trigger point. */
-			memcpy(devc->framebuf + devc->samp_buffered * 2,
-					transfer->buffer, num_samples * 2);
-			devc->samp_buffered += num_samples;
-		} else {
-			/*
-			 * This chunk hits or overruns the trigger point.
-			 * Store the part before the trigger fired, and
-			 * send the rest up to the session bus.
-			 */
-			pre = devc->trigger_offset - devc->samp_received;
-			memcpy(devc->framebuf + devc->samp_buffered * 2,
-					transfer->buffer, pre * 2);
-			devc->samp_buffered += pre;
-
-			/* The rest of this chunk starts with the trigger point. */
-			sr_dbg("Reached trigger point, %d samples buffered.",
-				devc->samp_buffered);
-
-			/* Avoid the corner case where the chunk ended at
-			 * exactly the trigger point. */
-			if (num_samples > pre)
-				send_chunk(sdi, transfer->buffer + pre * 2,
-						num_samples - pre);
+	/* TODO: Support for DSO-5xxx series 9-bit samples. */
+	for (i = 0; frame && i < num_samples; i++) {
+		pos = devc->samp_received + i;
+		if (pos >= devc->trigger_offset)
+			pos -= devc->trigger_offset;
+		else
+			pos += devc->framesize - devc->trigger_offset;
+		for (l = devc->enabled_channels, j = 0; l; l = l->next, j++) {
+			ch = l->data;
+			dst = frame->channels[j].data;
+			dst[pos] = transfer->buffer[i * 2 + 1 - ch->index];
 		}
-	} else {
-		/* Already past the trigger point, just send it all out. */
-		send_chunk(sdi, transfer->buffer, num_samples);
 	}
 
 	devc->samp_received += num_samples;
 
-	/* Everything in this transfer was either copied to the buffer or
-	 * sent to the session bus. */
+	/* Everything in this transfer was copied to the frame. */
 	g_free(transfer->buffer);
 	libusb_free_transfer(transfer);
 
-	if (devc->samp_received >= devc->framesize) {
-		/* That was the last chunk in this frame. Send the buffered
-		 * pre-trigger samples out now, in one big chunk. */
-		sr_dbg("End of frame, sending %d pre-trigger buffered samples.",
-			devc->samp_buffered);
-		send_chunk(sdi, devc->framebuf, devc->samp_buffered);
-
-		/* Mark the end of this frame. */
-		packet.type = SR_DF_FRAME_END;
-		sr_session_send(sdi, &packet);
-
-		if (devc->limit_frames && ++devc->num_frames == devc->limit_frames) {
-			/* Terminate session */
-			devc->dev_state = STOPPING;
-		} else {
-			devc->dev_state = NEW_CAPTURE;
-		}
+	if (devc->samp_received < devc->framesize)
+		return;
+
+	/* That was the last chunk in this frame. */
+	if (frame) {
+		frame->num_samples = devc->framesize;
+		frame->info.trigger_offset = devc->framesize * devc->triggerposition;
+		set_encodings(sdi, frame);
+		sr_frame_ring_commit(&devc->frames, frame);
+		sr_frame_ring_send(&devc->frames, sdi);
+		devc->frame = NULL;
+	}
+
+	if (sr_frame_ring_limit_reached(&devc->frames)) {
+		/* Terminate session */
+		devc->dev_state = STOPPING;
+	} else {
+		devc->dev_state = NEW_CAPTURE;
 	}
 }
 
 static int handle_event(int fd, int revents, void *cb_data)
 {
 	const struct sr_dev_inst *sdi;
-	struct sr_datafeed_packet packet;
 	struct timeval tv;
 	struct sr_dev_driver *di;
 	struct dev_context *devc;
 	struct drv_context *drvc;
-	int num_channels;
 	uint32_t trigger_offset;
 	uint8_t capturestate;
 
@@ -866,6 +837,8 @@ static int handle_event(int fd, int revents, void *cb_data)
 		 */
 		usb_source_remove(sdi->session, drvc->sr_ctx);
 
+		sr_frame_ring_acquisition_stop(&devc->frames);
+		devc->frame = NULL;
 		std_session_send_df_end(sdi);
 
 		devc->dev_state = IDLE;
@@ -915,11 +888,11 @@ static int handle_event(int fd, int revents, void *cb_data)
 		break;
 	case CAPTURE_READY_8BIT:
 		/* Remember where in the captured frame the trigger is. */
-		devc->trigger_offset = trigger_offset;
+		devc->trigger_offset = MIN(trigger_offset, devc->framesize);
+		devc->samp_received = 0;
 
-		num_channels = (devc->ch_enabled[0] && devc->ch_enabled[1]) ? 2 : 1;
-		devc->framebuf = g_malloc(devc->framesize * num_channels * 2);
-		devc->samp_buffered = devc->samp_received = 0;
+		/* The data is still fetched if the frame is dropped. */
+		devc->frame = sr_frame_ring_begin(&devc->frames, sdi);
 
 		/* Tell the scope to send us the first frame. */
 		if (dso_get_channeldata(sdi, receive_transfer) != SR_OK)
@@ -930,10 +903,6 @@ static int handle_event(int fd, int revents, void *cb_data)
 		 * the data we just told the scope to send.
 		 */
 		devc->dev_state = FETCH_DATA;
-
-		/* Tell the frontend a new frame is on the way. */
-		packet.type = SR_DF_FRAME_BEGIN;
-		sr_session_send(sdi, &packet);
 		break;
 	case CAPTURE_READY_9BIT:
 		/* TODO */
@@ -966,6 +935,14 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		return SR_ERR;
 	}
 
+	/* Frames are sent as soon as they are complete, one is enough. */
+	if (sr_frame_ring_acquisition_start(&devc->frames, 1,
+			devc->enabled_channels, devc->framesize, 1, FALSE) != SR_OK) {
+		sr_err("Failed to allocate frame buffers.");
+		return SR_ERR_MALLOC;
+	}
+	devc->frame = NULL;
+
 	if (dso_init(sdi) != SR_OK)
 		return SR_ERR;
 
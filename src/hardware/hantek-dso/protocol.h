@@ -162,8 +162,6 @@ struct dso_profile {
 
 struct dev_context {
 	const struct dso_profile *profile;
-	uint64_t limit_frames;
-	uint64_t num_frames;
 	GSList *enabled_channels;
 	/* We can't keep track of an FX2-based device after upgrading
 	 * the firmware (it re-enumerates into a different device address
@@ -193,10 +191,11 @@ struct dev_context {
 	int triggermode;
 
 	/* Frame transfer */
+	struct sr_frame_ring frames;
+	/* The frame being received, NULL if it's dropped. */
+	struct sr_frame *frame;
 	unsigned int samp_received;
-	unsigned int samp_buffered;
 	unsigned int trigger_offset;
-	unsigned char *framebuf;
 };
 
 SR_PRIV int dso_open(struct sr_dev_inst *sdi);
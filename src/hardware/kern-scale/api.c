@@ -86,8 +86,8 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 
 	/* Let's get a bit of data and see if we can find a packet. */
 	len = sizeof(buf);
-	ret = serial_stream_detect(serial, buf, &len, scale->packet_size,
-				   scale->packet_valid, 3000, scale->baudrate);
+	ret = serial_stream_detect_sync(serial, buf, &len, scale->sync,
+					scale->packet_valid, 3000, scale->baudrate);
 	if (ret != SR_OK)
 		goto scan_cleanup;
 
@@ -174,7 +174,7 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
-#define SCALE(ID, CHIPSET, VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, \
+#define SCALE(ID, CHIPSET, VENDOR, MODEL, CONN, BAUDRATE, SYNC, \
 			VALID, PARSE) \
 	&((struct scale_info) { \
 		{ \
@@ -194,14 +194,14 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 			.dev_acquisition_stop = std_serial_dev_acquisition_stop, \
 			.context = NULL, \
 		}, \
-		VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, \
+		VENDOR, MODEL, CONN, BAUDRATE, SYNC, \
 		VALID, PARSE, sizeof(struct CHIPSET##_info) \
 	}).di
 
 /*
  * Some scales have (user-configurable) 14-byte or 15-byte packets.
  * We transparently support both variants by specifying the larger value
- * below and due to the way the stream parser works.
+ * in sr_kern_packet_sync and due to the way the stream parser works.
  *
  * The scales have a standard baudrate (model dependent) as listed below,
  * but serial parameters are user-configurable. We support that by letting
@@ -212,6 +212,6 @@ SR_REGISTER_DEV_DRIVER_LIST(kern_scale_drivers,
 	SCALE(
 		"kern-ew-6200-2nm", kern,
 		"KERN", "EW 6200-2NM", "1200/8n2", 1200,
-		15 /* (or 14) */, sr_kern_packet_valid, sr_kern_parse
+		&sr_kern_packet_sync, sr_kern_packet_valid, sr_kern_parse
 	)
 );
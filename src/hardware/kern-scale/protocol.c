@@ -66,13 +66,26 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 {
 	struct scale_info *scale;
 	struct dev_context *devc;
-	int len, i, offset = 0;
+	const uint8_t *pkt;
+	size_t packet_size, skip;
+	int len;
 	struct sr_serial_dev_inst *serial;
 
 	scale = (struct scale_info *)sdi->driver;
 
 	devc = sdi->priv;
 	serial = sdi->conn;
+	packet_size = scale->sync->packet_size;
+
+	/* Move leftover data to the beginning of our buffer when it fills up. */
+	if (devc->bufoffset == devc->buflen) {
+		devc->bufoffset = devc->buflen = 0;
+	} else if ((size_t)(SCALE_BUFSIZE - devc->buflen) < packet_size) {
+		memmove(devc->buf, devc->buf + devc->bufoffset,
+			devc->buflen - devc->bufoffset);
+		devc->buflen -= devc->bufoffset;
+		devc->bufoffset = 0;
+	}
 
 	/* Try to get as much data as the buffer can hold. */
 	len = SCALE_BUFSIZE - devc->buflen;
@@ -86,19 +99,13 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 	devc->buflen += len;
 
 	/* Now look for packets in that data. */
-	while ((devc->buflen - offset) >= scale->packet_size) {
-		if (scale->packet_valid(devc->buf + offset)) {
-			handle_packet(devc->buf + offset, sdi, info);
-			offset += scale->packet_size;
-		} else {
-			offset++;
-		}
+	while ((pkt = sr_packet_sync_find(scale->sync, scale->packet_valid,
+			devc->buf + devc->bufoffset,
+			devc->buflen - devc->bufoffset, &skip))) {
+		handle_packet(pkt, sdi, info);
+		devc->bufoffset += skip + packet_size;
 	}
-
-	/* If we have any data left, move it to the beginning of our buffer. */
-	for (i = 0; i < devc->buflen - offset; i++)
-		devc->buf[i] = devc->buf[offset + i];
-	devc->buflen -= offset;
+	devc->bufoffset += skip;
 }
 
 SR_PRIV int kern_scale_receive_data(int fd, int revents, void *cb_data)
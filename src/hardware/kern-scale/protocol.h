@@ -34,8 +34,8 @@ struct scale_info {
 	const char *conn;
 	/** Baud rate. */
 	uint32_t baudrate;
-	/** Packet size in bytes. */
-	int packet_size;
+	/** Packet size and framing. */
+	const struct sr_packet_sync *sync;
 	/** Packet validation function. */
 	gboolean (*packet_valid)(const uint8_t *);
 	/** Packet parsing function. */
@@ -52,7 +52,9 @@ struct dev_context {
 	struct sr_sw_limits limits;
 
 	uint8_t buf[SCALE_BUFSIZE];
+	/** Start of the data not looked at yet. */
 	int bufoffset;
+	/** End of the data received so far. */
 	int buflen;
 };
 
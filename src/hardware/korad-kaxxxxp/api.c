@@ -37,6 +37,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_GET | SR_CONF_SET,
 	SR_CONF_LIMIT_MSEC | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_SAMPLES | SR_CONF_GET | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_MSEC | SR_CONF_GET | SR_CONF_SET,
 	/* Device configuration */
 	SR_CONF_VOLTAGE | SR_CONF_GET,
 	SR_CONF_VOLTAGE_TARGET | SR_CONF_GET | SR_CONF_SET | SR_CONF_LIST,
@@ -142,6 +144,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 
 	devc = g_malloc0(sizeof(struct dev_context));
 	sr_sw_limits_init(&devc->limits);
+	sr_analog_batch_init(&devc->batch);
 	devc->model = &models[model_id];
 	devc->reply[5] = 0;
 	devc->req_sent_at = 0;
@@ -179,6 +182,9 @@ static int config_get(uint32_t key, GVariant **data,
 	case SR_CONF_LIMIT_SAMPLES:
 	case SR_CONF_LIMIT_MSEC:
 		return sr_sw_limits_config_get(&devc->limits, key, data);
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		return sr_analog_batch_config_get(&devc->batch, key, data);
 	case SR_CONF_VOLTAGE:
 		*data = g_variant_new_double(devc->voltage);
 		break;
@@ -229,6 +235,9 @@ static int config_set(uint32_t key, GVariant *data,
 	case SR_CONF_LIMIT_MSEC:
 	case SR_CONF_LIMIT_SAMPLES:
 		return sr_sw_limits_config_set(&devc->limits, key, data);
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		return sr_analog_batch_config_set(&devc->batch, key, data);
 	case SR_CONF_VOLTAGE_TARGET:
 		dval = g_variant_get_double(data);
 		if (dval < devc->model->voltage[0] || dval > devc->model->voltage[1])
@@ -362,6 +371,16 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
+static int dev_acquisition_stop(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+
+	if ((devc = sdi->priv))
+		sr_analog_batch_flush(&devc->batch, sdi);
+
+	return std_serial_dev_acquisition_stop(sdi);
+}
+
 static struct sr_dev_driver korad_kaxxxxp_driver_info = {
 	.name = "korad-kaxxxxp",
 	.longname = "Korad KAxxxxP",
@@ -376,7 +395,7 @@ static struct sr_dev_driver korad_kaxxxxp_driver_info = {
 	.dev_open = std_serial_dev_open,
 	.dev_close = std_serial_dev_close,
 	.dev_acquisition_start = dev_acquisition_start,
-	.dev_acquisition_stop = std_serial_dev_acquisition_stop,
+	.dev_acquisition_stop = dev_acquisition_stop,
 	.context = NULL,
 };
 SR_REGISTER_DEV_DRIVER(korad_kaxxxxp_driver_info);
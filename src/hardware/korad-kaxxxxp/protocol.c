@@ -327,7 +327,6 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 	struct sr_dev_inst *sdi;
 	struct dev_context *devc;
 	struct sr_serial_dev_inst *serial;
-	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
@@ -352,8 +351,6 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 		sr_analog_init(&analog, &encoding, &meaning, &spec, 0);
 
 		/* Send the value forward. */
-		packet.type = SR_DF_ANALOG;
-		packet.payload = &analog;
 		analog.meaning->channels = sdi->channels;
 		analog.num_samples = 1;
 		if (devc->target == KAXXXXP_CURRENT) {
@@ -363,7 +360,7 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 			analog.encoding->digits = 3;
 			analog.spec->spec_digits = 3;
 			analog.data = &devc->current;
-			sr_session_send(sdi, &packet);
+			sr_analog_batch_send(&devc->batch, sdi, &analog, NULL);
 		}
 		if (devc->target == KAXXXXP_VOLTAGE) {
 			analog.meaning->mq = SR_MQ_VOLTAGE;
@@ -372,7 +369,7 @@ SR_PRIV int korad_kaxxxxp_receive_data(int fd, int revents, void *cb_data)
 			analog.encoding->digits = 2;
 			analog.spec->spec_digits = 2;
 			analog.data = &devc->voltage;
-			sr_session_send(sdi, &packet);
+			sr_analog_batch_send(&devc->batch, sdi, &analog, NULL);
 			sr_sw_limits_update_samples_read(&devc->limits, 1);
 		}
 		next_measurement(devc);
@@ -77,6 +77,7 @@ struct dev_context {
 
 	/* Acquisition settings */
 	struct sr_sw_limits limits;
+	struct sr_analog_batch batch;
 	int64_t req_sent_at;
 	gboolean reply_pending;
 
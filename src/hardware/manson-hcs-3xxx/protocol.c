@@ -127,7 +127,6 @@ SR_PRIV int hcs_parse_volt_curr_mode(struct sr_dev_inst *sdi, char **tokens)
 static void send_sample(struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
-	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
@@ -137,8 +136,6 @@ static void send_sample(struct sr_dev_inst *sdi)
 
 	sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
 
-	packet.type = SR_DF_ANALOG;
-	packet.payload = &analog;
 	analog.meaning->channels = sdi->channels;
 	analog.num_samples = 1;
 
@@ -146,13 +143,13 @@ static void send_sample(struct sr_dev_inst *sdi)
 	analog.meaning->unit = SR_UNIT_VOLT;
 	analog.meaning->mqflags = SR_MQFLAG_DC;
 	analog.data = &devc->voltage;
-	sr_session_send(sdi, &packet);
+	sr_analog_batch_send(&devc->batch, sdi, &analog, NULL);
 
 	analog.meaning->mq = SR_MQ_CURRENT;
 	analog.meaning->unit = SR_UNIT_AMPERE;
 	analog.meaning->mqflags = 0;
 	analog.data = &devc->current;
-	sr_session_send(sdi, &packet);
+	sr_analog_batch_send(&devc->batch, sdi, &analog, NULL);
 
 
 	sr_sw_limits_update_samples_read(&devc->limits, 1);
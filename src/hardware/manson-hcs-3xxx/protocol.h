@@ -72,6 +72,7 @@ struct dev_context {
 	const struct hcs_model *model; /**< Model information. */
 
 	struct sr_sw_limits limits;
+	struct sr_analog_batch batch;
 	int64_t req_sent_at;
 	gboolean reply_pending;
 
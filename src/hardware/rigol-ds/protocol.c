@@ -533,6 +533,17 @@ static int rigol_ds_read_header(struct sr_dev_inst *sdi)
 	return ret;
 }
 
+/*
+ * The device reports its settings as decimal numbers. With nine decimal
+ * places they are represented exactly, which a float can't.
+ */
+#define DECIMAL_DENOM 1000000000LL
+
+static int64_t to_decimal(float value)
+{
+	return llround((double)value * DECIMAL_DENOM);
+}
+
 SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 {
 	struct sr_dev_inst *sdi;
@@ -544,8 +555,9 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	struct sr_datafeed_logic logic;
-	double vdiv, offset;
-	int len, i, vref;
+	double vdiv;
+	int64_t scale, offset_p;
+	int len, vref;
 	struct sr_channel *ch;
 	gsize expected_data_bytes;
 
@@ -665,19 +677,34 @@ SR_PRIV int rigol_ds_receive(int fd, int revents, void *cb_data)
 	if (ch->type == SR_CHANNEL_ANALOG) {
 		vref = devc->vert_reference[ch->index];
 		vdiv = devc->vdiv[ch->index] / 25.6;
-		offset = devc->vert_offset[ch->index];
-		if (devc->model->series->protocol >= PROTOCOL_V3)
-			for (i = 0; i < len; i++)
-				devc->data[i] = ((int)devc->buffer[i] - vref) * vdiv - offset;
-		else
-			for (i = 0; i < len; i++)
-				devc->data[i] = (128 - devc->buffer[i]) * vdiv - offset;
 		float vdivlog = log10f(vdiv);
 		int digits = -(int)vdivlog + (vdivlog < 0.0);
 		sr_analog_init(&analog, &encoding, &meaning, &spec, digits);
+
+		/*
+		 * Send the ADC codes as they are, the encoding scales them
+		 * to volts: (code - vref) * vdiv - offset on newer models,
+		 * (128 - code) * vdiv - offset on older ones, with
+		 * vdiv = V/div * 10 / 256.
+		 */
+		analog.encoding->unitsize = 1;
+		analog.encoding->is_float = FALSE;
+		analog.encoding->is_signed = FALSE;
+		scale = to_decimal(devc->vdiv[ch->index]) * 10;
+		offset_p = to_decimal(devc->vert_offset[ch->index]) * 256;
+		if (devc->model->series->protocol >= PROTOCOL_V3) {
+			offset_p = -vref * scale - offset_p;
+		} else {
+			offset_p = 128 * scale - offset_p;
+			scale = -scale;
+		}
+		sr_rational_set(&analog.encoding->scale, scale,
+				256 * DECIMAL_DENOM);
+		sr_rational_set(&analog.encoding->offset, offset_p,
+				256 * DECIMAL_DENOM);
 		analog.meaning->channels = g_slist_append(NULL, ch);
 		analog.num_samples = len;
-		analog.data = devc->data;
+		analog.data = devc->buffer;
 		analog.meaning->mq = SR_MQ_VOLTAGE;
 		analog.meaning->unit = SR_UNIT_VOLT;
 		analog.meaning->mqflags = 0;
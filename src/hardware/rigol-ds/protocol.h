@@ -147,7 +147,6 @@ struct dev_context {
 	int wait_status;
 	/* Acq buffers used for reading from the scope and sending data to app */
 	unsigned char *buffer;
-	float *data;
 };
 
 SR_PRIV int rigol_ds_config_set(const struct sr_dev_inst *sdi, const char *format, ...);
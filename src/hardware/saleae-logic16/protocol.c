@@ -798,6 +798,7 @@ static void resubmit_transfer(struct libusb_transfer *transfer)
 	if ((ret = libusb_submit_transfer(transfer)) == LIBUSB_SUCCESS)
 		return;
 
+	sr_session_metrics_usb_resubmit_failed(transfer->user_data);
 	free_transfer(transfer);
 	/* TODO: Stop session? */
 
@@ -893,6 +894,9 @@ SR_PRIV void LIBUSB_CALL logic16_receive_transfer(struct libusb_transfer *transf
 		devc->empty_transfer_count = MAX_EMPTY_TRANSFERS;
 	}
 
+	sr_session_metrics_usb_transfer(sdi,
+			transfer->actual_length == 0 || packet_has_error);
+
 	if (transfer->actual_length == 0 || packet_has_error) {
 		devc->empty_transfer_count++;
 		if (devc->empty_transfer_count > MAX_EMPTY_TRANSFERS) {
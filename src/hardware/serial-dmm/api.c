@@ -39,6 +39,8 @@ static const uint32_t devopts[] = {
 	SR_CONF_CONTINUOUS,
 	SR_CONF_LIMIT_SAMPLES | SR_CONF_SET,
 	SR_CONF_LIMIT_MSEC | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_SAMPLES | SR_CONF_SET,
+	SR_CONF_ANALOG_BATCH_MSEC | SR_CONF_SET,
 };
 
 static GSList *scan(struct sr_dev_driver *di, GSList *options)
@@ -100,9 +102,9 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 
 	/* Let's get a bit of data and see if we can find a packet. */
 	len = sizeof(buf);
-	ret = serial_stream_detect(serial, buf, &len, dmm->packet_size,
-				   dmm->packet_valid, 3000,
-				   dmm->baudrate);
+	ret = serial_stream_detect_sync(serial, buf, &len, dmm->sync,
+					dmm->packet_valid, 3000,
+					dmm->baudrate);
 	if (ret != SR_OK)
 		goto scan_cleanup;
 
@@ -113,8 +115,8 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	 * combination of the nonstandard cable that ships with some devices
 	 * and the serial port or USB to serial adapter.
 	 */
-	dropped = len - dmm->packet_size;
-	if (dropped > 2 * dmm->packet_size)
+	dropped = len - dmm->sync->packet_size;
+	if (dropped > 2 * dmm->sync->packet_size)
 		sr_warn("Had to drop too much data.");
 
 	sr_info("Found device on port %s.", conn);
@@ -125,6 +127,7 @@ static GSList *scan(struct sr_dev_driver *di, GSList *options)
 	sdi->model = g_strdup(dmm->device);
 	devc = g_malloc0(sizeof(struct dev_context));
 	sr_sw_limits_init(&devc->limits);
+	sr_analog_batch_init(&devc->batch);
 	sdi->inst_type = SR_INST_SERIAL;
 	sdi->conn = serial;
 	sdi->priv = devc;
@@ -149,7 +152,13 @@ static int config_set(uint32_t key, GVariant *data, const struct sr_dev_inst *sd
 
 	devc = sdi->priv;
 
-	return sr_sw_limits_config_set(&devc->limits, key, data);
+	switch (key) {
+	case SR_CONF_ANALOG_BATCH_SAMPLES:
+	case SR_CONF_ANALOG_BATCH_MSEC:
+		return sr_analog_batch_config_set(&devc->batch, key, data);
+	default:
+		return sr_sw_limits_config_set(&devc->limits, key, data);
+	}
 }
 
 static int config_list(uint32_t key, GVariant **data, const struct sr_dev_inst *sdi,
@@ -195,7 +204,17 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 	return SR_OK;
 }
 
-#define DMM(ID, CHIPSET, VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, TIMEOUT, \
+static int dev_acquisition_stop(struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+
+	if ((devc = sdi->priv))
+		sr_analog_batch_flush(&devc->batch, sdi);
+
+	return std_serial_dev_acquisition_stop(sdi);
+}
+
+#define DMM(ID, CHIPSET, VENDOR, MODEL, CONN, BAUDRATE, SYNC, TIMEOUT, \
 			DELAY, REQUEST, VALID, PARSE, DETAILS) \
 	&((struct dmm_info) { \
 		{ \
@@ -212,10 +231,10 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 			.dev_open = std_serial_dev_open, \
 			.dev_close = std_serial_dev_close, \
 			.dev_acquisition_start = dev_acquisition_start, \
-			.dev_acquisition_stop = std_serial_dev_acquisition_stop, \
+			.dev_acquisition_stop = dev_acquisition_stop, \
 			.context = NULL, \
 		}, \
-		VENDOR, MODEL, CONN, BAUDRATE, PACKETSIZE, TIMEOUT, DELAY, \
+		VENDOR, MODEL, CONN, BAUDRATE, SYNC, TIMEOUT, DELAY, \
 		REQUEST, VALID, PARSE, DETAILS, sizeof(struct CHIPSET##_info) \
 	}).di
 
@@ -223,154 +242,154 @@ SR_REGISTER_DEV_DRIVER_LIST(serial_dmm_drivers,
 	DMM(
 		"bbcgm-2010", metex14,
 		"BBC Goertz Metrawatt", "M2110", "1200/7n2", 1200,
-		BBCGM_M2110_PACKET_SIZE, 0, 0, NULL,
+		&sr_m2110_packet_sync, 0, 0, NULL,
 		sr_m2110_packet_valid, sr_m2110_parse,
 		NULL
 	),
 	DMM(
 		"digitek-dt4000zc", fs9721,
 		"Digitek", "DT4000ZC", "2400/8n1/dtr=1", 2400,
-		FS9721_PACKET_SIZE, 0, 0, NULL,
+		&sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_10_temp_c
 	),
 	DMM(
 		"tekpower-tp4000ZC", fs9721,
 		"TekPower", "TP4000ZC", "2400/8n1/dtr=1", 2400,
-		FS9721_PACKET_SIZE, 0, 0, NULL,
+		&sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_10_temp_c
 	),
 	DMM(
 		"metex-me31", metex14,
 		"Metex", "ME-31", "600/7n2/rts=0/dtr=1", 600,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"peaktech-3410", metex14,
 		"Peaktech", "3410", "600/7n2/rts=0/dtr=1", 600,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"mastech-mas345", metex14,
 		"MASTECH", "MAS345", "600/7n2/rts=0/dtr=1", 600,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"mastech-ms8250b", fs9721,
 		"MASTECH", "MS8250B", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		NULL
 	),
 	DMM(
 		"va-va18b", fs9721,
 		"V&A", "VA18B", "2400/8n1", 2400,
-		FS9721_PACKET_SIZE, 0, 0, NULL,
+		&sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_01_temp_c
 	),
 	DMM(
 		"va-va40b", fs9721,
 		"V&A", "VA40B", "2400/8n1", 2400,
-		FS9721_PACKET_SIZE, 0, 0, NULL,
+		&sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_max_c_min
 	),
 	DMM(
 		"metex-m3640d", metex14,
 		"Metex", "M-3640D", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"metex-m4650cr", metex14,
 		"Metex", "M-4650CR", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"peaktech-4370", metex14,
 		"PeakTech", "4370", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"pce-pce-dm32", fs9721,
 		"PCE", "PCE-DM32", "2400/8n1", 2400,
-		FS9721_PACKET_SIZE, 0, 0, NULL,
+		&sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_01_10_temp_f_c
 	),
 	DMM(
 		"radioshack-22-168", metex14,
 		"RadioShack", "22-168", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"radioshack-22-805", metex14,
 		"RadioShack", "22-805", "600/7n2/rts=0/dtr=1", 600,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"radioshack-22-812", rs9lcd,
 		"RadioShack", "22-812", "4800/8n1/rts=0/dtr=1", 4800,
-		RS9LCD_PACKET_SIZE, 0, 0, NULL,
+		&sr_rs9lcd_packet_sync, 0, 0, NULL,
 		sr_rs9lcd_packet_valid, sr_rs9lcd_parse,
 		NULL
 	),
 	DMM(
 		"tecpel-dmm-8061-ser", fs9721,
 		"Tecpel", "DMM-8061 (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_00_temp_c
 	),
 	DMM(
 		"voltcraft-m3650cr", metex14,
 		"Voltcraft", "M-3650CR", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 150, 20, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 150, 20, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"voltcraft-m3650d", metex14,
 		"Voltcraft", "M-3650D", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"voltcraft-m4650cr", metex14,
 		"Voltcraft", "M-4650CR", "1200/7n2/rts=0/dtr=1", 1200,
-		METEX14_PACKET_SIZE, 0, 0, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 0, 0, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"voltcraft-me42", metex14,
 		"Voltcraft", "ME-42", "600/7n2/rts=0/dtr=1", 600,
-		METEX14_PACKET_SIZE, 250, 60, sr_metex14_packet_request,
+		&sr_metex14_packet_sync, 250, 60, sr_metex14_packet_request,
 		sr_metex14_packet_valid, sr_metex14_parse,
 		NULL
 	),
 	DMM(
 		"voltcraft-vc820-ser", fs9721,
 		"Voltcraft", "VC-820 (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		NULL
 	),
@@ -382,52 +401,52 @@ SR_REGISTER_DEV_DRIVER_LIST(serial_dmm_drivers,
 		 */
 		"voltcraft-vc830-ser", fs9922,
 		"Voltcraft", "VC-830 (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9922_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9922_packet_sync, 0, 0, NULL,
 		sr_fs9922_packet_valid, sr_fs9922_parse,
 		&sr_fs9922_z1_diode
 	),
 	DMM(
 		"voltcraft-vc840-ser", fs9721,
 		"Voltcraft", "VC-840 (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_00_temp_c
 	),
 	DMM(
 		"voltcraft-vc870-ser", vc870,
 		"Voltcraft", "VC-870 (UT-D02 cable)", "9600/8n1/rts=0/dtr=1",
-		9600, VC870_PACKET_SIZE, 0, 0, NULL,
+		9600, &sr_vc870_packet_sync, 0, 0, NULL,
 		sr_vc870_packet_valid, sr_vc870_parse, NULL
 	),
 	DMM(
 		"voltcraft-vc920-ser", ut71x,
 		"Voltcraft", "VC-920 (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"voltcraft-vc940-ser", ut71x,
 		"Voltcraft", "VC-940 (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"voltcraft-vc960-ser", ut71x, 
 		"Voltcraft", "VC-960 (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"uni-t-ut60a-ser", fs9721,
 		"UNI-T", "UT60A (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		NULL
 	),
 	DMM(
 		"uni-t-ut60e-ser", fs9721,
 		"UNI-T", "UT60E (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_00_temp_c
 	),
@@ -435,95 +454,95 @@ SR_REGISTER_DEV_DRIVER_LIST(serial_dmm_drivers,
 		/* Note: ES51986 baudrate is actually 19230! */
 		"uni-t-ut60g-ser", es519xx,
 		"UNI-T", "UT60G (UT-D02 cable)", "19200/7o1/rts=0/dtr=1",
-		19200, ES519XX_11B_PACKET_SIZE, 0, 0, NULL,
+		19200, &sr_es519xx_11b_packet_sync, 0, 0, NULL,
 		sr_es519xx_19200_11b_packet_valid, sr_es519xx_19200_11b_parse,
 		NULL
 	),
 	DMM(
 		"uni-t-ut61b-ser", fs9922,
 		"UNI-T", "UT61B (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9922_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9922_packet_sync, 0, 0, NULL,
 		sr_fs9922_packet_valid, sr_fs9922_parse, NULL
 	),
 	DMM(
 		"uni-t-ut61c-ser", fs9922,
 		"UNI-T", "UT61C (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9922_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9922_packet_sync, 0, 0, NULL,
 		sr_fs9922_packet_valid, sr_fs9922_parse, NULL
 	),
 	DMM(
 		"uni-t-ut61d-ser", fs9922,
 		"UNI-T", "UT61D (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9922_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9922_packet_sync, 0, 0, NULL,
 		sr_fs9922_packet_valid, sr_fs9922_parse, NULL
 	),
 	DMM(
 		"uni-t-ut61e-ser", es519xx,
 		/* Note: ES51922 baudrate is actually 19230! */
 		"UNI-T", "UT61E (UT-D02 cable)", "19200/7o1/rts=0/dtr=1",
-		19200, ES519XX_14B_PACKET_SIZE, 0, 0, NULL,
+		19200, &sr_es519xx_14b_packet_sync, 0, 0, NULL,
 		sr_es519xx_19200_14b_packet_valid, sr_es519xx_19200_14b_parse,
 		NULL
 	),
 	DMM(
 		"uni-t-ut71a-ser", ut71x,
 		"UNI-T", "UT71A (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"uni-t-ut71b-ser", ut71x,
 		"UNI-T", "UT71B (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"uni-t-ut71c-ser", ut71x,
 		"UNI-T", "UT71C (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"uni-t-ut71d-ser", ut71x,
 		"UNI-T", "UT71D (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"uni-t-ut71e-ser", ut71x,
 		"UNI-T", "UT71E (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"iso-tech-idm103n", es519xx,
 		"ISO-TECH", "IDM103N", "2400/7o1/rts=0/dtr=1",
-		2400, ES519XX_11B_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_es519xx_11b_packet_sync, 0, 0, NULL,
 		sr_es519xx_2400_11b_packet_valid, sr_es519xx_2400_11b_parse,
 		NULL
 	),
 	DMM(
 		"tenma-72-7730-ser", ut71x,
 		"Tenma", "72-7730 (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"tenma-72-7732-ser", ut71x,
 		"Tenma", "72-7732 (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"tenma-72-9380a-ser", ut71x,
 		"Tenma", "72-9380A (UT-D02 cable)", "2400/7o1/rts=0/dtr=1",
-		2400, UT71X_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_ut71x_packet_sync, 0, 0, NULL,
 		sr_ut71x_packet_valid, sr_ut71x_parse, NULL
 	),
 	DMM(
 		"tenma-72-7745-ser", fs9721,
 		"Tenma", "72-7745 (UT-D02 cable)", "2400/8n1/rts=0/dtr=1",
-		2400, FS9721_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_fs9721_packet_sync, 0, 0, NULL,
 		sr_fs9721_packet_valid, sr_fs9721_parse,
 		sr_fs9721_00_temp_c
 	),
@@ -531,27 +550,27 @@ SR_REGISTER_DEV_DRIVER_LIST(serial_dmm_drivers,
 		"tenma-72-7750-ser", es519xx,
 		/* Note: ES51986 baudrate is actually 19230! */
 		"Tenma", "72-7750 (UT-D02 cable)", "19200/7o1/rts=0/dtr=1",
-		19200, ES519XX_11B_PACKET_SIZE, 0, 0, NULL,
+		19200, &sr_es519xx_11b_packet_sync, 0, 0, NULL,
 		sr_es519xx_19200_11b_packet_valid, sr_es519xx_19200_11b_parse,
 		NULL
 	),
 	DMM(
 		"brymen-bm25x", bm25x,
 		"Brymen", "BM25x", "9600/8n1/rts=1/dtr=1",
-		9600, BRYMEN_BM25X_PACKET_SIZE, 0, 0, NULL,
+		9600, &sr_brymen_bm25x_packet_sync, 0, 0, NULL,
 		sr_brymen_bm25x_packet_valid, sr_brymen_bm25x_parse,
 		NULL
 	),
 	DMM(
 		"velleman-dvm4100", dtm0660,
 		"Velleman", "DVM4100", "2400/8n1/rts=0/dtr=1",
-		2400, DTM0660_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_dtm0660_packet_sync, 0, 0, NULL,
 		sr_dtm0660_packet_valid, sr_dtm0660_parse, NULL
 	),
 	DMM(
 		"peaktech-3415", dtm0660,
 		"Peaktech", "3415", "2400/8n1/rts=0/dtr=1",
-		2400, DTM0660_PACKET_SIZE, 0, 0, NULL,
+		2400, &sr_dtm0660_packet_sync, 0, 0, NULL,
 		sr_dtm0660_packet_valid, sr_dtm0660_parse, NULL
 	),
 );
@@ -43,7 +43,6 @@ static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
 {
 	struct dmm_info *dmm;
 	float floatval;
-	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
 	struct sr_analog_encoding encoding;
 	struct sr_analog_meaning meaning;
@@ -71,9 +70,7 @@ static void handle_packet(const uint8_t *buf, struct sr_dev_inst *sdi,
 
 	if (analog.meaning->mq != 0) {
 		/* Got a measurement. */
-		packet.type = SR_DF_ANALOG;
-		packet.payload = &analog;
-		sr_session_send(sdi, &packet);
+		sr_analog_batch_send(&devc->batch, sdi, &analog, NULL);
 		sr_sw_limits_update_samples_read(&devc->limits, 1);
 	}
 }
@@ -116,13 +113,29 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 {
 	struct dmm_info *dmm;
 	struct dev_context *devc;
-	int len, i, offset = 0;
+	const uint8_t *pkt;
+	size_t packet_size, skip;
+	int len;
 	struct sr_serial_dev_inst *serial;
 
 	dmm = (struct dmm_info *)sdi->driver;
 
 	devc = sdi->priv;
 	serial = sdi->conn;
+	packet_size = dmm->sync->packet_size;
+
+	/*
+	 * Less than a packet is left over from the last run. Only move it
+	 * to the beginning of our buffer once the space after it runs out.
+	 */
+	if (devc->bufoffset == devc->buflen) {
+		devc->bufoffset = devc->buflen = 0;
+	} else if ((size_t)(DMM_BUFSIZE - devc->buflen) < packet_size) {
+		memmove(devc->buf, devc->buf + devc->bufoffset,
+			devc->buflen - devc->bufoffset);
+		devc->buflen -= devc->bufoffset;
+		devc->bufoffset = 0;
+	}
 
 	/* Try to get as much data as the buffer can hold. */
 	len = DMM_BUFSIZE - devc->buflen;
@@ -136,27 +149,21 @@ static void handle_new_data(struct sr_dev_inst *sdi, void *info)
 	devc->buflen += len;
 
 	/* Now look for packets in that data. */
-	while ((devc->buflen - offset) >= dmm->packet_size) {
-		if (dmm->packet_valid(devc->buf + offset)) {
-			handle_packet(devc->buf + offset, sdi, info);
-			offset += dmm->packet_size;
-
-			/* Request next packet, if required. */
-			if (!dmm->packet_request)
-				break;
-			if (dmm->req_timeout_ms || dmm->req_delay_ms)
-				devc->req_next_at = g_get_monotonic_time() +
-					dmm->req_delay_ms * 1000;
-			req_packet(sdi);
-		} else {
-			offset++;
-		}
+	while ((pkt = sr_packet_sync_find(dmm->sync, dmm->packet_valid,
+			devc->buf + devc->bufoffset,
+			devc->buflen - devc->bufoffset, &skip))) {
+		handle_packet(pkt, sdi, info);
+		devc->bufoffset += skip + packet_size;
+
+		/* Request next packet, if required. */
+		if (!dmm->packet_request)
+			continue;
+		if (dmm->req_timeout_ms || dmm->req_delay_ms)
+			devc->req_next_at = g_get_monotonic_time() +
+				dmm->req_delay_ms * 1000;
+		req_packet(sdi);
 	}
-
-	/* If we have any data left, move it to the beginning of our buffer. */
-	for (i = 0; i < devc->buflen - offset; i++)
-		devc->buf[i] = devc->buf[offset + i];
-	devc->buflen -= offset;
+	devc->bufoffset += skip;
 }
 
 int receive_data(int fd, int revents, void *cb_data)
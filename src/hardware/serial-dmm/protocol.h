@@ -33,8 +33,8 @@ struct dmm_info {
 	const char *conn;
 	/** Baud rate. */
 	uint32_t baudrate;
-	/** Packet size in bytes. */
-	int packet_size;
+	/** Packet size and framing. */
+	const struct sr_packet_sync *sync;
 	/**
 	 * Request timeout [ms] before request is considered lost and a new
 	 * one is sent. Used only if device needs polling.
@@ -63,9 +63,12 @@ struct dmm_info {
 /** Private, per-device-instance driver context. */
 struct dev_context {
 	struct sr_sw_limits limits;
+	struct sr_analog_batch batch;
 
 	uint8_t buf[DMM_BUFSIZE];
+	/** Start of the data not looked at yet. */
 	int bufoffset;
+	/** End of the data received so far. */
 	int buflen;
 
 	/**
@@ -59,6 +59,12 @@ struct sr_usb_dev_inst;
  */
 #define MAX_ACQ_RECV_LEN32	(2 * 512 / 4)
 
+/* Number of USB in transfers used for reading the capture memory.
+ * While the response to one read request is being decoded, the next
+ * request is already on its way.
+ */
+#define NUM_READ_XFERS		2
+
 /* Maximum length of a register read/write sequence.
  */
 #define MAX_REG_SEQ_LEN		8
@@ -114,12 +120,17 @@ struct acquisition_state {
 	uint64_t sample;	/* last sample read from capture memory */
 	uint64_t run_len;	/* remaining run length of current sample */
 
-	struct libusb_transfer *xfer_in;	/* USB in transfer record */
+	struct libusb_transfer *xfer_in;	/* current USB in transfer record */
 	struct libusb_transfer *xfer_out;	/* USB out transfer record */
+	struct libusb_transfer *xfer_in_ring[NUM_READ_XFERS]; /* in records */
+	unsigned int xfer_in_pos;	/* ring index of next memory read */
+	gboolean xfer_out_busy;		/* out transfer not yet completed */
+	gboolean read_queued;		/* memory read waiting for xfer_out */
 
 	unsigned int mem_addr_fill;	/* capture memory fill level */
 	unsigned int mem_addr_done;	/* next address to be processed */
 	unsigned int mem_addr_next;	/* start address for next async read */
+	unsigned int mem_addr_avail;	/* end address of current read buffer */
 	unsigned int mem_addr_stop;	/* end of memory range to be read */
 	unsigned int in_index;		/* position in read transfer buffer */
 	unsigned int out_index;		/* position in logic packet buffer */
@@ -133,7 +144,8 @@ struct acquisition_state {
 	unsigned int reg_seq_len;	/* length of register/value sequence */
 
 	struct regval reg_sequence[MAX_REG_SEQ_LEN];	/* register buffer */
-	uint32_t xfer_buf_in[MAX_ACQ_RECV_LEN32];	/* USB in buffer */
+	uint32_t *xfer_buf_in;				/* current in buffer */
+	uint32_t xfer_buf_ring[NUM_READ_XFERS][MAX_ACQ_RECV_LEN32]; /* in */
 	uint16_t xfer_buf_out[MAX_ACQ_SEND_LEN16];	/* USB out buffer */
 	uint8_t out_packet[PACKET_SIZE];		/* logic payload */
 };
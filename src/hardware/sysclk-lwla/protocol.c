@@ -36,6 +36,8 @@ static int submit_transfer(struct dev_context *devc,
 		devc->transfer_error = TRUE;
 		return SR_ERR;
 	}
+	if (xfer == devc->acquisition->xfer_out)
+		devc->acquisition->xfer_out_busy = TRUE;
 
 	return SR_OK;
 }
@@ -123,6 +125,35 @@ static int submit_request(const struct sr_dev_inst *sdi,
 	return submit_transfer(devc, acq->xfer_out);
 }
 
+/* Submit a capture memory read request, and queue the input transfer
+ * for its response right away instead of waiting for the request to
+ * complete first. If the previous request is still being sent, the
+ * read is submitted once that has completed.
+ */
+static int submit_read_request(const struct sr_dev_inst *sdi)
+{
+	struct dev_context *devc;
+	struct acquisition_state *acq;
+	struct libusb_transfer *xfer;
+	int ret;
+
+	devc = sdi->priv;
+	acq = devc->acquisition;
+
+	if (acq->xfer_out_busy) {
+		acq->read_queued = TRUE;
+		return SR_OK;
+	}
+	xfer = acq->xfer_in_ring[acq->xfer_in_pos];
+	acq->xfer_in_pos = (acq->xfer_in_pos + 1) % NUM_READ_XFERS;
+
+	ret = submit_request(sdi, STATE_READ_REQUEST);
+	if (ret != SR_OK)
+		return ret;
+
+	return submit_transfer(devc, xfer);
+}
+
 /* Evaluate and act on the response to a capture status request.
  */
 static void handle_status_response(const struct sr_dev_inst *sdi)
@@ -179,6 +210,8 @@ static void handle_length_response(const struct sr_dev_inst *sdi)
 	acq->run_len = 0;
 	acq->samples_done = 0;
 	acq->mem_addr_done = acq->mem_addr_next;
+	acq->mem_addr_avail = acq->mem_addr_next;
+	acq->xfer_in_pos = 0;
 	acq->out_index = 0;
 
 	if (acq->mem_addr_next >= acq->mem_addr_stop) {
@@ -200,6 +233,7 @@ static void handle_read_response(const struct sr_dev_inst *sdi)
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_logic logic;
 	unsigned int end_addr;
+	gboolean read_pending;
 
 	devc = sdi->priv;
 	acq = devc->acquisition;
@@ -210,9 +244,24 @@ static void handle_read_response(const struct sr_dev_inst *sdi)
 	logic.unitsize = (devc->model->num_channels + 7) / 8;
 	logic.data = acq->out_packet;
 
-	end_addr = MIN(acq->mem_addr_next, acq->mem_addr_stop);
+	acq->mem_addr_avail = acq->mem_addr_next;
+	end_addr = MIN(acq->mem_addr_avail, acq->mem_addr_stop);
 	acq->in_index = 0;
 
+	/*
+	 * Request the next block before decoding the current one, so that
+	 * the device can send it in the meantime. If the sample limit is
+	 * reached within the current block, the response to the extra
+	 * request is simply discarded. If the request fails, the current
+	 * block is still decoded before the acquisition is aborted.
+	 */
+	read_pending = !devc->cancel_requested
+			&& acq->samples_done < acq->samples_max
+			&& acq->mem_addr_next < acq->mem_addr_stop;
+
+	if (read_pending && submit_read_request(sdi) != SR_OK)
+		read_pending = FALSE;
+
 	/*
 	 * Repeatedly call the model-specific read response handler until
 	 * all data received in the transfer has been accounted for.
@@ -233,13 +282,9 @@ static void handle_read_response(const struct sr_dev_inst *sdi)
 		}
 	}
 
-	if (!devc->cancel_requested
-			&& acq->samples_done < acq->samples_max
-			&& acq->mem_addr_next < acq->mem_addr_stop) {
-		/* Request the next block. */
-		submit_request(sdi, STATE_READ_REQUEST);
+	/* Wait for the response to the next block. */
+	if (read_pending)
 		return;
-	}
 
 	/* Send partially filled packet as it is the last one. */
 	if (!devc->cancel_requested && acq->out_index > 0) {
@@ -247,7 +292,8 @@ static void handle_read_response(const struct sr_dev_inst *sdi)
 		sr_session_send(sdi, &packet);
 		acq->out_index = 0;
 	}
-	submit_request(sdi, STATE_READ_FINISH);
+	if (!devc->transfer_error)
+		submit_request(sdi, STATE_READ_FINISH);
 }
 
 /* Destroy and unset the acquisition state record.
@@ -256,6 +302,7 @@ static void clear_acquisition_state(const struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
 	struct acquisition_state *acq;
+	int i;
 
 	devc = sdi->priv;
 	acq = devc->acquisition;
@@ -264,7 +311,8 @@ static void clear_acquisition_state(const struct sr_dev_inst *sdi)
 
 	if (acq) {
 		libusb_free_transfer(acq->xfer_out);
-		libusb_free_transfer(acq->xfer_in);
+		for (i = 0; i < NUM_READ_XFERS; i++)
+			libusb_free_transfer(acq->xfer_in_ring[i]);
 		g_free(acq);
 	}
 }
@@ -333,6 +381,8 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 	devc = sdi->priv;
 	acq = devc->acquisition;
 
+	acq->xfer_out_busy = FALSE;
+
 	if (transfer->status != LIBUSB_TRANSFER_COMPLETED) {
 		sr_err("Transfer to device failed (state %d): %s.",
 		       devc->state, libusb_error_name(transfer->status));
@@ -340,9 +390,16 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 		return;
 	}
 
-	/* If this was a read request, wait for the response. */
+	/* If this was a read request, wait for the response. The input
+	 * transfer for capture memory reads has already been submitted,
+	 * but the next one may have been waiting for this transfer. */
 	if ((devc->state & STATE_EXPECT_RESPONSE) != 0) {
-		submit_transfer(devc, acq->xfer_in);
+		if (devc->state != STATE_READ_REQUEST)
+			submit_transfer(devc, acq->xfer_in);
+		else if (acq->read_queued) {
+			acq->read_queued = FALSE;
+			submit_read_request(sdi);
+		}
 		return;
 	}
 	if (acq->reg_seq_pos < acq->reg_seq_len)
@@ -372,7 +429,7 @@ static void LIBUSB_CALL transfer_out_completed(struct libusb_transfer *transfer)
 		break;
 	case STATE_READ_PREPARE:
 		if (acq->mem_addr_next < acq->mem_addr_stop && !devc->cancel_requested)
-			submit_request(sdi, STATE_READ_REQUEST);
+			submit_read_request(sdi);
 		else
 			submit_request(sdi, STATE_READ_FINISH);
 		break;
@@ -439,7 +496,13 @@ static void LIBUSB_CALL transfer_in_completed(struct libusb_transfer *transfer)
 			handle_length_response(sdi);
 		break;
 	case STATE_READ_REQUEST:
+		/* Decode from the buffer of the completed transfer. */
+		acq->xfer_in = transfer;
+		acq->xfer_buf_in = (uint32_t *)transfer->buffer;
 		handle_read_response(sdi);
+		/* Register reads use the first transfer again. */
+		acq->xfer_in = acq->xfer_in_ring[0];
+		acq->xfer_buf_in = acq->xfer_buf_ring[0];
 		break;
 	default:
 		sr_err("Unexpected device state %d.", devc->state);
@@ -455,6 +518,7 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 	struct dev_context *devc;
 	struct sr_usb_dev_inst *usb;
 	struct acquisition_state *acq;
+	int i;
 
 	devc = sdi->priv;
 	usb = sdi->conn;
@@ -472,14 +536,16 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 	if (!acq)
 		return SR_ERR_MALLOC;
 
-	acq->xfer_in = libusb_alloc_transfer(0);
-	if (!acq->xfer_in) {
-		g_free(acq);
-		return SR_ERR_MALLOC;
+	for (i = 0; i < NUM_READ_XFERS; i++) {
+		acq->xfer_in_ring[i] = libusb_alloc_transfer(0);
+		if (!acq->xfer_in_ring[i])
+			break;
 	}
-	acq->xfer_out = libusb_alloc_transfer(0);
+	if (i == NUM_READ_XFERS)
+		acq->xfer_out = libusb_alloc_transfer(0);
 	if (!acq->xfer_out) {
-		libusb_free_transfer(acq->xfer_in);
+		while (i-- > 0)
+			libusb_free_transfer(acq->xfer_in_ring[i]);
 		g_free(acq);
 		return SR_ERR_MALLOC;
 	}
@@ -489,11 +555,16 @@ static int init_acquisition_state(const struct sr_dev_inst *sdi)
 				  &transfer_out_completed,
 				  (struct sr_dev_inst *)sdi, USB_TIMEOUT_MS);
 
-	libusb_fill_bulk_transfer(acq->xfer_in, usb->devhdl, EP_REPLY,
-				  (unsigned char *)acq->xfer_buf_in,
-				  sizeof(acq->xfer_buf_in),
-				  &transfer_in_completed,
-				  (struct sr_dev_inst *)sdi, USB_TIMEOUT_MS);
+	for (i = 0; i < NUM_READ_XFERS; i++)
+		libusb_fill_bulk_transfer(acq->xfer_in_ring[i], usb->devhdl,
+				EP_REPLY, (unsigned char *)acq->xfer_buf_ring[i],
+				sizeof(acq->xfer_buf_ring[i]),
+				&transfer_in_completed,
+				(struct sr_dev_inst *)sdi, USB_TIMEOUT_MS);
+
+	/* Register and status reads always use the first transfer. */
+	acq->xfer_in = acq->xfer_in_ring[0];
+	acq->xfer_buf_in = acq->xfer_buf_ring[0];
 
 	if (devc->limit_msec > 0) {
 		acq->duration_max = devc->limit_msec;
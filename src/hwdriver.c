@@ -209,6 +209,22 @@ static struct sr_key_info sr_key_info_config[] = {
 		"Device mode", NULL},
 	{SR_CONF_TEST_MODE, SR_T_STRING, "test_mode",
 		"Test mode", NULL},
+	{SR_CONF_FREE_RUNNING, SR_T_BOOL, "free_running",
+		"Free-running mode", NULL},
+	{SR_CONF_ANALOG_BATCH_SAMPLES, SR_T_UINT64, "batch_samples",
+		"Analog batch size", NULL},
+	{SR_CONF_ANALOG_BATCH_MSEC, SR_T_UINT64, "batch_time",
+		"Analog batch time", NULL},
+	{SR_CONF_ANALOG_TIMESTAMPS, SR_T_INT64_ARRAY, "analog_timestamps",
+		"Analog sample timestamps", NULL},
+	{SR_CONF_LOGIC_PACKED, SR_T_BOOL, "logic_packed",
+		"Packed logic channels", NULL},
+	{SR_CONF_FRAME_INDEX, SR_T_UINT64, "frame_index",
+		"Frame index", NULL},
+	{SR_CONF_FRAME_TIMESTAMP, SR_T_UINT64, "frame_timestamp",
+		"Frame timestamp", NULL},
+	{SR_CONF_FRAME_TRIGGER_OFFSET, SR_T_UINT64, "frame_trigger_offset",
+		"Frame trigger offset", NULL},
 
 	ALL_ZERO
 };
@@ -307,6 +323,8 @@ SR_PRIV const GVariantType *sr_variant_type_get(int datatype)
 		return G_VARIANT_TYPE_DICTIONARY;
 	case SR_T_MQ:
 		return G_VARIANT_TYPE_TUPLE;
+	case SR_T_INT64_ARRAY:
+		return G_VARIANT_TYPE("ax");
 	default:
 		return NULL;
 	}
@@ -610,14 +628,145 @@ static void log_key(const struct sr_dev_inst *sdi,
 	g_free(tmp_str);
 }
 
+/*
+ * Config keys which report instrument state that can change without a
+ * config_set() call (measurements, front panel controls, protection
+ * status). Their values are never cached.
+ */
+static const uint32_t volatile_keys[] = {
+	SR_CONF_VOLTAGE,
+	SR_CONF_CURRENT,
+	SR_CONF_ENABLED,
+	SR_CONF_OVER_VOLTAGE_PROTECTION_ACTIVE,
+	SR_CONF_OVER_CURRENT_PROTECTION_ACTIVE,
+	SR_CONF_OVER_TEMPERATURE_PROTECTION_ACTIVE,
+	SR_CONF_UNDER_VOLTAGE_CONDITION_ACTIVE,
+	SR_CONF_REGULATION,
+	SR_CONF_OUTPUT_FREQUENCY,
+	SR_CONF_MEASURED_QUANTITY,
+	SR_CONF_DATALOG,
+};
+
+/*
+ * The caches of a device are guarded by a per-device mutex, since
+ * frontends may query a device from several threads. The mutex is
+ * created on first use, so device instances don't need to initialize
+ * it. The caches are never locked across driver calls, which may
+ * recurse into the config API.
+ */
+static GMutex *cache_lock(const struct sr_dev_inst *sdi)
+{
+	struct sr_dev_inst *cache_sdi;
+	GMutex *mutex;
+
+	cache_sdi = (struct sr_dev_inst *)sdi;
+	if (!(mutex = g_atomic_pointer_get(&cache_sdi->config_mutex))) {
+		mutex = g_malloc(sizeof(GMutex));
+		g_mutex_init(mutex);
+		if (!g_atomic_pointer_compare_and_exchange(
+				&cache_sdi->config_mutex, NULL, mutex)) {
+			/* Another thread was faster. */
+			g_mutex_clear(mutex);
+			g_free(mutex);
+			mutex = g_atomic_pointer_get(&cache_sdi->config_mutex);
+		}
+	}
+	g_mutex_lock(mutex);
+
+	return mutex;
+}
+
+/*
+ * Get the per-key table of a channel group from a cache (sdi->config_caps
+ * or sdi->config_values), optionally creating it. Must be called with
+ * the cache locked.
+ */
+static GHashTable *cache_table_get(GHashTable **cache,
+		const struct sr_channel_group *cg, GDestroyNotify value_free,
+		gboolean create)
+{
+	GHashTable *table;
+
+	if (!*cache) {
+		if (!create)
+			return NULL;
+		*cache = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+				NULL, (GDestroyNotify)g_hash_table_unref);
+	}
+
+	if (!(table = g_hash_table_lookup(*cache, cg)) && create) {
+		table = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+				NULL, value_free);
+		g_hash_table_insert(*cache, (void *)cg, table);
+	}
+
+	return table;
+}
+
+/*
+ * Look up the published capabilities of a key. Device options are
+ * fetched from the driver once and kept in sdi->config_caps, so the
+ * lookup doesn't need a config_list() round trip per call.
+ */
+static int lookup_opt(const struct sr_dev_driver *driver,
+		const struct sr_dev_inst *sdi, const struct sr_channel_group *cg,
+		uint32_t key, uint32_t *pub_opt)
+{
+	struct sr_dev_inst *cache_sdi;
+	GMutex *mutex;
+	GHashTable *caps;
+	GVariant *gvar_opts;
+	const uint32_t *opts;
+	gsize num_opts, i;
+	guint generation;
+
+	/* The caches don't change what the caller sees, hence const. */
+	cache_sdi = (struct sr_dev_inst *)sdi;
+
+	*pub_opt = 0;
+	generation = 0;
+	if (sdi) {
+		mutex = cache_lock(sdi);
+		caps = cache_table_get(&cache_sdi->config_caps, cg, NULL, FALSE);
+		if (caps)
+			*pub_opt = GPOINTER_TO_UINT(g_hash_table_lookup(caps,
+					GUINT_TO_POINTER(key)));
+		generation = sdi->config_generation;
+		g_mutex_unlock(mutex);
+		if (caps)
+			return SR_OK;
+	}
+
+	if (sr_config_list(driver, sdi, cg, SR_CONF_DEVICE_OPTIONS, &gvar_opts) != SR_OK)
+		return SR_ERR;
+	opts = g_variant_get_fixed_array(gvar_opts, &num_opts, sizeof(uint32_t));
+	for (i = 0; i < num_opts; i++) {
+		if ((opts[i] & SR_CONF_MASK) == key)
+			*pub_opt = opts[i];
+	}
+
+	/* Don't fill the cache if it got cleared meanwhile. */
+	if (sdi) {
+		mutex = cache_lock(sdi);
+		if (sdi->config_generation == generation) {
+			caps = cache_table_get(&cache_sdi->config_caps, cg, NULL, TRUE);
+			for (i = 0; i < num_opts; i++)
+				g_hash_table_insert(caps,
+					GUINT_TO_POINTER(opts[i] & SR_CONF_MASK),
+					GUINT_TO_POINTER(opts[i]));
+		}
+		g_mutex_unlock(mutex);
+	}
+	g_variant_unref(gvar_opts);
+
+	return SR_OK;
+}
+
 static int check_key(const struct sr_dev_driver *driver,
 		const struct sr_dev_inst *sdi, const struct sr_channel_group *cg,
 		uint32_t key, int op, GVariant *data)
 {
 	const struct sr_key_info *srci;
-	gsize num_opts, i;
-	GVariant *gvar_opts;
-	const uint32_t *opts;
 	uint32_t pub_opt;
 	const char *suffix;
 	const char *opstr;
@@ -649,20 +798,11 @@ static int check_key(const struct sr_dev_driver *driver,
 		break;
 	}
 
-	if (sr_config_list(driver, sdi, cg, SR_CONF_DEVICE_OPTIONS, &gvar_opts) != SR_OK) {
+	if (lookup_opt(driver, sdi, cg, key, &pub_opt) != SR_OK) {
 		/* Driver publishes no options. */
 		sr_err("No options available%s.", suffix);
 		return SR_ERR_ARG;
 	}
-	opts = g_variant_get_fixed_array(gvar_opts, &num_opts, sizeof(uint32_t));
-	pub_opt = 0;
-	for (i = 0; i < num_opts; i++) {
-		if ((opts[i] & SR_CONF_MASK) == key) {
-			pub_opt = opts[i];
-			break;
-		}
-	}
-	g_variant_unref(gvar_opts);
 	if (!pub_opt) {
 		sr_err("Option '%s' not available%s.", srci->id, suffix);
 		return SR_ERR_ARG;
@@ -676,6 +816,21 @@ static int check_key(const struct sr_dev_driver *driver,
 	return SR_OK;
 }
 
+static gboolean value_cacheable(const struct sr_dev_inst *sdi, uint32_t key)
+{
+	unsigned int i;
+
+	if (!sdi || !g_atomic_int_get(&sdi->config_cache_enabled))
+		return FALSE;
+
+	for (i = 0; i < G_N_ELEMENTS(volatile_keys); i++) {
+		if (volatile_keys[i] == key)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
 /**
  * Query value of a configuration key at the given driver or device instance.
  *
@@ -706,6 +861,11 @@ SR_API int sr_config_get(const struct sr_dev_driver *driver,
 		const struct sr_channel_group *cg,
 		uint32_t key, GVariant **data)
 {
+	struct sr_dev_inst *cache_sdi;
+	GMutex *mutex;
+	GHashTable *values;
+	gboolean cacheable;
+	guint generation;
 	int ret;
 
 	if (!driver || !data)
@@ -722,11 +882,38 @@ SR_API int sr_config_get(const struct sr_dev_driver *driver,
 		return SR_ERR;
 	}
 
+	cache_sdi = (struct sr_dev_inst *)sdi;
+	generation = 0;
+	if ((cacheable = value_cacheable(sdi, key))) {
+		mutex = cache_lock(sdi);
+		values = cache_table_get(&cache_sdi->config_values, cg, NULL, FALSE);
+		if (values && (*data = g_hash_table_lookup(values,
+				GUINT_TO_POINTER(key))))
+			g_variant_ref(*data);
+		else
+			*data = NULL;
+		generation = sdi->config_generation;
+		g_mutex_unlock(mutex);
+		if (*data)
+			return SR_OK;
+	}
+
 	if ((ret = driver->config_get(key, data, sdi, cg)) == SR_OK) {
 		log_key(sdi, cg, key, SR_CONF_GET, *data);
 		/* Got a floating reference from the driver. Sink it here,
 		 * caller will need to unref when done with it. */
 		g_variant_ref_sink(*data);
+		/* Don't cache a value which a config_set() may have outdated. */
+		if (cacheable) {
+			mutex = cache_lock(sdi);
+			if (sdi->config_generation == generation) {
+				values = cache_table_get(&cache_sdi->config_values,
+					cg, (GDestroyNotify)g_variant_unref, TRUE);
+				g_hash_table_insert(values, GUINT_TO_POINTER(key),
+					g_variant_ref(*data));
+			}
+			g_mutex_unlock(mutex);
+		}
 	}
 
 	return ret;
@@ -769,6 +956,8 @@ SR_API int sr_config_set(const struct sr_dev_inst *sdi,
 	else if ((ret = sr_variant_type_check(key, data)) == SR_OK) {
 		log_key(sdi, cg, key, SR_CONF_SET, data);
 		ret = sdi->driver->config_set(key, data, sdi, cg);
+		/* Other keys and even the capabilities may depend on it. */
+		sr_config_cache_clear(sdi, TRUE);
 	}
 
 	g_variant_unref(data);
@@ -790,8 +979,15 @@ SR_API int sr_config_commit(const struct sr_dev_inst *sdi)
 	int ret;
 
 	if (!sdi || !sdi->driver)
-		ret = SR_ERR;
-	else if (!sdi->driver->config_commit)
+		return SR_ERR;
+
+	/*
+	 * This also runs right before every acquisition start, which
+	 * thereby invalidates the value cache as well.
+	 */
+	sr_config_cache_clear(sdi, FALSE);
+
+	if (!sdi->driver->config_commit)
 		ret = SR_OK;
 	else
 		ret = sdi->driver->config_commit(sdi);
@@ -799,6 +995,87 @@ SR_API int sr_config_commit(const struct sr_dev_inst *sdi)
 	return ret;
 }
 
+/**
+ * Enable or disable caching of configuration values of a device.
+ *
+ * While enabled, sr_config_get() returns the previously read value of a
+ * key instead of querying the driver (and thus possibly the instrument)
+ * again. The cache is cleared by sr_config_set(), sr_config_commit(),
+ * which also happens on acquisition start, and when the device is opened
+ * or closed. Keys which report live instrument state (measured voltage
+ * or current, protection status and the like) are never cached.
+ *
+ * Caching is disabled by default.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ * @param enable TRUE to enable caching, FALSE to disable it.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_config_cache_enable(struct sr_dev_inst *sdi, gboolean enable)
+{
+	if (!sdi)
+		return SR_ERR_ARG;
+
+	g_atomic_int_set(&sdi->config_cache_enabled, enable);
+	sr_config_cache_clear(sdi, FALSE);
+
+	return SR_OK;
+}
+
+/**
+ * Clear the cached configuration values of a device.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ * @param caps Whether to also clear the cached device options.
+ *
+ * @private
+ */
+SR_PRIV void sr_config_cache_clear(const struct sr_dev_inst *sdi,
+		gboolean caps)
+{
+	struct sr_dev_inst *cache_sdi;
+	GMutex *mutex;
+
+	cache_sdi = (struct sr_dev_inst *)sdi;
+	mutex = cache_lock(sdi);
+	cache_sdi->config_generation++;
+	if (cache_sdi->config_values) {
+		g_hash_table_unref(cache_sdi->config_values);
+		cache_sdi->config_values = NULL;
+	}
+	if (caps && cache_sdi->config_caps) {
+		g_hash_table_unref(cache_sdi->config_caps);
+		cache_sdi->config_caps = NULL;
+	}
+	g_mutex_unlock(mutex);
+}
+
+/**
+ * Free the configuration caches of a device, including their mutex.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_config_cache_free(struct sr_dev_inst *sdi)
+{
+	if (sdi->config_values)
+		g_hash_table_unref(sdi->config_values);
+	if (sdi->config_caps)
+		g_hash_table_unref(sdi->config_caps);
+	sdi->config_values = sdi->config_caps = NULL;
+
+	if (sdi->config_mutex) {
+		g_mutex_clear(sdi->config_mutex);
+		g_free(sdi->config_mutex);
+		sdi->config_mutex = NULL;
+	}
+}
+
 /**
  * List all possible values for a configuration key.
  *
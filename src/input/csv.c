@@ -26,6 +26,13 @@
 
 #define LOG_PREFIX "input/csv"
 
+/* Maximum number of bytes of sample data sent per packet. */
+#define CHUNK_SIZE (64 * 1024)
+
+/* Worker threads parse without knowing absolute line numbers. */
+#define csv_err(inc, ...) do { if (!(inc)->quiet) sr_err(__VA_ARGS__); } while (0)
+#define csv_spew(inc, ...) do { if (!(inc)->quiet) sr_spew(__VA_ARGS__); } while (0)
+
 /*
  * The CSV input module has the following options:
  *
@@ -65,6 +72,11 @@
  *
  * startline:     Line number to start processing sample data. Must be greater
  *                than 0. The default line number to start processing is 1.
+ *
+ * threads:       Number of threads to parse large inputs with. The input
+ *                is cut into chunks at line boundaries, which are parsed
+ *                in parallel and sent in order. 0 uses one thread per
+ *                processor. The default is 1 (no parallel parsing).
  */
 
 /* Single column formats. */
@@ -131,6 +143,23 @@ struct context {
 
 	/* Current line number. */
 	size_t line_number;
+
+	/* Number of threads to parse with, 0 for one per processor. */
+	unsigned int num_threads;
+
+	/* Worker threads, NULL when parsing sequentially. */
+	struct sr_input_workers *workers;
+
+	/* Don't log, line numbers are relative (worker thread copies). */
+	gboolean quiet;
+};
+
+/* Result of parsing a chunk of lines. */
+struct chunk_result {
+	/* Sample data of all lines parsed. */
+	GByteArray *samples;
+	/* Number of lines parsed. */
+	size_t lines;
 };
 
 static void strip_comment(char *buf, const GString *prefix)
@@ -151,7 +180,7 @@ static int parse_binstr(const char *str, struct context *inc)
 	length = strlen(str);
 
 	if (!length) {
-		sr_err("Column %u in line %zu is empty.", inc->single_column,
+		csv_err(inc, "Column %u in line %zu is empty.", inc->single_column,
 			inc->line_number);
 		return SR_ERR;
 	}
@@ -165,7 +194,7 @@ static int parse_binstr(const char *str, struct context *inc)
 		if (str[length - i - 1] == '1') {
 			inc->sample_buffer[j / 8] |= (1 << (j % 8));
 		} else if (str[length - i - 1] != '0') {
-			sr_err("Invalid value '%s' in column %u in line %zu.",
+			csv_err(inc, "Invalid value '%s' in column %u in line %zu.",
 				str, inc->single_column, inc->line_number);
 			return SR_ERR;
 		}
@@ -183,7 +212,7 @@ static int parse_hexstr(const char *str, struct context *inc)
 	length = strlen(str);
 
 	if (!length) {
-		sr_err("Column %u in line %zu is empty.", inc->single_column,
+		csv_err(inc, "Column %u in line %zu is empty.", inc->single_column,
 			inc->line_number);
 		return SR_ERR;
 	}
@@ -198,7 +227,7 @@ static int parse_hexstr(const char *str, struct context *inc)
 		c = str[length - i - 1];
 
 		if (!g_ascii_isxdigit(c)) {
-			sr_err("Invalid value '%s' in column %u in line %zu.",
+			csv_err(inc, "Invalid value '%s' in column %u in line %zu.",
 				str, inc->single_column, inc->line_number);
 			return SR_ERR;
 		}
@@ -227,7 +256,7 @@ static int parse_octstr(const char *str, struct context *inc)
 	length = strlen(str);
 
 	if (!length) {
-		sr_err("Column %u in line %zu is empty.", inc->single_column,
+		csv_err(inc, "Column %u in line %zu is empty.", inc->single_column,
 			inc->line_number);
 		return SR_ERR;
 	}
@@ -242,7 +271,7 @@ static int parse_octstr(const char *str, struct context *inc)
 		c = str[length - i - 1];
 
 		if (c < '0' || c > '7') {
-			sr_err("Invalid value '%s' in column %u in line %zu.",
+			csv_err(inc, "Invalid value '%s' in column %u in line %zu.",
 				str, inc->single_column, inc->line_number);
 			return SR_ERR;
 		}
@@ -321,11 +350,11 @@ static int parse_multi_columns(char **columns, struct context *inc)
 		if (columns[i][0] == '1') {
 			inc->sample_buffer[i / 8] |= (1 << (i % 8));
 		} else if (!strlen(columns[i])) {
-			sr_err("Column %zu in line %zu is empty.",
+			csv_err(inc, "Column %zu in line %zu is empty.",
 				inc->first_channel + i, inc->line_number);
 			return SR_ERR;
 		} else if (columns[i][0] != '0') {
-			sr_err("Invalid value '%s' in column %zu in line %zu.",
+			csv_err(inc, "Invalid value '%s' in column %zu in line %zu.",
 				columns[i], inc->first_channel + i,
 				inc->line_number);
 			return SR_ERR;
@@ -356,21 +385,22 @@ static int parse_single_column(const char *column, struct context *inc)
 	return res;
 }
 
-static int send_samples(const struct sr_dev_inst *sdi, uint8_t *buffer,
-		gsize buffer_size, gsize count)
+static int send_samples(const struct sr_dev_inst *sdi, const GByteArray *samples,
+		gsize unitsize)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_logic logic;
 	int res;
-	gsize i;
+	gsize i, chunk;
 
 	packet.type = SR_DF_LOGIC;
 	packet.payload = &logic;
-	logic.unitsize = buffer_size;
-	logic.length = buffer_size;
-	logic.data = buffer;
+	logic.unitsize = unitsize;
 
-	for (i = 0; i < count; i++) {
+	chunk = MAX(CHUNK_SIZE / unitsize, 1) * unitsize;
+	for (i = 0; i < samples->len; i += logic.length) {
+		logic.length = MIN(chunk, samples->len - i);
+		logic.data = samples->data + i;
 		if ((res = sr_session_send(sdi, &packet)) != SR_OK)
 			return res;
 	}
@@ -431,6 +461,8 @@ static int init(struct sr_input *in, GHashTable *options)
 		return SR_ERR_ARG;
 	}
 
+	inc->num_threads = MAX(g_variant_get_int32(g_hash_table_lookup(options, "threads")), 0);
+
 	if (inc->multi_column_mode)
 		inc->first_column = inc->first_channel;
 	else
@@ -599,41 +631,15 @@ static int initial_receive(const struct sr_input *in)
 	return ret;
 }
 
-static int process_buffer(struct sr_input *in)
+/*
+ * Parse a block of complete lines, and append the sample data to
+ * the given array.
+ */
+static int parse_lines(struct context *inc, char *text, GByteArray *samples)
 {
-	struct sr_datafeed_packet packet;
-	struct sr_datafeed_meta meta;
-	struct sr_config *src;
-	struct context *inc;
 	gsize num_columns;
-	uint64_t samplerate;
 	int max_columns, ret, l;
-	char *p, **lines, **columns;
-
-	inc = in->priv;
-	if (!inc->started) {
-		std_session_send_df_header(in->sdi);
-
-		if (inc->samplerate) {
-			packet.type = SR_DF_META;
-			packet.payload = &meta;
-			samplerate = inc->samplerate;
-			src = sr_config_new(SR_CONF_SAMPLERATE, g_variant_new_uint64(samplerate));
-			meta.config = g_slist_append(NULL, src);
-			sr_session_send(in->sdi, &packet);
-			g_slist_free(meta.config);
-			sr_config_free(src);
-		}
-
-		inc->started = TRUE;
-	}
-
-	if (!(p = g_strrstr_len(in->buf->str, in->buf->len, inc->termination)))
-		/* Don't have a full line. */
-		return SR_ERR;
-
-	*p = '\0';
-	g_strstrip(in->buf->str);
+	char **lines, **columns;
 
 	/* Limit the number of columns to parse. */
 	if (inc->multi_column_mode)
@@ -642,69 +648,202 @@ static int process_buffer(struct sr_input *in)
 		max_columns = 1;
 
 	ret = SR_OK;
-	lines = g_strsplit_set(in->buf->str, "\r\n", 0);
+	lines = g_strsplit_set(text, "\r\n", 0);
 	for (l = 0; lines[l]; l++) {
 		inc->line_number++;
 		if (lines[l][0] == '\0') {
-			sr_spew("Blank line %zu skipped.", inc->line_number);
+			csv_spew(inc, "Blank line %zu skipped.", inc->line_number);
 			continue;
 		}
 
 		/* Remove trailing comment. */
 		strip_comment(lines[l], inc->comment);
 		if (lines[l][0] == '\0') {
-			sr_spew("Comment-only line %zu skipped.", inc->line_number);
+			csv_spew(inc, "Comment-only line %zu skipped.", inc->line_number);
 			continue;
 		}
 
 		/* Skip the header line, its content was used as the channel names. */
 		if (inc->header) {
-			sr_spew("Header line %zu skipped.", inc->line_number);
+			csv_spew(inc, "Header line %zu skipped.", inc->line_number);
 			inc->header = FALSE;
 			continue;
 		}
 
 		if (!(columns = parse_line(lines[l], inc, max_columns))) {
-			sr_err("Error while parsing line %zu.", inc->line_number);
-			return SR_ERR;
+			csv_err(inc, "Error while parsing line %zu.", inc->line_number);
+			ret = SR_ERR;
+			break;
 		}
 		num_columns = g_strv_length(columns);
 		if (!num_columns) {
-			sr_err("Column %u in line %zu is out of bounds.",
+			csv_err(inc, "Column %u in line %zu is out of bounds.",
 				inc->first_column, inc->line_number);
 			g_strfreev(columns);
-			return SR_ERR;
+			ret = SR_ERR;
+			break;
 		}
 		/*
 		 * Ensure that the number of channels does not exceed the number
 		 * of columns in multi column mode.
 		 */
 		if (inc->multi_column_mode && num_columns < inc->num_channels) {
-			sr_err("Not enough columns for desired number of channels in line %zu.",
+			csv_err(inc, "Not enough columns for desired number of channels in line %zu.",
 				inc->line_number);
 			g_strfreev(columns);
-			return SR_ERR;
+			ret = SR_ERR;
+			break;
 		}
 
 		if (inc->multi_column_mode)
 			ret = parse_multi_columns(columns, inc);
 		else
 			ret = parse_single_column(columns[0], inc);
+		g_strfreev(columns);
 		if (ret != SR_OK) {
-			g_strfreev(columns);
-			return SR_ERR;
+			ret = SR_ERR;
+			break;
 		}
 
-		/* Send sample data to the session bus. */
-		ret = send_samples(in->sdi, inc->sample_buffer,
-			inc->sample_buffer_size, 1);
+		g_byte_array_append(samples, inc->sample_buffer,
+			inc->sample_buffer_size);
+	}
+	g_strfreev(lines);
+
+	return ret;
+}
+
+/* Parse one chunk of lines on a worker thread. */
+static void parse_chunk(struct sr_input_chunk *chunk, void *cb_data)
+{
+	struct context wc;
+	struct chunk_result *res;
+
+	/* Private copy of the context, with relative line numbers. */
+	wc = *(const struct context *)cb_data;
+	wc.line_number = 0;
+	wc.quiet = TRUE;
+	wc.sample_buffer = g_malloc(wc.sample_buffer_size);
+
+	res = chunk->result;
+	chunk->ret = parse_lines(&wc, chunk->text, res->samples);
+	res->lines = wc.line_number;
+
+	g_free(wc.sample_buffer);
+}
+
+/*
+ * Parse the lines in parallel, and send the sample data in order. The
+ * header line must have been skipped before.
+ */
+static int parse_parallel(struct sr_input *in, char *text, gsize len)
+{
+	struct context *inc;
+	struct sr_input_chunk *chunks;
+	struct chunk_result *results;
+	GByteArray *samples;
+	unsigned int num_chunks, i;
+	int ret;
+
+	inc = in->priv;
+	chunks = sr_input_split_lines(inc->workers, text, len, NULL,
+			&num_chunks);
+	results = g_malloc0(num_chunks * sizeof(struct chunk_result));
+	for (i = 0; i < num_chunks; i++) {
+		results[i].samples = g_byte_array_new();
+		chunks[i].result = &results[i];
+	}
+
+	sr_input_workers_run(inc->workers, chunks, num_chunks);
+
+	ret = SR_OK;
+	for (i = 0; i < num_chunks && ret == SR_OK; i++) {
+		if (chunks[i].ret != SR_OK) {
+			/*
+			 * Parse the failed chunk again, now that its first
+			 * line number is known, to get proper messages.
+			 */
+			samples = g_byte_array_new();
+			ret = parse_lines(inc, chunks[i].text, samples);
+			if (send_samples(in->sdi, samples, inc->sample_buffer_size) != SR_OK)
+				sr_err("Sending samples failed.");
+			g_byte_array_free(samples, TRUE);
+			ret = SR_ERR;
+			break;
+		}
+		inc->line_number += results[i].lines;
+		ret = send_samples(in->sdi, results[i].samples,
+			inc->sample_buffer_size);
 		if (ret != SR_OK) {
 			sr_err("Sending samples failed.");
-			return SR_ERR;
+			ret = SR_ERR;
 		}
-		g_strfreev(columns);
 	}
-	g_strfreev(lines);
+
+	for (i = 0; i < num_chunks; i++)
+		g_byte_array_free(results[i].samples, TRUE);
+	g_free(results);
+	g_free(chunks);
+
+	return ret;
+}
+
+static int process_buffer(struct sr_input *in)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+	struct context *inc;
+	GByteArray *samples;
+	uint64_t samplerate;
+	int ret;
+	char *p;
+
+	inc = in->priv;
+	if (!inc->started) {
+		std_session_send_df_header(in->sdi);
+
+		if (inc->samplerate) {
+			packet.type = SR_DF_META;
+			packet.payload = &meta;
+			samplerate = inc->samplerate;
+			src = sr_config_new(SR_CONF_SAMPLERATE, g_variant_new_uint64(samplerate));
+			meta.config = g_slist_append(NULL, src);
+			sr_session_send(in->sdi, &packet);
+			g_slist_free(meta.config);
+			sr_config_free(src);
+		}
+
+		if (inc->num_threads != 1)
+			inc->workers = sr_input_workers_new(inc->num_threads,
+					parse_chunk, inc);
+
+		inc->started = TRUE;
+	}
+
+	if (!(p = g_strrstr_len(in->buf->str, in->buf->len, inc->termination)))
+		/* Don't have a full line. */
+		return SR_ERR;
+
+	*p = '\0';
+	g_strstrip(in->buf->str);
+
+	/*
+	 * The header line is looked for sequentially, which only affects
+	 * the first buffer.
+	 */
+	if (inc->workers && !inc->header) {
+		ret = parse_parallel(in, in->buf->str, strlen(in->buf->str));
+	} else {
+		samples = g_byte_array_new();
+		ret = parse_lines(inc, in->buf->str, samples);
+		/* Send sample data to the session bus. */
+		if (send_samples(in->sdi, samples, inc->sample_buffer_size) != SR_OK) {
+			sr_err("Sending samples failed.");
+			ret = SR_ERR;
+		}
+		g_byte_array_free(samples, TRUE);
+	}
 	g_string_erase(in->buf, 0, p - in->buf->str + 1);
 
 	return ret;
@@ -766,6 +905,9 @@ static void cleanup(struct sr_input *in)
 
 	g_free(inc->termination);
 	g_free(inc->sample_buffer);
+
+	sr_input_workers_free(inc->workers);
+	inc->workers = NULL;
 }
 
 static int reset(struct sr_input *in)
@@ -789,6 +931,7 @@ static struct sr_option options[] = {
 	{ "first-channel", "First channel", "Column number of first channel", NULL, NULL },
 	{ "header", "Header", "Treat first line as header with channel names", NULL, NULL },
 	{ "startline", "Start line", "Line number at which to start processing samples", NULL, NULL },
+	{ "threads", "Threads", "Number of threads to parse with (0 = one per processor)", NULL, NULL },
 	ALL_ZERO
 };
 
@@ -804,6 +947,7 @@ static const struct sr_option *get_options(void)
 		options[6].def = g_variant_ref_sink(g_variant_new_int32(0));
 		options[7].def = g_variant_ref_sink(g_variant_new_boolean(FALSE));
 		options[8].def = g_variant_ref_sink(g_variant_new_int32(1));
+		options[9].def = g_variant_ref_sink(g_variant_new_int32(1));
 	}
 
 	return options;
@@ -20,6 +20,8 @@
 #include <config.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
@@ -27,6 +29,9 @@
 
 /** @cond PRIVATE */
 #define LOG_PREFIX "input"
+
+/* Size of the chunks a mapped file is fed in to modules without mmap support. */
+#define LOAD_CHUNK_SIZE (4 * 1024 * 1024)
 /** @endcond */
 
 /**
@@ -545,6 +550,154 @@ SR_API int sr_input_send(const struct sr_input *in, GString *buf)
 	return in->module->receive((struct sr_input *)in, buf);
 }
 
+static void input_unmap(struct sr_input *in)
+{
+	if (!in->mapped)
+		return;
+
+	g_mapped_file_unref(in->mapped);
+	g_free(in->mapped_name);
+	in->mapped = NULL;
+	in->mapped_name = NULL;
+	in->mapped_pos = 0;
+}
+
+static int input_map(struct sr_input *in, const char *filename)
+{
+	GError *error;
+	int fd, flags;
+
+	/*
+	 * The file only needs to be readable. The private mapping is
+	 * writable, so that transforms can modify the data in place
+	 * without the changes reaching the file.
+	 */
+	flags = O_RDONLY;
+#ifdef O_BINARY
+	flags |= O_BINARY;
+#endif
+	if ((fd = g_open(filename, flags, 0)) < 0) {
+		sr_err("Failed to open %s: %s", filename, g_strerror(errno));
+		return SR_ERR;
+	}
+
+	error = NULL;
+	in->mapped = g_mapped_file_new_from_fd(fd, TRUE, &error);
+	close(fd);
+	if (!in->mapped) {
+		sr_err("Failed to map %s: %s", filename, error->message);
+		g_error_free(error);
+		return SR_ERR;
+	}
+	in->mapped_name = g_strdup(filename);
+	in->mapped_pos = 0;
+
+	return SR_OK;
+}
+
+/**
+ * Load the contents of a file into the specified input instance.
+ *
+ * This is an alternative to reading the file and passing it in chunks to
+ * sr_input_send(). The file is memory-mapped instead. Input modules that
+ * support it parse the data straight from the mapping and send it to the
+ * session without copying it. For all other modules the mapped data is
+ * fed through the same path as sr_input_send().
+ *
+ * Just like sr_input_send(), this returns as soon as the device instance
+ * is ready, so that the caller can set up the session. A second call with
+ * the same file name continues where the first one left off. Finally,
+ * sr_input_end() needs to be called as usual:
+ *
+ * @code
+ * sr_input_load_file(in, filename);
+ * sdi = sr_input_dev_inst_get(in);
+ * ...add sdi to the session...
+ * sr_input_load_file(in, filename);
+ * sr_input_end(in);
+ * @endcode
+ *
+ * The file stays mapped until the input instance is reset or freed.
+ *
+ * @param in The input instance to use. Must not be NULL.
+ * @param filename The file to load. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval SR_ERR The file could not be mapped.
+ * @retval other Error code returned by the input module.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_input_load_file(const struct sr_input *in, const char *filename)
+{
+	struct sr_input *inw;
+	GString *chunk;
+	char *data;
+	gsize len, used;
+	gboolean was_ready;
+	int ret;
+
+	if (!in || !filename || !filename[0]) {
+		sr_err("%s: Invalid argument.", __func__);
+		return SR_ERR_ARG;
+	}
+
+	inw = (struct sr_input *)in;
+	if (inw->mapped && strcmp(inw->mapped_name, filename) != 0)
+		input_unmap(inw);
+
+	if (!inw->mapped && (ret = input_map(inw, filename)) != SR_OK)
+		return ret;
+
+	data = g_mapped_file_get_contents(inw->mapped);
+	len = g_mapped_file_get_length(inw->mapped);
+
+	sr_spew("Loading %" G_GSIZE_FORMAT " bytes of %s into %s module.",
+		len - inw->mapped_pos, filename, in->module->id);
+
+	chunk = NULL;
+	ret = SR_OK;
+	while (inw->mapped_pos < len) {
+		was_ready = in->sdi_ready;
+		if (in->module->receive_mapped) {
+			used = 0;
+			ret = in->module->receive_mapped(inw,
+					data + inw->mapped_pos,
+					len - inw->mapped_pos, &used);
+		} else {
+			/* Same as sr_input_send(), one chunk at a time. */
+			used = MIN(LOAD_CHUNK_SIZE, len - inw->mapped_pos);
+			if (!chunk)
+				chunk = g_string_sized_new(used);
+			g_string_truncate(chunk, 0);
+			g_string_append_len(chunk, data + inw->mapped_pos, used);
+			ret = in->module->receive(inw, chunk);
+		}
+		inw->mapped_pos += MIN(used, len - inw->mapped_pos);
+		if (ret != SR_OK)
+			break;
+		/* Give the caller a chance to set up the session. */
+		if (!was_ready && in->sdi_ready)
+			break;
+		/*
+		 * Whatever is left (e.g. less than a sample) can only be
+		 * handled at the end. Keep it in the buffer, just like
+		 * receive() does, so that end() gets to see it.
+		 */
+		if (used == 0) {
+			g_string_append_len(inw->buf, data + inw->mapped_pos,
+				len - inw->mapped_pos);
+			inw->mapped_pos = len;
+			break;
+		}
+	}
+	if (chunk)
+		g_string_free(chunk, TRUE);
+
+	return ret;
+}
+
 /**
  * Signal the input module no more data will come.
  *
@@ -570,6 +723,8 @@ SR_API int sr_input_end(const struct sr_input *in)
  */
 SR_API int sr_input_reset(const struct sr_input *in)
 {
+	input_unmap((struct sr_input *)in);
+
 	if (!in->module->reset) {
 		sr_spew("Tried to reset %s module but no reset handler found.",
 			in->module->id);
@@ -594,6 +749,7 @@ SR_API void sr_input_free(const struct sr_input *in)
 		in->module->cleanup((struct sr_input *)in);
 	if (in->sdi)
 		sr_dev_inst_free(in->sdi);
+	input_unmap((struct sr_input *)in);
 	if (in->buf->len > 64) {
 		/* That seems more than just some sub-unitsize leftover... */
 		sr_warn("Found %" G_GSIZE_FORMAT
@@ -0,0 +1,231 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "input/parallel"
+/** @endcond */
+
+/* Don't bother splitting text into chunks smaller than this. */
+#define MIN_CHUNK_SIZE (64 * 1024)
+
+/**
+ * @file
+ *
+ * Helpers for parsing text input on several threads.
+ *
+ * A buffer of complete lines is cut into chunks at line boundaries. The
+ * chunks are parsed independently by a pool of worker threads, and the
+ * module then emits the results in order, reconciling whatever state
+ * carries over from one chunk to the next.
+ */
+
+struct sr_input_workers {
+	GThreadPool *pool;
+	unsigned int num_threads;
+	sr_input_chunk_func func;
+	void *cb_data;
+	GMutex mutex;
+	GCond cond;
+	unsigned int pending;
+};
+
+static void worker(gpointer data, gpointer user_data)
+{
+	struct sr_input_workers *workers;
+
+	workers = user_data;
+	workers->func(data, workers->cb_data);
+
+	g_mutex_lock(&workers->mutex);
+	if (--workers->pending == 0)
+		g_cond_signal(&workers->cond);
+	g_mutex_unlock(&workers->mutex);
+}
+
+/**
+ * Create a pool of worker threads for parsing text chunks.
+ *
+ * @param num_threads The number of threads to use, or 0 to use one
+ *                    thread per processor.
+ * @param func The function parsing one chunk. Must be thread-safe.
+ * @param cb_data Opaque pointer passed to @a func.
+ *
+ * @return The new pool, or NULL if only one thread would be used. In
+ *         that case the caller should parse sequentially.
+ *
+ * @private
+ */
+SR_PRIV struct sr_input_workers *sr_input_workers_new(unsigned int num_threads,
+		sr_input_chunk_func func, void *cb_data)
+{
+	struct sr_input_workers *workers;
+	GError *error;
+
+	if (num_threads == 0) {
+#if GLIB_CHECK_VERSION(2, 36, 0)
+		num_threads = g_get_num_processors();
+#else
+		num_threads = 1;
+#endif
+	}
+	if (num_threads <= 1)
+		return NULL;
+
+	workers = g_malloc0(sizeof(struct sr_input_workers));
+	workers->num_threads = num_threads;
+	workers->func = func;
+	workers->cb_data = cb_data;
+	g_mutex_init(&workers->mutex);
+	g_cond_init(&workers->cond);
+
+	error = NULL;
+	workers->pool = g_thread_pool_new(worker, workers, num_threads,
+			FALSE, &error);
+	if (!workers->pool) {
+		sr_warn("Failed to create worker threads: %s", error->message);
+		g_error_free(error);
+		g_mutex_clear(&workers->mutex);
+		g_cond_clear(&workers->cond);
+		g_free(workers);
+		return NULL;
+	}
+	sr_dbg("Parsing with %u threads.", num_threads);
+
+	return workers;
+}
+
+/**
+ * Destroy a pool of worker threads.
+ *
+ * @param workers The pool to destroy. May be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_input_workers_free(struct sr_input_workers *workers)
+{
+	if (!workers)
+		return;
+
+	g_thread_pool_free(workers->pool, FALSE, TRUE);
+	g_mutex_clear(&workers->mutex);
+	g_cond_clear(&workers->cond);
+	g_free(workers);
+}
+
+/**
+ * Cut a buffer of complete lines into chunks for parallel parsing.
+ *
+ * The buffer is cut after a newline character, which is replaced with
+ * a NUL character, so each chunk is a NUL-terminated string. No more
+ * chunks are created than the pool has threads, and none of them is
+ * made smaller than a minimum size.
+ *
+ * @param workers The pool the chunks will be parsed with. May be NULL,
+ *                in which case a single chunk is returned.
+ * @param text The text to split. Must be NUL-terminated.
+ * @param len The length of the text.
+ * @param line_start If not NULL, only cut before lines starting with
+ *                   this string.
+ * @param num_chunks Pointer which will be set to the number of chunks.
+ *
+ * @return Newly allocated array of chunks, to be freed with g_free().
+ *
+ * @private
+ */
+SR_PRIV struct sr_input_chunk *sr_input_split_lines(
+		const struct sr_input_workers *workers, char *text, gsize len,
+		const char *line_start, unsigned int *num_chunks)
+{
+	struct sr_input_chunk *chunks;
+	unsigned int max_chunks, n;
+	gsize pos, next, start_len;
+	char *p;
+
+	start_len = line_start ? strlen(line_start) : 0;
+
+	max_chunks = workers ? workers->num_threads : 1;
+	max_chunks = MAX(1, MIN(max_chunks, len / MIN_CHUNK_SIZE));
+	chunks = g_malloc0(max_chunks * sizeof(struct sr_input_chunk));
+
+	pos = 0;
+	for (n = 0; n < max_chunks && pos < len; n++) {
+		chunks[n].text = text + pos;
+		next = pos + (len - pos) / (max_chunks - n);
+		p = NULL;
+		if (n < max_chunks - 1 && next < len)
+			p = memchr(text + next, '\n', len - next);
+		while (p && start_len && strncmp(p + 1, line_start, start_len)) {
+			next = p - text + 1;
+			p = next < len ? memchr(text + next, '\n', len - next) : NULL;
+		}
+		if (!p) {
+			/* Last chunk, takes the rest. */
+			chunks[n].len = len - pos;
+			pos = len;
+			continue;
+		}
+		*p = '\0';
+		chunks[n].len = p - chunks[n].text;
+		pos = p - text + 1;
+	}
+	if (n == 0) {
+		/* Empty text still makes one (empty) chunk. */
+		chunks[0].text = text;
+		n = 1;
+	}
+	*num_chunks = n;
+
+	return chunks;
+}
+
+/**
+ * Parse chunks of text, using a pool of worker threads.
+ *
+ * Returns when all chunks have been parsed. The parse function stores
+ * its status and results in each chunk.
+ *
+ * @param workers The pool to use. Must not be NULL.
+ * @param chunks The chunks to parse.
+ * @param num_chunks The number of chunks.
+ *
+ * @private
+ */
+SR_PRIV void sr_input_workers_run(struct sr_input_workers *workers,
+		struct sr_input_chunk *chunks, unsigned int num_chunks)
+{
+	unsigned int i;
+
+	g_mutex_lock(&workers->mutex);
+	workers->pending = num_chunks;
+	g_mutex_unlock(&workers->mutex);
+
+	for (i = 0; i < num_chunks; i++)
+		g_thread_pool_push(workers->pool, &chunks[i], NULL);
+
+	g_mutex_lock(&workers->mutex);
+	while (workers->pending > 0)
+		g_cond_wait(&workers->cond, &workers->mutex);
+	g_mutex_unlock(&workers->mutex);
+}
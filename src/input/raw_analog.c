@@ -141,13 +141,13 @@ static int init(struct sr_input *in, GHashTable *options)
 	return SR_OK;
 }
 
-static int process_buffer(struct sr_input *in)
+static gsize process_data(struct sr_input *in, char *data, gsize len)
 {
 	struct context *inc;
 	struct sr_datafeed_meta meta;
 	struct sr_datafeed_packet packet;
 	struct sr_config *src;
-	unsigned int offset, chunk_size;
+	gsize offset, chunk_size;
 
 	inc = in->priv;
 	if (!inc->started) {
@@ -171,21 +171,30 @@ static int process_buffer(struct sr_input *in)
 	chunk_size = inc->analog.num_samples * inc->samplesize;
 	offset = 0;
 
-	while ((offset + chunk_size) < in->buf->len) {
-		inc->analog.data = in->buf->str + offset;
+	while ((offset + chunk_size) < len) {
+		inc->analog.data = data + offset;
 		sr_session_send(in->sdi, &inc->packet);
 		offset += chunk_size;
 	}
 
-	inc->analog.num_samples = (in->buf->len - offset) / inc->samplesize;
+	inc->analog.num_samples = (len - offset) / inc->samplesize;
 	chunk_size = inc->analog.num_samples * inc->samplesize;
 	if (chunk_size > 0) {
-		inc->analog.data = in->buf->str + offset;
+		inc->analog.data = data + offset;
 		sr_session_send(in->sdi, &inc->packet);
 		offset += chunk_size;
 	}
 
-	if ((unsigned int)offset < in->buf->len) {
+	return offset;
+}
+
+static int process_buffer(struct sr_input *in)
+{
+	gsize offset;
+
+	offset = process_data(in, in->buf->str, in->buf->len);
+
+	if (offset < in->buf->len) {
 		/*
 		 * The incoming buffer wasn't processed completely. Stash
 		 * the leftover data for next time.
@@ -215,6 +224,21 @@ static int receive(struct sr_input *in, GString *buf)
 	return ret;
 }
 
+static int receive_mapped(struct sr_input *in, char *data, gsize len,
+		gsize *consumed)
+{
+	if (!in->sdi_ready) {
+		/* sdi is ready, notify frontend. */
+		in->sdi_ready = TRUE;
+		return SR_OK;
+	}
+
+	/* The samples are sent straight from the mapping. */
+	*consumed = process_data(in, data, len);
+
+	return SR_OK;
+}
+
 static int end(struct sr_input *in)
 {
 	struct context *inc;
@@ -224,6 +248,9 @@ static int end(struct sr_input *in)
 		ret = process_buffer(in);
 	else
 		ret = SR_OK;
+	if (in->sdi_ready && in->buf->len > 0)
+		sr_warn("Ignoring %" G_GSIZE_FORMAT " trailing bytes, less than a sample.",
+			in->buf->len);
 
 	inc = in->priv;
 	if (inc->started)
@@ -286,6 +313,7 @@ SR_PRIV struct sr_input_module input_raw_analog = {
 	.options = get_options,
 	.init = init,
 	.receive = receive,
+	.receive_mapped = receive_mapped,
 	.end = end,
 	.cleanup = cleanup,
 	.reset = reset,
@@ -42,6 +42,12 @@
  *              This can speed up analyzing of long captures.
  *              Default 0 = don't compress.
  *
+ * threads:     Number of threads to parse large inputs with. The data
+ *              section is cut into chunks before timestamp lines, which
+ *              are tokenized in parallel. The resulting value changes
+ *              are then applied in order. 0 uses one thread per
+ *              processor. Default 1 = no parallel parsing.
+ *
  * Based on Verilog standard IEEE Std 1364-2001 Version C
  *
  * Supported features:
@@ -79,7 +85,11 @@ struct context {
 	unsigned compress;
 	int64_t skip;
 	gboolean skip_until_end;
+	uint64_t prev_timestamp;
 	GSList *channels;
+	GHashTable *channel_ids;
+	unsigned int num_threads;
+	struct sr_input_workers *workers;
 	size_t bytes_per_sample;
 	size_t samples_in_buffer;
 	uint8_t *buffer;
@@ -91,6 +101,28 @@ struct vcd_channel {
 	gchar *identifier;
 };
 
+enum event_type {
+	EVENT_TIMESTAMP,
+	EVENT_LEVEL,
+	EVENT_SECTION,
+	EVENT_END,
+	EVENT_UNKNOWN_TOKEN,
+	EVENT_UNKNOWN_ID,
+	EVENT_MESSAGE,
+};
+
+/*
+ * An item of the data section. Chunks of the data section are parsed
+ * into lists of events independently, then the events are applied in
+ * order, since they depend on the state left over by previous chunks.
+ */
+struct vcd_event {
+	int type;
+	unsigned int channel;
+	uint64_t value;
+	const char *token;
+};
+
 /*
  * Reads a single VCD section from input file and parses it to name/contents.
  * e.g. $timescale 1ps $end => "timescale" "1ps"
@@ -181,6 +213,8 @@ static gboolean parse_header(const struct sr_input *in, GString *buf)
 	struct context *inc;
 	gboolean status;
 	gchar *name, *contents, **parts;
+	GSList *l;
+	unsigned int i;
 
 	inc = in->priv;
 	name = contents = NULL;
@@ -259,6 +293,15 @@ static gboolean parse_header(const struct sr_input *in, GString *buf)
 	inc->bytes_per_sample = (inc->channelcount + 7) / 8;
 	inc->current_levels = g_malloc0(inc->bytes_per_sample);
 
+	/* Map identifiers to channel indices, the first channel wins. */
+	inc->channel_ids = g_hash_table_new(g_str_hash, g_str_equal);
+	for (i = 0, l = inc->channels; l; i++, l = l->next) {
+		vcd_ch = l->data;
+		if (!g_hash_table_lookup(inc->channel_ids, vcd_ch->identifier))
+			g_hash_table_insert(inc->channel_ids, vcd_ch->identifier,
+					GUINT_TO_POINTER(i + 1));
+	}
+
 	inc->got_header = status;
 
 	return status;
@@ -339,145 +382,241 @@ static void add_samples(const struct sr_input *in, size_t count)
 	}
 }
 
-/* Set the channel level depending on the identifier and parsed value. */
-static void process_bit(struct context *inc, char *identifier, unsigned int bit)
+/* Cut the next whitespace delimited token from the text, in place. */
+static char *next_token(char **text)
 {
-	GSList *l;
-	struct vcd_channel *vcd_ch;
-	unsigned int j;
+	char *p, *token;
+
+	p = *text;
+	while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+		p++;
+	if (*p == '\0') {
+		*text = p;
+		return NULL;
+	}
 
-	for (j = 0, l = inc->channels; j < inc->channelcount && l; j++, l = l->next) {
-		vcd_ch = l->data;
-		if (g_strcmp0(identifier, vcd_ch->identifier) == 0) {
-			/* Found our channel. */
-			size_t byte_idx = (j / 8);
-			size_t bit_idx = j - 8 * byte_idx;
-			if (bit)
-				inc->current_levels[byte_idx] |= (uint8_t)1 << bit_idx;
-			else
-				inc->current_levels[byte_idx] &= ~((uint8_t)1 << bit_idx);
-			break;
-		}
+	token = p;
+	while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+		p++;
+	if (*p)
+		*p++ = '\0';
+	*text = p;
+
+	return token;
+}
+
+/* Look up the channel for an identifier. */
+static void level_event(const struct context *inc, const char *identifier,
+		unsigned int bit, struct vcd_event *ev)
+{
+	gpointer idx;
+
+	if ((idx = g_hash_table_lookup(inc->channel_ids, identifier))) {
+		ev->type = EVENT_LEVEL;
+		ev->channel = GPOINTER_TO_UINT(idx) - 1;
+		ev->value = bit;
+	} else {
+		ev->type = EVENT_UNKNOWN_ID;
+		ev->token = identifier;
 	}
-	if (j == inc->channelcount)
-		sr_dbg("Did not find channel for identifier '%s'.", identifier);
 }
 
-/* Parse a set of lines from the data section. */
-static void parse_contents(const struct sr_input *in, char *data)
+/*
+ * Parse a chunk of lines from the data section into a list of events.
+ * This doesn't touch the context, and may run on a worker thread.
+ */
+static void parse_chunk(struct sr_input_chunk *chunk, void *cb_data)
 {
-	struct context *inc;
-	uint64_t timestamp, prev_timestamp;
-	unsigned int bit, i;
-	char **tokens;
+	const struct context *inc;
+	struct vcd_event ev;
+	GArray *events;
+	unsigned int bit;
+	char *text, *token, *identifier;
 
-	inc = in->priv;
-	prev_timestamp = 0;
+	inc = cb_data;
+	events = g_array_new(FALSE, FALSE, sizeof(struct vcd_event));
 
 	/* Read one space-delimited token at a time. */
-	tokens = g_strsplit_set(data, " \t\r\n", 0);
-	remove_empty_parts(tokens);
-	for (i = 0; tokens[i]; i++) {
-		if (inc->skip_until_end) {
-			if (!strcmp(tokens[i], "$end")) {
-				/* Done with unhandled/unknown section. */
-				inc->skip_until_end = FALSE;
-				break;
-			}
-		}
-		if (tokens[i][0] == '#' && g_ascii_isdigit(tokens[i][1])) {
+	text = chunk->text;
+	while ((token = next_token(&text))) {
+		ev.type = EVENT_MESSAGE;
+		ev.channel = 0;
+		ev.value = 0;
+		ev.token = NULL;
+
+		if (token[0] == '#' && g_ascii_isdigit(token[1])) {
 			/* Numeric value beginning with # is a new timestamp value */
-			timestamp = strtoull(tokens[i] + 1, NULL, 10);
-
-			if (inc->downsample > 1)
-				timestamp /= inc->downsample;
-
-			/*
-			 * Skip < 0 => skip until first timestamp.
-			 * Skip = 0 => don't skip
-			 * Skip > 0 => skip until timestamp >= skip.
-			 */
-			if (inc->skip < 0) {
-				inc->skip = timestamp;
-				prev_timestamp = timestamp;
-			} else if (inc->skip > 0 && timestamp < (uint64_t)inc->skip) {
-				prev_timestamp = inc->skip;
-			} else if (timestamp == prev_timestamp) {
-				/* Ignore repeated timestamps (e.g. sigrok outputs these) */
-			} else {
-				if (inc->compress != 0 && timestamp - prev_timestamp > inc->compress) {
-					/* Compress long idle periods */
-					prev_timestamp = timestamp - inc->compress;
-				}
-
-				sr_dbg("New timestamp: %" PRIu64, timestamp);
-
-				/* Generate samples from prev_timestamp up to timestamp - 1. */
-				add_samples(in, timestamp - prev_timestamp);
-				prev_timestamp = timestamp;
-			}
-		} else if (tokens[i][0] == '$' && tokens[i][1] != '\0') {
+			ev.type = EVENT_TIMESTAMP;
+			ev.value = strtoull(token + 1, NULL, 10);
+		} else if (token[0] == '$' && token[1] != '\0') {
 			/*
 			 * This is probably a $dumpvars, $comment or similar.
 			 * $dump* contain useful data.
 			 */
-			if (g_strcmp0(tokens[i], "$dumpvars") == 0
-					|| g_strcmp0(tokens[i], "$dumpon") == 0
-					|| g_strcmp0(tokens[i], "$dumpoff") == 0
-					|| g_strcmp0(tokens[i], "$end") == 0) {
+			if (g_strcmp0(token, "$dumpvars") == 0
+					|| g_strcmp0(token, "$dumpon") == 0
+					|| g_strcmp0(token, "$dumpoff") == 0) {
 				/* Ignore, parse contents as normally. */
+				continue;
+			} else if (g_strcmp0(token, "$end") == 0) {
+				ev.type = EVENT_END;
 			} else {
-				/* Ignore this and future lines until $end. */
-				inc->skip_until_end = TRUE;
-				break;
+				/* Ignore this and future tokens until $end. */
+				ev.type = EVENT_SECTION;
 			}
-		} else if (strchr("rR", tokens[i][0]) != NULL) {
-			sr_dbg("Real type vector values not supported yet!");
-			if (!tokens[++i])
-				/* No tokens left, bail out */
-				break;
-			else
-				/* Process next token */
-				continue;
-		} else if (strchr("bB", tokens[i][0]) != NULL) {
-			bit = (tokens[i][1] == '1');
+		} else if (strchr("rR", token[0]) != NULL) {
+			ev.token = "Real type vector values not supported yet!";
+			/* Skip the identifier. */
+			next_token(&text);
+		} else if (strchr("bB", token[0]) != NULL) {
+			bit = (token[1] == '1');
 
 			/*
 			 * Bail out if a) char after 'b' is NUL, or b) there is
 			 * a second character after 'b', or c) there is no
 			 * identifier.
 			 */
-			if (!tokens[i][1] || tokens[i][2] || !tokens[++i]) {
-				sr_dbg("Unexpected vector format!");
-				break;
-			}
-
-			process_bit(inc, tokens[i], bit);
-		} else if (strchr("01xXzZ", tokens[i][0]) != NULL) {
-			char *identifier;
-
+			if (!token[1] || token[2] || !(identifier = next_token(&text)))
+				ev.token = "Unexpected vector format!";
+			else
+				level_event(inc, identifier, bit, &ev);
+		} else if (strchr("01xXzZ", token[0]) != NULL) {
 			/* A new 1-bit sample value */
-			bit = (tokens[i][0] == '1');
+			bit = (token[0] == '1');
 
 			/*
 			 * The identifier is either the next character, or, if
 			 * there was whitespace after the bit, the next token.
 			 */
-			if (tokens[i][1] == '\0') {
-				if (!tokens[++i]) {
-					sr_dbg("Identifier missing!");
-					break;
-				}
-				identifier = tokens[i];
-			} else {
-				identifier = tokens[i] + 1;
-			}
-			process_bit(inc, identifier, bit);
+			if (token[1] != '\0')
+				identifier = token + 1;
+			else
+				identifier = next_token(&text);
+			if (identifier)
+				level_event(inc, identifier, bit, &ev);
+			else
+				ev.token = "Identifier missing!";
 		} else {
-			sr_warn("Skipping unknown token '%s'.", tokens[i]);
+			ev.type = EVENT_UNKNOWN_TOKEN;
+			ev.token = token;
 		}
+		g_array_append_val(events, ev);
 	}
-	g_strfreev(tokens);
+
+	chunk->result = events;
+	chunk->ret = SR_OK;
+}
+
+static void process_timestamp(const struct sr_input *in, uint64_t timestamp)
+{
+	struct context *inc;
+
+	inc = in->priv;
+
+	if (inc->downsample > 1)
+		timestamp /= inc->downsample;
+
+	/*
+	 * Skip < 0 => skip until first timestamp.
+	 * Skip = 0 => don't skip
+	 * Skip > 0 => skip until timestamp >= skip.
+	 */
+	if (inc->skip < 0) {
+		inc->skip = timestamp;
+		inc->prev_timestamp = timestamp;
+	} else if (inc->skip > 0 && timestamp < (uint64_t)inc->skip) {
+		inc->prev_timestamp = inc->skip;
+	} else if (timestamp == inc->prev_timestamp) {
+		/* Ignore repeated timestamps (e.g. sigrok outputs these) */
+	} else {
+		if (inc->compress != 0 && timestamp - inc->prev_timestamp > inc->compress) {
+			/* Compress long idle periods */
+			inc->prev_timestamp = timestamp - inc->compress;
+		}
+
+		sr_dbg("New timestamp: %" PRIu64, timestamp);
+
+		/* Generate samples from prev_timestamp up to timestamp - 1. */
+		add_samples(in, timestamp - inc->prev_timestamp);
+		inc->prev_timestamp = timestamp;
+	}
+}
+
+/* Apply the events parsed from a chunk, in order. */
+static void apply_events(const struct sr_input *in, const GArray *events)
+{
+	struct context *inc;
+	const struct vcd_event *ev;
+	size_t byte_idx, bit_idx;
+	guint i;
+
+	inc = in->priv;
+
+	for (i = 0; i < events->len; i++) {
+		ev = &g_array_index(events, struct vcd_event, i);
+
+		if (inc->skip_until_end) {
+			/* Done with unhandled/unknown section? */
+			if (ev->type == EVENT_END)
+				inc->skip_until_end = FALSE;
+			continue;
+		}
+
+		switch (ev->type) {
+		case EVENT_TIMESTAMP:
+			process_timestamp(in, ev->value);
+			break;
+		case EVENT_LEVEL:
+			byte_idx = ev->channel / 8;
+			bit_idx = ev->channel % 8;
+			if (ev->value)
+				inc->current_levels[byte_idx] |= (uint8_t)1 << bit_idx;
+			else
+				inc->current_levels[byte_idx] &= ~((uint8_t)1 << bit_idx);
+			break;
+		case EVENT_SECTION:
+			inc->skip_until_end = TRUE;
+			break;
+		case EVENT_UNKNOWN_TOKEN:
+			sr_warn("Skipping unknown token '%s'.", ev->token);
+			break;
+		case EVENT_UNKNOWN_ID:
+			sr_dbg("Did not find channel for identifier '%s'.", ev->token);
+			break;
+		case EVENT_MESSAGE:
+			sr_dbg("%s", ev->token);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/* Parse a set of lines from the data section. */
+static void parse_contents(const struct sr_input *in, char *data, gsize len)
+{
+	struct context *inc;
+	struct sr_input_chunk *chunks;
+	unsigned int num_chunks, i;
+
+	inc = in->priv;
+
+	/*
+	 * Chunks are only cut before timestamps, so that no value change
+	 * is torn apart from its identifier.
+	 */
+	chunks = sr_input_split_lines(inc->workers, data, len, "#",
+			&num_chunks);
+	if (inc->workers)
+		sr_input_workers_run(inc->workers, chunks, num_chunks);
+	else
+		parse_chunk(&chunks[0], inc);
+
+	for (i = 0; i < num_chunks; i++) {
+		apply_events(in, chunks[i].result);
+		g_array_free(chunks[i].result, TRUE);
+	}
+	g_free(chunks);
 }
 
 static int init(struct sr_input *in, GHashTable *options)
@@ -494,6 +633,7 @@ static int init(struct sr_input *in, GHashTable *options)
 	inc->compress = g_variant_get_int32(g_hash_table_lookup(options, "compress"));
 	inc->skip = g_variant_get_int32(g_hash_table_lookup(options, "skip"));
 	inc->skip /= inc->downsample;
+	inc->num_threads = MAX(g_variant_get_int32(g_hash_table_lookup(options, "threads")), 0);
 
 	in->sdi = g_malloc0(sizeof(struct sr_dev_inst));
 	in->priv = inc;
@@ -541,14 +681,16 @@ static int process_buffer(struct sr_input *in)
 		g_slist_free(meta.config);
 		sr_config_free(src);
 
+		if (inc->num_threads != 1)
+			inc->workers = sr_input_workers_new(inc->num_threads,
+					parse_chunk, inc);
+
 		inc->started = TRUE;
 	}
 
-	while ((p = g_strrstr_len(in->buf->str, in->buf->len, "\n"))) {
+	if ((p = g_strrstr_len(in->buf->str, in->buf->len, "\n"))) {
 		*p = '\0';
-		g_strstrip(in->buf->str);
-		if (in->buf->str[0] != '\0')
-			parse_contents(in, in->buf->str);
+		parse_contents(in, in->buf->str, p - in->buf->str);
 		g_string_erase(in->buf, 0, p - in->buf->str + 1);
 	}
 
@@ -606,7 +748,13 @@ static void cleanup(struct sr_input *in)
 	struct context *inc;
 
 	inc = in->priv;
+	sr_input_workers_free(inc->workers);
+	inc->workers = NULL;
+	if (inc->channel_ids)
+		g_hash_table_destroy(inc->channel_ids);
+	inc->channel_ids = NULL;
 	g_slist_free_full(inc->channels, free_channel);
+	inc->channels = NULL;
 	g_free(inc->buffer);
 	inc->buffer = NULL;
 	g_free(inc->current_levels);
@@ -629,6 +777,7 @@ static struct sr_option options[] = {
 	{ "skip", "Skip", "Skip until timestamp", NULL, NULL },
 	{ "downsample", "Downsample", "Divide samplerate by factor", NULL, NULL },
 	{ "compress", "Compress", "Compress idle periods longer than this value", NULL, NULL },
+	{ "threads", "Threads", "Number of threads to parse with (0 = one per processor)", NULL, NULL },
 	ALL_ZERO
 };
 
@@ -639,6 +788,7 @@ static const struct sr_option *get_options(void)
 		options[1].def = g_variant_ref_sink(g_variant_new_int32(-1));
 		options[2].def = g_variant_ref_sink(g_variant_new_int32(1));
 		options[3].def = g_variant_ref_sink(g_variant_new_int32(0));
+		options[4].def = g_variant_ref_sink(g_variant_new_int32(1));
 	}
 
 	return options;
@@ -53,19 +53,20 @@ struct context {
 	gboolean found_data;
 };
 
-static int parse_wav_header(GString *buf, struct context *inc)
+static int parse_wav_header(const char *buf, gsize len,
+		struct context *inc)
 {
 	uint64_t samplerate;
 	unsigned int fmt_code, samplesize, num_channels, unitsize;
 
-	if (buf->len < MIN_DATA_CHUNK_OFFSET)
+	if (len < MIN_DATA_CHUNK_OFFSET)
 		return SR_ERR_NA;
 
-	fmt_code = RL16(buf->str + 20);
-	samplerate = RL32(buf->str + 24);
+	fmt_code = RL16(buf + 20);
+	samplerate = RL32(buf + 24);
 
-	samplesize = RL16(buf->str + 32);
-	num_channels = RL16(buf->str + 22);
+	samplesize = RL16(buf + 32);
+	num_channels = RL16(buf + 22);
 	if (num_channels == 0)
 		return SR_ERR;
 	unitsize = samplesize / num_channels;
@@ -81,24 +82,24 @@ static int parse_wav_header(GString *buf, struct context *inc)
 			return SR_ERR_DATA;
 		}
 	} else if (fmt_code == WAVE_FORMAT_EXTENSIBLE_) {
-		if (buf->len < 70)
+		if (len < 70)
 			/* Not enough for extensible header and next chunk. */
 			return SR_ERR_NA;
 
-		if (RL16(buf->str + 16) != 40) {
+		if (RL16(buf + 16) != 40) {
 			sr_err("WAV extensible format chunk must be 40 bytes.");
 			return SR_ERR;
 		}
-		if (RL16(buf->str + 36) != 22) {
+		if (RL16(buf + 36) != 22) {
 			sr_err("WAV extension must be 22 bytes.");
 			return SR_ERR;
 		}
-		if (RL16(buf->str + 34) != RL16(buf->str + 38)) {
+		if (RL16(buf + 34) != RL16(buf + 38)) {
 			sr_err("Reduced valid bits per sample not supported.");
 			return SR_ERR_DATA;
 		}
 		/* Real format code is the first two bytes of the GUID. */
-		fmt_code = RL16(buf->str + 44);
+		fmt_code = RL16(buf + 44);
 		if (fmt_code != WAVE_FORMAT_PCM_ && fmt_code != WAVE_FORMAT_IEEE_FLOAT_) {
 			sr_err("Only PCM and floating point samples are supported.");
 			return SR_ERR_DATA;
@@ -140,7 +141,7 @@ static int format_match(GHashTable *metadata)
 	 * Only gets called when we already know this is a WAV file, so
 	 * this parser can log error messages.
 	 */
-	if ((ret = parse_wav_header(buf, NULL)) != SR_OK)
+	if ((ret = parse_wav_header(buf->str, buf->len, NULL)) != SR_OK)
 		return ret;
 
 	return SR_OK;
@@ -156,23 +157,24 @@ static int init(struct sr_input *in, GHashTable *options)
 	return SR_OK;
 }
 
-static int find_data_chunk(GString *buf, int initial_offset)
+static int find_data_chunk(const char *buf, gsize len,
+		int initial_offset)
 {
 	unsigned int offset, i;
 
 	offset = initial_offset;
-	while (offset < MIN(MAX_DATA_CHUNK_OFFSET, buf->len)) {
-		if (!memcmp(buf->str + offset, "data", 4))
+	while (offset < MIN(MAX_DATA_CHUNK_OFFSET, len)) {
+		if (!memcmp(buf + offset, "data", 4))
 			/* Skip into the samples. */
 			return offset + 8;
 		for (i = 0; i < 4; i++) {
-			if (!isalnum(buf->str[offset + i])
-					&& !isblank(buf->str[offset + i]))
+			if (!isalnum(buf[offset + i])
+					&& !isblank(buf[offset + i]))
 				/* Doesn't look like a chunk ID. */
 				return -1;
 		}
 		/* Skip past this chunk. */
-		offset += 8 + RL32(buf->str + offset + 4);
+		offset += 8 + RL32(buf + offset + 4);
 	}
 
 	if (offset > MAX_DATA_CHUNK_OFFSET)
@@ -181,7 +183,8 @@ static int find_data_chunk(GString *buf, int initial_offset)
 	return offset;
 }
 
-static void send_chunk(const struct sr_input *in, int offset, int num_samples)
+static void send_chunk(const struct sr_input *in, const char *data,
+		int num_samples)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_analog analog;
@@ -191,11 +194,12 @@ static void send_chunk(const struct sr_input *in, int offset, int num_samples)
 	struct context *inc;
 	float fdata[CHUNK_SIZE];
 	int total_samples, samplenum;
-	char *s, *d;
+	const char *s;
+	char *d;
 
 	inc = in->priv;
 
-	s = in->buf->str + offset;
+	s = data;
 	d = (char *)fdata;
 	memset(fdata, 0, CHUNK_SIZE);
 	total_samples = num_samples * inc->num_channels;
@@ -240,7 +244,8 @@ static void send_chunk(const struct sr_input *in, int offset, int num_samples)
 	sr_session_send(in->sdi, &packet);
 }
 
-static int process_buffer(struct sr_input *in)
+static int process_data(struct sr_input *in, const char *data, gsize len,
+		gsize *consumed)
 {
 	struct context *inc;
 	struct sr_datafeed_packet packet;
@@ -266,10 +271,10 @@ static int process_buffer(struct sr_input *in)
 
 	if (!inc->found_data) {
 		/* Skip past size of 'fmt ' chunk. */
-		i = 20 + RL32(in->buf->str + 16);
-		offset = find_data_chunk(in->buf, i);
+		i = 20 + RL32(data + 16);
+		offset = find_data_chunk(data, len, i);
 		if (offset < 0) {
-			if (in->buf->len > MAX_DATA_CHUNK_OFFSET) {
+			if (len > MAX_DATA_CHUNK_OFFSET) {
 				sr_err("Couldn't find data chunk.");
 				return SR_ERR;
 			}
@@ -279,7 +284,7 @@ static int process_buffer(struct sr_input *in)
 		offset = 0;
 
 	/* Round off up to the last channels * unitsize boundary. */
-	chunk_samples = (in->buf->len - offset) / inc->samplesize;
+	chunk_samples = (len - offset) / inc->samplesize;
 	max_chunk_samples = CHUNK_SIZE / inc->samplesize;
 	processed = 0;
 	total_samples = chunk_samples;
@@ -288,13 +293,26 @@ static int process_buffer(struct sr_input *in)
 			num_samples = max_chunk_samples;
 		else
 			num_samples = chunk_samples;
-		send_chunk(in, offset, num_samples);
+		send_chunk(in, data + offset, num_samples);
 		offset += num_samples * inc->samplesize;
 		chunk_samples -= num_samples;
 		processed += num_samples;
 	}
 
-	if ((unsigned int)offset < in->buf->len) {
+	*consumed = offset;
+
+	return SR_OK;
+}
+
+static int process_buffer(struct sr_input *in)
+{
+	gsize offset;
+	int ret;
+
+	offset = 0;
+	ret = process_data(in, in->buf->str, in->buf->len, &offset);
+
+	if (offset < in->buf->len) {
 		/*
 		 * The incoming buffer wasn't processed completely. Stash
 		 * the leftover data for next time.
@@ -303,15 +321,38 @@ static int process_buffer(struct sr_input *in)
 	} else
 		g_string_truncate(in->buf, 0);
 
-	return SR_OK;
+	return ret;
 }
 
-static int receive(struct sr_input *in, GString *buf)
+/* Parse the header and create the channels, once there's enough data. */
+static int setup_channels(struct sr_input *in, const char *data, gsize len)
 {
 	struct context *inc;
 	int ret;
 	char channelname[8];
 
+	inc = in->priv;
+	if ((ret = parse_wav_header(data, len, inc)) == SR_ERR_NA)
+		/* Not enough data yet. */
+		return SR_OK;
+	else if (ret != SR_OK)
+		return ret;
+
+	for (int i = 0; i < inc->num_channels; i++) {
+		snprintf(channelname, 8, "CH%d", i + 1);
+		sr_channel_new(in->sdi, i, SR_CHANNEL_ANALOG, TRUE, channelname);
+	}
+
+	/* sdi is ready, notify frontend. */
+	in->sdi_ready = TRUE;
+
+	return SR_OK;
+}
+
+static int receive(struct sr_input *in, GString *buf)
+{
+	int ret;
+
 	g_string_append_len(in->buf, buf->str, buf->len);
 
 	if (in->buf->len < MIN_DATA_CHUNK_OFFSET) {
@@ -322,29 +363,25 @@ static int receive(struct sr_input *in, GString *buf)
 		return SR_OK;
 	}
 
-	inc = in->priv;
-	if (!in->sdi_ready) {
-		if ((ret = parse_wav_header(in->buf, inc)) == SR_ERR_NA)
-			/* Not enough data yet. */
-			return SR_OK;
-		else if (ret != SR_OK)
-			return ret;
-
-		for (int i = 0; i < inc->num_channels; i++) {
-			snprintf(channelname, 8, "CH%d", i + 1);
-			sr_channel_new(in->sdi, i, SR_CHANNEL_ANALOG, TRUE, channelname);
-		}
-
-		/* sdi is ready, notify frontend. */
-		in->sdi_ready = TRUE;
-		return SR_OK;
-	}
+	if (!in->sdi_ready)
+		return setup_channels(in, in->buf->str, in->buf->len);
 
 	ret = process_buffer(in);
 
 	return ret;
 }
 
+static int receive_mapped(struct sr_input *in, char *data, gsize len,
+		gsize *consumed)
+{
+	/* The whole file is available, no need to wait for more data. */
+	if (!in->sdi_ready)
+		return setup_channels(in, data, len);
+
+	/* Samples are converted straight from the mapping. */
+	return process_data(in, data, len, consumed);
+}
+
 static int end(struct sr_input *in)
 {
 	struct context *inc;
@@ -354,6 +391,9 @@ static int end(struct sr_input *in)
 		ret = process_buffer(in);
 	else
 		ret = SR_OK;
+	if (in->sdi_ready && in->buf->len > 0)
+		sr_warn("Ignoring %" G_GSIZE_FORMAT " trailing bytes, less than a sample.",
+			in->buf->len);
 
 	inc = in->priv;
 	if (inc->started)
@@ -381,6 +421,7 @@ SR_PRIV struct sr_input_module input_wav = {
 	.format_match = format_match,
 	.init = init,
 	.receive = receive,
+	.receive_mapped = receive_mapped,
 	.end = end,
 	.reset = reset,
 };
@@ -63,14 +63,21 @@ static int dev_buffer_fill_serial(struct dev_buffer *dbuf,
 
 	serial = sdi->conn;
 
-	/* If we already have data, move it to the beginning of the buffer. */
-	if (dbuf->len > 0 && dbuf->offset > 0)
+	/*
+	 * Only move the data we already have to the beginning of the buffer
+	 * when there's no space left after it. Packets are searched for in
+	 * place, so the data stays contiguous.
+	 */
+	if (dbuf->len == 0) {
+		dbuf->offset = 0;
+	} else if (dbuf->offset + dbuf->len == dbuf->size) {
 		memmove(dbuf->data, dbuf->data + dbuf->offset, dbuf->len);
+		dbuf->offset = 0;
+	}
 
-	dbuf->offset = 0;
-
-	len = dbuf->size - dbuf->len;
-	len = serial_read_nonblocking(serial, dbuf->data + dbuf->len, len);
+	len = dbuf->size - dbuf->offset - dbuf->len;
+	len = serial_read_nonblocking(serial,
+			dbuf->data + dbuf->offset + dbuf->len, len);
 	if (len < 0) {
 		sr_err("Serial port read error: %d.", len);
 		return len;
@@ -81,24 +88,21 @@ static int dev_buffer_fill_serial(struct dev_buffer *dbuf,
 	return SR_OK;
 }
 
-static uint8_t *dev_buffer_packet_find(struct dev_buffer *dbuf,
+static const uint8_t *dev_buffer_packet_find(struct dev_buffer *dbuf,
 				gboolean (*packet_valid)(const uint8_t *),
-				size_t packet_size)
+				const struct sr_packet_sync *sync)
 {
-	size_t offset;
+	const uint8_t *pkt;
+	size_t skip;
 
-	while (dbuf->len >= packet_size) {
-		if (packet_valid(dbuf->data + dbuf->offset)) {
-			offset = dbuf->offset;
-			dbuf->offset += packet_size;
-			dbuf->len -= packet_size;
-			return dbuf->data + offset;
-		}
-		dbuf->offset++;
-		dbuf->len--;
-	}
+	pkt = sr_packet_sync_find(sync, packet_valid,
+				  dbuf->data + dbuf->offset, dbuf->len, &skip);
+	if (pkt)
+		skip += sync->packet_size;
+	dbuf->offset += skip;
+	dbuf->len -= skip;
 
-	return NULL;
+	return pkt;
 }
 
 struct dev_limit_counter {
@@ -205,7 +209,7 @@ static struct sr_serial_dev_inst *serial_dev_new(GSList *options,
 
 static int serial_stream_check_buf(struct sr_serial_dev_inst *serial,
 				   uint8_t *buf, size_t buflen,
-				   size_t packet_size,
+				   const struct sr_packet_sync *sync,
 				   packet_valid_callback is_valid,
 				   uint64_t timeout_ms, int baudrate)
 {
@@ -218,8 +222,8 @@ static int serial_stream_check_buf(struct sr_serial_dev_inst *serial,
 	serial_flush(serial);
 
 	len = buflen;
-	ret = serial_stream_detect(serial, buf, &len, packet_size,
-				   is_valid, timeout_ms, baudrate);
+	ret = serial_stream_detect_sync(serial, buf, &len, sync,
+					is_valid, timeout_ms, baudrate);
 
 	serial_close(serial);
 
@@ -233,21 +237,21 @@ static int serial_stream_check_buf(struct sr_serial_dev_inst *serial,
 	 * combination of the nonstandard cable that ships with some devices
 	 * and the serial port or USB to serial adapter.
 	 */
-	dropped = len - packet_size;
-	if (dropped > 2 * packet_size)
+	dropped = len - sync->packet_size;
+	if (dropped > 2 * sync->packet_size)
 		sr_warn("Had to drop too much data.");
 
 	return SR_OK;
 }
 
 static int serial_stream_check(struct sr_serial_dev_inst *serial,
-			       size_t packet_size,
+			       const struct sr_packet_sync *sync,
 			       packet_valid_callback is_valid,
 			       uint64_t timeout_ms, int baudrate)
 {
 	uint8_t buf[128];
 
-	return serial_stream_check_buf(serial, buf, sizeof(buf), packet_size,
+	return serial_stream_check_buf(serial, buf, sizeof(buf), sync,
 				       is_valid, timeout_ms, baudrate);
 }
 
@@ -403,6 +407,13 @@ static int send_config_update_key(struct sr_dev_inst *sdi, uint32_t key,
 
 #define PACKET_SIZE 17
 
+/* The footer is the only part of a packet known to be constant. */
+static const struct sr_packet_sync packet_sync = {
+	.packet_size = PACKET_SIZE,
+	.sync_mask = 0xff,
+	.terminator = "\r\n",
+};
+
 static const double frequencies[] = {
 	100, 120, 1000, 10000, 100000, 0,
 };
@@ -695,7 +706,7 @@ static void handle_packet(struct sr_dev_inst *sdi, const uint8_t *pkt)
 static int handle_new_data(struct sr_dev_inst *sdi)
 {
 	struct dev_context *devc;
-	uint8_t *pkt;
+	const uint8_t *pkt;
 	int ret;
 
 	devc = sdi->priv;
@@ -705,7 +716,7 @@ static int handle_new_data(struct sr_dev_inst *sdi)
 		return ret;
 
 	while ((pkt = dev_buffer_packet_find(devc->buf, packet_valid,
-					     PACKET_SIZE)))
+					     &packet_sync)))
 		handle_packet(sdi, pkt);
 
 	return SR_OK;
@@ -778,7 +789,7 @@ SR_PRIV struct sr_dev_inst *es51919_serial_scan(GSList *options,
 	if (!(serial = serial_dev_new(options, "9600/8n1/rts=1/dtr=1")))
 		goto scan_cleanup;
 
-	ret = serial_stream_check(serial, PACKET_SIZE, packet_valid,
+	ret = serial_stream_check(serial, &packet_sync, packet_valid,
 				  3000, 9600);
 	if (ret != SR_OK)
 		goto scan_cleanup;
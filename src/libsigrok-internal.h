@@ -370,6 +370,12 @@ struct sr_input {
 	struct sr_dev_inst *sdi;
 	gboolean sdi_ready;
 	void *priv;
+	/** File mapped by sr_input_load_file(), or NULL. */
+	GMappedFile *mapped;
+	/** Name of the mapped file. */
+	char *mapped_name;
+	/** Number of bytes of the mapped file consumed by the module. */
+	gsize mapped_pos;
 };
 
 /** Input (file) module driver. */
@@ -462,6 +468,27 @@ struct sr_input_module {
 	 */
 	int (*receive) (struct sr_input *in, GString *buf);
 
+	/**
+	 * Parse data directly from a memory-mapped input file.
+	 *
+	 * This function is optional. If present, sr_input_load_file() uses
+	 * it instead of receive(), so the data needn't be copied into the
+	 * instance's buffer. @a data points to the part of the file not yet
+	 * consumed, and stays valid (and writable) until the instance is
+	 * reset or freed, so it can be sent to the session as it is. The
+	 * number of bytes the module is done with must be stored in
+	 * @a consumed. The remaining bytes are passed again with the next
+	 * call.
+	 *
+	 * Just like receive(), this returns as soon as the device instance
+	 * is ready.
+	 *
+	 * @retval SR_OK Success
+	 * @retval other Negative error code.
+	 */
+	int (*receive_mapped) (struct sr_input *in, char *data, gsize len,
+			gsize *consumed);
+
 	/**
 	 * Signal the input module no more data will come.
 	 *
@@ -601,6 +628,22 @@ struct sr_output_module {
 	int (*receive) (const struct sr_output *o,
 			const struct sr_datafeed_packet *packet, GString **out);
 
+	/**
+	 * Optional. Called for packets whose output is a part of their
+	 * payload as it is, instead of receive(). This lets callers which
+	 * write the output to a file themselves write it straight from
+	 * the payload, without copying it into a GString first.
+	 *
+	 * @param o Pointer to the respective 'struct sr_output'.
+	 * @param packet The complete packet.
+	 * @param size Set to the number of bytes of output.
+	 *
+	 * @return A pointer to the output within the packet's payload, or
+	 *         NULL if the packet has to be passed to receive().
+	 */
+	const void *(*payload) (const struct sr_output *o,
+			const struct sr_datafeed_packet *packet, size_t *size);
+
 	/**
 	 * This function is called after the caller is finished using
 	 * the output module, and can be used to free any internal
@@ -747,12 +790,23 @@ SR_PRIV int sr_log(int loglevel, const char *format, ...)
 SR_PRIV int sr_log(int loglevel, const char *format, ...) G_GNUC_PRINTF(2, 3);
 #endif
 
-/* Message logging helpers with subsystem-specific prefix string. */
-#define sr_spew(...)	sr_log(SR_LOG_SPEW, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_dbg(...)	sr_log(SR_LOG_DBG,  LOG_PREFIX ": " __VA_ARGS__)
-#define sr_info(...)	sr_log(SR_LOG_INFO, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_warn(...)	sr_log(SR_LOG_WARN, LOG_PREFIX ": " __VA_ARGS__)
-#define sr_err(...)	sr_log(SR_LOG_ERR,  LOG_PREFIX ": " __VA_ARGS__)
+SR_PRIV void sr_log_flush(void);
+SR_PRIV void sr_log_stop(void);
+
+/* Currently selected loglevel, use sr_log_loglevel_get() outside log.c. */
+extern SR_PRIV int sr_log_cur_loglevel;
+
+/*
+ * Message logging helpers with subsystem-specific prefix string. The
+ * loglevel is checked before any arguments are evaluated or formatted.
+ */
+#define sr_log_level(l, ...) \
+	((l) <= sr_log_cur_loglevel ? sr_log((l), __VA_ARGS__) : SR_OK)
+#define sr_spew(...)	sr_log_level(SR_LOG_SPEW, LOG_PREFIX ": " __VA_ARGS__)
+#define sr_dbg(...)	sr_log_level(SR_LOG_DBG,  LOG_PREFIX ": " __VA_ARGS__)
+#define sr_info(...)	sr_log_level(SR_LOG_INFO, LOG_PREFIX ": " __VA_ARGS__)
+#define sr_warn(...)	sr_log_level(SR_LOG_WARN, LOG_PREFIX ": " __VA_ARGS__)
+#define sr_err(...)	sr_log_level(SR_LOG_ERR,  LOG_PREFIX ": " __VA_ARGS__)
 
 /*--- device.c --------------------------------------------------------------*/
 
@@ -804,6 +858,17 @@ struct sr_dev_inst {
 	void *priv;
 	/** Session to which this device is currently assigned. */
 	struct sr_session *session;
+	/** Cached SR_CONF_DEVICE_OPTIONS, per channel group and key. */
+	GHashTable *config_caps;
+	/** Cached config values, per channel group and key. Only used if
+	 * enabled with sr_config_cache_enable(). */
+	GHashTable *config_values;
+	/** Whether config values are cached. */
+	gboolean config_cache_enabled;
+	/** Guards the caches above, created on first use. */
+	GMutex *config_mutex;
+	/** Bumped whenever the caches are cleared. */
+	guint config_generation;
 };
 
 /* Generic device instances */
@@ -834,6 +899,9 @@ SR_PRIV int sr_variant_type_check(uint32_t key, GVariant *data);
 SR_PRIV void sr_hw_cleanup_all(const struct sr_context *ctx);
 SR_PRIV struct sr_config *sr_config_new(uint32_t key, GVariant *data);
 SR_PRIV void sr_config_free(struct sr_config *src);
+SR_PRIV void sr_config_cache_clear(const struct sr_dev_inst *sdi,
+		gboolean caps);
+SR_PRIV void sr_config_cache_free(struct sr_dev_inst *sdi);
 
 /*--- session.c -------------------------------------------------------------*/
 
@@ -867,6 +935,14 @@ struct sr_session {
 	unsigned int stop_check_id;
 	/** Whether the session has been started. */
 	gboolean running;
+
+	/** Whether metrics are collected, see sr_session_metrics_enable(). */
+	gboolean metrics_enabled;
+	/** Mutex protecting the metrics table. */
+	GMutex metrics_mutex;
+	/** Metrics stages (struct sr_metrics_stage), keyed by device
+	 * instance, transform or datafeed callback. */
+	GHashTable *metrics;
 };
 
 SR_PRIV int sr_session_source_add_internal(struct sr_session *session,
@@ -895,6 +971,8 @@ SR_PRIV int sr_session_source_remove_channel(struct sr_session *session,
 
 SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		const struct sr_datafeed_packet *packet);
+SR_PRIV int sr_session_send_from(const struct sr_transform *t,
+		const struct sr_datafeed_packet *packet);
 SR_PRIV int sr_sessionfile_check(const char *filename);
 SR_PRIV struct sr_dev_inst *sr_session_prepare_sdi(const char *filename,
 		struct sr_session **session);
@@ -902,6 +980,18 @@ SR_PRIV int sr_packet_copy(const struct sr_datafeed_packet *packet,
 		struct sr_datafeed_packet **copy);
 SR_PRIV void sr_packet_free(struct sr_datafeed_packet *packet);
 
+/*--- session_metrics.c -----------------------------------------------------*/
+
+SR_PRIV void sr_session_metrics_init(struct sr_session *session);
+SR_PRIV void sr_session_metrics_cleanup(struct sr_session *session);
+SR_PRIV void sr_session_metrics_add(struct sr_session *session, int type,
+		const void *key, const struct sr_datafeed_packet *packet,
+		int64_t usec);
+SR_PRIV void sr_session_metrics_usb_transfer(const struct sr_dev_inst *sdi,
+		gboolean empty);
+SR_PRIV void sr_session_metrics_usb_resubmit_failed(const struct sr_dev_inst *sdi);
+SR_PRIV void sr_session_metrics_frame_dropped(const struct sr_dev_inst *sdi);
+
 /*--- session_file.c --------------------------------------------------------*/
 
 #if !HAVE_ZIP_DISCARD
@@ -912,6 +1002,10 @@ SR_PRIV void sr_zip_discard(struct zip *archive);
 
 SR_PRIV GKeyFile *sr_sessionfile_read_metadata(struct zip *archive,
 			const struct zip_stat *entry);
+SR_PRIV char *sr_sessionfile_encoding_string(
+		const struct sr_analog_encoding *encoding);
+SR_PRIV int sr_sessionfile_encoding_parse(const char *s,
+		struct sr_analog_encoding *encoding);
 
 /*--- analog.c --------------------------------------------------------------*/
 
@@ -966,6 +1060,9 @@ SR_PRIV int sr_atof_ascii(const char *str, float *ret);
 
 /*--- soft-trigger.c --------------------------------------------------------*/
 
+/* Default for the memory the pre-trigger data may take up. */
+#define SOFT_TRIGGER_MEMORY_BUDGET (256 * 1024 * 1024)
+
 struct soft_trigger_logic {
 	const struct sr_dev_inst *sdi;
 	const struct sr_trigger *trigger;
@@ -973,10 +1070,17 @@ struct soft_trigger_logic {
 	int unitsize;
 	int cur_stage;
 	uint8_t *prev_sample;
-	uint8_t *pre_trigger_buffer;
-	uint8_t *pre_trigger_head;
-	int pre_trigger_size;
-	int pre_trigger_fill;
+	/* Recent buffers (GBytes), oldest first, for the pre-trigger data. */
+	GQueue *pre_trigger_buffers;
+	uint64_t pre_trigger_size;
+	uint64_t pre_trigger_fill;
+	/* Memory the kept buffers may take up, this also limits the size. */
+	uint64_t pre_trigger_budget;
+};
+
+struct soft_trigger_pool {
+	gsize buffer_size;
+	GSList *free_buffers;
 };
 
 SR_PRIV struct soft_trigger_logic *soft_trigger_logic_new(
@@ -985,9 +1089,99 @@ SR_PRIV struct soft_trigger_logic *soft_trigger_logic_new(
 SR_PRIV void soft_trigger_logic_free(struct soft_trigger_logic *st);
 SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *st, uint8_t *buf,
 		int len, int *pre_trigger_samples);
+SR_PRIV int soft_trigger_logic_check_bytes(struct soft_trigger_logic *stl,
+		GBytes *bytes, int *pre_trigger_samples);
+SR_PRIV struct soft_trigger_pool *soft_trigger_pool_new(gsize buffer_size);
+SR_PRIV void soft_trigger_pool_free(struct soft_trigger_pool *pool);
+SR_PRIV uint8_t *soft_trigger_pool_get(struct soft_trigger_pool *pool);
+SR_PRIV GBytes *soft_trigger_pool_wrap(struct soft_trigger_pool *pool,
+		uint8_t *buf, gsize length);
+
+struct analog_match;
+
+struct soft_trigger_analog {
+	const struct sr_dev_inst *sdi;
+	const struct sr_trigger *trigger;
+	int num_stages;
+	int cur_stage;
+	struct analog_match *matches;
+	int num_matches;
+	/* Recent samples of every stream of packets. */
+	GSList *streams;
+	uint64_t pre_trigger_samples;
+	gboolean fired;
+	float *values;
+	uint64_t values_size;
+};
+
+SR_PRIV struct soft_trigger_analog *soft_trigger_analog_new(
+		const struct sr_dev_inst *sdi, struct sr_trigger *trigger,
+		int pre_trigger_samples);
+SR_PRIV void soft_trigger_analog_free(struct soft_trigger_analog *sta);
+SR_PRIV int soft_trigger_analog_check(struct soft_trigger_analog *sta,
+		struct sr_datafeed_packet *packet, int *pre_trigger_samples);
+
+/*--- input/parallel.c ------------------------------------------------------*/
+
+/** A piece of text input, cut at a line boundary, for parallel parsing. */
+struct sr_input_chunk {
+	/** The text of the chunk, NUL-terminated. */
+	char *text;
+	/** Length of the text. */
+	gsize len;
+	/** Status returned by the parse function. */
+	int ret;
+	/** Parse results, owned by the input module. */
+	void *result;
+};
+
+typedef void (*sr_input_chunk_func)(struct sr_input_chunk *chunk,
+		void *cb_data);
+
+struct sr_input_workers;
+
+SR_PRIV struct sr_input_workers *sr_input_workers_new(unsigned int num_threads,
+		sr_input_chunk_func func, void *cb_data);
+SR_PRIV void sr_input_workers_free(struct sr_input_workers *workers);
+SR_PRIV struct sr_input_chunk *sr_input_split_lines(
+		const struct sr_input_workers *workers, char *text, gsize len,
+		const char *line_start, unsigned int *num_chunks);
+SR_PRIV void sr_input_workers_run(struct sr_input_workers *workers,
+		struct sr_input_chunk *chunks, unsigned int num_chunks);
+
+/*--- output/output.c -------------------------------------------------------*/
+
+SR_PRIV void sr_output_bitplanes(const uint8_t *data, unsigned int unitsize,
+		unsigned int num_samples, uint8_t *planes);
+SR_PRIV int sr_output_logic_bit(const struct sr_dev_inst *sdi,
+		gboolean packed, const struct sr_channel *ch);
+SR_PRIV gboolean sr_output_logic_packed(const struct sr_datafeed_meta *meta,
+		gboolean packed);
+SR_PRIV uint8_t *sr_output_logic_unpack(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_logic *logic, unsigned int *unitsize,
+		uint64_t *length);
 
 /*--- hardware/serial.c -----------------------------------------------------*/
 
+/**
+ * Framing of a fixed-size packet in a serial data stream.
+ *
+ * Used to find packet candidates quickly before running the (usually
+ * much more expensive) validation callback of a parser.
+ */
+struct sr_packet_sync {
+	/** Packet size in bytes. */
+	size_t packet_size;
+	/** Offset of the sync byte in the packet. */
+	size_t sync_offset;
+	/** Mask applied to the sync byte before comparing it. */
+	uint8_t sync_mask;
+	/** Allowed (masked) sync byte values, or NULL if there are none. */
+	const char *sync;
+	/** Bytes ending every packet, or NULL if there are none. */
+	const char *terminator;
+};
+
 #ifdef HAVE_LIBSERIALPORT
 enum {
 	SERIAL_RDWR = 1,
@@ -1014,6 +1208,14 @@ SR_PRIV int serial_set_paramstr(struct sr_serial_dev_inst *serial,
 		const char *paramstr);
 SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial, char **buf,
 		int *buflen, gint64 timeout_ms);
+SR_PRIV const uint8_t *sr_packet_sync_find(const struct sr_packet_sync *sync,
+		packet_valid_callback is_valid, const uint8_t *buf, size_t len,
+		size_t *skip);
+SR_PRIV int serial_stream_detect_sync(struct sr_serial_dev_inst *serial,
+				      uint8_t *buf, size_t *buflen,
+				      const struct sr_packet_sync *sync,
+				      packet_valid_callback is_valid,
+				      uint64_t timeout_ms, int baudrate);
 SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 				 uint8_t *buf, size_t *buflen,
 				 size_t packet_size,
@@ -1115,6 +1317,9 @@ SR_PRIV void sr_modbus_free(struct sr_modbus_dev_inst *modbus);
 #define ES519XX_11B_PACKET_SIZE (11 * 2)
 #define ES519XX_14B_PACKET_SIZE 14
 
+extern SR_PRIV const struct sr_packet_sync sr_es519xx_11b_packet_sync;
+extern SR_PRIV const struct sr_packet_sync sr_es519xx_14b_packet_sync;
+
 struct es519xx_info {
 	gboolean is_judge, is_voltage, is_auto, is_micro, is_current;
 	gboolean is_milli, is_resistance, is_continuity, is_diode;
@@ -1156,6 +1361,8 @@ SR_PRIV int sr_es519xx_19200_14b_sel_lpf_parse(const uint8_t *buf,
 
 #define FS9922_PACKET_SIZE 14
 
+extern SR_PRIV const struct sr_packet_sync sr_fs9922_packet_sync;
+
 struct fs9922_info {
 	gboolean is_auto, is_dc, is_ac, is_rel, is_hold, is_bpn, is_z1, is_z2;
 	gboolean is_max, is_min, is_apo, is_bat, is_nano, is_z3, is_micro;
@@ -1174,6 +1381,8 @@ SR_PRIV void sr_fs9922_z1_diode(struct sr_datafeed_analog *analog, void *info);
 
 #define FS9721_PACKET_SIZE 14
 
+extern SR_PRIV const struct sr_packet_sync sr_fs9721_packet_sync;
+
 struct fs9721_info {
 	gboolean is_ac, is_dc, is_auto, is_rs232, is_micro, is_nano, is_kilo;
 	gboolean is_diode, is_milli, is_percent, is_mega, is_beep, is_farad;
@@ -1194,6 +1403,8 @@ SR_PRIV void sr_fs9721_max_c_min(struct sr_datafeed_analog *analog, void *info);
 
 #define DTM0660_PACKET_SIZE 15
 
+extern SR_PRIV const struct sr_packet_sync sr_dtm0660_packet_sync;
+
 struct dtm0660_info {
 	gboolean is_ac, is_dc, is_auto, is_rs232, is_micro, is_nano, is_kilo;
 	gboolean is_diode, is_milli, is_percent, is_mega, is_beep, is_farad;
@@ -1210,6 +1421,8 @@ SR_PRIV int sr_dtm0660_parse(const uint8_t *buf, float *floatval,
 
 #define BBCGM_M2110_PACKET_SIZE 9
 
+extern SR_PRIV const struct sr_packet_sync sr_m2110_packet_sync;
+
 SR_PRIV gboolean sr_m2110_packet_valid(const uint8_t *buf);
 SR_PRIV int sr_m2110_parse(const uint8_t *buf, float *floatval,
 			     struct sr_datafeed_analog *analog, void *info);
@@ -1218,6 +1431,8 @@ SR_PRIV int sr_m2110_parse(const uint8_t *buf, float *floatval,
 
 #define METEX14_PACKET_SIZE 14
 
+extern SR_PRIV const struct sr_packet_sync sr_metex14_packet_sync;
+
 struct metex14_info {
 	gboolean is_ac, is_dc, is_resistance, is_capacity, is_temperature;
 	gboolean is_diode, is_frequency, is_ampere, is_volt, is_farad;
@@ -1237,6 +1452,8 @@ SR_PRIV int sr_metex14_parse(const uint8_t *buf, float *floatval,
 
 #define RS9LCD_PACKET_SIZE 9
 
+extern SR_PRIV const struct sr_packet_sync sr_rs9lcd_packet_sync;
+
 /* Dummy info struct. The parser does not use it. */
 struct rs9lcd_info { int dummy; };
 
@@ -1248,6 +1465,8 @@ SR_PRIV int sr_rs9lcd_parse(const uint8_t *buf, float *floatval,
 
 #define BRYMEN_BM25X_PACKET_SIZE 15
 
+extern SR_PRIV const struct sr_packet_sync sr_brymen_bm25x_packet_sync;
+
 /* Dummy info struct. The parser does not use it. */
 struct bm25x_info { int dummy; };
 
@@ -1259,6 +1478,8 @@ SR_PRIV int sr_brymen_bm25x_parse(const uint8_t *buf, float *floatval,
 
 #define UT71X_PACKET_SIZE 11
 
+extern SR_PRIV const struct sr_packet_sync sr_ut71x_packet_sync;
+
 struct ut71x_info {
 	gboolean is_voltage, is_resistance, is_capacitance, is_temperature;
 	gboolean is_celsius, is_fahrenheit, is_current, is_continuity;
@@ -1274,6 +1495,8 @@ SR_PRIV int sr_ut71x_parse(const uint8_t *buf, float *floatval,
 
 #define VC870_PACKET_SIZE 23
 
+extern SR_PRIV const struct sr_packet_sync sr_vc870_packet_sync;
+
 struct vc870_info {
 	gboolean is_voltage, is_dc, is_ac, is_temperature, is_resistance;
 	gboolean is_continuity, is_capacitance, is_diode, is_loop_current;
@@ -1313,6 +1536,8 @@ SR_PRIV int es51919_serial_acquisition_stop(struct sr_dev_inst *sdi);
 
 #define UT372_PACKET_SIZE 27
 
+extern SR_PRIV const struct sr_packet_sync sr_ut372_packet_sync;
+
 struct ut372_info {
 	int dummy;
 };
@@ -1323,6 +1548,8 @@ SR_PRIV int sr_ut372_parse(const uint8_t *buf, float *floatval,
 
 /*--- hardware/scale/kern.c -------------------------------------------------*/
 
+extern SR_PRIV const struct sr_packet_sync sr_kern_packet_sync;
+
 struct kern_info {
 	gboolean is_gram, is_carat, is_ounce, is_pound, is_troy_ounce;
 	gboolean is_pennyweight, is_grain, is_tael, is_momme, is_tola;
@@ -1353,4 +1580,98 @@ SR_PRIV void sr_sw_limits_update_samples_read(struct sr_sw_limits *limits,
 	uint64_t samples_read);
 SR_PRIV void sr_sw_limits_init(struct sr_sw_limits *limits);
 
+/*--- analog_batch.c --------------------------------------------------------*/
+
+struct sr_analog_batch {
+	uint64_t limit_samples;
+	uint64_t limit_msec;
+	GSList *streams;
+	const struct sr_dev_inst *sdi;
+	gboolean timer_running;
+};
+
+SR_PRIV void sr_analog_batch_init(struct sr_analog_batch *batch);
+SR_PRIV int sr_analog_batch_config_get(struct sr_analog_batch *batch,
+	uint32_t key, GVariant **data);
+SR_PRIV int sr_analog_batch_config_set(struct sr_analog_batch *batch,
+	uint32_t key, GVariant *data);
+SR_PRIV gboolean sr_analog_batch_enabled(const struct sr_analog_batch *batch);
+SR_PRIV int sr_analog_batch_send(struct sr_analog_batch *batch,
+	const struct sr_dev_inst *sdi, const struct sr_datafeed_analog *analog,
+	const int64_t *timestamps);
+SR_PRIV void sr_analog_batch_flush(struct sr_analog_batch *batch,
+	const struct sr_dev_inst *sdi);
+
+/*--- frame_ring.c ----------------------------------------------------------*/
+
+/* One channel of a frame, sent as one analog packet. */
+struct sr_frame_channel {
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	void *data;
+};
+
+/* Sent in an SR_DF_META packet after SR_DF_FRAME_BEGIN. */
+struct sr_frame_info {
+	/* Counts dropped frames too. */
+	uint64_t index;
+	/* Host time [µs] since the Unix epoch. */
+	int64_t timestamp;
+	/* Trigger position in samples, or -1 if unknown. */
+	int64_t trigger_offset;
+};
+
+struct sr_frame {
+	struct sr_frame_info info;
+	/* Number of samples per channel. */
+	uint32_t num_samples;
+	/* The channels, in the order they were passed at acquisition start. */
+	struct sr_frame_channel *channels;
+};
+
+struct sr_frame_ring {
+	uint64_t limit_frames;
+	gboolean drop_frames;
+	struct sr_frame *frames;
+	unsigned int num_frames;
+	unsigned int num_channels;
+	unsigned int max_samples;
+	unsigned int unitsize;
+	/* Oldest queued frame, and the number of queued frames. */
+	unsigned int read;
+	unsigned int pending;
+	gboolean running;
+	uint64_t frames_started;
+	uint64_t frames_committed;
+	uint64_t frames_sent;
+	uint64_t frames_dropped;
+	GMutex mutex;
+	GCond cond;
+};
+
+typedef int (*sr_frame_fill_callback)(const struct sr_dev_inst *sdi,
+	struct sr_frame *frame, void *cb_data);
+
+SR_PRIV void sr_frame_ring_init(struct sr_frame_ring *ring);
+SR_PRIV void sr_frame_ring_clear(struct sr_frame_ring *ring);
+SR_PRIV int sr_frame_ring_config_get(struct sr_frame_ring *ring,
+	uint32_t key, GVariant **data);
+SR_PRIV int sr_frame_ring_config_set(struct sr_frame_ring *ring,
+	uint32_t key, GVariant *data);
+SR_PRIV int sr_frame_ring_acquisition_start(struct sr_frame_ring *ring,
+	unsigned int num_frames, const GSList *channels,
+	unsigned int max_samples, unsigned int unitsize, gboolean drop_frames);
+SR_PRIV void sr_frame_ring_acquisition_stop(struct sr_frame_ring *ring);
+SR_PRIV struct sr_frame *sr_frame_ring_begin(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi);
+SR_PRIV void sr_frame_ring_commit(struct sr_frame_ring *ring,
+	struct sr_frame *frame);
+SR_PRIV int sr_frame_ring_fill(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi, sr_frame_fill_callback fill,
+	void *cb_data);
+SR_PRIV unsigned int sr_frame_ring_send(struct sr_frame_ring *ring,
+	const struct sr_dev_inst *sdi);
+SR_PRIV gboolean sr_frame_ring_limit_reached(struct sr_frame_ring *ring);
+
 #endif
@@ -21,6 +21,7 @@
 #include <config.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <glib/gprintf.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
@@ -42,7 +43,7 @@
  */
 
 /* Currently selected libsigrok loglevel. Default: SR_LOG_WARN. */
-static int cur_loglevel = SR_LOG_WARN; /* Show errors+warnings per default. */
+SR_PRIV int sr_log_cur_loglevel = SR_LOG_WARN; /* Show errors+warnings per default. */
 
 /* Function prototype. */
 static int sr_logv(void *cb_data, int loglevel, const char *format,
@@ -62,6 +63,50 @@ static void *sr_log_cb_data = NULL;
 /** @endcond */
 static int64_t sr_log_start_time = 0;
 
+/*
+ * The default log callback doesn't write messages itself, it formats
+ * them into a slot of a lock-free queue. A writer thread outputs them to
+ * stderr, so a slow terminal doesn't stall acquisitions.
+ *
+ * The queue is a bounded multi-producer queue (D. Vyukov's design): each
+ * slot carries a sequence number telling whether it is free for the
+ * producer with a given ticket, or filled for the consumer. When the
+ * queue is full, messages are dropped and counted instead of blocking.
+ *
+ * The writer sleeps on a condition variable while the queue is empty.
+ * Producers only take the mutex to wake it up when it's about to sleep,
+ * so logging doesn't contend on a lock otherwise. The writer is started
+ * with the first message and stopped (after writing everything) by
+ * sr_exit() or at process exit. Errors are written out right away, so
+ * they don't get lost when the process aborts.
+ */
+#define LOG_QUEUE_SIZE		512 /* Must be a power of two. */
+#define LOG_RECORD_SIZE		480
+
+struct log_record {
+	/* Slot state, see above. Accessed with g_atomic_int_*() only. */
+	gint sequence;
+	/* Time stamp (relative to startup) in us, or -1 for none. */
+	int64_t elapsed_us;
+	/* Heap copy of messages which don't fit into text[], or NULL. */
+	char *long_text;
+	char text[LOG_RECORD_SIZE];
+};
+
+static struct log_record log_queue[LOG_QUEUE_SIZE];
+static gint log_enqueue_pos;
+static gint log_dequeue_pos;
+static gint log_dropped;
+
+/* Writer thread state, protected by log_mutex. */
+static GMutex log_mutex;
+static GCond log_wake_cond;
+static GCond log_drained_cond;
+static GThread *log_writer;
+static gboolean log_stopping;
+/* Set while the writer is about to sleep. Accessed with g_atomic_int_*(). */
+static gint log_sleeping;
+
 /**
  * Set the libsigrok loglevel.
  *
@@ -89,7 +134,7 @@ SR_API int sr_log_loglevel_set(int loglevel)
 	if (loglevel >= LOGLEVEL_TIMESTAMP && sr_log_start_time == 0)
 		sr_log_start_time = g_get_monotonic_time();
 
-	cur_loglevel = loglevel;
+	sr_log_cur_loglevel = loglevel;
 
 	sr_dbg("libsigrok loglevel set to %d.", loglevel);
 
@@ -105,7 +150,7 @@ SR_API int sr_log_loglevel_set(int loglevel)
  */
 SR_API int sr_log_loglevel_get(void)
 {
-	return cur_loglevel;
+	return sr_log_cur_loglevel;
 }
 
 /**
@@ -132,6 +177,9 @@ SR_API int sr_log_callback_set(sr_log_callback cb, void *cb_data)
 
 	/* Note: 'cb_data' is allowed to be NULL. */
 
+	/* Keep the order of messages still queued by the default callback. */
+	sr_log_flush();
+
 	sr_log_cb = cb;
 	sr_log_cb_data = cb_data;
 
@@ -159,54 +207,268 @@ SR_API int sr_log_callback_set_default(void)
 	return SR_OK;
 }
 
-static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args)
+/* Remove newlines from a message, in place. */
+static void strip_newlines(char *text)
 {
-	uint64_t elapsed_us, minutes;
-	unsigned int rest_us, seconds, microseconds;
-	char *raw_output, *output;
-	int raw_len, raw_idx, idx, ret;
-
-	/* This specific log callback doesn't need the void pointer data. */
-	(void)cb_data;
+	char *dst;
 
-	/* Only output messages of at least the selected loglevel(s). */
-	if (loglevel > cur_loglevel)
-		return SR_OK;
+	for (dst = text; *text; text++) {
+		if (*text != '\n')
+			*dst++ = *text;
+	}
+	*dst = '\0';
+}
 
-	if (cur_loglevel >= LOGLEVEL_TIMESTAMP) {
-		elapsed_us = g_get_monotonic_time() - sr_log_start_time;
+static void log_write_record(struct log_record *rec)
+{
+	uint64_t minutes;
+	unsigned int rest_us, seconds, microseconds;
 
-		minutes = elapsed_us / G_TIME_SPAN_MINUTE;
-		rest_us = elapsed_us % G_TIME_SPAN_MINUTE;
+	if (rec->elapsed_us >= 0) {
+		minutes = rec->elapsed_us / G_TIME_SPAN_MINUTE;
+		rest_us = rec->elapsed_us % G_TIME_SPAN_MINUTE;
 		seconds = rest_us / G_TIME_SPAN_SECOND;
 		microseconds = rest_us % G_TIME_SPAN_SECOND;
 
-		ret = g_fprintf(stderr, "sr: [%.2" PRIu64 ":%.2u.%.6u] ",
-				minutes, seconds, microseconds);
+		g_fprintf(stderr, "sr: [%.2" PRIu64 ":%.2u.%.6u] %s\n",
+			minutes, seconds, microseconds,
+			rec->long_text ? rec->long_text : rec->text);
 	} else {
-		ret = fputs("sr: ", stderr);
+		g_fprintf(stderr, "sr: %s\n",
+			rec->long_text ? rec->long_text : rec->text);
+	}
+	g_free(rec->long_text);
+	rec->long_text = NULL;
+}
+
+/* Output all queued messages, return whether there were any. */
+static gboolean log_drain(void)
+{
+	struct log_record *rec;
+	guint pos;
+	gint dropped;
+	gboolean written;
+
+	/* Positions wrap around, so they are compared as unsigned values. */
+	written = FALSE;
+	pos = g_atomic_int_get(&log_dequeue_pos);
+	for (;;) {
+		rec = &log_queue[pos & (LOG_QUEUE_SIZE - 1)];
+		if ((guint)g_atomic_int_get(&rec->sequence) != pos + 1)
+			break;
+		log_write_record(rec);
+		/* Hand the slot back to the producer one lap ahead. */
+		g_atomic_int_set(&rec->sequence, pos + LOG_QUEUE_SIZE);
+		g_atomic_int_set(&log_dequeue_pos, ++pos);
+		written = TRUE;
+	}
+
+	if ((dropped = g_atomic_int_and(&log_dropped, 0)) > 0)
+		g_fprintf(stderr, "sr: %d log messages dropped.\n", dropped);
+
+	if (written)
+		fflush(stderr);
+
+	return written;
+}
+
+/* Whether the next record in the queue has been published. */
+static gboolean log_pending(void)
+{
+	guint pos;
+
+	pos = g_atomic_int_get(&log_dequeue_pos);
+
+	return (guint)g_atomic_int_get(&log_queue[pos
+			& (LOG_QUEUE_SIZE - 1)].sequence) == pos + 1
+		|| g_atomic_int_get(&log_dropped) > 0;
+}
+
+static gpointer log_writer_thread(gpointer data)
+{
+	gboolean stop;
+
+	(void)data;
+
+	do {
+		log_drain();
+
+		g_mutex_lock(&log_mutex);
+		g_cond_broadcast(&log_drained_cond);
+		/*
+		 * Announce the sleep before checking the queue once more.
+		 * A producer publishing a record after this check sees the
+		 * flag and signals the condition, which needs the mutex we
+		 * hold until waiting.
+		 */
+		g_atomic_int_set(&log_sleeping, 1);
+		if (!log_stopping && !log_pending())
+			g_cond_wait(&log_wake_cond, &log_mutex);
+		g_atomic_int_set(&log_sleeping, 0);
+		stop = log_stopping;
+		g_mutex_unlock(&log_mutex);
+	} while (!stop);
+
+	/* Final drain, the producers may have been busy meanwhile. */
+	log_drain();
+
+	return NULL;
+}
+
+static void log_writer_wake(void)
+{
+	if (!g_atomic_int_get(&log_sleeping))
+		return;
+
+	g_mutex_lock(&log_mutex);
+	g_cond_signal(&log_wake_cond);
+	g_mutex_unlock(&log_mutex);
+}
+
+static void log_writer_start(void)
+{
+	g_mutex_lock(&log_mutex);
+	if (!log_writer && !log_stopping)
+		g_atomic_pointer_set(&log_writer,
+			g_thread_new("sr-log", log_writer_thread, NULL));
+	g_mutex_unlock(&log_mutex);
+}
+
+/**
+ * Stop the writer thread of the default log callback, after it has
+ * written out all queued messages. It gets started again by the next
+ * message.
+ *
+ * @private
+ */
+SR_PRIV void sr_log_stop(void)
+{
+	GThread *writer;
+
+	g_mutex_lock(&log_mutex);
+	writer = log_writer;
+	if (writer) {
+		log_stopping = TRUE;
+		g_cond_signal(&log_wake_cond);
 	}
+	g_mutex_unlock(&log_mutex);
 
-	if (ret < 0 || (raw_len = g_vasprintf(&raw_output, format, args)) < 0)
-		return SR_ERR;
+	if (!writer)
+		return;
 
-	output = g_malloc0(raw_len + 1);
+	g_thread_join(writer);
 
-	/* Copy the string without any unwanted newlines. */
-	raw_idx = idx = 0;
-	while (raw_idx < raw_len) {
-		if (raw_output[raw_idx] != '\n') {
-			output[idx] = raw_output[raw_idx];
-			idx++;
+	g_mutex_lock(&log_mutex);
+	g_atomic_pointer_set(&log_writer, NULL);
+	log_stopping = FALSE;
+	/* Release anyone still waiting in sr_log_flush(). */
+	g_cond_broadcast(&log_drained_cond);
+	g_mutex_unlock(&log_mutex);
+}
+
+static void log_queue_init(void)
+{
+	static gsize initialized = 0;
+	int i;
+
+	if (g_once_init_enter(&initialized)) {
+		for (i = 0; i < LOG_QUEUE_SIZE; i++)
+			log_queue[i].sequence = i;
+		/* Don't lose messages of frontends not calling sr_exit(). */
+		atexit(sr_log_stop);
+		g_once_init_leave(&initialized, 1);
+	}
+
+	if (!g_atomic_pointer_get(&log_writer))
+		log_writer_start();
+}
+
+/* Reserve a queue slot, return NULL if the queue is full. */
+static struct log_record *log_reserve(guint *ticket)
+{
+	struct log_record *rec;
+	guint pos;
+	gint diff;
+
+	pos = g_atomic_int_get(&log_enqueue_pos);
+	for (;;) {
+		rec = &log_queue[pos & (LOG_QUEUE_SIZE - 1)];
+		diff = (gint)((guint)g_atomic_int_get(&rec->sequence) - pos);
+		if (diff == 0) {
+			if (g_atomic_int_compare_and_exchange(&log_enqueue_pos,
+					pos, pos + 1))
+				break;
+		} else if (diff < 0) {
+			return NULL;
 		}
-		raw_idx++;
+		pos = g_atomic_int_get(&log_enqueue_pos);
 	}
+	*ticket = pos;
 
-	g_fprintf(stderr, "%s\n", output);
-	g_free(raw_output);
-	g_free(output);
+	return rec;
+}
 
-	return SR_OK;
+/**
+ * Wait until all queued messages of the default log callback have been
+ * written out.
+ *
+ * @private
+ */
+SR_PRIV void sr_log_flush(void)
+{
+	g_mutex_lock(&log_mutex);
+	while (log_writer && g_atomic_int_get(&log_dequeue_pos) !=
+			g_atomic_int_get(&log_enqueue_pos)) {
+		g_cond_signal(&log_wake_cond);
+		g_cond_wait(&log_drained_cond, &log_mutex);
+	}
+	g_mutex_unlock(&log_mutex);
+}
+
+static int sr_logv(void *cb_data, int loglevel, const char *format, va_list args)
+{
+	struct log_record *rec;
+	va_list args_copy;
+	guint ticket;
+	int len;
+
+	/* This specific log callback doesn't need the void pointer data. */
+	(void)cb_data;
+
+	/* Only output messages of at least the selected loglevel(s). */
+	if (loglevel > sr_log_cur_loglevel)
+		return SR_OK;
+
+	log_queue_init();
+	if (!(rec = log_reserve(&ticket))) {
+		g_atomic_int_inc(&log_dropped);
+		log_writer_wake();
+		return SR_OK;
+	}
+
+	if (sr_log_cur_loglevel >= LOGLEVEL_TIMESTAMP)
+		rec->elapsed_us = g_get_monotonic_time() - sr_log_start_time;
+	else
+		rec->elapsed_us = -1;
+
+	va_copy(args_copy, args);
+	len = g_vsnprintf(rec->text, sizeof(rec->text), format, args);
+	if (len < 0)
+		rec->text[0] = '\0';
+	else if (len >= (int)sizeof(rec->text))
+		rec->long_text = g_strdup_vprintf(format, args_copy);
+	va_end(args_copy);
+
+	strip_newlines(rec->long_text ? rec->long_text : rec->text);
+
+	/* Publish the record to the writer thread. */
+	g_atomic_int_set(&rec->sequence, ticket + 1);
+	log_writer_wake();
+
+	if (loglevel <= SR_LOG_ERR)
+		sr_log_flush();
+
+	return (len < 0) ? SR_ERR : SR_OK;
 }
 
 /** @private */
@@ -215,6 +477,10 @@ SR_PRIV int sr_log(int loglevel, const char *format, ...)
 	int ret;
 	va_list args;
 
+	/* Only output messages of at least the selected loglevel(s). */
+	if (loglevel > sr_log_cur_loglevel)
+		return SR_OK;
+
 	va_start(args, format);
 	ret = sr_log_cb(sr_log_cb_data, loglevel, format, args);
 	va_end(args);
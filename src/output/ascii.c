@@ -39,10 +39,14 @@ struct context {
 	int *channel_index;
 	char **channel_names;
 	char **line_values;
-	uint8_t *prev_sample;
+	uint8_t *prev_bits;
 	gboolean header_done;
 	GString **lines;
 	GString *header;
+	/* The characters of the 8 samples in a bit plane, by previous bit. */
+	char chars[2][256][8];
+	uint8_t *planes;
+	unsigned int num_planes;
 };
 
 static int init(struct sr_output *o, GHashTable *options)
@@ -50,7 +54,9 @@ static int init(struct sr_output *o, GHashTable *options)
 	struct context *ctx;
 	struct sr_channel *ch;
 	GSList *l;
-	unsigned int i, j;
+	unsigned int i, j, k;
+	int curbit, prevbit;
+	char c;
 
 	if (!o || !o->sdi)
 		return SR_ERR_ARG;
@@ -71,7 +77,7 @@ static int init(struct sr_output *o, GHashTable *options)
 	ctx->channel_index = g_malloc(sizeof(int) * ctx->num_enabled_channels);
 	ctx->channel_names = g_malloc(sizeof(char *) * ctx->num_enabled_channels);
 	ctx->lines = g_malloc(sizeof(GString *) * ctx->num_enabled_channels);
-	ctx->prev_sample = g_malloc(g_slist_length(o->sdi->channels));
+	ctx->prev_bits = g_malloc0(ctx->num_enabled_channels);
 
 	j = 0;
 	for (i = 0, l = o->sdi->channels; l; l = l->next, i++) {
@@ -82,10 +88,29 @@ static int init(struct sr_output *o, GHashTable *options)
 			continue;
 		ctx->channel_index[j] = ch->index;
 		ctx->channel_names[j] = ch->name;
-		ctx->lines[j] = g_string_sized_new(80);
+		ctx->lines[j] = g_string_sized_new(strlen(ch->name) + 2 + ctx->spl);
 		g_string_printf(ctx->lines[j], "%s:", ch->name);
+		ctx->num_planes = MAX(ctx->num_planes, (unsigned int)ch->index + 1);
 		j++;
 	}
+	ctx->num_planes = (ctx->num_planes + 7) & ~7;
+	ctx->planes = g_malloc0(ctx->num_planes);
+
+	for (k = 0; k < 2; k++) {
+		for (i = 0; i < 256; i++) {
+			prevbit = k;
+			for (j = 0; j < 8; j++) {
+				curbit = (i >> (7 - j)) & 1;
+				c = curbit ? '"' : '.';
+				if (curbit < prevbit)
+					c = '\\';
+				else if (curbit > prevbit)
+					c = '/';
+				ctx->chars[k][i][j] = c;
+				prevbit = curbit;
+			}
+		}
+	}
 
 	return SR_OK;
 }
@@ -130,9 +155,9 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 	const struct sr_config *src;
 	GSList *l;
 	struct context *ctx;
-	int idx, offset, curbit, prevbit;
-	uint64_t i, j;
-	gchar *p, c;
+	int idx, offset, prevbit;
+	uint64_t i, j, n, num_samples;
+	uint8_t plane;
 
 	*out = NULL;
 	if (!o || !o->sdi)
@@ -149,6 +174,11 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 				continue;
 			ctx->samplerate = g_variant_get_uint64(src->data);
 		}
+		/* Packed samples only hold the enabled channels, in order. */
+		if (sr_output_logic_packed(meta, FALSE)) {
+			for (j = 0; j < ctx->num_enabled_channels; j++)
+				ctx->channel_index[j] = j;
+		}
 		break;
 	case SR_DF_TRIGGER:
 		ctx->trigger = ctx->spl_cnt;
@@ -161,39 +191,44 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 			*out = g_string_sized_new(512);
 
 		logic = packet->payload;
-		for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize) {
-			ctx->spl_cnt++;
+		if (logic->unitsize * 8 > ctx->num_planes) {
+			ctx->planes = g_realloc(ctx->planes, logic->unitsize * 8);
+			ctx->num_planes = logic->unitsize * 8;
+		}
+		num_samples = logic->length / logic->unitsize;
+		for (i = 0; i < num_samples; i += n) {
+			/* Up to 8 samples, but not beyond the end of the line. */
+			n = MIN(8, num_samples - i);
+			if (ctx->spl > 0)
+				n = MIN(n, (uint64_t)(ctx->spl - ctx->spl_cnt));
+			sr_output_bitplanes(logic->data + i * logic->unitsize,
+					logic->unitsize, n, ctx->planes);
 			for (j = 0; j < ctx->num_enabled_channels; j++) {
 				idx = ctx->channel_index[j];
-				p = logic->data + i + idx / 8;
-				curbit = *p & (1 << (idx % 8));
-				prevbit = (ctx->prev_sample[idx / 8] & ((uint8_t) 1 << (idx % 8)));
-
-				c = curbit ? '"' : '.';
-				if (ctx->spl_cnt > 1) {
-					if (curbit < prevbit)
-						c = '\\';
-					else if (curbit > prevbit)
-						c = '/';
-				}
-				g_string_append_c(ctx->lines[j], c);
+				plane = ctx->planes[idx];
+				/* No edge at the start of a line. */
+				prevbit = ctx->spl_cnt ? ctx->prev_bits[j] : plane >> 7;
+				g_string_append_len(ctx->lines[j],
+						ctx->chars[prevbit][plane], n);
+				ctx->prev_bits[j] = (plane >> (8 - n)) & 1;
+			}
+			ctx->spl_cnt += n;
 
-				if (ctx->spl_cnt == ctx->spl) {
-					/* Flush line buffers. */
+			if (ctx->spl_cnt == ctx->spl) {
+				/* Flush line buffers. */
+				for (j = 0; j < ctx->num_enabled_channels; j++) {
 					g_string_append_len(*out, ctx->lines[j]->str, ctx->lines[j]->len);
 					g_string_append_c(*out, '\n');
-					if (j == ctx->num_enabled_channels - 1 && ctx->trigger > -1) {
-						offset = ctx->trigger + ctx->trigger / 8;
-						g_string_append_printf(*out, "T:%*s^ %d\n", offset, "", ctx->trigger);
-						ctx->trigger = -1;
-					}
-					g_string_printf(ctx->lines[j], "%s:", ctx->channel_names[j]);
+					g_string_truncate(ctx->lines[j],
+							strlen(ctx->channel_names[j]) + 1);
+				}
+				if (ctx->num_enabled_channels && ctx->trigger > -1) {
+					offset = ctx->trigger + ctx->trigger / 8;
+					g_string_append_printf(*out, "T:%*s^ %d\n", offset, "", ctx->trigger);
+					ctx->trigger = -1;
 				}
-			}
-			if (ctx->spl_cnt == ctx->spl)
-				/* Line buffers were already flushed. */
 				ctx->spl_cnt = 0;
-			memcpy(ctx->prev_sample, logic->data + i, logic->unitsize);
+			}
 		}
 		break;
 	case SR_DF_END:
@@ -223,7 +258,8 @@ static int cleanup(struct sr_output *o)
 		return SR_OK;
 
 	g_free(ctx->channel_index);
-	g_free(ctx->prev_sample);
+	g_free(ctx->prev_bits);
+	g_free(ctx->planes);
 	g_free(ctx->channel_names);
 	for (i = 0; i < ctx->num_enabled_channels; i++)
 		g_string_free(ctx->lines[i], TRUE);
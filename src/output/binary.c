@@ -19,22 +19,344 @@
  */
 
 #include <config.h>
+#include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
 
 #define LOG_PREFIX "output/binary"
 
+/* A file holding the samples of a single channel. */
+struct plane {
+	const struct sr_channel *ch;
+	FILE *fp;
+	/* Logic channels: the bit holding the channel in the samples. */
+	int bit;
+	/* Analog channels: the encoding of the samples in the file. */
+	gboolean have_encoding;
+	uint8_t unitsize;
+	gboolean is_signed;
+	gboolean is_float;
+	gboolean is_bigendian;
+};
+
+struct context {
+	gboolean planar;
+	struct plane *planes;
+	unsigned int num_planes;
+	/* Logic samples held back until each plane gets a full byte. */
+	uint8_t *pending;
+	unsigned int num_pending;
+	unsigned int unitsize;
+	uint8_t *bitplanes;
+	uint8_t *buf;
+	size_t bufsize;
+};
+
+static int planes_open(const struct sr_output *o, struct context *ctx)
+{
+	struct sr_channel *ch;
+	struct plane *plane;
+	GSList *l;
+	char *name, *filename;
+
+	if (!o->filename) {
+		sr_err("Writing channels to separate files requires a file name.");
+		return SR_ERR_ARG;
+	}
+
+	ctx->planes = g_malloc0(sizeof(struct plane)
+			* g_slist_length(o->sdi->channels));
+	for (l = o->sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (!ch->enabled)
+			continue;
+		if (ch->type != SR_CHANNEL_LOGIC && ch->type != SR_CHANNEL_ANALOG)
+			continue;
+
+		/* Channel names become part of the file name. */
+		name = g_strdelimit(g_strdup(ch->name), "/\\:", '_');
+		filename = g_strdup_printf("%s.%s", o->filename, name);
+		g_free(name);
+
+		plane = &ctx->planes[ctx->num_planes++];
+		plane->ch = ch;
+		plane->bit = ch->index;
+		plane->fp = g_fopen(filename, "wb");
+		if (!plane->fp) {
+			sr_err("Failed to open '%s': %s.", filename,
+				g_strerror(errno));
+			g_free(filename);
+			return SR_ERR_IO;
+		}
+		sr_dbg("Writing channel %s to '%s'.", ch->name, filename);
+		g_free(filename);
+	}
+
+	return SR_OK;
+}
+
+static int context_free(struct sr_output *o)
+{
+	struct context *ctx;
+	unsigned int i;
+	int ret;
+
+	ctx = o->priv;
+	ret = SR_OK;
+	for (i = 0; i < ctx->num_planes; i++) {
+		if (ctx->planes[i].fp && fclose(ctx->planes[i].fp) != 0) {
+			sr_err("Failed to close channel %s: %s.",
+				ctx->planes[i].ch->name, g_strerror(errno));
+			ret = SR_ERR_IO;
+		}
+	}
+	g_free(ctx->planes);
+	g_free(ctx->pending);
+	g_free(ctx->bitplanes);
+	g_free(ctx->buf);
+	g_free(ctx);
+	o->priv = NULL;
+
+	return ret;
+}
+
+static int init(struct sr_output *o, GHashTable *options)
+{
+	struct context *ctx;
+	int ret;
+
+	if (!o || !o->sdi)
+		return SR_ERR_ARG;
+
+	ctx = g_malloc0(sizeof(struct context));
+	o->priv = ctx;
+	ctx->planar = g_variant_get_boolean(g_hash_table_lookup(options, "planar"));
+
+	if (ctx->planar && (ret = planes_open(o, ctx)) != SR_OK) {
+		context_free(o);
+		return ret;
+	}
+
+	return SR_OK;
+}
+
+static int plane_write(struct plane *plane, const void *data, size_t len)
+{
+	if (fwrite(data, 1, len, plane->fp) != len) {
+		sr_err("Failed to write channel %s: %s.", plane->ch->name,
+			g_strerror(errno));
+		return SR_ERR_IO;
+	}
+
+	return SR_OK;
+}
+
+static uint8_t *buf_get(struct context *ctx, size_t size)
+{
+	if (size > ctx->bufsize) {
+		ctx->buf = g_realloc(ctx->buf, size);
+		ctx->bufsize = size;
+	}
+
+	return ctx->buf;
+}
+
+/*
+ * Write groups of 8 samples as a byte per logic channel, the first sample
+ * in the most significant bit. A last group of fewer samples is padded.
+ */
+static int logic_write(struct context *ctx, const uint8_t *data,
+		uint64_t num_samples)
+{
+	struct plane *plane;
+	uint64_t num_groups, g, n;
+	unsigned int i;
+	uint8_t *buf;
+	int ret;
+
+	num_groups = (num_samples + 7) / 8;
+	buf = buf_get(ctx, num_groups * ctx->num_planes);
+	for (g = 0; g < num_groups; g++) {
+		n = MIN(8, num_samples - g * 8);
+		sr_output_bitplanes(data + g * 8 * ctx->unitsize, ctx->unitsize,
+				n, ctx->bitplanes);
+		for (i = 0; i < ctx->num_planes; i++) {
+			plane = &ctx->planes[i];
+			if (plane->ch->type != SR_CHANNEL_LOGIC)
+				continue;
+			buf[i * num_groups + g] = plane->bit >= 0
+				&& (unsigned int)plane->bit < ctx->unitsize * 8
+				? ctx->bitplanes[plane->bit] : 0;
+		}
+	}
+
+	for (i = 0; i < ctx->num_planes; i++) {
+		plane = &ctx->planes[i];
+		if (plane->ch->type != SR_CHANNEL_LOGIC)
+			continue;
+		ret = plane_write(plane, buf + i * num_groups, num_groups);
+		if (ret != SR_OK)
+			return ret;
+	}
+
+	return SR_OK;
+}
+
+static int pending_flush(struct context *ctx)
+{
+	int ret;
+
+	if (!ctx->num_pending)
+		return SR_OK;
+	ret = logic_write(ctx, ctx->pending, ctx->num_pending);
+	ctx->num_pending = 0;
+
+	return ret;
+}
+
+static int logic_planes(struct context *ctx,
+		const struct sr_datafeed_logic *logic)
+{
+	const uint8_t *data;
+	uint64_t num_samples, n;
+	int ret;
+
+	if (!logic->unitsize)
+		return SR_ERR_ARG;
+	if (logic->unitsize != ctx->unitsize) {
+		if ((ret = pending_flush(ctx)) != SR_OK)
+			return ret;
+		ctx->unitsize = logic->unitsize;
+		ctx->pending = g_realloc(ctx->pending, 8 * ctx->unitsize);
+		ctx->bitplanes = g_realloc(ctx->bitplanes, 8 * ctx->unitsize);
+	}
+
+	data = logic->data;
+	num_samples = logic->length / logic->unitsize;
+
+	/* Complete the group left over from the previous packet. */
+	if (ctx->num_pending) {
+		n = MIN(8 - ctx->num_pending, num_samples);
+		memcpy(ctx->pending + ctx->num_pending * ctx->unitsize, data,
+			n * ctx->unitsize);
+		ctx->num_pending += n;
+		data += n * ctx->unitsize;
+		num_samples -= n;
+		if (ctx->num_pending < 8)
+			return SR_OK;
+		if ((ret = pending_flush(ctx)) != SR_OK)
+			return ret;
+	}
+
+	n = num_samples & ~UINT64_C(7);
+	if (n && (ret = logic_write(ctx, data, n)) != SR_OK)
+		return ret;
+
+	ctx->num_pending = num_samples - n;
+	memcpy(ctx->pending, data + n * ctx->unitsize,
+		ctx->num_pending * ctx->unitsize);
+
+	return SR_OK;
+}
+
+static int analog_planes(struct context *ctx,
+		const struct sr_datafeed_analog *analog)
+{
+	const struct sr_analog_encoding *enc;
+	struct plane *plane;
+	GSList *l;
+	const uint8_t *src;
+	uint8_t *buf;
+	unsigned int num_channels, unitsize, c, i;
+	uint32_t s;
+	int ret;
+
+	enc = analog->encoding;
+	unitsize = enc->unitsize;
+	num_channels = g_slist_length(analog->meaning->channels);
+
+	for (c = 0, l = analog->meaning->channels; l; l = l->next, c++) {
+		for (i = 0; i < ctx->num_planes; i++) {
+			if (ctx->planes[i].ch == l->data)
+				break;
+		}
+		if (i == ctx->num_planes)
+			continue;
+		plane = &ctx->planes[i];
+
+		/* The file holds raw samples, in a single encoding. */
+		if (!plane->have_encoding) {
+			plane->have_encoding = TRUE;
+			plane->unitsize = enc->unitsize;
+			plane->is_signed = enc->is_signed;
+			plane->is_float = enc->is_float;
+			plane->is_bigendian = enc->is_bigendian;
+		} else if (plane->unitsize != enc->unitsize
+				|| plane->is_signed != enc->is_signed
+				|| plane->is_float != enc->is_float
+				|| plane->is_bigendian != enc->is_bigendian) {
+			sr_err("Channel %s changed its sample encoding.",
+				plane->ch->name);
+			return SR_ERR_DATA;
+		}
+
+		if (num_channels == 1) {
+			ret = plane_write(plane, analog->data,
+					analog->num_samples * unitsize);
+		} else {
+			/* Deinterleave this channel's samples. */
+			buf = buf_get(ctx, analog->num_samples * unitsize);
+			src = (const uint8_t *)analog->data + c * unitsize;
+			for (s = 0; s < analog->num_samples; s++) {
+				memcpy(buf + s * unitsize, src, unitsize);
+				src += num_channels * unitsize;
+			}
+			ret = plane_write(plane, buf, analog->num_samples * unitsize);
+		}
+		if (ret != SR_OK)
+			return ret;
+	}
+
+	return SR_OK;
+}
+
 static int receive(const struct sr_output *o, const struct sr_datafeed_packet *packet,
 		GString **out)
 {
+	struct context *ctx;
 	const struct sr_datafeed_logic *logic;
-
-	(void)o;
+	unsigned int i;
 
 	*out = NULL;
+	ctx = o->priv;
+
+	if (ctx->planar) {
+		switch (packet->type) {
+		case SR_DF_META:
+			/* Packed samples only hold the enabled channels, in order. */
+			if (sr_output_logic_packed(packet->payload, FALSE)) {
+				for (i = 0; i < ctx->num_planes; i++)
+					ctx->planes[i].bit = sr_output_logic_bit(
+						o->sdi, TRUE, ctx->planes[i].ch);
+			}
+			break;
+		case SR_DF_LOGIC:
+			return logic_planes(ctx, packet->payload);
+		case SR_DF_ANALOG:
+			return analog_planes(ctx, packet->payload);
+		case SR_DF_END:
+			return pending_flush(ctx);
+		default:
+			break;
+		}
+		return SR_OK;
+	}
+
 	if (packet->type != SR_DF_LOGIC)
 		return SR_OK;
 	logic = packet->payload;
@@ -43,12 +365,55 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 	return SR_OK;
 }
 
+static const void *payload(const struct sr_output *o,
+		const struct sr_datafeed_packet *packet, size_t *size)
+{
+	struct context *ctx;
+	const struct sr_datafeed_logic *logic;
+
+	ctx = o->priv;
+	if (ctx->planar || packet->type != SR_DF_LOGIC)
+		return NULL;
+
+	/* The output is the samples as they are. */
+	logic = packet->payload;
+	*size = logic->length;
+
+	return logic->data;
+}
+
+static struct sr_option options[] = {
+	{ "planar", "Planar", "Write each channel to a file of its own", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	if (!options[0].def) {
+		options[0].def = g_variant_new_boolean(FALSE);
+		g_variant_ref_sink(options[0].def);
+	}
+
+	return options;
+}
+
+static int cleanup(struct sr_output *o)
+{
+	if (!o || !o->sdi)
+		return SR_ERR_ARG;
+
+	return context_free(o);
+}
+
 SR_PRIV struct sr_output_module output_binary = {
 	.id = "binary",
 	.name = "Binary",
 	.desc = "Raw binary",
 	.exts = NULL,
 	.flags = 0,
-	.options = NULL,
+	.options = get_options,
+	.init = init,
 	.receive = receive,
+	.payload = payload,
+	.cleanup = cleanup,
 };
@@ -38,6 +38,10 @@ struct context {
 	char **channel_names;
 	gboolean header_done;
 	GString **lines;
+	/* The digits of the 8 samples in a bit plane. */
+	char digits[256][8];
+	uint8_t *planes;
+	unsigned int num_planes;
 };
 
 static int init(struct sr_output *o, GHashTable *options)
@@ -76,10 +80,19 @@ static int init(struct sr_output *o, GHashTable *options)
 			continue;
 		ctx->channel_index[j] = ch->index;
 		ctx->channel_names[j] = ch->name;
-		ctx->lines[j] = g_string_sized_new(80);
+		ctx->lines[j] = g_string_sized_new(strlen(ch->name) + 2
+				+ ctx->spl + ctx->spl / 8);
 		g_string_printf(ctx->lines[j], "%s:", ch->name);
+		ctx->num_planes = MAX(ctx->num_planes, (unsigned int)ch->index + 1);
 		j++;
 	}
+	ctx->num_planes = (ctx->num_planes + 7) & ~7;
+	ctx->planes = g_malloc0(ctx->num_planes);
+
+	for (i = 0; i < 256; i++) {
+		for (j = 0; j < 8; j++)
+			ctx->digits[i][j] = i & (0x80 >> j) ? '1' : '0';
+	}
 
 	return SR_OK;
 }
@@ -125,8 +138,7 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 	struct context *ctx;
 	GSList *l;
 	int idx, offset;
-	uint64_t i, j;
-	gchar *p, c;
+	uint64_t i, j, n, num_samples;
 
 	*out = NULL;
 	if (!o || !o->sdi)
@@ -143,6 +155,11 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 				continue;
 			ctx->samplerate = g_variant_get_uint64(src->data);
 		}
+		/* Packed samples only hold the enabled channels, in order. */
+		if (sr_output_logic_packed(meta, FALSE)) {
+			for (j = 0; j < ctx->num_enabled_channels; j++)
+				ctx->channel_index[j] = j;
+		}
 		break;
 	case SR_DF_TRIGGER:
 		ctx->trigger = ctx->spl_cnt;
@@ -155,32 +172,44 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 			*out = g_string_sized_new(512);
 
 		logic = packet->payload;
-		for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize) {
-			ctx->spl_cnt++;
+		if (logic->unitsize * 8 > ctx->num_planes) {
+			ctx->planes = g_realloc(ctx->planes, logic->unitsize * 8);
+			ctx->num_planes = logic->unitsize * 8;
+		}
+		num_samples = logic->length / logic->unitsize;
+		for (i = 0; i < num_samples; i += n) {
+			/* Up to the next space or the end of the line. */
+			n = MIN(8 - (ctx->spl_cnt & 7), num_samples - i);
+			if (ctx->spl > 0)
+				n = MIN(n, (uint64_t)(ctx->spl - ctx->spl_cnt));
+			sr_output_bitplanes(logic->data + i * logic->unitsize,
+					logic->unitsize, n, ctx->planes);
+			ctx->spl_cnt += n;
 			for (j = 0; j < ctx->num_enabled_channels; j++) {
 				idx = ctx->channel_index[j];
-				p = logic->data + i + idx / 8;
-				c = (*p & (1 << (idx % 8))) ? '1' : '0';
-				g_string_append_c(ctx->lines[j], c);
+				g_string_append_len(ctx->lines[j],
+						ctx->digits[ctx->planes[idx]], n);
+			}
 
-				if (ctx->spl_cnt == ctx->spl) {
-					/* Flush line buffers. */
+			if (ctx->spl_cnt == ctx->spl) {
+				/* Flush line buffers. */
+				for (j = 0; j < ctx->num_enabled_channels; j++) {
 					g_string_append_len(*out, ctx->lines[j]->str, ctx->lines[j]->len);
 					g_string_append_c(*out, '\n');
-					if (j == ctx->num_enabled_channels - 1 && ctx->trigger > -1) {
-						offset = ctx->trigger + ctx->trigger / 8;
-						g_string_append_printf(*out, "T:%*s^ %d\n", offset, "", ctx->trigger);
-						ctx->trigger = -1;
-					}
-					g_string_printf(ctx->lines[j], "%s:", ctx->channel_names[j]);
-				} else if ((ctx->spl_cnt & 7) == 0) {
-					/* Add a space every 8th bit. */
-					g_string_append_c(ctx->lines[j], ' ');
+					g_string_truncate(ctx->lines[j],
+							strlen(ctx->channel_names[j]) + 1);
+				}
+				if (ctx->num_enabled_channels && ctx->trigger > -1) {
+					offset = ctx->trigger + ctx->trigger / 8;
+					g_string_append_printf(*out, "T:%*s^ %d\n", offset, "", ctx->trigger);
+					ctx->trigger = -1;
 				}
-			}
-			if (ctx->spl_cnt == ctx->spl)
-				/* Line buffers were already flushed. */
 				ctx->spl_cnt = 0;
+			} else if ((ctx->spl_cnt & 7) == 0) {
+				/* Add a space every 8th bit. */
+				for (j = 0; j < ctx->num_enabled_channels; j++)
+					g_string_append_c(ctx->lines[j], ' ');
+			}
 		}
 		break;
 	case SR_DF_END:
@@ -211,6 +240,7 @@ static int cleanup(struct sr_output *o)
 
 	g_free(ctx->channel_index);
 	g_free(ctx->channel_names);
+	g_free(ctx->planes);
 	for (i = 0; i < ctx->num_enabled_channels; i++)
 		g_string_free(ctx->lines[i], TRUE);
 	g_free(ctx->lines);
@@ -34,6 +34,7 @@ struct context {
 	uint64_t samplecount;
 	int *channel_index;
 	GString *pretrig_buf;
+	gboolean logic_packed;
 };
 
 /**
@@ -110,7 +111,9 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 	const struct sr_datafeed_logic *logic;
 	struct context *ctx;
 	GVariant *gvar;
-	uint64_t samplerate;
+	uint64_t samplerate, length;
+	unsigned int unitsize;
+	uint8_t *data;
 	gchar c[4];
 
 	*out = NULL;
@@ -145,8 +148,25 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 					ctx->pretrig_buf->len);
 		ctx->triggered = TRUE;
 		break;
+	case SR_DF_META:
+		ctx->logic_packed = sr_output_logic_packed(packet->payload,
+				ctx->logic_packed);
+		break;
 	case SR_DF_LOGIC:
 		logic = packet->payload;
+		if (ctx->logic_packed) {
+			/* Channels keep their bits, as in unpacked samples. */
+			data = sr_output_logic_unpack(o->sdi, logic, &unitsize,
+					&length);
+			if (!ctx->triggered)
+				g_string_append_len(ctx->pretrig_buf,
+						(const gchar *)data, length);
+			else
+				*out = g_string_new_len((const gchar *)data, length);
+			g_free(data);
+			ctx->samplecount += length / unitsize;
+			break;
+		}
 		if (!ctx->triggered)
 			g_string_append_len(ctx->pretrig_buf, logic->data, logic->length);
 		else
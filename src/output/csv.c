@@ -64,10 +64,38 @@
 
 #define LOG_PREFIX "output/csv"
 
+/* Longest string format_float() writes, e.g. "-1.17549e-38". */
+#define FLOAT_MAX_LEN 16
+
+/* Longest string format_uint() writes. */
+#define UINT_MAX_LEN 20
+
 struct ctx_channel {
 	struct sr_channel *ch;
 	char *label;
 	float min, max;
+	/* Logic: the bit holding the channel in a sample. */
+	int bit;
+};
+
+enum {
+	SEGMENT_ANALOG,
+	SEGMENT_LOGIC,
+};
+
+/*
+ * A run of columns which is rendered in one step: either one analog
+ * channel, or consecutive logic channels sampled in the same byte.
+ */
+struct ctx_segment {
+	int type;
+	/* Analog: index into the analog row. Logic: byte within the sample. */
+	unsigned int index;
+	/* The (first) column in the channel list. */
+	unsigned int column;
+	/* Logic: the rendered cells of each possible byte value. */
+	size_t len;
+	char *table;
 };
 
 struct context {
@@ -89,18 +117,43 @@ struct context {
 	unsigned int num_logic_channels;
 	struct ctx_channel *channels;
 
+	/* Column map */
+	struct ctx_segment *segments;
+	unsigned int num_segments;
+	GHashTable *analog_index;
+	unsigned int *analog_column;
+	unsigned int *analog_identity;
+	unsigned int logic_bytes;
+	uint8_t *logic_mask;
+	size_t value_len, record_len;
+	size_t row_max;
+
 	/* Metadata */
 	gboolean trigger;
-	uint32_t num_samples;
 	uint32_t channel_count, logic_channel_count;
 	uint32_t channels_seen;
 	uint64_t period;
 	uint64_t sample_time;
-	uint8_t *previous_sample;
-	float *analog_samples;
-	uint8_t *logic_samples;
 	const char *xlabel;	/* Don't free: will point to a static string. */
 	const char *title;	/* Don't free: will point into the driver struct. */
+
+	/* Samples of the current frame, the buffers are reused. */
+	float *analog_samples;
+	size_t analog_size;
+	uint32_t num_analog_samples;
+	gboolean have_analog;
+	uint8_t *logic_samples;
+	size_t logic_size;
+	unsigned int logic_unitsize;
+	uint32_t num_logic_samples;
+	gboolean have_logic;
+	float *fdata;
+	size_t fdata_size;
+	unsigned int *analog_pos;
+
+	/* The last row output, for dedup. */
+	uint8_t *previous_logic;
+	float *previous_analog;
 };
 
 /*
@@ -109,6 +162,118 @@ struct context {
  *    channel LAs) as ASCII/hex etc. etc.
  */
 
+/*
+ * Precompute how each row is rendered. Analog channels get an index
+ * into the row of analog values, logic channels are grouped by the
+ * byte of the sample they are in, with a table holding the rendered
+ * cells (including separators) for each possible value of that byte.
+ */
+static void build_columns(struct context *ctx)
+{
+	struct ctx_segment *seg;
+	struct sr_channel *ch;
+	unsigned int i, j, a, bit, num_columns;
+	char *p;
+
+	num_columns = ctx->num_analog_channels + ctx->num_logic_channels;
+	ctx->value_len = strlen(ctx->value);
+	ctx->record_len = strlen(ctx->record);
+	ctx->segments = g_malloc0(sizeof(struct ctx_segment) * num_columns);
+	ctx->analog_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+	ctx->analog_column = g_malloc(sizeof(unsigned int) * ctx->num_analog_channels);
+	ctx->analog_identity = g_malloc(sizeof(unsigned int) * ctx->num_analog_channels);
+	ctx->analog_pos = g_malloc(sizeof(unsigned int) * ctx->num_analog_channels);
+	ctx->previous_analog = g_malloc0(sizeof(float) * ctx->num_analog_channels);
+
+	seg = NULL;
+	for (i = a = 0; i < num_columns; i++) {
+		ch = ctx->channels[i].ch;
+		if (ch->type == SR_CHANNEL_ANALOG) {
+			seg = &ctx->segments[ctx->num_segments++];
+			seg->type = SEGMENT_ANALOG;
+			seg->index = a;
+			seg->column = i;
+			ctx->analog_column[a] = i;
+			ctx->analog_identity[a] = a;
+			g_hash_table_insert(ctx->analog_index, ch,
+					GUINT_TO_POINTER(a + 1));
+			a++;
+		} else if (ch->type == SR_CHANNEL_LOGIC) {
+			bit = ctx->channels[i].bit;
+			if (!seg || seg->type != SEGMENT_LOGIC
+					|| seg->index != bit / 8) {
+				seg = &ctx->segments[ctx->num_segments++];
+				seg->type = SEGMENT_LOGIC;
+				seg->index = bit / 8;
+				seg->column = i;
+			}
+			seg->len += 1 + ctx->value_len;
+			ctx->logic_bytes = MAX(ctx->logic_bytes, seg->index + 1);
+		}
+	}
+
+	ctx->logic_mask = g_malloc0(ctx->logic_bytes);
+	ctx->previous_logic = g_malloc0(ctx->logic_bytes);
+	ctx->row_max = ctx->record_len;
+	if (ctx->time)
+		ctx->row_max += UINT_MAX_LEN + ctx->value_len;
+	if (ctx->do_trigger)
+		ctx->row_max += 1 + ctx->value_len;
+	for (i = 0; i < ctx->num_segments; i++) {
+		seg = &ctx->segments[i];
+		if (seg->type == SEGMENT_ANALOG) {
+			ctx->row_max += FLOAT_MAX_LEN + ctx->value_len;
+			continue;
+		}
+		ctx->row_max += seg->len;
+		seg->table = g_malloc(seg->len * 256);
+		for (a = 0; a < 256; a++) {
+			p = seg->table + a * seg->len;
+			for (j = seg->column; p < seg->table + (a + 1) * seg->len; j++) {
+				bit = ctx->channels[j].bit;
+				*p++ = a & (1 << (bit % 8)) ? '1' : '0';
+				memcpy(p, ctx->value, ctx->value_len);
+				p += ctx->value_len;
+				ctx->logic_mask[seg->index] |= 1 << (bit % 8);
+			}
+		}
+	}
+}
+
+static void free_columns(struct context *ctx)
+{
+	unsigned int i;
+
+	for (i = 0; i < ctx->num_segments; i++)
+		g_free(ctx->segments[i].table);
+	g_free(ctx->segments);
+	g_hash_table_destroy(ctx->analog_index);
+	g_free(ctx->analog_column);
+	g_free(ctx->analog_identity);
+	g_free(ctx->analog_pos);
+	g_free(ctx->logic_mask);
+	g_free(ctx->previous_logic);
+	g_free(ctx->previous_analog);
+	ctx->num_segments = 0;
+	ctx->logic_bytes = 0;
+}
+
+/* Logic samples only hold the enabled channels from now on. */
+static void set_packed(struct context *ctx)
+{
+	unsigned int i, num_columns;
+	int bit;
+
+	num_columns = ctx->num_analog_channels + ctx->num_logic_channels;
+	for (i = bit = 0; i < num_columns; i++) {
+		if (ctx->channels[i].ch->type == SR_CHANNEL_LOGIC)
+			ctx->channels[i].bit = bit++;
+	}
+
+	free_columns(ctx);
+	build_columns(ctx);
+}
+
 static int init(struct sr_output *o, GHashTable *options)
 {
 	unsigned int i, analog_channels, logic_channels;
@@ -179,7 +344,7 @@ static int init(struct sr_output *o, GHashTable *options)
 		sr_info("Outputting %d logic values", logic_channels);
 		ctx->num_logic_channels = logic_channels;
 	}
-	ctx->channels = g_malloc(sizeof(struct ctx_channel)
+	ctx->channels = g_malloc0(sizeof(struct ctx_channel)
 		* (ctx->num_analog_channels + ctx->num_logic_channels));
 
 	/* Once more to map the enabled channels. */
@@ -193,14 +358,18 @@ static int init(struct sr_output *o, GHashTable *options)
 			} else if (ch->type == SR_CHANNEL_LOGIC) {
 				ctx->channels[i].min = 0;
 				ctx->channels[i].max = 1;
+				ctx->channels[i].bit = ch->index;
 			} else {
 				sr_warn("Unknown channel type %d.", ch->type);
 			}
 			if (ctx->label_do && ctx->label_names)
 				ctx->channels[i].label = ch->name;
+			else if (ctx->label_do && ch->type == SR_CHANNEL_LOGIC)
+				ctx->channels[i].label = "logic";
 			ctx->channels[i++].ch = ch;
 		}
 	}
+	build_columns(ctx);
 
 	return SR_OK;
 }
@@ -282,6 +451,218 @@ static GString *gen_header(const struct sr_output *o,
 	return header;
 }
 
+static const double pow10_table[] = {
+	1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+};
+
+static char *format_uint(char *p, uint64_t value)
+{
+	char digits[UINT_MAX_LEN];
+	unsigned int n;
+
+	n = 0;
+	do {
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	while (n)
+		*p++ = digits[--n];
+
+	return p;
+}
+
+/*
+ * Write a value the way printf("%g") does. The common case of values
+ * printed without an exponent is handled here, everything else (and
+ * values too close to a rounding tie to be sure) goes to printf.
+ */
+static char *format_float(char *p, float value)
+{
+	double a, scaled, frac;
+	uint32_t m;
+	int e, n, i;
+	char digits[6];
+
+	a = fabs(value);
+	if (!(a >= 1e-4 && a < 1e6))
+		return p + sprintf(p, "%g", value);
+
+	/* Scale to six significant digits. */
+	for (e = 5; e > -4 && a < pow10_table[e + 4]; e--)
+		;
+	scaled = a * pow10_table[5 - e + 4];
+	frac = scaled - floor(scaled);
+	if (fabs(frac - 0.5) < 1e-6)
+		return p + sprintf(p, "%g", value);
+	m = scaled + 0.5;
+	if (m >= 1000000) {
+		m /= 10;
+		if (++e > 5)
+			return p + sprintf(p, "%g", value);
+	}
+	for (i = 5; i >= 0; i--) {
+		digits[i] = '0' + m % 10;
+		m /= 10;
+	}
+
+	/* Drop trailing zeroes after the decimal point. */
+	n = 6;
+	while (n > e + 1 && digits[n - 1] == '0')
+		n--;
+
+	if (value < 0)
+		*p++ = '-';
+	if (e < 0) {
+		*p++ = '0';
+		*p++ = '.';
+		for (i = e + 1; i < 0; i++)
+			*p++ = '0';
+		memcpy(p, digits, n);
+		return p + n;
+	}
+	for (i = 0; i < n; i++) {
+		if (i == e + 1)
+			*p++ = '.';
+		*p++ = digits[i];
+	}
+
+	return p;
+}
+
+static void append_labels(struct context *ctx, GString *out)
+{
+	const char *label;
+	unsigned int i, num_channels;
+	gsize len;
+
+	len = out->len;
+	if (ctx->time) {
+		label = ctx->label_names ? "Time" : ctx->xlabel;
+		g_string_append(out, label ? label : "");
+		g_string_append(out, ctx->value);
+	}
+	num_channels = ctx->num_analog_channels + ctx->num_logic_channels;
+	for (i = 0; i < num_channels; i++) {
+		label = ctx->channels[i].label;
+		g_string_append(out, label ? label : "");
+		g_string_append(out, ctx->value);
+	}
+	if (ctx->do_trigger) {
+		g_string_append(out, "Trigger");
+		g_string_append(out, ctx->value);
+	}
+	/* Drop last separator. */
+	if (out->len > len)
+		g_string_truncate(out, out->len - ctx->value_len);
+	g_string_append(out, ctx->record);
+
+	ctx->label_do = FALSE;
+}
+
+static gboolean row_is_previous(const struct context *ctx,
+		const uint8_t *logic, const float *analog, const unsigned int *pos)
+{
+	unsigned int i;
+
+	for (i = 0; i < ctx->logic_bytes; i++) {
+		if ((logic[i] ^ ctx->previous_logic[i]) & ctx->logic_mask[i])
+			return FALSE;
+	}
+	for (i = 0; i < ctx->num_analog_channels; i++) {
+		if (memcmp(&analog[pos[i]], &ctx->previous_analog[i], sizeof(float)))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void row_save(struct context *ctx,
+		const uint8_t *logic, const float *analog, const unsigned int *pos)
+{
+	unsigned int i;
+
+	if (ctx->logic_bytes)
+		memcpy(ctx->previous_logic, logic, ctx->logic_bytes);
+	for (i = 0; i < ctx->num_analog_channels; i++)
+		ctx->previous_analog[i] = analog[pos[i]];
+}
+
+/*
+ * Render rows of samples. Logic samples are rows of @a unitsize bytes,
+ * analog samples rows of @a stride values, with the value of analog
+ * channel i at position @a pos[i].
+ */
+static void render_rows(struct context *ctx, const uint8_t *logic,
+		unsigned int unitsize, const float *analog, unsigned int stride,
+		const unsigned int *pos, uint32_t num_samples, GString **out)
+{
+	const struct ctx_segment *seg;
+	struct ctx_channel *col;
+	const uint8_t *logic_row;
+	const float *analog_row;
+	unsigned int s;
+	uint32_t i;
+	gsize len;
+	float value;
+	char *p, *row;
+
+	if (!*out)
+		*out = g_string_sized_new(MIN(num_samples * ctx->row_max, 1 << 20));
+	if (ctx->label_do)
+		append_labels(ctx, *out);
+
+	for (i = 0; i < num_samples; i++) {
+		ctx->sample_time += ctx->period;
+		logic_row = logic ? logic + i * unitsize : NULL;
+		analog_row = analog ? analog + i * stride : NULL;
+		if (ctx->dedup) {
+			if (i > 0 && i < num_samples - 1 &&
+			    row_is_previous(ctx, logic_row, analog_row, pos))
+				continue;
+			row_save(ctx, logic_row, analog_row, pos);
+		}
+
+		len = (*out)->len;
+		g_string_set_size(*out, len + ctx->row_max);
+		row = p = (*out)->str + len;
+
+		if (ctx->time) {
+			p = format_uint(p, ctx->sample_time);
+			memcpy(p, ctx->value, ctx->value_len);
+			p += ctx->value_len;
+		}
+		for (s = 0; s < ctx->num_segments; s++) {
+			seg = &ctx->segments[s];
+			if (seg->type == SEGMENT_LOGIC) {
+				memcpy(p, seg->table + logic_row[seg->index] * seg->len,
+					seg->len);
+				p += seg->len;
+				continue;
+			}
+			value = analog_row[pos[seg->index]];
+			col = &ctx->channels[seg->column];
+			col->max = fmax(value, col->max);
+			col->min = fmin(value, col->min);
+			p = format_float(p, value);
+			memcpy(p, ctx->value, ctx->value_len);
+			p += ctx->value_len;
+		}
+		if (ctx->do_trigger) {
+			*p++ = ctx->trigger ? '1' : '0';
+			memcpy(p, ctx->value, ctx->value_len);
+			p += ctx->value_len;
+			ctx->trigger = FALSE;
+		}
+		/* Drop last separator. */
+		if (p > row)
+			p -= ctx->value_len;
+		memcpy(p, ctx->record, ctx->record_len);
+		p += ctx->record_len;
+
+		g_string_truncate(*out, p - (*out)->str);
+	}
+}
+
 /*
  * Analog devices can have samples of different types. Since each
  * packet has only one meaning, it is restricted to having at most one
@@ -304,56 +685,79 @@ static GString *gen_header(const struct sr_output *o,
  * All of the data for a channel is assumed to be in one frame;
  * otherwise the data in the second packet will overwrite the data in
  * the first packet.
+ *
+ * A packet which holds all the channels we output makes up complete
+ * rows on its own; these are output right away, without saving them.
  */
 static void process_analog(struct context *ctx,
-			   const struct sr_datafeed_analog *analog)
+			   const struct sr_datafeed_analog *analog, GString **out)
 {
-	int ret;
-	unsigned int i, j, c, ch, num_channels;
+	unsigned int c, a, num_channels, matched;
 	struct sr_analog_meaning *meaning;
+	uint32_t i, num_samples;
+	size_t size;
 	GSList *l;
-	float *fdata = NULL;
 
 	meaning = analog->meaning;
 	num_channels = g_slist_length(meaning->channels);
-	ctx->channels_seen += num_channels;
-	sr_dbg("Processing packet of %u analog channels", num_channels);
-	fdata = g_malloc(analog->num_samples * num_channels * sizeof(float));
-	if ((ret = sr_analog_to_float(analog, fdata)) != SR_OK)
+	size = (size_t)analog->num_samples * num_channels;
+	if (ctx->fdata_size < size) {
+		ctx->fdata = g_realloc(ctx->fdata, size * sizeof(float));
+		ctx->fdata_size = size;
+	}
+	if (sr_analog_to_float(analog, ctx->fdata) != SR_OK)
 		sr_warn("Problems converting data to floating point values.");
 
-	if (!ctx->analog_samples) {
-		ctx->analog_samples = g_malloc(sizeof(float) * analog->num_samples
-                                               * ctx->num_analog_channels);
-		if (!ctx->num_samples)
-			ctx->num_samples = analog->num_samples;
+	matched = 0;
+	for (a = 0; a < ctx->num_analog_channels; a++)
+		ctx->analog_pos[a] = G_MAXUINT;
+	for (l = meaning->channels, c = 0; l; l = l->next, c++) {
+		a = GPOINTER_TO_UINT(g_hash_table_lookup(ctx->analog_index, l->data));
+		if (!a--)
+			continue;
+		ctx->analog_pos[a] = c;
+		matched++;
+		if (ctx->label_do && !ctx->label_names) {
+			g_free(ctx->channels[ctx->analog_column[a]].label);
+			sr_analog_unit_to_string(analog,
+				&ctx->channels[ctx->analog_column[a]].label);
+		}
 	}
-	if (ctx->num_samples != analog->num_samples)
-		sr_warn("Expecting %u analog samples, got %u.",
-			ctx->num_samples, analog->num_samples);
-
-	for (j = ch = 0; ch < ctx->num_analog_channels; j++) {
-		if (ctx->channels[j].ch->type == SR_CHANNEL_ANALOG) {
-			sr_dbg("Looking for channel %s", 
-				ctx->channels[j].ch->name);
-			for (l = meaning->channels, c = 0; l; l = l->next, c++) {
-				sr_dbg("Checking %s",
-					((struct sr_channel *) l->data)->name);
-				if (ctx->channels[j].ch == l->data) {
-					if (ctx->label_do && !ctx->label_names) {
-						sr_analog_unit_to_string(
-							analog,
-							&ctx->channels[j].label);
-					}
-					for (i = 0; i < analog->num_samples; i++)
- 						ctx->analog_samples[i * ctx->num_analog_channels + ch] = fdata[i * num_channels + c];
-					break;
-				}
-			}
-			ch++;
+
+	if (matched && matched == ctx->num_analog_channels &&
+	    !ctx->num_logic_channels && !ctx->channels_seen) {
+		render_rows(ctx, NULL, 0, ctx->fdata, num_channels,
+			ctx->analog_pos, analog->num_samples, out);
+		return;
+	}
+
+	ctx->channels_seen += num_channels;
+	if (!matched)
+		return;
+
+	if (!ctx->have_analog) {
+		size = (size_t)analog->num_samples * ctx->num_analog_channels;
+		if (ctx->analog_size < size) {
+			ctx->analog_samples = g_realloc(ctx->analog_samples,
+				size * sizeof(float));
+			ctx->analog_size = size;
 		}
+		memset(ctx->analog_samples, 0, size * sizeof(float));
+		ctx->num_analog_samples = analog->num_samples;
+		ctx->have_analog = TRUE;
+	}
+	if (ctx->num_analog_samples != analog->num_samples)
+		sr_warn("Expecting %u analog samples, got %u.",
+			ctx->num_analog_samples, analog->num_samples);
+	num_samples = MIN(ctx->num_analog_samples, analog->num_samples);
+
+	for (a = 0; a < ctx->num_analog_channels; a++) {
+		if ((c = ctx->analog_pos[a]) == G_MAXUINT)
+			continue;
+		for (i = 0; i < num_samples; i++)
+			ctx->analog_samples[i * ctx->num_analog_channels + a] =
+				ctx->fdata[i * num_channels + c];
 	}
-	g_free(fdata);
 }
 
 /*
@@ -361,145 +765,68 @@ static void process_analog(struct context *ctx,
  * strictly required. This allows us to process mixed signals properly.
  */
 static void process_logic(struct context *ctx,
-			  const struct sr_datafeed_logic *logic)
+			  const struct sr_datafeed_logic *logic, GString **out)
 {
-	unsigned int i, j, ch, num_samples;
-	int idx;
-	uint8_t *sample;
+	uint32_t num_samples;
+
+	if (!ctx->num_logic_channels) {
+		ctx->channels_seen += ctx->logic_channel_count;
+		return;
+	}
+	if (logic->unitsize < ctx->logic_bytes) {
+		sr_warn("Logic packet has %u bytes per sample, need %u.",
+			logic->unitsize, ctx->logic_bytes);
+		return;
+	}
 
 	num_samples = logic->length / logic->unitsize;
-	ctx->channels_seen += ctx->logic_channel_count;
-	sr_dbg("Logic packet had %d channels", logic->unitsize * 8);
-	if (!ctx->logic_samples) {
-		ctx->logic_samples = g_malloc(num_samples * ctx->num_logic_channels);
-		if (!ctx->num_samples)
-			ctx->num_samples = num_samples;
+	if (!ctx->num_analog_channels) {
+		render_rows(ctx, logic->data, logic->unitsize, NULL, 0, NULL,
+			num_samples, out);
+		return;
 	}
-	if (ctx->num_samples != num_samples)
+
+	ctx->channels_seen += ctx->logic_channel_count;
+	if (ctx->have_logic && ctx->num_logic_samples != num_samples)
 		sr_warn("Expecting %u samples, got %u",
-			ctx->num_samples, num_samples);
-
-	for (j = ch = 0; ch < ctx->num_logic_channels; j++) {
-		if (ctx->channels[j].ch->type == SR_CHANNEL_LOGIC) {
-			for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize) {
-				sample = logic->data + i;
-				idx = ctx->channels[ch].ch->index;
-				if (ctx->label_do && !ctx->label_names)
-					ctx->channels[i].label = "logic";
-				ctx->logic_samples[i * ctx->num_logic_channels + ch] = sample[idx / 8] & (1 << (idx % 8));
-			}
-			ch++;
-		}
+			ctx->num_logic_samples, num_samples);
+	if (ctx->logic_size < logic->length) {
+		ctx->logic_samples = g_realloc(ctx->logic_samples, logic->length);
+		ctx->logic_size = logic->length;
 	}
+	memcpy(ctx->logic_samples, logic->data, logic->length);
+	ctx->logic_unitsize = logic->unitsize;
+	ctx->num_logic_samples = num_samples;
+	ctx->have_logic = TRUE;
 }
 
 static void dump_saved_values(struct context *ctx, GString **out)
 {
-	unsigned int i, ch, analog_size, num_channels;
-	float *analog_sample, value;
-	uint8_t *logic_sample;
+	uint32_t num_samples;
 
 	/* If we haven't seen samples we're expecting, skip them. */
-	if ((ctx->num_analog_channels && !ctx->analog_samples) ||
-	    (ctx->num_logic_channels && !ctx->logic_samples)) {
+	if ((ctx->num_analog_channels && !ctx->have_analog) ||
+	    (ctx->num_logic_channels && !ctx->have_logic)) {
 		sr_warn("Discarding partial packet");
 	} else {
-		sr_info("Dumping %u samples", ctx->num_samples);
-
-		*out = g_string_sized_new(512);
-		num_channels =
-		    ctx->num_logic_channels + ctx->num_analog_channels;
-
-		if (ctx->label_do) {
-			if (ctx->time)
-				g_string_append_printf(*out, "%s%s",
-					ctx->label_names ? "Time" :
-					ctx->xlabel, ctx->value);
-			for (i = 0; i < num_channels; i++) {
-				g_string_append_printf(*out, "%s%s",
-					ctx->channels[i].label, ctx->value);
-				if (ctx->channels[i].ch->type == SR_CHANNEL_ANALOG
-						&& ctx->label_names)
-					g_free(ctx->channels[i].label);
-			}
-			if (ctx->do_trigger)
-				g_string_append_printf(*out, "Trigger%s",
-						       ctx->value);
-			/* Drop last separator. */
-			g_string_truncate(*out, (*out)->len - 1);
-			g_string_append(*out, ctx->record);
-
-			ctx->label_do = FALSE;
-		}
-
-		analog_size = ctx->num_analog_channels * sizeof(float);
-		if (ctx->dedup && !ctx->previous_sample)
-			ctx->previous_sample = g_malloc0(analog_size + ctx->num_logic_channels);
-
-		for (i = 0; i < ctx->num_samples; i++) {
-			ctx->sample_time += ctx->period;
-			if (ctx->dedup) {
-                                analog_sample = &ctx->analog_samples[
-                                        i * ctx->num_analog_channels];
-                                logic_sample = &ctx->logic_samples[
-                                        i * ctx->num_logic_channels];
-
-				if (i > 0 && i < ctx->num_samples - 1 &&
-				    !memcmp(logic_sample, ctx->previous_sample,
-					    ctx->num_logic_channels) &&
-				    !memcmp(analog_sample,
-					    ctx->previous_sample +
-					    ctx->num_logic_channels,
-					    analog_size))
-					continue;
-				memcpy(ctx->previous_sample, logic_sample,
-				       ctx->num_logic_channels);
-				memcpy(ctx->previous_sample
-				       + ctx->num_logic_channels,
-				       analog_sample, analog_size);
-			}
-
-			if (ctx->time)
-				g_string_append_printf(*out, "%lu%s",
-					ctx->sample_time, ctx->value);
-
-			for (ch = 0; ch < num_channels; ch++) {
-				if (ctx->channels[ch].ch->type == SR_CHANNEL_ANALOG) {
-					value = ctx->analog_samples[i * ctx->num_analog_channels + ch];
-					ctx->channels[ch].max =
-					    fmax(value, ctx->channels[ch].max);
-					ctx->channels[ch].min =
-					    fmin(value, ctx->channels[ch].min);
-					g_string_append_printf(*out, "%g%s",
-						value, ctx->value);
-				} else if (ctx->channels[ch].ch->type == SR_CHANNEL_LOGIC) {
-					g_string_append_printf(*out, "%c%s",
-							       ctx->logic_samples[i * ctx->num_logic_channels + ch] ? '1' : '0', ctx->value);
-				} else {
-					sr_warn("Unexpected channel type: %d",
-						ctx->channels[ch].ch->type);
-				}
-			}
-
-			if (ctx->do_trigger) {
-				g_string_append_printf(*out, "%d%s",
-					ctx->trigger, ctx->value);
-				ctx->trigger = FALSE;
-			}
-			g_string_truncate(*out, (*out)->len - 1);
-			g_string_append(*out, ctx->record);
-		}
+		if (!ctx->num_logic_channels)
+			num_samples = ctx->num_analog_samples;
+		else if (!ctx->num_analog_channels)
+			num_samples = ctx->num_logic_samples;
+		else
+			num_samples = MIN(ctx->num_analog_samples,
+				ctx->num_logic_samples);
+		sr_info("Dumping %u samples", num_samples);
+
+		render_rows(ctx, ctx->logic_samples, ctx->logic_unitsize,
+			ctx->analog_samples, ctx->num_analog_channels,
+			ctx->analog_identity, num_samples, out);
 	}
 
-	/* Discard all of the working space. */
-	g_free(ctx->previous_sample);
-	g_free(ctx->analog_samples);
-	g_free(ctx->logic_samples);
+	/* Start over with the next set of samples. */
 	ctx->channels_seen = 0;
-	ctx->num_samples = 0;
-	ctx->previous_sample = NULL;
-	ctx->analog_samples = NULL;
-	ctx->logic_samples = NULL;
+	ctx->have_analog = FALSE;
+	ctx->have_logic = FALSE;
 }
 
 static void save_gnuplot(struct context *ctx)
@@ -565,34 +892,41 @@ static int receive(const struct sr_output *o,
 	if (!(ctx = o->priv))
 		return SR_ERR_ARG;
 
-	sr_dbg("Got packet of type %d", packet->type);
 	switch (packet->type) {
 	case SR_DF_HEADER:
 		*out = gen_header(o, packet->payload);
 		break;
+	case SR_DF_META:
+		if (sr_output_logic_packed(packet->payload, FALSE))
+			set_packed(ctx);
+		break;
 	case SR_DF_TRIGGER:
 		ctx->trigger = TRUE;
 		break;
 	case SR_DF_LOGIC:
-		process_logic(ctx, packet->payload);
+		process_logic(ctx, packet->payload, out);
 		break;
 	case SR_DF_ANALOG:
-		process_analog(ctx, packet->payload);
+		process_analog(ctx, packet->payload, out);
 		break;
 	case SR_DF_FRAME_BEGIN:
-		*out = g_string_new(ctx->frame);
-		/* And then fall through to... */
 	case SR_DF_END:
 		/* Got to end of frame/session with part of the data. */
 		if (ctx->channels_seen)
-			ctx->channels_seen = ctx->channel_count;
+			dump_saved_values(ctx, out);
 		if (*ctx->gnuplot)
 			save_gnuplot(ctx);
+		if (packet->type == SR_DF_FRAME_BEGIN) {
+			if (*out)
+				g_string_append(*out, ctx->frame);
+			else
+				*out = g_string_new(ctx->frame);
+		}
 		break;
 	}
 
 	/* If we've got them all, dump the values. */
-	if (ctx->channels_seen >= ctx->channel_count)
+	if (ctx->channels_seen && ctx->channels_seen >= ctx->channel_count)
 		dump_saved_values(ctx, out);
 
 	return SR_OK;
@@ -601,17 +935,28 @@ static int receive(const struct sr_output *o,
 static int cleanup(struct sr_output *o)
 {
 	struct context *ctx;
+	unsigned int i, num_channels;
 
 	if (!o || !o->sdi)
 		return SR_ERR_ARG;
 
 	if (o->priv) {
 		ctx = o->priv;
+		num_channels = ctx->num_analog_channels + ctx->num_logic_channels;
+		for (i = 0; i < num_channels; i++) {
+			if (ctx->channels[i].ch->type == SR_CHANNEL_ANALOG
+					&& !ctx->label_names)
+				g_free(ctx->channels[i].label);
+		}
+		free_columns(ctx);
+		g_free(ctx->analog_samples);
+		g_free(ctx->logic_samples);
+		g_free(ctx->fdata);
+		g_free((gpointer)ctx->value);
 		g_free((gpointer)ctx->record);
 		g_free((gpointer)ctx->frame);
 		g_free((gpointer)ctx->comment);
 		g_free((gpointer)ctx->gnuplot);
-		g_free(ctx->previous_sample);
 		g_free(ctx->channels);
 		g_free(o->priv);
 		o->priv = NULL;
@@ -37,6 +37,7 @@
 struct context {
 	uint64_t samplerate;
 	uint64_t num_samples;
+	gboolean logic_packed;
 };
 
 static int init(struct sr_output *o, GHashTable *options)
@@ -95,7 +96,10 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 	const struct sr_datafeed_logic *logic;
 	const struct sr_config *src;
 	GSList *l;
-	unsigned int i, j;
+	const uint8_t *data;
+	uint8_t *unpacked;
+	uint64_t i, length;
+	unsigned int j, unitsize;
 	uint8_t c;
 
 	*out = NULL;
@@ -111,6 +115,8 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 			if (src->key == SR_CONF_SAMPLERATE)
 				ctx->samplerate = g_variant_get_uint64(src->data);
 		}
+		ctx->logic_packed = sr_output_logic_packed(meta,
+				ctx->logic_packed);
 		break;
 	case SR_DF_LOGIC:
 		logic = packet->payload;
@@ -119,14 +125,25 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 			*out = gen_header(o->sdi, ctx);
 		} else
 			*out = g_string_sized_new(512);
-		for (i = 0; i <= logic->length - logic->unitsize; i += logic->unitsize) {
-			for (j = 0; j < logic->unitsize; j++) {
+		unpacked = NULL;
+		if (ctx->logic_packed) {
+			/* Channels keep their bits, as in unpacked samples. */
+			data = unpacked = sr_output_logic_unpack(o->sdi, logic,
+					&unitsize, &length);
+		} else {
+			data = logic->data;
+			unitsize = logic->unitsize;
+			length = logic->length;
+		}
+		for (i = 0; i + unitsize <= length; i += unitsize) {
+			for (j = 0; j < unitsize; j++) {
 				/* The OLS format wants the samples presented MSB first. */
-				c = *((uint8_t *)logic->data + i + logic->unitsize - 1 - j);
+				c = data[i + unitsize - 1 - j];
 				g_string_append_printf(*out, "%02x", c);
 			}
 			g_string_append_printf(*out, "@%"PRIu64"\n", ctx->num_samples++);
 		}
+		g_free(unpacked);
 		break;
 	}
 
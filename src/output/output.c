@@ -64,6 +64,7 @@ extern SR_PRIV struct sr_output_module output_csv;
 extern SR_PRIV struct sr_output_module output_analog;
 extern SR_PRIV struct sr_output_module output_srzip;
 extern SR_PRIV struct sr_output_module output_wav;
+extern SR_PRIV struct sr_output_module output_parquet;
 /* @endcond */
 
 static const struct sr_output_module *output_module_list[] = {
@@ -78,6 +79,7 @@ static const struct sr_output_module *output_module_list[] = {
 	&output_analog,
 	&output_srzip,
 	&output_wav,
+	&output_parquet,
 	NULL,
 };
 
@@ -356,4 +358,161 @@ SR_API int sr_output_free(const struct sr_output *o)
 	return ret;
 }
 
+/**
+ * Split up to 8 logic samples into bit planes.
+ *
+ * For each channel, one byte holds its state in the consecutive samples,
+ * the first sample in the most significant bit. Text output modules use
+ * this to render several samples of a channel with a single table lookup.
+ *
+ * @param data The samples.
+ * @param unitsize The number of bytes per sample.
+ * @param num_samples The number of samples, at most 8. Unused low bits
+ *                    of the bit planes are cleared.
+ * @param planes Array of unitsize * 8 bytes, which will receive the bit
+ *               plane of each channel, indexed by the channel index.
+ *
+ * @private
+ */
+SR_PRIV void sr_output_bitplanes(const uint8_t *data, unsigned int unitsize,
+		unsigned int num_samples, uint8_t *planes)
+{
+	unsigned int i, s, b;
+	uint64_t x, t;
+
+	for (i = 0; i < unitsize; i++) {
+		/* An 8x8 bit matrix, the first sample in the top byte... */
+		x = 0;
+		for (s = 0; s < num_samples; s++)
+			x |= (uint64_t)data[s * unitsize + i] << (56 - 8 * s);
+		/* ...transposed in three steps. */
+		t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+		x ^= t ^ (t << 7);
+		t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+		x ^= t ^ (t << 14);
+		t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+		x ^= t ^ (t << 28);
+		for (b = 0; b < 8; b++)
+			planes[i * 8 + b] = x >> (8 * b);
+	}
+}
+
+/**
+ * Get the bit holding a logic channel in the samples.
+ *
+ * @param sdi The device instance the channel belongs to.
+ * @param packed Whether the samples only hold the enabled logic channels,
+ *               as announced by SR_CONF_LOGIC_PACKED.
+ * @param ch The logic channel.
+ *
+ * @return The bit number, or -1 if a packed stream doesn't hold @p ch.
+ *
+ * @private
+ */
+SR_PRIV int sr_output_logic_bit(const struct sr_dev_inst *sdi,
+		gboolean packed, const struct sr_channel *ch)
+{
+	const struct sr_channel *c;
+	GSList *l;
+	int bit;
+
+	if (!packed)
+		return ch->index;
+	if (!ch->enabled)
+		return -1;
+
+	bit = 0;
+	for (l = sdi->channels; l && l->data != ch; l = l->next) {
+		c = l->data;
+		if (c->type == SR_CHANNEL_LOGIC && c->enabled)
+			bit++;
+	}
+
+	return l ? bit : -1;
+}
+
+/**
+ * Check an SR_DF_META packet for a change of the logic sample layout.
+ *
+ * @param meta The payload of the SR_DF_META packet.
+ * @param packed The current layout.
+ *
+ * @return The value of SR_CONF_LOGIC_PACKED in @p meta, or @p packed if
+ *         it isn't there.
+ *
+ * @private
+ */
+SR_PRIV gboolean sr_output_logic_packed(const struct sr_datafeed_meta *meta,
+		gboolean packed)
+{
+	const struct sr_config *src;
+	GSList *l;
+
+	for (l = meta->config; l; l = l->next) {
+		src = l->data;
+		if (src->key == SR_CONF_LOGIC_PACKED)
+			packed = g_variant_get_boolean(src->data);
+	}
+
+	return packed;
+}
+
+/**
+ * Unpack logic samples.
+ *
+ * Moves the enabled logic channels from packed samples back to the bits
+ * of their channel indices, for formats which store the samples as the
+ * device sends them. Disabled channels read as low.
+ *
+ * @param sdi The device instance the samples belong to.
+ * @param logic The packed samples.
+ * @param unitsize Will receive the number of bytes per unpacked sample.
+ * @param length Will receive the number of bytes of unpacked samples.
+ *
+ * @return The unpacked samples, which must be freed with g_free().
+ *
+ * @private
+ */
+SR_PRIV uint8_t *sr_output_logic_unpack(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_logic *logic, unsigned int *unitsize,
+		uint64_t *length)
+{
+	const struct sr_channel *ch;
+	const uint8_t *in;
+	uint8_t *out;
+	unsigned int *bits, num_bits, width, i;
+	uint64_t num_samples, s;
+	GSList *l;
+
+	/* Packed bit i holds the i-th enabled channel, which goes to bits[i]. */
+	bits = g_malloc(sizeof(unsigned int) * (g_slist_length(sdi->channels) + 1));
+	num_bits = 0;
+	width = 1;
+	for (l = sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (ch->type != SR_CHANNEL_LOGIC)
+			continue;
+		width = MAX(width, (unsigned int)ch->index / 8 + 1);
+		if (ch->enabled)
+			bits[num_bits++] = ch->index;
+	}
+	num_bits = MIN(num_bits, logic->unitsize * 8);
+
+	num_samples = logic->unitsize ? logic->length / logic->unitsize : 0;
+	*unitsize = width;
+	*length = num_samples * width;
+	out = g_malloc0(*length + 1);
+
+	in = logic->data;
+	for (s = 0; s < num_samples; s++, in += logic->unitsize) {
+		for (i = 0; i < num_bits; i++) {
+			if (in[i / 8] & (1 << (i % 8)))
+				out[s * width + bits[i] / 8] |= 1 << (bits[i] % 8);
+		}
+	}
+	g_free(bits);
+
+	return out;
+}
+
 /** @} */
@@ -0,0 +1,762 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Apache Parquet output, without compression.
+ *
+ * Every enabled channel becomes a column, and every sample a row. Logic
+ * channels are BOOLEAN columns in the RLE/bit-packing hybrid encoding,
+ * which keeps the long runs of logic signals small. Analog channels are
+ * plain FLOAT columns. Rows are written in row groups of a fixed size,
+ * each column chunk with min/max statistics, so readers can skip row
+ * groups without decoding them.
+ *
+ * The columns are optional. A channel which sends no samples at all, or
+ * fewer samples than others by the end of the capture, is padded with
+ * nulls.
+ *
+ * The file metadata is Thrift compact protocol, as the format requires;
+ * the few structures needed are encoded by hand below.
+ */
+
+#include <config.h>
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "output/parquet"
+
+#define DEFAULT_ROWS (1024 * 1024)
+/* Data pages of a column chunk must stay below 2 GiB. */
+#define MAX_ROWS (256 * 1024 * 1024)
+
+/*
+ * Pad channels without samples once others are this many row groups,
+ * and at least this many rows, ahead.
+ */
+#define MAX_LAG_GROUPS 4
+#define MIN_LAG_ROWS (1024 * 1024)
+
+#define PARQUET_MAGIC "PAR1"
+
+/* Parquet physical types, repetition types and encodings. */
+#define TYPE_BOOLEAN 0
+#define TYPE_FLOAT 4
+#define REPETITION_OPTIONAL 1
+#define ENCODING_PLAIN 0
+#define ENCODING_RLE 3
+#define PAGE_DATA 0
+#define CODEC_UNCOMPRESSED 0
+
+/* Thrift compact protocol types. */
+#define T_I32 5
+#define T_I64 6
+#define T_BINARY 8
+#define T_LIST 9
+#define T_STRUCT 12
+
+/* Where a column chunk went, for the file metadata. */
+struct chunk {
+	uint64_t offset;
+	uint64_t size;
+	uint64_t num_values;
+	uint64_t null_count;
+	gboolean have_stats;
+	float min;
+	float max;
+};
+
+struct column {
+	const struct sr_channel *ch;
+	/* Logic channels: the bit holding the channel in the samples. */
+	int bit;
+	/* Values for the next row groups, one byte each for logic channels. */
+	uint8_t *values;
+	uint64_t num_values;
+	uint64_t size;
+	GArray *chunks;
+	gboolean has_data;
+	gboolean padded;
+};
+
+struct context {
+	uint64_t rows;
+	uint64_t max_lag;
+	struct column *columns;
+	unsigned int num_columns;
+	uint64_t samplerate;
+	int64_t trigger;
+	gboolean magic_done;
+	uint64_t offset;
+	uint64_t num_rows;
+	GArray *row_groups;
+	float *fbuf;
+	size_t fbuf_size;
+};
+
+/* A Thrift compact protocol encoder, tracking the last field of each struct. */
+struct thrift {
+	GString *s;
+	int16_t last[8];
+	unsigned int depth;
+};
+
+static void varint(GString *s, uint64_t v)
+{
+	while (v >= 0x80) {
+		g_string_append_c(s, (v & 0x7f) | 0x80);
+		v >>= 7;
+	}
+	g_string_append_c(s, v);
+}
+
+static uint64_t zigzag(int64_t v)
+{
+	return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static void t_field(struct thrift *t, int type, int16_t id)
+{
+	int16_t delta;
+
+	delta = id - t->last[t->depth];
+	if (delta > 0 && delta <= 15) {
+		g_string_append_c(t->s, (delta << 4) | type);
+	} else {
+		g_string_append_c(t->s, type);
+		varint(t->s, zigzag(id));
+	}
+	t->last[t->depth] = id;
+}
+
+static void t_i32(struct thrift *t, int16_t id, int32_t v)
+{
+	t_field(t, T_I32, id);
+	varint(t->s, zigzag(v));
+}
+
+static void t_i64(struct thrift *t, int16_t id, int64_t v)
+{
+	t_field(t, T_I64, id);
+	varint(t->s, zigzag(v));
+}
+
+static void t_binary(struct thrift *t, int16_t id, const void *data, size_t len)
+{
+	t_field(t, T_BINARY, id);
+	varint(t->s, len);
+	g_string_append_len(t->s, data, len);
+}
+
+static void t_string(struct thrift *t, int16_t id, const char *str)
+{
+	t_binary(t, id, str, strlen(str));
+}
+
+static void t_list(struct thrift *t, int16_t id, int type, unsigned int n)
+{
+	t_field(t, T_LIST, id);
+	if (n < 15) {
+		g_string_append_c(t->s, (n << 4) | type);
+	} else {
+		g_string_append_c(t->s, 0xf0 | type);
+		varint(t->s, n);
+	}
+}
+
+/* Start a struct, as a field or as a list element if the id is 0. */
+static void t_begin(struct thrift *t, int16_t id)
+{
+	if (id)
+		t_field(t, T_STRUCT, id);
+	t->last[++t->depth] = 0;
+}
+
+static void t_end(struct thrift *t)
+{
+	g_string_append_c(t->s, 0);
+	t->depth--;
+}
+
+static void rle_run(GString *s, uint64_t count, uint8_t value)
+{
+	varint(s, count << 1);
+	g_string_append_c(s, value);
+}
+
+/*
+ * Encode values of a bit width of 1 in the RLE/bit-packing hybrid encoding:
+ * runs of at least 8 equal values as RLE runs, everything in between bit
+ * packed, 8 values to a byte.
+ */
+static void rle_encode(GString *s, const uint8_t *values, uint64_t n)
+{
+	uint64_t pos, run, start, i, j, num_groups;
+	uint8_t byte;
+
+	pos = 0;
+	while (pos < n) {
+		for (run = 1; pos + run < n && values[pos + run] == values[pos]; run++);
+		if (run >= 8) {
+			rle_run(s, run, values[pos]);
+			pos += run;
+			continue;
+		}
+
+		/* Bit pack groups of 8 until the next long run. */
+		start = pos;
+		do {
+			pos += 8;
+			for (run = 1; pos + run < n && run < 8
+					&& values[pos + run] == values[pos]; run++);
+		} while (pos < n && run < 8);
+		pos = MIN(pos, n);
+
+		num_groups = (pos - start + 7) / 8;
+		varint(s, (num_groups << 1) | 1);
+		for (i = 0; i < num_groups; i++) {
+			byte = 0;
+			for (j = 0; j < 8 && start + i * 8 + j < pos; j++)
+				byte |= values[start + i * 8 + j] << j;
+			g_string_append_c(s, byte);
+		}
+	}
+}
+
+/* Data in data pages is prefixed by its length. */
+static void length_prefix(GString *s, gsize start)
+{
+	char tmp[4];
+
+	WL32(tmp, s->len - start - 4);
+	memcpy(s->str + start, tmp, 4);
+}
+
+static void column_reserve(struct column *col, unsigned int valuesize,
+		uint64_t num_values)
+{
+	if (col->num_values + num_values <= col->size)
+		return;
+	col->size = MAX(col->size * 2, col->num_values + num_values);
+	col->values = g_realloc(col->values, col->size * valuesize);
+}
+
+/* Write the first num_rows rows of a column as a column chunk. */
+static void column_write(struct context *ctx, struct column *col,
+		uint64_t num_rows, GString *out)
+{
+	struct chunk chunk;
+	struct thrift t;
+	GString *page;
+	const float *fvalues;
+	uint64_t num_present, i;
+	uint8_t stat[4];
+	gsize start;
+	gboolean logic;
+
+	logic = col->ch->type == SR_CHANNEL_LOGIC;
+	num_present = MIN(col->num_values, num_rows);
+
+	memset(&chunk, 0, sizeof(chunk));
+	chunk.offset = ctx->offset + out->len;
+	chunk.num_values = num_rows;
+	chunk.null_count = num_rows - num_present;
+
+	/* Definition levels: the present values are first, nulls last. */
+	page = g_string_sized_new((logic ? num_present / 8 : num_present * 4) + 64);
+	g_string_set_size(page, 4);
+	if (num_present)
+		rle_run(page, num_present, 1);
+	if (chunk.null_count)
+		rle_run(page, chunk.null_count, 0);
+	length_prefix(page, 0);
+
+	if (logic) {
+		start = page->len;
+		g_string_set_size(page, start + 4);
+		rle_encode(page, col->values, num_present);
+		length_prefix(page, start);
+		for (i = 0; i < num_present; i++) {
+			if (!chunk.have_stats) {
+				chunk.min = chunk.max = col->values[i];
+				chunk.have_stats = TRUE;
+			}
+			chunk.min = MIN(chunk.min, col->values[i]);
+			chunk.max = MAX(chunk.max, col->values[i]);
+		}
+	} else {
+		fvalues = (const float *)col->values;
+		for (i = 0; i < num_present; i++) {
+			WLFL(stat, fvalues[i]);
+			g_string_append_len(page, (const char *)stat, 4);
+			if (isnan(fvalues[i]))
+				continue;
+			if (!chunk.have_stats) {
+				chunk.min = chunk.max = fvalues[i];
+				chunk.have_stats = TRUE;
+			}
+			chunk.min = MIN(chunk.min, fvalues[i]);
+			chunk.max = MAX(chunk.max, fvalues[i]);
+		}
+	}
+
+	memset(&t, 0, sizeof(t));
+	t.s = out;
+	t_begin(&t, 0);
+	t_i32(&t, 1, PAGE_DATA);
+	t_i32(&t, 2, page->len);
+	t_i32(&t, 3, page->len);
+	t_begin(&t, 5);
+	t_i32(&t, 1, num_rows);
+	t_i32(&t, 2, logic ? ENCODING_RLE : ENCODING_PLAIN);
+	t_i32(&t, 3, ENCODING_RLE);
+	t_i32(&t, 4, ENCODING_RLE);
+	t_end(&t);
+	t_end(&t);
+	g_string_append_len(out, page->str, page->len);
+	g_string_free(page, TRUE);
+
+	chunk.size = ctx->offset + out->len - chunk.offset;
+	g_array_append_val(col->chunks, chunk);
+
+	/* Keep the values of the next row groups. */
+	col->num_values -= num_present;
+	if (num_present && col->num_values)
+		memmove(col->values, col->values + num_present * (logic ? 1 : 4),
+			col->num_values * (logic ? 1 : 4));
+}
+
+/*
+ * Write out complete row groups. Channels which didn't send any samples
+ * yet are padded with nulls once the others are far enough ahead, and
+ * at the end all columns are.
+ */
+static void row_groups_write(struct context *ctx, gboolean end, GString *out)
+{
+	struct column *col;
+	uint64_t min, max, num_rows;
+	unsigned int i;
+
+	for (;;) {
+		max = 0;
+		for (i = 0; i < ctx->num_columns; i++)
+			max = MAX(max, ctx->columns[i].num_values);
+		min = max;
+		for (i = 0; i < ctx->num_columns; i++) {
+			col = &ctx->columns[i];
+			if (col->has_data || max < ctx->max_lag)
+				min = MIN(min, col->num_values);
+		}
+
+		if (min >= ctx->rows && max > 0)
+			num_rows = ctx->rows;
+		else if (end && max > 0)
+			num_rows = MIN(max, ctx->rows);
+		else
+			break;
+
+		for (i = 0; i < ctx->num_columns; i++) {
+			col = &ctx->columns[i];
+			if (!end && !col->has_data && !col->padded) {
+				sr_warn("No samples for channel %s, padding it "
+					"with nulls.", col->ch->name);
+				col->padded = TRUE;
+			}
+			column_write(ctx, col, num_rows, out);
+		}
+		g_array_append_val(ctx->row_groups, num_rows);
+		ctx->num_rows += num_rows;
+	}
+}
+
+static void footer_write(const struct sr_output *o, GString *out)
+{
+	struct context *ctx;
+	struct column *col;
+	struct chunk *chunk;
+	struct thrift t;
+	uint64_t total;
+	unsigned int g, i;
+	uint8_t stat[4];
+	char tmp[4], *s;
+	gsize start;
+
+	ctx = o->priv;
+	start = out->len;
+	memset(&t, 0, sizeof(t));
+	t.s = out;
+
+	t_begin(&t, 0);
+	t_i32(&t, 1, 1);
+
+	t_list(&t, 2, T_STRUCT, ctx->num_columns + 1);
+	t_begin(&t, 0);
+	t_string(&t, 4, "schema");
+	t_i32(&t, 5, ctx->num_columns);
+	t_end(&t);
+	for (i = 0; i < ctx->num_columns; i++) {
+		col = &ctx->columns[i];
+		t_begin(&t, 0);
+		t_i32(&t, 1, col->ch->type == SR_CHANNEL_LOGIC
+			? TYPE_BOOLEAN : TYPE_FLOAT);
+		t_i32(&t, 3, REPETITION_OPTIONAL);
+		t_string(&t, 4, col->ch->name);
+		t_end(&t);
+	}
+
+	t_i64(&t, 3, ctx->num_rows);
+
+	t_list(&t, 4, T_STRUCT, ctx->row_groups->len);
+	for (g = 0; g < ctx->row_groups->len; g++) {
+		t_begin(&t, 0);
+		t_list(&t, 1, T_STRUCT, ctx->num_columns);
+		total = 0;
+		for (i = 0; i < ctx->num_columns; i++) {
+			col = &ctx->columns[i];
+			chunk = &g_array_index(col->chunks, struct chunk, g);
+			total += chunk->size;
+			t_begin(&t, 0);
+			t_i64(&t, 2, chunk->offset);
+			t_begin(&t, 3);
+			if (col->ch->type == SR_CHANNEL_LOGIC) {
+				t_i32(&t, 1, TYPE_BOOLEAN);
+				t_list(&t, 2, T_I32, 1);
+				varint(out, zigzag(ENCODING_RLE));
+			} else {
+				t_i32(&t, 1, TYPE_FLOAT);
+				t_list(&t, 2, T_I32, 2);
+				varint(out, zigzag(ENCODING_PLAIN));
+				varint(out, zigzag(ENCODING_RLE));
+			}
+			t_list(&t, 3, T_BINARY, 1);
+			varint(out, strlen(col->ch->name));
+			g_string_append(out, col->ch->name);
+			t_i32(&t, 4, CODEC_UNCOMPRESSED);
+			t_i64(&t, 5, chunk->num_values);
+			t_i64(&t, 6, chunk->size);
+			t_i64(&t, 7, chunk->size);
+			t_i64(&t, 9, chunk->offset);
+			t_begin(&t, 12);
+			t_i64(&t, 3, chunk->null_count);
+			if (chunk->have_stats) {
+				if (col->ch->type == SR_CHANNEL_LOGIC) {
+					stat[0] = chunk->max;
+					t_binary(&t, 5, stat, 1);
+					stat[0] = chunk->min;
+					t_binary(&t, 6, stat, 1);
+				} else {
+					WLFL(stat, chunk->max);
+					t_binary(&t, 5, stat, 4);
+					WLFL(stat, chunk->min);
+					t_binary(&t, 6, stat, 4);
+				}
+			}
+			t_end(&t);
+			t_end(&t);
+			t_end(&t);
+		}
+		t_i64(&t, 2, total);
+		t_i64(&t, 3, g_array_index(ctx->row_groups, uint64_t, g));
+		t_end(&t);
+	}
+
+	/* The capture parameters, as key/value pairs. */
+	t_list(&t, 5, T_STRUCT, (ctx->samplerate ? 1 : 0)
+		+ (ctx->trigger >= 0 ? 1 : 0));
+	if (ctx->samplerate) {
+		t_begin(&t, 0);
+		t_string(&t, 1, "samplerate");
+		s = g_strdup_printf("%" PRIu64, ctx->samplerate);
+		t_string(&t, 2, s);
+		g_free(s);
+		t_end(&t);
+	}
+	if (ctx->trigger >= 0) {
+		t_begin(&t, 0);
+		t_string(&t, 1, "trigger");
+		s = g_strdup_printf("%" PRId64, ctx->trigger);
+		t_string(&t, 2, s);
+		g_free(s);
+		t_end(&t);
+	}
+
+	s = g_strdup_printf("libsigrok version %s", SR_PACKAGE_VERSION_STRING);
+	t_string(&t, 6, s);
+	g_free(s);
+
+	/* Statistics use the sort order of the physical types. */
+	t_list(&t, 7, T_STRUCT, ctx->num_columns);
+	for (i = 0; i < ctx->num_columns; i++) {
+		t_begin(&t, 0);
+		t_begin(&t, 1);
+		t_end(&t);
+		t_end(&t);
+	}
+	t_end(&t);
+
+	WL32(tmp, out->len - start);
+	g_string_append_len(out, tmp, 4);
+	g_string_append(out, PARQUET_MAGIC);
+}
+
+static int init(struct sr_output *o, GHashTable *options)
+{
+	struct context *ctx;
+	struct column *col;
+	struct sr_channel *ch;
+	GSList *l;
+
+	if (!o || !o->sdi)
+		return SR_ERR_ARG;
+
+	ctx = g_malloc0(sizeof(struct context));
+	o->priv = ctx;
+	ctx->rows = g_variant_get_uint64(g_hash_table_lookup(options, "rows"));
+	if (!ctx->rows)
+		ctx->rows = DEFAULT_ROWS;
+	ctx->rows = MIN(ctx->rows, MAX_ROWS);
+	ctx->max_lag = MAX(ctx->rows * MAX_LAG_GROUPS, MIN_LAG_ROWS);
+	ctx->trigger = -1;
+	ctx->row_groups = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+
+	ctx->columns = g_malloc0(sizeof(struct column)
+			* g_slist_length(o->sdi->channels));
+	for (l = o->sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (!ch->enabled)
+			continue;
+		if (ch->type != SR_CHANNEL_LOGIC && ch->type != SR_CHANNEL_ANALOG)
+			continue;
+		col = &ctx->columns[ctx->num_columns++];
+		col->ch = ch;
+		col->bit = ch->index;
+		col->chunks = g_array_new(FALSE, FALSE, sizeof(struct chunk));
+	}
+
+	if (!ctx->num_columns) {
+		sr_err("No enabled logic or analog channels.");
+		g_free(ctx->columns);
+		g_array_free(ctx->row_groups, TRUE);
+		g_free(ctx);
+		o->priv = NULL;
+		return SR_ERR_ARG;
+	}
+
+	return SR_OK;
+}
+
+static void logic_append(struct context *ctx,
+		const struct sr_datafeed_logic *logic)
+{
+	struct column *col;
+	const uint8_t *data;
+	uint64_t num_samples, s;
+	unsigned int i;
+	uint8_t mask;
+
+	num_samples = logic->length / logic->unitsize;
+	for (i = 0; i < ctx->num_columns; i++) {
+		col = &ctx->columns[i];
+		if (col->ch->type != SR_CHANNEL_LOGIC)
+			continue;
+		column_reserve(col, 1, num_samples);
+		if (col->bit < 0 || (unsigned int)col->bit >= logic->unitsize * 8) {
+			memset(col->values + col->num_values, 0, num_samples);
+		} else {
+			data = (const uint8_t *)logic->data + col->bit / 8;
+			mask = 1 << (col->bit % 8);
+			for (s = 0; s < num_samples; s++, data += logic->unitsize)
+				col->values[col->num_values + s] = (*data & mask) != 0;
+		}
+		col->num_values += num_samples;
+		col->has_data = TRUE;
+	}
+}
+
+static int analog_append(struct context *ctx,
+		const struct sr_datafeed_analog *analog)
+{
+	struct column *col;
+	float *values;
+	GSList *l;
+	unsigned int num_channels, c, i;
+	uint32_t s;
+	size_t size;
+	int ret;
+
+	num_channels = g_slist_length(analog->meaning->channels);
+	size = sizeof(float) * analog->num_samples * num_channels;
+	if (size > ctx->fbuf_size) {
+		ctx->fbuf = g_realloc(ctx->fbuf, size);
+		ctx->fbuf_size = size;
+	}
+	if ((ret = sr_analog_to_float(analog, ctx->fbuf)) != SR_OK)
+		return ret;
+
+	for (c = 0, l = analog->meaning->channels; l; l = l->next, c++) {
+		for (i = 0; i < ctx->num_columns; i++) {
+			if (ctx->columns[i].ch == l->data)
+				break;
+		}
+		if (i == ctx->num_columns)
+			continue;
+		col = &ctx->columns[i];
+		column_reserve(col, sizeof(float), analog->num_samples);
+		values = (float *)col->values + col->num_values;
+		for (s = 0; s < analog->num_samples; s++)
+			values[s] = ctx->fbuf[s * num_channels + c];
+		col->num_values += analog->num_samples;
+		col->has_data = TRUE;
+	}
+
+	return SR_OK;
+}
+
+static int receive(const struct sr_output *o, const struct sr_datafeed_packet *packet,
+		GString **out)
+{
+	struct context *ctx;
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_config *src;
+	GVariant *gvar;
+	GSList *l;
+	unsigned int i;
+	int ret;
+
+	*out = NULL;
+	if (!o || !o->sdi || !(ctx = o->priv))
+		return SR_ERR_ARG;
+
+	*out = g_string_sized_new(0);
+	if (!ctx->magic_done) {
+		g_string_append(*out, PARQUET_MAGIC);
+		ctx->magic_done = TRUE;
+	}
+
+	ret = SR_OK;
+	switch (packet->type) {
+	case SR_DF_HEADER:
+		if (sr_config_get(o->sdi->driver, o->sdi, NULL, SR_CONF_SAMPLERATE,
+				&gvar) == SR_OK) {
+			ctx->samplerate = g_variant_get_uint64(gvar);
+			g_variant_unref(gvar);
+		}
+		break;
+	case SR_DF_META:
+		meta = packet->payload;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			if (src->key == SR_CONF_SAMPLERATE)
+				ctx->samplerate = g_variant_get_uint64(src->data);
+		}
+		/* Packed samples only hold the enabled channels, in order. */
+		if (sr_output_logic_packed(meta, FALSE)) {
+			for (i = 0; i < ctx->num_columns; i++)
+				ctx->columns[i].bit = sr_output_logic_bit(o->sdi,
+					TRUE, ctx->columns[i].ch);
+		}
+		break;
+	case SR_DF_TRIGGER:
+		/* The row of the first sample after the trigger. */
+		if (ctx->trigger < 0) {
+			ctx->trigger = ctx->num_rows;
+			for (i = 0; i < ctx->num_columns; i++)
+				ctx->trigger = MAX((uint64_t)ctx->trigger,
+					ctx->num_rows + ctx->columns[i].num_values);
+		}
+		break;
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		if (!logic->unitsize)
+			return SR_ERR_ARG;
+		logic_append(ctx, logic);
+		row_groups_write(ctx, FALSE, *out);
+		break;
+	case SR_DF_ANALOG:
+		ret = analog_append(ctx, packet->payload);
+		row_groups_write(ctx, FALSE, *out);
+		break;
+	case SR_DF_END:
+		row_groups_write(ctx, TRUE, *out);
+		footer_write(o, *out);
+		break;
+	default:
+		break;
+	}
+
+	ctx->offset += (*out)->len;
+	if (!(*out)->len) {
+		g_string_free(*out, TRUE);
+		*out = NULL;
+	}
+
+	return ret;
+}
+
+static struct sr_option options[] = {
+	{ "rows", "Rows", "Number of rows per row group", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	if (!options[0].def) {
+		options[0].def = g_variant_new_uint64(DEFAULT_ROWS);
+		g_variant_ref_sink(options[0].def);
+	}
+
+	return options;
+}
+
+static int cleanup(struct sr_output *o)
+{
+	struct context *ctx;
+	unsigned int i;
+
+	if (!o || !o->sdi)
+		return SR_ERR_ARG;
+
+	ctx = o->priv;
+	for (i = 0; i < ctx->num_columns; i++) {
+		g_free(ctx->columns[i].values);
+		g_array_free(ctx->columns[i].chunks, TRUE);
+	}
+	g_free(ctx->columns);
+	g_array_free(ctx->row_groups, TRUE);
+	g_free(ctx->fbuf);
+	g_free(ctx);
+	o->priv = NULL;
+
+	return SR_OK;
+}
+
+SR_PRIV struct sr_output_module output_parquet = {
+	.id = "parquet",
+	.name = "Parquet",
+	.desc = "Apache Parquet columnar format",
+	.exts = (const char*[]){"parquet", NULL},
+	.flags = 0,
+	.options = get_options,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
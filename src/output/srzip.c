@@ -35,6 +35,13 @@ struct out_context {
 	char *filename;
 	gint first_analog_index;
 	gint *analog_index_map;
+	/* Per analog channel, the number of chunks written... */
+	unsigned int *analog_chunks;
+	/* ...and the encoding of the last one. */
+	char **analog_encodings;
+	gboolean version3;
+	/* Logic samples only hold the enabled channels. */
+	gboolean logic_packed;
 };
 
 static int init(struct sr_output *o, GHashTable *options)
@@ -55,6 +62,19 @@ static int init(struct sr_output *o, GHashTable *options)
 	return SR_OK;
 }
 
+/* The encoding readers assume for analog chunks without an encoding key. */
+static char *default_encoding(void)
+{
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+
+	sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
+
+	return sr_sessionfile_encoding_string(&encoding);
+}
+
 static int zip_create(const struct sr_output *o)
 {
 	struct out_context *outc;
@@ -70,6 +90,7 @@ static int zip_create(const struct sr_output *o)
 	guint logic_channels = 0, enabled_logic_channels = 0;
 	guint enabled_analog_channels = 0;
 	guint index;
+	int bit;
 
 	outc = o->priv;
 
@@ -118,6 +139,8 @@ static int zip_create(const struct sr_output *o)
 			break;
 		}
 	}
+	if (outc->logic_packed)
+		logic_channels = enabled_logic_channels;
 
 	/* When reading the file, the first index of the analog channels
 	 * can only be deduced through the "total probes" count, so the
@@ -144,6 +167,11 @@ static int zip_create(const struct sr_output *o)
 	outc->analog_index_map = g_malloc0(sizeof(gint) * (enabled_analog_channels + 1));
 	outc->analog_index_map[enabled_analog_channels] = -1;
 
+	outc->analog_chunks = g_malloc0(sizeof(unsigned int) * enabled_analog_channels);
+	outc->analog_encodings = g_malloc0(sizeof(char *) * (enabled_analog_channels + 1));
+	for (index = 0; index < enabled_analog_channels; index++)
+		outc->analog_encodings[index] = default_encoding();
+
 	index = 0;
 	for (l = o->sdi->channels; l; l = l->next) {
 		ch = l->data;
@@ -152,7 +180,8 @@ static int zip_create(const struct sr_output *o)
 
 		switch (ch->type) {
 		case SR_CHANNEL_LOGIC:
-			s = g_strdup_printf("probe%d", ch->index + 1);
+			bit = sr_output_logic_bit(o->sdi, outc->logic_packed, ch);
+			s = g_strdup_printf("probe%d", bit + 1);
 			break;
 		case SR_CHANNEL_ANALOG:
 			outc->analog_index_map[index] = ch->index;
@@ -305,101 +334,200 @@ static int zip_append(const struct sr_output *o, unsigned char *buf,
 	return SR_OK;
 }
 
+/*
+ * Integer samples are stored as they are, with their scale and offset in
+ * the metadata. Everything else is converted to float.
+ */
+static gboolean store_native(const struct sr_analog_encoding *encoding)
+{
+	if (encoding->is_float)
+		return FALSE;
+
+	return encoding->unitsize == 1 || encoding->unitsize == 2
+		|| encoding->unitsize == 4;
+}
+
 static int zip_append_analog(const struct sr_output *o,
 		const struct sr_datafeed_analog *analog)
 {
 	struct out_context *outc;
 	struct zip *archive;
-	struct zip_source *analogsrc;
-	int64_t i, num_files;
+	struct zip_source *src;
 	struct zip_stat zs;
-	uint64_t chunk_num;
-	const char *entry_name;
-	char *basename;
-	gsize baselen;
+	struct sr_analog_encoding encoding;
+	struct sr_datafeed_analog tmp;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
 	struct sr_channel *channel;
-	float *chunkbuf;
+	GKeyFile *kf;
+	GSList *l;
+	const uint8_t *samples;
+	uint8_t *chunkbuf;
+	float *floatbuf;
 	gsize chunksize;
-	char *chunkname;
-	unsigned int next_chunk_num, index;
+	char *encstr, *chunkname, *key, *metabuf;
+	gsize metalen;
+	unsigned int *indexes;
+	unsigned int num_channels, index, i, j;
+	int ret;
 
 	outc = o->priv;
 
-	/* TODO: support packets covering multiple channels */
-	if (g_slist_length(analog->meaning->channels) != 1) {
-		sr_err("Analog packets covering multiple channels not supported yet");
-		return SR_ERR;
-	}
-	channel = analog->meaning->channels->data;
+	num_channels = g_slist_length(analog->meaning->channels);
+	if (num_channels == 0 || analog->num_samples == 0)
+		return SR_OK;
 
 	/* When reading the file, analog channels must be consecutive.
 	 * Thus we need a global channel index map as we don't know in
 	 * which order the channel data comes in. */
-	for (index = 0; outc->analog_index_map[index] != -1; index++)
-		if (outc->analog_index_map[index] == channel->index)
-			break;
-	if (outc->analog_index_map[index] == -1)
-		return SR_ERR_ARG; /* Channel index was not in the list */
+	indexes = g_malloc(sizeof(unsigned int) * num_channels);
+	for (l = analog->meaning->channels, j = 0; l; l = l->next, j++) {
+		channel = l->data;
+		for (index = 0; outc->analog_index_map[index] != -1; index++)
+			if (outc->analog_index_map[index] == channel->index)
+				break;
+		if (outc->analog_index_map[index] == -1) {
+			/* Channel index was not in the list */
+			g_free(indexes);
+			return SR_ERR_ARG;
+		}
+		indexes[j] = index;
+	}
 
-	index += outc->first_analog_index;
+	floatbuf = NULL;
+	if (store_native(analog->encoding)) {
+		encoding = *analog->encoding;
+		samples = analog->data;
+	} else {
+		floatbuf = g_try_malloc(sizeof(float)
+				* analog->num_samples * num_channels);
+		if (!floatbuf || sr_analog_to_float(analog, floatbuf) != SR_OK) {
+			g_free(floatbuf);
+			g_free(indexes);
+			return SR_ERR;
+		}
+		sr_analog_init(&tmp, &encoding, &meaning, &spec,
+				analog->encoding->digits);
+		samples = (const uint8_t *)floatbuf;
+	}
+	encstr = sr_sessionfile_encoding_string(&encoding);
+
+	/* Packets are interleaved, each channel gets a chunk of its own. */
+	chunksize = encoding.unitsize * analog->num_samples;
+	if (!(chunkbuf = g_try_malloc(chunksize * num_channels))) {
+		g_free(encstr);
+		g_free(floatbuf);
+		g_free(indexes);
+		return SR_ERR_MALLOC;
+	}
+	if (num_channels == 1) {
+		memcpy(chunkbuf, samples, chunksize);
+	} else {
+		for (j = 0; j < num_channels; j++) {
+			for (i = 0; i < analog->num_samples; i++)
+				memcpy(chunkbuf + j * chunksize + i * encoding.unitsize,
+					samples + (i * num_channels + j) * encoding.unitsize,
+					encoding.unitsize);
+		}
+	}
+	g_free(floatbuf);
 
+	ret = SR_ERR;
+	kf = NULL;
+	metabuf = NULL;
 	if (!(archive = zip_open(outc->filename, 0, NULL)))
-		return SR_ERR;
+		goto out;
 
 	if (zip_stat(archive, "metadata", 0, &zs) < 0) {
 		sr_err("Failed to open metadata: %s", zip_strerror(archive));
 		goto err_zip_discard;
 	}
 
-	basename = g_strdup_printf("analog-1-%u", index);
-	baselen = strlen(basename);
-	next_chunk_num = 1;
-	num_files = zip_get_num_entries(archive, 0);
-	for (i = 0; i < num_files; i++) {
-		entry_name = zip_get_name(archive, i, 0);
-		if (!entry_name || strncmp(entry_name, basename, baselen) != 0) {
+	for (j = 0; j < num_channels; j++) {
+		index = indexes[j];
+		if (!strcmp(encstr, outc->analog_encodings[index]))
 			continue;
-		} else if (entry_name[baselen] == '-') {
-			chunk_num = g_ascii_strtoull(entry_name + baselen + 1, NULL, 10);
-			if (chunk_num < G_MAXINT && chunk_num >= next_chunk_num)
-				next_chunk_num = chunk_num + 1;
+		/* The encoding changed, record it from this chunk on. */
+		if (!kf && !(kf = sr_sessionfile_read_metadata(archive, &zs)))
+			goto err_zip_discard;
+		key = g_strdup_printf("encoding analog-1-%u-%u",
+				outc->first_analog_index + index,
+				outc->analog_chunks[index] + 1);
+		g_key_file_set_string(kf, "device 1", key, encstr);
+		g_free(key);
+	}
+	if (kf) {
+		metabuf = g_key_file_to_data(kf, &metalen, NULL);
+		src = zip_source_buffer(archive, metabuf, metalen, FALSE);
+		if (zip_replace(archive, zs.index, src) < 0) {
+			sr_err("Failed to replace metadata: %s",
+				zip_strerror(archive));
+			zip_source_free(src);
+			goto err_zip_discard;
 		}
 	}
 
-	chunksize = sizeof(float) * analog->num_samples;
-	if (!(chunkbuf = g_try_malloc(chunksize)))
-		goto err_free_basename;
-
-	if (sr_analog_to_float(analog, chunkbuf) != SR_OK)
-		goto err_free_chunkbuf;
+	/* Older readers would take integer samples for floats. */
+	if (!encoding.is_float && !outc->version3) {
+		if (zip_stat(archive, "version", 0, &zs) < 0) {
+			sr_err("Failed to find version: %s", zip_strerror(archive));
+			goto err_zip_discard;
+		}
+		src = zip_source_buffer(archive, "3", 1, FALSE);
+		if (zip_replace(archive, zs.index, src) < 0) {
+			sr_err("Failed to replace version: %s",
+				zip_strerror(archive));
+			zip_source_free(src);
+			goto err_zip_discard;
+		}
+	}
 
-	analogsrc = zip_source_buffer(archive, chunkbuf, chunksize, FALSE);
-	chunkname = g_strdup_printf("%s-%u", basename, next_chunk_num);
-	i = zip_add(archive, chunkname, analogsrc);
-	g_free(chunkname);
-	if (i < 0) {
-		sr_err("Failed to add chunk '%s': %s", chunkname, zip_strerror(archive));
-		zip_source_free(analogsrc);
-		goto err_free_chunkbuf;
+	for (j = 0; j < num_channels; j++) {
+		index = indexes[j];
+		src = zip_source_buffer(archive, chunkbuf + j * chunksize,
+				chunksize, FALSE);
+		chunkname = g_strdup_printf("analog-1-%u-%u",
+				outc->first_analog_index + index,
+				outc->analog_chunks[index] + 1);
+		if (zip_add(archive, chunkname, src) < 0) {
+			sr_err("Failed to add chunk '%s': %s", chunkname,
+				zip_strerror(archive));
+			zip_source_free(src);
+			g_free(chunkname);
+			goto err_zip_discard;
+		}
+		g_free(chunkname);
 	}
+
 	if (zip_close(archive) < 0) {
 		sr_err("Error saving session file: %s", zip_strerror(archive));
-		goto err_free_chunkbuf;
+		goto err_zip_discard;
 	}
 
-	g_free(basename);
-	g_free(chunkbuf);
-
-	return SR_OK;
+	for (j = 0; j < num_channels; j++) {
+		index = indexes[j];
+		outc->analog_chunks[index]++;
+		if (strcmp(encstr, outc->analog_encodings[index])) {
+			g_free(outc->analog_encodings[index]);
+			outc->analog_encodings[index] = g_strdup(encstr);
+		}
+	}
+	if (!encoding.is_float)
+		outc->version3 = TRUE;
+	ret = SR_OK;
+	goto out;
 
-err_free_chunkbuf:
-	g_free(chunkbuf);
-err_free_basename:
-	g_free(basename);
 err_zip_discard:
 	zip_discard(archive);
+out:
+	if (kf)
+		g_key_file_free(kf);
+	g_free(metabuf);
+	g_free(chunkbuf);
+	g_free(encstr);
+	g_free(indexes);
 
-	return SR_ERR;
+	return ret;
 }
 
 static int receive(const struct sr_output *o, const struct sr_datafeed_packet *packet,
@@ -427,6 +555,8 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 				continue;
 			outc->samplerate = g_variant_get_uint64(src->data);
 		}
+		outc->logic_packed = sr_output_logic_packed(meta,
+				outc->logic_packed);
 		break;
 	case SR_DF_LOGIC:
 		if (!outc->zip_created) {
@@ -474,6 +604,8 @@ static int cleanup(struct sr_output *o)
 	outc = o->priv;
 	g_variant_unref(options[0].def);
 	g_free(outc->analog_index_map);
+	g_free(outc->analog_chunks);
+	g_strfreev(outc->analog_encodings);
 	g_free(outc->filename);
 	g_free(outc);
 	o->priv = NULL;
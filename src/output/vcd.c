@@ -180,6 +180,11 @@ static int receive(const struct sr_output *o, const struct sr_datafeed_packet *p
 				continue;
 			ctx->samplerate = g_variant_get_uint64(src->data);
 		}
+		/* Packed samples only hold the enabled channels, in order. */
+		if (sr_output_logic_packed(meta, FALSE)) {
+			for (p = 0; p < ctx->num_enabled_channels; p++)
+				ctx->channel_index[p] = p;
+		}
 		break;
 	case SR_DF_LOGIC:
 		logic = packet->payload;
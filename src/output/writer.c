@@ -0,0 +1,530 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "output/writer"
+/** @endcond */
+
+/**
+ * @file
+ *
+ * Asynchronous output writer.
+ */
+
+/**
+ * @addtogroup grp_output
+ *
+ * @{
+ */
+
+/* Queue depth used when the caller doesn't specify one. */
+#define DEFAULT_MAX_PACKETS 64
+
+/* Output is gathered and written in blocks of this size... */
+#define BLOCK_SIZE (1024 * 1024)
+/* ...aligned in memory and in the file as required for direct I/O. */
+#define BLOCK_ALIGN 4096
+
+/* Packet payloads written with a single call, at most. */
+#define MAX_CHUNKS 64
+
+struct chunk {
+	const void *data;
+	size_t len;
+};
+
+/** @cond PRIVATE */
+struct sr_output_writer {
+	const struct sr_output *output;
+	unsigned int max_packets;
+	int flags;
+	int fd;
+	gboolean direct;
+
+	/* Output of the module, waiting to be written. */
+	uint8_t *block_mem;
+	uint8_t *block;
+	size_t block_fill;
+
+	GThread *thread;
+	GMutex mutex;
+	/* Signalled when a packet was queued, or the writer is stopping. */
+	GCond data_cond;
+	/* Signalled when the writer thread took a packet off the queue. */
+	GCond space_cond;
+	GQueue *queue;
+	gboolean stopping;
+	uint64_t dropped;
+	/* The first error, only set by the writer thread. */
+	int status;
+};
+/** @endcond */
+
+static int open_file(struct sr_output_writer *w, const char *filename)
+{
+	int flags;
+
+	flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_BINARY
+	flags |= O_BINARY;
+#endif
+
+	w->fd = -1;
+#ifdef O_DIRECT
+	if (w->flags & SR_OUTPUT_WRITER_DIRECT) {
+		w->fd = g_open(filename, flags | O_DIRECT, 0644);
+		if (w->fd < 0)
+			sr_dbg("Direct I/O not available for '%s': %s.",
+				filename, g_strerror(errno));
+		else
+			w->direct = TRUE;
+	}
+#endif
+	if (w->fd < 0)
+		w->fd = g_open(filename, flags, 0644);
+	if (w->fd < 0) {
+		sr_err("Failed to open '%s': %s.", filename, g_strerror(errno));
+		return SR_ERR_IO;
+	}
+
+#ifdef POSIX_FADV_SEQUENTIAL
+	if (!w->direct)
+		posix_fadvise(w->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	return SR_OK;
+}
+
+static int write_all(struct sr_output_writer *w, const uint8_t *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = write(w->fd, buf, len);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret < 0) {
+			sr_err("Failed to write output: %s.", g_strerror(errno));
+			return SR_ERR_IO;
+		}
+		buf += ret;
+		len -= ret;
+	}
+
+	return SR_OK;
+}
+
+static int block_append(struct sr_output_writer *w, const char *data, size_t len)
+{
+	size_t n;
+	int ret;
+
+	while (len > 0) {
+		n = MIN(len, BLOCK_SIZE - w->block_fill);
+		memcpy(w->block + w->block_fill, data, n);
+		w->block_fill += n;
+		data += n;
+		len -= n;
+		if (w->block_fill < BLOCK_SIZE)
+			break;
+		if ((ret = write_all(w, w->block, BLOCK_SIZE)) != SR_OK)
+			return ret;
+		w->block_fill = 0;
+	}
+
+	return SR_OK;
+}
+
+/* Write the partial last block, which direct I/O can't take as it is. */
+static int block_flush(struct sr_output_writer *w)
+{
+	int ret;
+
+	if (!w->block_fill)
+		return SR_OK;
+
+#if defined(O_DIRECT) && defined(F_SETFL)
+	if (w->direct) {
+		fcntl(w->fd, F_SETFL, fcntl(w->fd, F_GETFL) & ~O_DIRECT);
+		w->direct = FALSE;
+	}
+#endif
+	ret = write_all(w, w->block, w->block_fill);
+	w->block_fill = 0;
+
+	return ret;
+}
+
+static int packet_write(struct sr_output_writer *w,
+		const struct sr_datafeed_packet *packet)
+{
+	GString *out;
+	int ret;
+
+	out = NULL;
+	ret = sr_output_send(w->output, packet, &out);
+	if (out) {
+		if (ret == SR_OK && w->fd >= 0)
+			ret = block_append(w, out->str, out->len);
+		g_string_free(out, TRUE);
+	}
+
+	return ret;
+}
+
+static struct sr_datafeed_packet *packet_pop(struct sr_output_writer *w,
+		gboolean wait)
+{
+	struct sr_datafeed_packet *packet;
+
+	g_mutex_lock(&w->mutex);
+	while (!(packet = g_queue_pop_head(w->queue)) && wait && !w->stopping)
+		g_cond_wait(&w->data_cond, &w->mutex);
+	if (packet)
+		g_cond_signal(&w->space_cond);
+	g_mutex_unlock(&w->mutex);
+
+	return packet;
+}
+
+static void status_set(struct sr_output_writer *w, int status)
+{
+	g_mutex_lock(&w->mutex);
+	w->status = status;
+	g_cond_signal(&w->space_cond);
+	g_mutex_unlock(&w->mutex);
+}
+
+/*
+ * The payload of a packet which the module's output is taken from as it
+ * is. Direct I/O would need it aligned, so it's copied into blocks then.
+ */
+static gboolean payload_get(struct sr_output_writer *w,
+		const struct sr_datafeed_packet *packet, struct chunk *chunk)
+{
+	if (w->fd < 0 || w->direct || !w->output->module->payload)
+		return FALSE;
+
+	chunk->data = w->output->module->payload(w->output, packet, &chunk->len);
+
+	return chunk->data != NULL;
+}
+
+/* Write payloads straight from the queued packets, in as few calls as possible. */
+static int chunks_write(struct sr_output_writer *w, struct chunk *chunks,
+		unsigned int num_chunks)
+{
+	unsigned int i;
+	int ret;
+#ifdef HAVE_SYS_UIO_H
+	struct iovec iov[MAX_CHUNKS], *v;
+	ssize_t n;
+#endif
+
+	/* Output gathered so far goes first. */
+	if ((ret = block_flush(w)) != SR_OK)
+		return ret;
+
+#ifdef HAVE_SYS_UIO_H
+	for (i = 0; i < num_chunks; i++) {
+		iov[i].iov_base = (void *)chunks[i].data;
+		iov[i].iov_len = chunks[i].len;
+	}
+	v = iov;
+	while (num_chunks > 0) {
+		n = writev(w->fd, v, num_chunks);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0) {
+			sr_err("Failed to write output: %s.", g_strerror(errno));
+			return SR_ERR_IO;
+		}
+		/* Skip what was written, and retry the rest. */
+		while (num_chunks > 0 && (size_t)n >= v->iov_len) {
+			n -= v->iov_len;
+			v++;
+			num_chunks--;
+		}
+		if (num_chunks > 0) {
+			v->iov_base = (uint8_t *)v->iov_base + n;
+			v->iov_len -= n;
+		}
+	}
+#else
+	for (i = 0; i < num_chunks; i++) {
+		if ((ret = write_all(w, chunks[i].data, chunks[i].len)) != SR_OK)
+			return ret;
+	}
+#endif
+
+	return SR_OK;
+}
+
+static gpointer writer_thread(gpointer data)
+{
+	struct sr_output_writer *w;
+	struct sr_datafeed_packet *packet, *batch[MAX_CHUNKS];
+	struct chunk chunks[MAX_CHUNKS];
+	unsigned int num_chunks, i;
+	int ret;
+
+	w = data;
+	packet = NULL;
+	for (;;) {
+		if (!packet && !(packet = packet_pop(w, TRUE)))
+			break;
+
+		/* Gather consecutive packets which need no conversion. */
+		num_chunks = 0;
+		while (packet && num_chunks < MAX_CHUNKS && w->status == SR_OK
+				&& payload_get(w, packet, &chunks[num_chunks])) {
+			batch[num_chunks++] = packet;
+			packet = packet_pop(w, FALSE);
+		}
+		if (num_chunks) {
+			ret = chunks_write(w, chunks, num_chunks);
+			if (ret != SR_OK)
+				status_set(w, ret);
+			for (i = 0; i < num_chunks; i++)
+				sr_packet_free(batch[i]);
+			continue;
+		}
+
+		if (w->status == SR_OK && (ret = packet_write(w, packet)) != SR_OK)
+			status_set(w, ret);
+		sr_packet_free(packet);
+		packet = NULL;
+	}
+
+	return NULL;
+}
+
+/**
+ * Create a writer running an output instance on its own thread.
+ *
+ * Packets passed to sr_output_writer_send() are copied into a bounded
+ * queue, from which the writer thread feeds them to the output instance.
+ * This keeps slow output modules and slow storage from stalling the
+ * session's datafeed callback. The text the instance generates is written
+ * to @p filename in large blocks. Output which modules take from the packet
+ * payloads as they are, such as raw binary samples, is written from the
+ * queued packets directly.
+ *
+ * The output instance must not be used by the caller until the writer
+ * has been freed, and is not freed along with it.
+ *
+ * @param o The output instance.
+ * @param filename The file to write the instance's output to. Can be NULL
+ *                 for modules which write the output themselves.
+ * @param max_packets The number of packets which can be queued, or 0 for
+ *                    the default.
+ * @param flags Bitmask of sr_output_writer_flag values.
+ *
+ * @return A new writer, or NULL on error.
+ *
+ * @since 0.6.0
+ */
+SR_API struct sr_output_writer *sr_output_writer_new(const struct sr_output *o,
+		const char *filename, unsigned int max_packets, int flags)
+{
+	struct sr_output_writer *w;
+	GError *error;
+
+	if (!o)
+		return NULL;
+
+	if (!filename && !sr_output_test_flag(o->module,
+			SR_OUTPUT_INTERNAL_IO_HANDLING)) {
+		sr_err("Output module '%s' requires a file name.", o->module->id);
+		return NULL;
+	}
+
+	w = g_malloc0(sizeof(struct sr_output_writer));
+	w->output = o;
+	w->max_packets = max_packets ? max_packets : DEFAULT_MAX_PACKETS;
+	w->flags = flags;
+	w->fd = -1;
+	w->status = SR_OK;
+
+	if (filename) {
+		if (open_file(w, filename) != SR_OK) {
+			g_free(w);
+			return NULL;
+		}
+		w->block_mem = g_malloc(BLOCK_SIZE + BLOCK_ALIGN);
+		w->block = (uint8_t *)(((uintptr_t)w->block_mem + BLOCK_ALIGN - 1)
+				& ~(uintptr_t)(BLOCK_ALIGN - 1));
+	}
+
+	g_mutex_init(&w->mutex);
+	g_cond_init(&w->data_cond);
+	g_cond_init(&w->space_cond);
+	w->queue = g_queue_new();
+
+	error = NULL;
+	w->thread = g_thread_try_new("sr-output-writer", writer_thread, w, &error);
+	if (!w->thread) {
+		sr_err("Failed to start writer thread: %s.", error->message);
+		g_error_free(error);
+		g_queue_free(w->queue);
+		g_cond_clear(&w->space_cond);
+		g_cond_clear(&w->data_cond);
+		g_mutex_clear(&w->mutex);
+		if (w->fd >= 0)
+			close(w->fd);
+		g_free(w->block_mem);
+		g_free(w);
+		return NULL;
+	}
+
+	return w;
+}
+
+/**
+ * Queue a packet for the writer's output instance.
+ *
+ * The packet is copied, so the caller's buffers can be reused as soon as
+ * this returns. When the queue is full, this blocks until the writer
+ * thread made room for the packet. With SR_OUTPUT_WRITER_DROP set, logic
+ * and analog packets are dropped instead; all other packets are always
+ * queued, so the output still sees a well-formed stream.
+ *
+ * @param w The writer.
+ * @param packet The packet.
+ *
+ * @retval SR_OK Success, which includes dropping the packet.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval other The first error returned by the output instance, or
+ *               encountered when writing its output. No further packets
+ *               are queued after an error.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_output_writer_send(struct sr_output_writer *w,
+		const struct sr_datafeed_packet *packet)
+{
+	struct sr_datafeed_packet *copy;
+	gboolean data;
+	int ret;
+
+	if (!w || !packet)
+		return SR_ERR_ARG;
+
+	data = packet->type == SR_DF_LOGIC || packet->type == SR_DF_ANALOG;
+
+	g_mutex_lock(&w->mutex);
+	if (w->flags & SR_OUTPUT_WRITER_DROP) {
+		if (data && w->status == SR_OK
+				&& g_queue_get_length(w->queue) >= w->max_packets) {
+			w->dropped++;
+			g_mutex_unlock(&w->mutex);
+			return SR_OK;
+		}
+	} else {
+		while (w->status == SR_OK
+				&& g_queue_get_length(w->queue) >= w->max_packets)
+			g_cond_wait(&w->space_cond, &w->mutex);
+	}
+	ret = w->status;
+	g_mutex_unlock(&w->mutex);
+	if (ret != SR_OK)
+		return ret;
+
+	/* Only this thread adds packets, so the room made above is kept. */
+	if ((ret = sr_packet_copy(packet, &copy)) != SR_OK) {
+		g_free(copy);
+		return ret;
+	}
+
+	g_mutex_lock(&w->mutex);
+	g_queue_push_tail(w->queue, copy);
+	g_cond_signal(&w->data_cond);
+	g_mutex_unlock(&w->mutex);
+
+	return SR_OK;
+}
+
+/**
+ * Stop a writer and free all associated resources.
+ *
+ * All queued packets are passed to the output instance, and its output is
+ * written out before the file is closed. The output instance itself is
+ * not freed.
+ *
+ * @param w The writer.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ * @retval other The first error returned by the output instance, or
+ *               encountered when writing its output.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_output_writer_free(struct sr_output_writer *w)
+{
+	int ret;
+
+	if (!w)
+		return SR_ERR_ARG;
+
+	g_mutex_lock(&w->mutex);
+	w->stopping = TRUE;
+	g_cond_signal(&w->data_cond);
+	g_mutex_unlock(&w->mutex);
+	g_thread_join(w->thread);
+
+	ret = w->status;
+	if (w->fd >= 0) {
+		if (ret == SR_OK)
+			ret = block_flush(w);
+		if (close(w->fd) < 0 && ret == SR_OK) {
+			sr_err("Failed to close output file: %s.",
+				g_strerror(errno));
+			ret = SR_ERR_IO;
+		}
+	}
+
+	if (w->dropped)
+		sr_warn("Dropped %" PRIu64 " packets, output couldn't keep up.",
+			w->dropped);
+
+	g_queue_free(w->queue);
+	g_cond_clear(&w->space_cond);
+	g_cond_clear(&w->data_cond);
+	g_mutex_clear(&w->mutex);
+	g_free(w->block_mem);
+	g_free(w);
+
+	return ret;
+}
+
+/** @} */
@@ -32,6 +32,17 @@
 
 #define LOG_PREFIX "kern"
 
+/*
+ * Packets start with the sign. They are 14 or 15 bytes long, so the CR/LF
+ * at the end is not at a fixed offset and can't be used for syncing.
+ */
+SR_PRIV const struct sr_packet_sync sr_kern_packet_sync = {
+	.packet_size = 15,
+	.sync_offset = 0,
+	.sync_mask = 0xff,
+	.sync = "+- ",
+};
+
 static int get_buflen(const uint8_t *buf)
 {
 	/* Find out whether it's a 14-byte or 15-byte packet. */
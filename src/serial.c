@@ -657,13 +657,127 @@ SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial, char **buf,
 	return SR_OK;
 }
 
+/* Check the sync byte and terminator of a packet candidate. */
+static gboolean packet_sync_match(const struct sr_packet_sync *sync,
+		const uint8_t *pkt)
+{
+	size_t term_len;
+
+	if (sync->sync && *sync->sync && !memchr(sync->sync,
+			pkt[sync->sync_offset] & sync->sync_mask,
+			strlen(sync->sync)))
+		return FALSE;
+
+	if (sync->terminator) {
+		term_len = strlen(sync->terminator);
+		if (memcmp(pkt + sync->packet_size - term_len,
+				sync->terminator, term_len))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Return the first offset in [pos, last] where a packet could start, as far
+ * as the sync byte and terminator tell, or last + 1 if there is none.
+ */
+static size_t packet_sync_next(const struct sr_packet_sync *sync,
+		const uint8_t *buf, size_t pos, size_t last)
+{
+	const uint8_t *p;
+	size_t anchor;
+	uint8_t c;
+
+	if (sync->terminator && *sync->terminator) {
+		/* Anchor on the last terminator byte. */
+		anchor = sync->packet_size - 1;
+		c = sync->terminator[strlen(sync->terminator) - 1];
+	} else if (sync->sync && sync->sync[0] && !sync->sync[1]
+			&& sync->sync_mask == 0xff) {
+		/* Anchor on a single sync byte value. */
+		anchor = sync->sync_offset;
+		c = sync->sync[0];
+	} else {
+		/* Masked or multiple sync values, or no markers at all. */
+		while (pos <= last && !packet_sync_match(sync, buf + pos))
+			pos++;
+		return pos;
+	}
+
+	while (pos <= last) {
+		p = memchr(buf + pos + anchor, c, last - pos + 1);
+		if (!p)
+			return last + 1;
+		pos = p - buf - anchor;
+		if (packet_sync_match(sync, buf + pos))
+			return pos;
+		pos++;
+	}
+
+	return pos;
+}
+
+/**
+ * Find the first valid packet in a buffer.
+ *
+ * Only the offsets where the sync byte and terminator of @a sync match are
+ * passed to @a is_valid, so most of the garbage between packets is skipped
+ * with memchr() instead of a full validation at every byte.
+ *
+ * @param sync Description of the packet framing. Must not be NULL.
+ * @param is_valid Callback that assesses whether the packet is valid or not.
+ * @param buf Buffer to search.
+ * @param len Number of bytes in the buffer.
+ * @param skip Pointer which will be set to the offset of the packet found.
+ *             If none is found, it is set to the number of leading bytes
+ *             which cannot start a valid packet and can be discarded.
+ *
+ * @return Pointer to the packet in @a buf, or NULL if none was found.
+ *
+ * @private
+ */
+SR_PRIV const uint8_t *sr_packet_sync_find(const struct sr_packet_sync *sync,
+		packet_valid_callback is_valid, const uint8_t *buf, size_t len,
+		size_t *skip)
+{
+	size_t pos, last;
+
+	pos = 0;
+	if (len >= sync->packet_size) {
+		last = len - sync->packet_size;
+		while ((pos = packet_sync_next(sync, buf, pos, last)) <= last) {
+			if (is_valid(buf + pos)) {
+				*skip = pos;
+				return buf + pos;
+			}
+			pos++;
+		}
+	}
+
+	/* Drop incomplete candidates whose sync byte is already wrong. */
+	if (sync->sync && *sync->sync) {
+		while (pos + sync->sync_offset < len && !memchr(sync->sync,
+				buf[pos + sync->sync_offset] & sync->sync_mask,
+				strlen(sync->sync)))
+			pos++;
+	}
+	*skip = pos;
+
+	return NULL;
+}
+
 /**
  * Try to find a valid packet in a serial data stream.
  *
+ * Bytes are only read as far as needed to complete the current packet
+ * candidate, so on success the packet found ends the data read.
+ *
  * @param serial Previously initialized serial port structure.
- * @param buf Buffer containing the bytes to write.
- * @param buflen Size of the buffer.
- * @param[in] packet_size Size, in bytes, of a valid packet.
+ * @param buf Buffer to read the data into.
+ * @param buflen Size of the buffer. Will be set to the number of bytes
+ *               read, including the packet found.
+ * @param sync Description of the packet framing. Must not be NULL.
  * @param is_valid Callback that assesses whether the packet is valid or not.
  * @param[in] timeout_ms The timeout after which, if no packet is detected, to
  *                       abort scanning.
@@ -676,17 +790,18 @@ SR_PRIV int serial_readline(struct sr_serial_dev_inst *serial, char **buf,
  *
  * @private
  */
-SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
-				 uint8_t *buf, size_t *buflen,
-				 size_t packet_size,
-				 packet_valid_callback is_valid,
-				 uint64_t timeout_ms, int baudrate)
+SR_PRIV int serial_stream_detect_sync(struct sr_serial_dev_inst *serial,
+				      uint8_t *buf, size_t *buflen,
+				      const struct sr_packet_sync *sync,
+				      packet_valid_callback is_valid,
+				      uint64_t timeout_ms, int baudrate)
 {
 	uint64_t start, time, byte_delay_us;
-	size_t ibuf, i, maxlen;
+	size_t ibuf, i, skip, maxlen, packet_size;
 	ssize_t len;
 
 	maxlen = *buflen;
+	packet_size = sync->packet_size;
 
 	sr_dbg("Detecting packets on %s (timeout = %" PRIu64
 	       "ms, baudrate = %d).", serial->port, timeout_ms, baudrate);
@@ -702,7 +817,9 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 
 	i = ibuf = len = 0;
 	while (ibuf < maxlen) {
-		len = serial_read_nonblocking(serial, &buf[ibuf], 1);
+		/* Read no further than the end of the current candidate. */
+		len = MIN(MAX(i + packet_size, ibuf + 1), maxlen) - ibuf;
+		len = serial_read_nonblocking(serial, &buf[ibuf], len);
 		if (len > 0) {
 			ibuf += len;
 		} else if (len == 0) {
@@ -714,19 +831,19 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 		time = g_get_monotonic_time() - start;
 		time /= 1000;
 
-		if ((ibuf - i) >= packet_size) {
-			/* We have at least a packet's worth of data. */
-			if (is_valid(&buf[i])) {
+		if (len > 0) {
+			if (sr_packet_sync_find(sync, is_valid, &buf[i],
+					ibuf - i, &skip)) {
 				sr_spew("Found valid %zu-byte packet after "
-					"%" PRIu64 "ms.", (ibuf - i), time);
-				*buflen = ibuf;
+					"%" PRIu64 "ms.", packet_size, time);
+				*buflen = i + skip + packet_size;
 				return SR_OK;
-			} else {
-				sr_spew("Got %zu bytes, but not a valid "
-					"packet.", (ibuf - i));
 			}
+			if (skip)
+				sr_spew("Got %zu bytes, but not a valid "
+					"packet.", ibuf - i);
 			/* Not a valid packet. Continue searching. */
-			i++;
+			i += skip;
 		}
 		if (time >= timeout_ms) {
 			/* Timeout */
@@ -744,6 +861,43 @@ SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
 	return SR_ERR;
 }
 
+/**
+ * Try to find a valid packet in a serial data stream.
+ *
+ * Like serial_stream_detect_sync(), for packets without any known sync
+ * bytes or terminator.
+ *
+ * @param serial Previously initialized serial port structure.
+ * @param buf Buffer to read the data into.
+ * @param buflen Size of the buffer.
+ * @param[in] packet_size Size, in bytes, of a valid packet.
+ * @param is_valid Callback that assesses whether the packet is valid or not.
+ * @param[in] timeout_ms The timeout after which, if no packet is detected, to
+ *                       abort scanning.
+ * @param[in] baudrate The baudrate of the serial port. This parameter is not
+ *                     critical, but it helps fine tune the serial port polling
+ *                     delay.
+ *
+ * @retval SR_OK Valid packet was found within the given timeout.
+ * @retval SR_ERR Failure.
+ *
+ * @private
+ */
+SR_PRIV int serial_stream_detect(struct sr_serial_dev_inst *serial,
+				 uint8_t *buf, size_t *buflen,
+				 size_t packet_size,
+				 packet_valid_callback is_valid,
+				 uint64_t timeout_ms, int baudrate)
+{
+	struct sr_packet_sync sync;
+
+	memset(&sync, 0, sizeof(sync));
+	sync.packet_size = packet_size;
+
+	return serial_stream_detect_sync(serial, buf, buflen, &sync, is_valid,
+					 timeout_ms, baudrate);
+}
+
 /**
  * Extract the serial device and options from the options linked list.
  *
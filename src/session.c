@@ -230,6 +230,8 @@ SR_API int sr_session_new(struct sr_context *ctx,
 	 */
 	session->event_sources = g_hash_table_new(NULL, NULL);
 
+	sr_session_metrics_init(session);
+
 	*new_session = session;
 
 	return SR_OK;
@@ -262,6 +264,8 @@ SR_API int sr_session_destroy(struct sr_session *session)
 
 	g_mutex_clear(&session->main_mutex);
 
+	sr_session_metrics_cleanup(session);
+
 	g_free(session);
 
 	return SR_OK;
@@ -1072,26 +1076,22 @@ static void datafeed_dump(const struct sr_datafeed_packet *packet)
 	}
 }
 
-/**
- * Send a packet to whatever is listening on the datafeed bus.
- *
- * Hardware drivers use this to send a data packet to the frontend.
- *
- * @param sdi TODO.
- * @param packet The datafeed packet to send to the session bus.
- *
- * @retval SR_OK Success.
- * @retval SR_ERR_ARG Invalid argument.
- *
- * @private
+/*
+ * Pass a packet through the transform modules after @p from, or all of
+ * them if @p from is NULL, then to the datafeed callbacks. The device
+ * stage metrics only account for packets sent by the device itself.
  */
-SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
-		const struct sr_datafeed_packet *packet)
+static int session_send(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet,
+		const struct sr_transform *from)
 {
 	GSList *l;
 	struct datafeed_callback *cb_struct;
 	struct sr_datafeed_packet *packet_in, *packet_out;
 	struct sr_transform *t;
+	struct sr_session *session;
+	gboolean metrics;
+	int64_t start, t0, t1;
 	int ret;
 
 	if (!sdi) {
@@ -1104,21 +1104,40 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 		return SR_ERR_ARG;
 	}
 
-	if (!sdi->session) {
+	if (!(session = sdi->session)) {
 		sr_err("%s: session was NULL", __func__);
 		return SR_ERR_BUG;
 	}
 
+	l = session->transforms;
+	if (from) {
+		if (!(l = g_slist_find(session->transforms, from))) {
+			sr_err("%s: transform not in session", __func__);
+			return SR_ERR_BUG;
+		}
+		l = l->next;
+	}
+
+	/* Timestamps are only taken while metrics are being collected. */
+	metrics = session->metrics_enabled;
+	start = t0 = metrics ? g_get_monotonic_time() : 0;
+
 	/*
 	 * Pass the packet to the first transform module. If that returns
 	 * another packet (instead of NULL), pass that packet to the next
 	 * transform module in the list, and so on.
 	 */
 	packet_in = (struct sr_datafeed_packet *)packet;
-	for (l = sdi->session->transforms; l; l = l->next) {
+	for (; l; l = l->next) {
 		t = l->data;
 		sr_spew("Running transform module '%s'.", t->module->id);
 		ret = t->module->receive(t, packet_in, &packet_out);
+		if (metrics) {
+			t1 = g_get_monotonic_time();
+			sr_session_metrics_add(session, SR_METRICS_TRANSFORM,
+					t, packet_in, t1 - t0);
+			t0 = t1;
+		}
 		if (ret < 0) {
 			sr_err("Error while running transform module: %d.", ret);
 			return SR_ERR;
@@ -1129,6 +1148,9 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 			 * packet, abort.
 			 */
 			sr_spew("Transform module didn't return a packet, aborting.");
+			if (metrics && !from)
+				sr_session_metrics_add(session, SR_METRICS_DEVICE,
+						sdi, packet, t0 - start);
 			return SR_OK;
 		} else {
 			/*
@@ -1138,22 +1160,79 @@ SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
 			packet_in = packet_out;
 		}
 	}
-	packet = packet_in;
 
 	/*
 	 * If the last transform did output a packet, pass it to all datafeed
 	 * callbacks.
 	 */
-	for (l = sdi->session->datafeed_callbacks; l; l = l->next) {
+	for (l = session->datafeed_callbacks; l; l = l->next) {
 		if (sr_log_loglevel_get() >= SR_LOG_DBG)
-			datafeed_dump(packet);
+			datafeed_dump(packet_in);
 		cb_struct = l->data;
-		cb_struct->cb(sdi, packet, cb_struct->cb_data);
+		if (metrics)
+			t0 = g_get_monotonic_time();
+		cb_struct->cb(sdi, packet_in, cb_struct->cb_data);
+		if (metrics) {
+			t1 = g_get_monotonic_time();
+			sr_session_metrics_add(session, SR_METRICS_CALLBACK,
+					cb_struct, packet_in, t1 - t0);
+		}
 	}
 
+	/* Device stage: the packet as sent, and the whole time taken. */
+	if (metrics && !from)
+		sr_session_metrics_add(session, SR_METRICS_DEVICE, sdi, packet,
+				g_get_monotonic_time() - start);
+
 	return SR_OK;
 }
 
+/**
+ * Send a packet to whatever is listening on the datafeed bus.
+ *
+ * Hardware drivers use this to send a data packet to the frontend.
+ *
+ * @param sdi TODO.
+ * @param packet The datafeed packet to send to the session bus.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @private
+ */
+SR_PRIV int sr_session_send(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet)
+{
+	return session_send(sdi, packet, NULL);
+}
+
+/**
+ * Send an additional packet from a transform module.
+ *
+ * The packet is passed on as if the transform module had returned it
+ * from its receive() callback, i.e. to the transform modules after it
+ * and then to the datafeed callbacks. This lets a transform module
+ * emit more than one packet for a packet it received.
+ *
+ * @param t The transform module sending the packet. Must not be NULL.
+ * @param packet The datafeed packet to send.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @private
+ */
+SR_PRIV int sr_session_send_from(const struct sr_transform *t,
+		const struct sr_datafeed_packet *packet)
+{
+	if (!t) {
+		sr_err("%s: transform was NULL", __func__);
+		return SR_ERR_ARG;
+	}
+
+	return session_send(t->sdi, packet, t);
+}
+
 /**
  * Add an event source for a file descriptor.
  *
@@ -1460,6 +1539,7 @@ SR_PRIV int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	const struct sr_datafeed_analog *analog;
 	struct sr_datafeed_analog *analog_copy;
 	uint8_t *payload;
+	size_t size;
 
 	*copy = g_malloc0(sizeof(struct sr_datafeed_packet));
 	(*copy)->type = packet->type;
@@ -1467,6 +1547,8 @@ SR_PRIV int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
@@ -1477,7 +1559,7 @@ SR_PRIV int sr_packet_copy(const struct sr_datafeed_packet *packet,
 	case SR_DF_META:
 		meta = packet->payload;
 		meta_copy = g_malloc0(sizeof(struct sr_datafeed_meta));
-		g_slist_foreach(meta->config, (GFunc)copy_src, meta_copy->config);
+		g_slist_foreach(meta->config, (GFunc)copy_src, meta_copy);
 		(*copy)->payload = meta_copy;
 		break;
 	case SR_DF_LOGIC:
@@ -1485,16 +1567,17 @@ SR_PRIV int sr_packet_copy(const struct sr_datafeed_packet *packet,
 		logic_copy = g_malloc(sizeof(*logic_copy));
 		logic_copy->length = logic->length;
 		logic_copy->unitsize = logic->unitsize;
-		memcpy(logic_copy->data, logic->data, logic->length * logic->unitsize);
+		logic_copy->data = g_malloc(logic->length);
+		memcpy(logic_copy->data, logic->data, logic->length);
 		(*copy)->payload = logic_copy;
 		break;
 	case SR_DF_ANALOG:
 		analog = packet->payload;
 		analog_copy = g_malloc(sizeof(*analog_copy));
-		analog_copy->data = g_malloc(
-				analog->encoding->unitsize * analog->num_samples);
-		memcpy(analog_copy->data, analog->data,
-				analog->encoding->unitsize * analog->num_samples);
+		size = analog->encoding->unitsize * analog->num_samples
+			* g_slist_length(analog->meaning->channels);
+		analog_copy->data = g_malloc(size);
+		memcpy(analog_copy->data, analog->data, size);
 		analog_copy->num_samples = analog->num_samples;
 		analog_copy->encoding = g_memdup(analog->encoding,
 				sizeof(struct sr_analog_encoding));
@@ -1525,6 +1608,8 @@ void sr_packet_free(struct sr_datafeed_packet *packet)
 	switch (packet->type) {
 	case SR_DF_TRIGGER:
 	case SR_DF_END:
+	case SR_DF_FRAME_BEGIN:
+	case SR_DF_FRAME_END:
 		/* No payload. */
 		break;
 	case SR_DF_HEADER:
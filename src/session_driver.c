@@ -41,6 +41,7 @@ struct session_vdev {
 	char *capturefile;
 	struct zip *archive;
 	struct zip_file *capfile;
+	GKeyFile *metadata;
 	int bytes_read;
 	uint64_t samplerate;
 	int unitsize;
@@ -48,6 +49,8 @@ struct session_vdev {
 	int num_analog_channels;
 	int cur_analog_channel;
 	GArray *analog_channels;
+	/* Encoding of the analog chunk being read. */
+	struct sr_analog_encoding encoding;
 	int cur_chunk;
 	gboolean finished;
 };
@@ -61,6 +64,42 @@ static const uint32_t devopts[] = {
 	SR_CONF_SESSIONFILE | SR_CONF_SET,
 };
 
+static void reset_encoding(struct session_vdev *vdev)
+{
+	struct sr_datafeed_analog analog;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+
+	/* TODO: Use proper 'digits' value for this device (and its modes). */
+	sr_analog_init(&analog, &vdev->encoding, &meaning, &spec, 2);
+}
+
+/*
+ * Analog chunks are float unless the metadata says otherwise. A change
+ * of encoding is recorded for the chunk it takes effect with.
+ */
+static int update_encoding(struct session_vdev *vdev)
+{
+	char *key, *val;
+	int ret;
+
+	if (!vdev->metadata || vdev->cur_analog_channel == 0
+			|| vdev->cur_chunk == 0)
+		return SR_OK;
+
+	key = g_strdup_printf("encoding analog-1-%d-%d",
+			vdev->num_channels + vdev->cur_analog_channel,
+			vdev->cur_chunk);
+	val = g_key_file_get_string(vdev->metadata, "device 1", key, NULL);
+	g_free(key);
+	if (!val)
+		return SR_OK;
+	ret = sr_sessionfile_encoding_parse(val, &vdev->encoding);
+	g_free(val);
+
+	return ret;
+}
+
 static gboolean stream_session_data(struct sr_dev_inst *sdi)
 {
 	struct session_vdev *vdev;
@@ -71,7 +110,7 @@ static gboolean stream_session_data(struct sr_dev_inst *sdi)
 	struct sr_analog_meaning meaning;
 	struct sr_analog_spec spec;
 	struct zip_stat zs;
-	int ret, got_data;
+	int ret, got_data, unitsize;
 	char capturefile[16];
 	void *buf;
 
@@ -116,24 +155,32 @@ static gboolean stream_session_data(struct sr_dev_inst *sdi)
 					return FALSE;
 				sr_dbg("Opened %s.", capturefile);
 			} else if (vdev->cur_analog_channel < vdev->num_analog_channels) {
+				g_free(vdev->capturefile);
 				vdev->capturefile = g_strdup_printf("analog-1-%d",
 						vdev->num_channels + vdev->cur_analog_channel + 1);
 				vdev->cur_analog_channel++;
 				vdev->cur_chunk = 0;
+				reset_encoding(vdev);
 				return TRUE;
 			} else {
 				/* We got all the chunks, finish up. */
 				return FALSE;
 			}
 		}
+		if (update_encoding(vdev) != SR_OK)
+			return FALSE;
 	}
 
 	buf = g_malloc(CHUNKSIZE);
 
 	/* unitsize is not defined for purely analog session files. */
-	if (vdev->unitsize)
+	if (vdev->cur_analog_channel != 0)
+		unitsize = vdev->encoding.unitsize;
+	else
+		unitsize = vdev->unitsize;
+	if (unitsize)
 		ret = zip_fread(vdev->capfile, buf,
-				CHUNKSIZE / vdev->unitsize * vdev->unitsize);
+				CHUNKSIZE / unitsize * unitsize);
 	else
 		ret = zip_fread(vdev->capfile, buf, CHUNKSIZE);
 
@@ -142,16 +189,17 @@ static gboolean stream_session_data(struct sr_dev_inst *sdi)
 		if (vdev->cur_analog_channel != 0) {
 			packet.type = SR_DF_ANALOG;
 			packet.payload = &analog;
-			/* TODO: Use proper 'digits' value for this device (and its modes). */
-			sr_analog_init(&analog, &encoding, &meaning, &spec, 2);
+			sr_analog_init(&analog, &encoding, &meaning, &spec,
+					vdev->encoding.digits);
+			encoding = vdev->encoding;
 			analog.meaning->channels = g_slist_prepend(NULL,
 					g_array_index(vdev->analog_channels,
 						struct sr_channel *, vdev->cur_analog_channel - 1));
-			analog.num_samples = ret / sizeof(float);
+			analog.num_samples = ret / encoding.unitsize;
 			analog.meaning->mq = SR_MQ_VOLTAGE;
 			analog.meaning->unit = SR_UNIT_VOLT;
 			analog.meaning->mqflags = SR_MQFLAG_DC;
-			analog.data = (float *) buf;
+			analog.data = buf;
 		} else {
 			if (ret % vdev->unitsize != 0)
 				sr_warn("Read size %d not a multiple of the"
@@ -164,6 +212,8 @@ static gboolean stream_session_data(struct sr_dev_inst *sdi)
 		}
 		vdev->bytes_read += ret;
 		sr_session_send(sdi, &packet);
+		if (packet.type == SR_DF_ANALOG)
+			g_slist_free(analog.meaning->channels);
 	} else {
 		/* done with this capture file */
 		zip_fclose(vdev->capfile);
@@ -203,6 +253,10 @@ static int receive_data(int fd, int revents, void *cb_data)
 		zip_discard(vdev->archive);
 		vdev->archive = NULL;
 	}
+	if (vdev->metadata) {
+		g_key_file_free(vdev->metadata);
+		vdev->metadata = NULL;
+	}
 
 	std_session_send_df_end(sdi);
 
@@ -339,6 +393,7 @@ static int config_list(uint32_t key, GVariant **data, const struct sr_dev_inst *
 static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 {
 	struct session_vdev *vdev;
+	struct zip_stat zs;
 	int ret;
 	GSList *l;
 	struct sr_channel *ch;
@@ -364,6 +419,13 @@ static int dev_acquisition_start(const struct sr_dev_inst *sdi)
 		       "zip error %d.", vdev->sessionfile, ret);
 		return SR_ERR;
 	}
+	if (zip_stat(vdev->archive, "metadata", 0, &zs) < 0
+			|| !(vdev->metadata = sr_sessionfile_read_metadata(
+				vdev->archive, &zs))) {
+		zip_discard(vdev->archive);
+		vdev->archive = NULL;
+		return SR_ERR_DATA;
+	}
 
 	std_session_send_df_header(sdi);
 
@@ -104,6 +104,117 @@ SR_PRIV GKeyFile *sr_sessionfile_read_metadata(struct zip *archive,
 	return keyfile;
 }
 
+static char *rational_string(const struct sr_rational *r)
+{
+	return g_strdup_printf("%" PRId64 "/%" PRIu64, r->p, r->q);
+}
+
+static int parse_rational(const char *s, struct sr_rational *r)
+{
+	char *end;
+
+	r->p = g_ascii_strtoll(s, &end, 10);
+	if (end == s || *end != '/')
+		return SR_ERR_DATA;
+	s = end + 1;
+	r->q = g_ascii_strtoull(s, &end, 10);
+	if (end == s || *end != '\0' || r->q == 0)
+		return SR_ERR_DATA;
+
+	return SR_OK;
+}
+
+/**
+ * Describe how the samples of an analog chunk are stored.
+ *
+ * The description is kept in the metadata as e.g. "s16le 1/1000 0/1 3":
+ * the sample type, scale, offset and digits. A type starts with 'f' for
+ * floating point, 's' for signed or 'u' for unsigned integers, followed
+ * by the number of bits and, for multi-byte types, "le" or "be".
+ *
+ * @param[in] encoding The encoding of the stored samples.
+ * @return A newly allocated string, to be freed with g_free().
+ *
+ * @private
+ */
+SR_PRIV char *sr_sessionfile_encoding_string(
+		const struct sr_analog_encoding *encoding)
+{
+	char *scale, *offset, *s;
+
+	scale = rational_string(&encoding->scale);
+	offset = rational_string(&encoding->offset);
+	s = g_strdup_printf("%c%d%s %s %s %d",
+			encoding->is_float ? 'f' : encoding->is_signed ? 's' : 'u',
+			encoding->unitsize * 8, encoding->unitsize == 1 ? "" :
+			encoding->is_bigendian ? "be" : "le",
+			scale, offset, encoding->digits);
+	g_free(scale);
+	g_free(offset);
+
+	return s;
+}
+
+/**
+ * Parse the description of how the samples of an analog chunk are stored.
+ *
+ * @param[in] s A description as created by sr_sessionfile_encoding_string().
+ * @param[out] encoding The encoding to fill in. Only the fields which are
+ *                      part of the description are changed.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_DATA Malformed or unsupported description.
+ *
+ * @private
+ */
+SR_PRIV int sr_sessionfile_encoding_parse(const char *s,
+		struct sr_analog_encoding *encoding)
+{
+	struct sr_analog_encoding enc;
+	char **tokens, *end;
+	uint64_t bits;
+	int64_t digits;
+	int ret;
+
+	enc = *encoding;
+	ret = SR_ERR_DATA;
+	tokens = g_strsplit(s, " ", 0);
+	if (g_strv_length(tokens) != 4 || !strchr("fsu", tokens[0][0]))
+		goto out;
+
+	enc.is_float = tokens[0][0] == 'f';
+	enc.is_signed = tokens[0][0] != 'u';
+	bits = g_ascii_strtoull(tokens[0] + 1, &end, 10);
+	if (bits != 8 && bits != 16 && bits != 32 && bits != 64)
+		goto out;
+	if (enc.is_float && bits != 32 && bits != 64)
+		goto out;
+	enc.unitsize = bits / 8;
+	if (!strcmp(end, "be") && bits > 8)
+		enc.is_bigendian = TRUE;
+	else if (!strcmp(end, "le") && bits > 8)
+		enc.is_bigendian = FALSE;
+	else if (*end || bits > 8)
+		goto out;
+
+	if (parse_rational(tokens[1], &enc.scale) != SR_OK
+			|| parse_rational(tokens[2], &enc.offset) != SR_OK)
+		goto out;
+	digits = g_ascii_strtoll(tokens[3], &end, 10);
+	if (*end || digits < INT8_MIN || digits > INT8_MAX)
+		goto out;
+	enc.digits = digits;
+
+	*encoding = enc;
+	ret = SR_OK;
+out:
+	if (ret != SR_OK)
+		sr_err("Invalid analog encoding '%s'.", s);
+	g_strfreev(tokens);
+
+	return ret;
+}
+
 /** @private */
 SR_PRIV int sr_sessionfile_check(const char *filename)
 {
@@ -144,7 +255,7 @@ SR_PRIV int sr_sessionfile_check(const char *filename)
 	zip_fclose(zf);
 	s[ret] = '\0';
 	version = g_ascii_strtoull(s, NULL, 10);
-	if (version == 0 || version > 2) {
+	if (version == 0 || version > 3) {
 		sr_dbg("Cannot handle sigrok session file version %" PRIu64 ".",
 			version);
 		zip_discard(archive);
@@ -0,0 +1,336 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+/** @cond PRIVATE */
+#define LOG_PREFIX "session-metrics"
+/** @endcond */
+
+/**
+ * @file
+ *
+ * Counters and latency histograms for the session datafeed path.
+ */
+
+/**
+ * @addtogroup grp_session
+ *
+ * @{
+ */
+
+static void stage_free(void *data)
+{
+	struct sr_metrics_stage *stage;
+
+	stage = data;
+	g_free(stage->name);
+	g_free(stage);
+}
+
+/* Lookup (or create) the stage for @a key. Must be called with the lock held. */
+static struct sr_metrics_stage *stage_get(struct sr_session *session,
+		int type, const void *key)
+{
+	struct sr_metrics_stage *stage;
+	const struct sr_dev_inst *sdi;
+	const struct sr_transform *t;
+
+	if ((stage = g_hash_table_lookup(session->metrics, key)))
+		return stage;
+
+	stage = g_malloc0(sizeof(struct sr_metrics_stage));
+	stage->type = type;
+	switch (type) {
+	case SR_METRICS_DEVICE:
+		sdi = key;
+		stage->index = g_slist_index(session->devs, key);
+		stage->name = g_strdup(sdi->driver ? sdi->driver->name : "user");
+		break;
+	case SR_METRICS_TRANSFORM:
+		t = key;
+		stage->index = g_slist_index(session->transforms, key);
+		stage->name = g_strdup(t->module->id);
+		break;
+	default:
+		stage->index = g_slist_index(session->datafeed_callbacks, key);
+		stage->name = g_strdup("callback");
+		break;
+	}
+	g_hash_table_insert(session->metrics, (void *)key, stage);
+
+	return stage;
+}
+
+static uint64_t packet_bytes(const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+
+	switch (packet->type) {
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		return logic->length;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		return (uint64_t)analog->num_samples * analog->encoding->unitsize;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Account one packet passing through a stage of the datafeed path.
+ *
+ * @param session The session. Must not be NULL.
+ * @param type The stage type, enum sr_metrics_stage_type.
+ * @param key The device instance, transform or datafeed callback.
+ * @param packet The packet passed to the stage.
+ * @param usec The time spent in the stage, in microseconds.
+ *
+ * @private
+ */
+SR_PRIV void sr_session_metrics_add(struct sr_session *session, int type,
+		const void *key, const struct sr_datafeed_packet *packet,
+		int64_t usec)
+{
+	struct sr_metrics_stage *stage;
+	unsigned int bucket;
+
+	usec = MAX(usec, 0);
+	bucket = 0;
+	while ((usec >> bucket) && bucket < SR_METRICS_HIST_BUCKETS - 1)
+		bucket++;
+
+	g_mutex_lock(&session->metrics_mutex);
+	stage = stage_get(session, type, key);
+	stage->packets++;
+	stage->bytes += packet_bytes(packet);
+	stage->time_total += usec;
+	stage->time_max = MAX(stage->time_max, (uint64_t)usec);
+	stage->histogram[bucket]++;
+	g_mutex_unlock(&session->metrics_mutex);
+}
+
+/**
+ * Account a completed USB transfer of a device.
+ *
+ * To be called by drivers from their transfer completion callback.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ * @param empty TRUE if the transfer completed without any data.
+ *
+ * @private
+ */
+SR_PRIV void sr_session_metrics_usb_transfer(const struct sr_dev_inst *sdi,
+		gboolean empty)
+{
+	struct sr_session *session;
+	struct sr_metrics_stage *stage;
+
+	session = sdi->session;
+	if (!session || !session->metrics_enabled)
+		return;
+
+	g_mutex_lock(&session->metrics_mutex);
+	stage = stage_get(session, SR_METRICS_DEVICE, sdi);
+	stage->usb_transfers++;
+	if (empty)
+		stage->usb_empty_transfers++;
+	g_mutex_unlock(&session->metrics_mutex);
+}
+
+/**
+ * Account a failed USB transfer resubmission of a device.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_session_metrics_usb_resubmit_failed(const struct sr_dev_inst *sdi)
+{
+	struct sr_session *session;
+
+	session = sdi->session;
+	if (!session || !session->metrics_enabled)
+		return;
+
+	g_mutex_lock(&session->metrics_mutex);
+	stage_get(session, SR_METRICS_DEVICE, sdi)->usb_resubmit_failures++;
+	g_mutex_unlock(&session->metrics_mutex);
+}
+
+/**
+ * Account a frame a device dropped because the bus fell behind.
+ *
+ * @param sdi The device instance. Must not be NULL.
+ *
+ * @private
+ */
+SR_PRIV void sr_session_metrics_frame_dropped(const struct sr_dev_inst *sdi)
+{
+	struct sr_session *session;
+
+	session = sdi->session;
+	if (!session || !session->metrics_enabled)
+		return;
+
+	g_mutex_lock(&session->metrics_mutex);
+	stage_get(session, SR_METRICS_DEVICE, sdi)->frames_dropped++;
+	g_mutex_unlock(&session->metrics_mutex);
+}
+
+/**
+ * Enable or disable collection of metrics in a session.
+ *
+ * Collection is disabled by default. While enabled, the number of
+ * packets and bytes and the time spent are recorded for every device,
+ * transform and datafeed callback of the session. Disabling collection
+ * keeps the metrics recorded so far.
+ *
+ * @param session The session to use. Must not be NULL.
+ * @param enable TRUE to enable collection, FALSE to disable it.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid session passed.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_session_metrics_enable(struct sr_session *session,
+		gboolean enable)
+{
+	if (!session) {
+		sr_err("%s: session was NULL", __func__);
+		return SR_ERR_ARG;
+	}
+
+	session->metrics_enabled = enable;
+
+	return SR_OK;
+}
+
+/**
+ * Discard all metrics recorded in a session.
+ *
+ * @param session The session to use. Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid session passed.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_session_metrics_reset(struct sr_session *session)
+{
+	if (!session) {
+		sr_err("%s: session was NULL", __func__);
+		return SR_ERR_ARG;
+	}
+
+	g_mutex_lock(&session->metrics_mutex);
+	g_hash_table_remove_all(session->metrics);
+	g_mutex_unlock(&session->metrics_mutex);
+
+	return SR_OK;
+}
+
+static gint stage_compare(gconstpointer a, gconstpointer b)
+{
+	const struct sr_metrics_stage *sa, *sb;
+
+	sa = a;
+	sb = b;
+	if (sa->type != sb->type)
+		return sa->type - sb->type;
+
+	return sa->index - sb->index;
+}
+
+/**
+ * Get a snapshot of the metrics recorded in a session.
+ *
+ * This may be called from any thread, also while the session is running.
+ *
+ * @param session The session to use. Must not be NULL.
+ * @param stages Pointer which will be set to a newly allocated list of
+ *               struct sr_metrics_stage pointers, ordered by type and
+ *               index. The list must be freed with sr_session_metrics_free().
+ *               Must not be NULL.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_session_metrics_get(struct sr_session *session, GSList **stages)
+{
+	GHashTableIter iter;
+	struct sr_metrics_stage *stage, *copy;
+	void *value;
+
+	if (!session || !stages)
+		return SR_ERR_ARG;
+
+	*stages = NULL;
+	g_mutex_lock(&session->metrics_mutex);
+	g_hash_table_iter_init(&iter, session->metrics);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		stage = value;
+		copy = g_memdup(stage, sizeof(struct sr_metrics_stage));
+		copy->name = g_strdup(stage->name);
+		*stages = g_slist_prepend(*stages, copy);
+	}
+	g_mutex_unlock(&session->metrics_mutex);
+
+	*stages = g_slist_sort(*stages, stage_compare);
+
+	return SR_OK;
+}
+
+/**
+ * Free a metrics snapshot obtained from sr_session_metrics_get().
+ *
+ * @param stages The list to free. May be NULL.
+ *
+ * @since 0.6.0
+ */
+SR_API void sr_session_metrics_free(GSList *stages)
+{
+	g_slist_free_full(stages, stage_free);
+}
+
+/** @private */
+SR_PRIV void sr_session_metrics_init(struct sr_session *session)
+{
+	g_mutex_init(&session->metrics_mutex);
+	session->metrics = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, stage_free);
+}
+
+/** @private */
+SR_PRIV void sr_session_metrics_cleanup(struct sr_session *session)
+{
+	g_hash_table_destroy(session->metrics);
+	g_mutex_clear(&session->metrics_mutex);
+}
+
+/** @} */
@@ -18,6 +18,7 @@
  */
 
 #include <config.h>
+#include <math.h>
 #include <string.h>
 #include <libsigrok/libsigrok.h>
 #include "libsigrok-internal.h"
@@ -31,63 +32,98 @@ SR_PRIV struct soft_trigger_logic *soft_trigger_logic_new(
 		int pre_trigger_samples)
 {
 	struct soft_trigger_logic *stl;
+	struct sr_channel *ch;
+	GSList *l;
+	int num_logic_channels;
+
+	/* Only logic channels take part in the sample width. */
+	num_logic_channels = 0;
+	for (l = sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (ch->type == SR_CHANNEL_LOGIC)
+			num_logic_channels++;
+	}
 
 	stl = g_malloc0(sizeof(struct soft_trigger_logic));
 	stl->sdi = sdi;
 	stl->trigger = trigger;
-	stl->unitsize = (g_slist_length(sdi->channels) + 7) / 8;
+	stl->unitsize = (num_logic_channels + 7) / 8;
 	stl->prev_sample = g_malloc0(stl->unitsize);
-	stl->pre_trigger_size = stl->unitsize * pre_trigger_samples;
-	stl->pre_trigger_buffer = g_malloc(stl->pre_trigger_size);
-	stl->pre_trigger_head = stl->pre_trigger_buffer;
-
-	if (stl->pre_trigger_size > 0 && !stl->pre_trigger_buffer) {
-		soft_trigger_logic_free(stl);
-		return NULL;
-	}
+	stl->pre_trigger_size = (uint64_t)stl->unitsize
+			* MAX(pre_trigger_samples, 0);
+	stl->pre_trigger_budget = SOFT_TRIGGER_MEMORY_BUDGET;
+	stl->pre_trigger_buffers = g_queue_new();
 
 	return stl;
 }
 
 SR_PRIV void soft_trigger_logic_free(struct soft_trigger_logic *stl)
 {
-	g_free(stl->pre_trigger_buffer);
+	g_queue_free_full(stl->pre_trigger_buffers,
+		(GDestroyNotify)g_bytes_unref);
 	g_free(stl->prev_sample);
 	g_free(stl);
 }
 
-static void pre_trigger_append(struct soft_trigger_logic *stl,
-		uint8_t *buf, int len)
+/* The number of bytes before the trigger which are to be sent. */
+static uint64_t pre_trigger_wanted(const struct soft_trigger_logic *stl)
 {
-	/* Avoid uselessly copying more than the pre-trigger size. */
-	if (len > stl->pre_trigger_size) {
-		buf += len - stl->pre_trigger_size;
-		len = stl->pre_trigger_size;
+	return MIN(stl->pre_trigger_size,
+		stl->pre_trigger_budget / stl->unitsize * stl->unitsize);
+}
+
+/* Keep a buffer for the pre-trigger data, and let go of older ones. */
+static void pre_trigger_append(struct soft_trigger_logic *stl, GBytes *bytes)
+{
+	GBytes *oldest;
+	const uint8_t *data;
+	uint64_t wanted;
+	gsize size, skip;
+
+	wanted = pre_trigger_wanted(stl);
+	if (!wanted || !g_bytes_get_size(bytes)) {
+		g_bytes_unref(bytes);
+		return;
 	}
 
-	/* Update the filling level of the pre-trigger circular buffer. */
-	stl->pre_trigger_fill = MIN(stl->pre_trigger_fill + len,
-	                            stl->pre_trigger_size);
+	g_queue_push_tail(stl->pre_trigger_buffers, bytes);
+	stl->pre_trigger_fill += g_bytes_get_size(bytes);
 
-	/* Actually copy data to the pre-trigger circular buffer. */
-	while (len > 0) {
-		size_t size = MIN(stl->pre_trigger_buffer + stl->pre_trigger_size
-		                  - stl->pre_trigger_head, len);
-		memcpy(stl->pre_trigger_head, buf, size);
-		stl->pre_trigger_head += size;
-		if (stl->pre_trigger_head >= stl->pre_trigger_buffer
-		                             + stl->pre_trigger_size)
-			stl->pre_trigger_head = stl->pre_trigger_buffer;
-		buf += size;
-		len -= size;
+	/* Drop buffers which are entirely older than the wanted samples. */
+	while ((oldest = g_queue_peek_head(stl->pre_trigger_buffers))) {
+		size = g_bytes_get_size(oldest);
+		if (stl->pre_trigger_fill - size < wanted)
+			break;
+		g_queue_pop_head(stl->pre_trigger_buffers);
+		stl->pre_trigger_fill -= size;
+		g_bytes_unref(oldest);
+	}
+
+	/*
+	 * Over the budget, only keep the part of the oldest buffer that
+	 * is still wanted. This is the only copy of pre-trigger data.
+	 */
+	if (stl->pre_trigger_fill > stl->pre_trigger_budget) {
+		oldest = g_queue_pop_head(stl->pre_trigger_buffers);
+		data = g_bytes_get_data(oldest, &size);
+		skip = stl->pre_trigger_fill - wanted;
+		g_queue_push_head(stl->pre_trigger_buffers,
+			g_bytes_new(data + skip, size - skip));
+		stl->pre_trigger_fill -= skip;
+		g_bytes_unref(oldest);
 	}
 }
 
+/* Send the kept buffers as they are, and let go of them. */
 static void pre_trigger_send(struct soft_trigger_logic *stl,
 		int *pre_trigger_samples)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_datafeed_logic logic;
+	GBytes *bytes;
+	const uint8_t *data;
+	uint64_t skip;
+	gsize size;
 
 	packet.type = SR_DF_LOGIC;
 	packet.payload = &logic;
@@ -96,22 +132,23 @@ static void pre_trigger_send(struct soft_trigger_logic *stl,
 	if (pre_trigger_samples)
 		*pre_trigger_samples = 0;
 
-	/* If pre-trigger buffer not full, rewind head to the first valid sample. */
-	if (stl->pre_trigger_fill < stl->pre_trigger_size)
-		stl->pre_trigger_head = stl->pre_trigger_buffer;
-
-	/* Send logic packets for the pre-trigger circular buffer content. */
-	while (stl->pre_trigger_fill > 0) {
-		size_t size = MIN(stl->pre_trigger_buffer + stl->pre_trigger_size
-		                  - stl->pre_trigger_head, stl->pre_trigger_fill);
-		logic.length = size;
-		logic.data = stl->pre_trigger_head;
-		sr_session_send(stl->sdi, &packet);
-		stl->pre_trigger_head = stl->pre_trigger_buffer;
-		stl->pre_trigger_fill -= size;
-		if (pre_trigger_samples)
-			*pre_trigger_samples += size / stl->unitsize;
+	/* The oldest buffer may reach back further than wanted. */
+	skip = stl->pre_trigger_fill - MIN(stl->pre_trigger_fill,
+		pre_trigger_wanted(stl));
+
+	while ((bytes = g_queue_pop_head(stl->pre_trigger_buffers))) {
+		data = g_bytes_get_data(bytes, &size);
+		if (skip < size) {
+			logic.length = size - skip;
+			logic.data = (uint8_t *)data + skip;
+			sr_session_send(stl->sdi, &packet);
+			if (pre_trigger_samples)
+				*pre_trigger_samples += logic.length / stl->unitsize;
+		}
+		skip -= MIN(skip, size);
+		g_bytes_unref(bytes);
 	}
+	stl->pre_trigger_fill = 0;
 }
 
 static gboolean logic_check_match(struct soft_trigger_logic *stl,
@@ -146,15 +183,19 @@ static gboolean logic_check_match(struct soft_trigger_logic *stl,
 	return result;
 }
 
-/* Returns the offset (in samples) within buf of where the trigger
- * occurred, or -1 if not triggered. */
-SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
-		uint8_t *buf, int len, int *pre_trigger_samples)
+/*
+ * Returns the offset (in samples) within buf of where the trigger
+ * occurred, or -1 if not triggered. Untriggered data is kept for the
+ * pre-trigger data: a reference to bytes if given, else a copy.
+ */
+static int logic_check(struct soft_trigger_logic *stl, uint8_t *buf,
+		int len, GBytes *bytes, int *pre_trigger_samples)
 {
 	struct sr_datafeed_packet packet;
 	struct sr_trigger_stage *stage;
 	struct sr_trigger_match *match;
 	GSList *l, *l_stage;
+	uint64_t size;
 	int offset;
 	int i;
 	gboolean match_found;
@@ -186,7 +227,7 @@ SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
 				stl->cur_stage++;
 			} else {
 				/* Matched on last stage, send pre-trigger data. */
-				pre_trigger_append(stl, buf, i);
+				pre_trigger_append(stl, g_bytes_new_static(buf, i));
 				pre_trigger_send(stl, pre_trigger_samples);
 
 				/* Fire trigger. */
@@ -215,8 +256,924 @@ SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
 		}
 	}
 
-	if (offset == -1)
-		pre_trigger_append(stl, buf, len);
+	if (offset == -1 && bytes) {
+		pre_trigger_append(stl, g_bytes_ref(bytes));
+	} else if (offset == -1) {
+		/* Only copy what may still be sent. */
+		size = MIN((uint64_t)len, pre_trigger_wanted(stl));
+		pre_trigger_append(stl, g_bytes_new(buf + len - size, size));
+	}
+
+	return offset;
+}
+
+SR_PRIV int soft_trigger_logic_check(struct soft_trigger_logic *stl,
+		uint8_t *buf, int len, int *pre_trigger_samples)
+{
+	return logic_check(stl, buf, len, NULL, pre_trigger_samples);
+}
+
+/*
+ * Like soft_trigger_logic_check(), but the data is in a buffer the soft
+ * trigger may keep a reference to for the pre-trigger data, instead of
+ * copying it. The buffer must not be modified after the call, drivers
+ * continue with another one (see soft_trigger_pool_get()).
+ */
+SR_PRIV int soft_trigger_logic_check_bytes(struct soft_trigger_logic *stl,
+		GBytes *bytes, int *pre_trigger_samples)
+{
+	gconstpointer data;
+	gsize size;
+
+	data = g_bytes_get_data(bytes, &size);
+
+	return logic_check(stl, (uint8_t *)data, size, bytes,
+		pre_trigger_samples);
+}
+
+/*
+ * A pool of buffers for data handed to the soft trigger. Buffers wrapped
+ * with soft_trigger_pool_wrap() come back to the pool once the soft
+ * trigger lets go of them, so drivers can take a buffer from the pool
+ * for every transfer without allocating all the time. The pool must
+ * outlive the soft trigger.
+ */
+
+struct pool_buffer {
+	struct soft_trigger_pool *pool;
+	uint8_t *buf;
+};
+
+SR_PRIV struct soft_trigger_pool *soft_trigger_pool_new(gsize buffer_size)
+{
+	struct soft_trigger_pool *pool;
+
+	pool = g_malloc0(sizeof(struct soft_trigger_pool));
+	pool->buffer_size = buffer_size;
+
+	return pool;
+}
+
+SR_PRIV void soft_trigger_pool_free(struct soft_trigger_pool *pool)
+{
+	if (!pool)
+		return;
+
+	g_slist_free_full(pool->free_buffers, g_free);
+	g_free(pool);
+}
+
+/* Take a buffer from the pool. Free it with g_free() if not wrapped. */
+SR_PRIV uint8_t *soft_trigger_pool_get(struct soft_trigger_pool *pool)
+{
+	uint8_t *buf;
+
+	if (!pool->free_buffers)
+		return g_malloc(pool->buffer_size);
+
+	buf = pool->free_buffers->data;
+	pool->free_buffers = g_slist_delete_link(pool->free_buffers,
+		pool->free_buffers);
+
+	return buf;
+}
+
+static void pool_buffer_release(gpointer data)
+{
+	struct pool_buffer *pb;
+
+	pb = data;
+	pb->pool->free_buffers = g_slist_prepend(pb->pool->free_buffers, pb->buf);
+	g_free(pb);
+}
+
+/* Wrap the first length bytes of a pool buffer for the soft trigger. */
+SR_PRIV GBytes *soft_trigger_pool_wrap(struct soft_trigger_pool *pool,
+		uint8_t *buf, gsize length)
+{
+	struct pool_buffer *pb;
+
+	pb = g_malloc(sizeof(struct pool_buffer));
+	pb->pool = pool;
+	pb->buf = buf;
+
+	return g_bytes_new_with_free_func(buf, length, pool_buffer_release, pb);
+}
+
+
+/*
+ * Analog soft trigger.
+ *
+ * Matches on analog channels compare the physical value against a level,
+ * with hysteresis for edges, or the change of the value over a number of
+ * samples for slopes. A window is an over and an under match on the same
+ * channel in one stage. Logic channels may take part as well, as values
+ * of 0 and 1 against a level of 0.5.
+ *
+ * Every stream of packets (the logic data, and each set of analog
+ * channels) keeps its recent samples in a ring of its own. When the
+ * trigger fires, the pre-trigger part of all rings is sent, then the
+ * trigger, and then whatever the other streams have beyond the trigger
+ * position. All streams are assumed to run at the same samplerate. The
+ * matches of one stage must be on channels sent in the same packet.
+ */
+
+/* Analog trigger matches, with their state carried across packets. */
+struct analog_match {
+	const struct sr_channel *channel;
+	int type;
+	int stage;
+	float value;
+	float hysteresis;
+	/* Column of the channel in the current packet, or -1. */
+	int col;
+	gboolean result;
+	gboolean armed_rising;
+	gboolean armed_falling;
+	/* The last num_samples values, for slopes. */
+	float *history;
+	int num_samples;
+	int history_pos;
+	uint64_t count;
+};
+
+/* The recent samples of one stream of packets. */
+struct analog_stream {
+	int type;
+	GSList *channels;
+	unsigned int num_channels;
+	/* Bytes per sample, across all channels. */
+	unsigned int sample_size;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	uint8_t *ring;
+	/* Ring size, write position and filling level, in samples. */
+	uint64_t ring_size;
+	uint64_t head;
+	uint64_t fill;
+	/* Number of samples seen on this stream. */
+	uint64_t pos;
+};
+
+SR_PRIV struct soft_trigger_analog *soft_trigger_analog_new(
+		const struct sr_dev_inst *sdi, struct sr_trigger *trigger,
+		int pre_trigger_samples)
+{
+	struct soft_trigger_analog *sta;
+	struct sr_trigger_stage *stage;
+	struct sr_trigger_match *match;
+	struct analog_match *m;
+	GSList *l, *l_stage;
+	int num_matches, i;
+
+	num_matches = 0;
+	for (l_stage = trigger->stages; l_stage; l_stage = l_stage->next) {
+		stage = l_stage->data;
+		for (l = stage->matches; l; l = l->next) {
+			match = l->data;
+			if (match->channel->enabled)
+				num_matches++;
+		}
+	}
+
+	sta = g_malloc0(sizeof(struct soft_trigger_analog));
+	sta->sdi = sdi;
+	sta->trigger = trigger;
+	sta->num_stages = g_slist_length(trigger->stages);
+	sta->pre_trigger_samples = MAX(pre_trigger_samples, 0);
+	sta->matches = g_malloc0(sizeof(struct analog_match) * MAX(num_matches, 1));
+
+	i = 0;
+	for (l_stage = trigger->stages; l_stage; l_stage = l_stage->next) {
+		stage = l_stage->data;
+		for (l = stage->matches; l; l = l->next) {
+			match = l->data;
+			if (!match->channel->enabled)
+				/* Ignore disabled channels with a trigger. */
+				continue;
+			m = &sta->matches[i++];
+			m->channel = match->channel;
+			m->type = match->match;
+			m->stage = g_slist_position(trigger->stages, l_stage);
+			m->value = match->value;
+			m->hysteresis = MAX(match->hysteresis, 0);
+			m->num_samples = MAX(match->num_samples, 1);
+			if (m->channel->type == SR_CHANNEL_LOGIC) {
+				m->value = 0.5;
+				m->hysteresis = 0;
+				if (m->type == SR_TRIGGER_ZERO)
+					m->type = SR_TRIGGER_UNDER;
+				else if (m->type == SR_TRIGGER_ONE)
+					m->type = SR_TRIGGER_OVER;
+			}
+			if (m->type == SR_TRIGGER_SLOPE_UP
+					|| m->type == SR_TRIGGER_SLOPE_DOWN)
+				m->history = g_malloc0(sizeof(float) * m->num_samples);
+		}
+	}
+	sta->num_matches = i;
+
+	return sta;
+}
+
+static void stream_free(void *data)
+{
+	struct analog_stream *s;
+
+	s = data;
+	g_slist_free(s->channels);
+	g_free(s->ring);
+	g_free(s);
+}
+
+SR_PRIV void soft_trigger_analog_free(struct soft_trigger_analog *sta)
+{
+	int i;
+
+	for (i = 0; i < sta->num_matches; i++)
+		g_free(sta->matches[i].history);
+	g_free(sta->matches);
+	g_slist_free_full(sta->streams, stream_free);
+	g_free(sta->values);
+	g_free(sta);
+}
+
+static gboolean same_channels(const GSList *a, const GSList *b)
+{
+	while (a && b && a->data == b->data) {
+		a = a->next;
+		b = b->next;
+	}
+
+	return !a && !b;
+}
+
+static gboolean same_encoding(const struct sr_analog_encoding *a,
+		const struct sr_analog_encoding *b)
+{
+	return a->unitsize == b->unitsize && a->is_signed == b->is_signed
+		&& a->is_float == b->is_float
+		&& a->is_bigendian == b->is_bigendian
+		&& a->scale.p == b->scale.p && a->scale.q == b->scale.q
+		&& a->offset.p == b->offset.p && a->offset.q == b->offset.q;
+}
+
+/* Find the stream a packet belongs to, and follow changes of its layout. */
+static struct analog_stream *stream_get(struct soft_trigger_analog *sta,
+		const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct analog_stream *s;
+	GSList *l;
+	unsigned int sample_size;
+	gboolean changed;
+
+	logic = NULL;
+	analog = NULL;
+	if (packet->type == SR_DF_LOGIC)
+		logic = packet->payload;
+	else
+		analog = packet->payload;
+
+	s = NULL;
+	for (l = sta->streams; l; l = l->next) {
+		s = l->data;
+		if (s->type == packet->type && (logic
+				|| same_channels(s->channels, analog->meaning->channels)))
+			break;
+	}
+	if (!l) {
+		s = g_malloc0(sizeof(struct analog_stream));
+		s->type = packet->type;
+		if (analog) {
+			s->channels = g_slist_copy(analog->meaning->channels);
+			s->num_channels = g_slist_length(s->channels);
+		}
+		sta->streams = g_slist_append(sta->streams, s);
+	}
+
+	if (logic) {
+		sample_size = logic->unitsize;
+		changed = sample_size != s->sample_size;
+	} else {
+		sample_size = analog->encoding->unitsize * s->num_channels;
+		changed = sample_size != s->sample_size
+			|| !same_encoding(&s->encoding, analog->encoding);
+		s->encoding = *analog->encoding;
+		s->meaning = *analog->meaning;
+		s->meaning.channels = s->channels;
+		if (analog->spec)
+			s->spec = *analog->spec;
+	}
+
+	/* Samples of another layout can't go out with the new ones. */
+	if (changed) {
+		g_free(s->ring);
+		s->ring = NULL;
+		s->ring_size = 0;
+		s->head = 0;
+		s->fill = 0;
+		s->sample_size = sample_size;
+	}
+
+	return s;
+}
+
+static void stream_append(struct analog_stream *s, uint64_t pre_trigger_samples,
+		const uint8_t *data, uint64_t num_samples)
+{
+	uint8_t *ring;
+	uint64_t keep, size, first;
+
+	/* The ring keeps the pre-trigger samples before a whole packet. */
+	size = pre_trigger_samples + num_samples;
+	if (s->ring_size < size) {
+		keep = MIN(s->fill, pre_trigger_samples);
+		ring = g_malloc(size * s->sample_size);
+		if (keep > 0) {
+			first = (s->head + s->ring_size - keep) % s->ring_size;
+			size = MIN(keep, s->ring_size - first);
+			memcpy(ring, s->ring + first * s->sample_size,
+				size * s->sample_size);
+			memcpy(ring + size * s->sample_size, s->ring,
+				(keep - size) * s->sample_size);
+		}
+		g_free(s->ring);
+		s->ring = ring;
+		s->ring_size = pre_trigger_samples + num_samples;
+		s->head = keep % s->ring_size;
+		s->fill = keep;
+	}
+
+	s->pos += num_samples;
+	s->fill = MIN(s->fill + num_samples, s->ring_size);
+	while (num_samples > 0) {
+		size = MIN(s->ring_size - s->head, num_samples);
+		memcpy(s->ring + s->head * s->sample_size, data,
+			size * s->sample_size);
+		s->head = (s->head + size) % s->ring_size;
+		data += size * s->sample_size;
+		num_samples -= size;
+	}
+}
+
+static void stream_send_data(const struct soft_trigger_analog *sta,
+		struct analog_stream *s, uint8_t *data, uint64_t num_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+
+	packet.type = s->type;
+	if (s->type == SR_DF_LOGIC) {
+		logic.length = num_samples * s->sample_size;
+		logic.unitsize = s->sample_size;
+		logic.data = data;
+		packet.payload = &logic;
+	} else {
+		analog.data = data;
+		analog.num_samples = num_samples;
+		analog.encoding = &s->encoding;
+		analog.meaning = &s->meaning;
+		analog.spec = &s->spec;
+		packet.payload = &analog;
+	}
+	sr_session_send(sta->sdi, &packet);
+}
+
+/* Send the buffered samples of a stream in the range [start, end). */
+static uint64_t stream_send(const struct soft_trigger_analog *sta,
+		struct analog_stream *s, uint64_t start, uint64_t end)
+{
+	uint64_t num_samples, first, size;
+
+	start = MAX(start, s->pos - s->fill);
+	end = MIN(end, s->pos);
+	if (start >= end)
+		return 0;
+
+	num_samples = end - start;
+	first = (s->head + s->ring_size - (s->pos - start)) % s->ring_size;
+	size = MIN(num_samples, s->ring_size - first);
+	stream_send_data(sta, s, s->ring + first * s->sample_size, size);
+	if (size < num_samples)
+		stream_send_data(sta, s, s->ring, num_samples - size);
+
+	return num_samples;
+}
+
+/* Send the pre-trigger data of all streams and the trigger itself. */
+static void fire(struct soft_trigger_analog *sta, struct analog_stream *fired,
+		uint64_t position, int *pre_trigger_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct analog_stream *s;
+	GSList *l;
+	uint64_t start, sent;
+
+	sta->fired = TRUE;
+
+	start = position - MIN(position, sta->pre_trigger_samples);
+	for (l = sta->streams; l; l = l->next) {
+		s = l->data;
+		sent = stream_send(sta, s, start, position);
+		if (s == fired && pre_trigger_samples)
+			*pre_trigger_samples = sent;
+	}
+
+	packet.type = SR_DF_TRIGGER;
+	packet.payload = NULL;
+	sr_session_send(sta->sdi, &packet);
+
+	/* Streams that are ahead have sent their packets already. */
+	for (l = sta->streams; l; l = l->next) {
+		s = l->data;
+		if (s != fired)
+			stream_send(sta, s, position, s->pos);
+	}
+}
+
+static gboolean match_update(struct analog_match *m, float x)
+{
+	gboolean result;
+	float old;
+
+	result = FALSE;
+	switch (m->type) {
+	case SR_TRIGGER_OVER:
+		result = x > m->value;
+		break;
+	case SR_TRIGGER_UNDER:
+		result = x < m->value;
+		break;
+	case SR_TRIGGER_RISING:
+	case SR_TRIGGER_FALLING:
+	case SR_TRIGGER_EDGE:
+		/* An edge needs the value to come from beyond the hysteresis. */
+		if (m->type != SR_TRIGGER_FALLING) {
+			if (m->armed_rising && x >= m->value) {
+				result = TRUE;
+				m->armed_rising = FALSE;
+			}
+			if (x < m->value - m->hysteresis)
+				m->armed_rising = TRUE;
+		}
+		if (m->type != SR_TRIGGER_RISING) {
+			if (m->armed_falling && x <= m->value) {
+				result = TRUE;
+				m->armed_falling = FALSE;
+			}
+			if (x > m->value + m->hysteresis)
+				m->armed_falling = TRUE;
+		}
+		break;
+	case SR_TRIGGER_SLOPE_UP:
+	case SR_TRIGGER_SLOPE_DOWN:
+		if (m->count >= (uint64_t)m->num_samples) {
+			old = m->history[m->history_pos];
+			if (m->type == SR_TRIGGER_SLOPE_UP)
+				result = x - old >= m->value;
+			else
+				result = old - x >= m->value;
+		}
+		m->history[m->history_pos] = x;
+		m->history_pos = (m->history_pos + 1) % m->num_samples;
+		m->count++;
+		break;
+	}
+
+	return result;
+}
+
+static gboolean stage_matched(const struct soft_trigger_analog *sta, int stage)
+{
+	const struct analog_match *m;
+	int i;
+
+	for (i = 0; i < sta->num_matches; i++) {
+		m = &sta->matches[i];
+		if (m->stage != stage)
+			continue;
+		if (m->col < 0 || !m->result)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Threshold searches on raw sample values. A condition on the physical
+ * value becomes a bound on the raw values, which are then compared in
+ * chunks without branching, so the compiler can vectorize the loop.
+ * Only a chunk with a hit is searched sample by sample.
+ */
+
+#define SCAN_CHUNK 32
+
+enum {
+	SCAN_U8,
+	SCAN_S8,
+	SCAN_U16,
+	SCAN_S16,
+	SCAN_U32,
+	SCAN_S32,
+	SCAN_FLOAT,
+};
+
+static const int64_t scan_limits[][2] = {
+	[SCAN_U8] = { 0, UINT8_MAX },
+	[SCAN_S8] = { INT8_MIN, INT8_MAX },
+	[SCAN_U16] = { 0, UINT16_MAX },
+	[SCAN_S16] = { INT16_MIN, INT16_MAX },
+	[SCAN_U32] = { 0, UINT32_MAX },
+	[SCAN_S32] = { INT32_MIN, INT32_MAX },
+};
+
+struct raw_scan {
+	int kind;
+	const void *data;
+	unsigned int stride;
+	uint64_t num_samples;
+	/* The conversion to physical values. */
+	float scale;
+	float offset;
+};
+
+struct raw_bound {
+	/* Look for a raw value >= bound, else <= bound. */
+	gboolean ge;
+	gboolean never;
+	gboolean always;
+	int64_t i;
+	float f;
+};
+
+#define DEFINE_SCAN(name, type) \
+static uint64_t scan_##name(const void *data, unsigned int stride, \
+		uint64_t from, uint64_t num_samples, gboolean ge, type bound) \
+{ \
+	const type *p; \
+	uint64_t i, j; \
+	int hit; \
+\
+	p = data; \
+	for (i = from; i + SCAN_CHUNK <= num_samples; i += SCAN_CHUNK) { \
+		hit = 0; \
+		if (ge) { \
+			for (j = 0; j < SCAN_CHUNK; j++) \
+				hit |= p[(i + j) * stride] >= bound; \
+		} else { \
+			for (j = 0; j < SCAN_CHUNK; j++) \
+				hit |= p[(i + j) * stride] <= bound; \
+		} \
+		if (hit) \
+			break; \
+	} \
+	for (; i < num_samples; i++) { \
+		if (ge ? p[i * stride] >= bound : p[i * stride] <= bound) \
+			return i; \
+	} \
+\
+	return num_samples; \
+}
+
+DEFINE_SCAN(u8, uint8_t)
+DEFINE_SCAN(s8, int8_t)
+DEFINE_SCAN(u16, uint16_t)
+DEFINE_SCAN(s16, int16_t)
+DEFINE_SCAN(u32, uint32_t)
+DEFINE_SCAN(s32, int32_t)
+DEFINE_SCAN(float, float)
+
+static gboolean raw_scan_init(struct raw_scan *rs,
+		const struct sr_datafeed_analog *analog, int col,
+		unsigned int num_channels)
+{
+	const struct sr_analog_encoding *enc;
+	gboolean bigendian;
+
+#ifdef WORDS_BIGENDIAN
+	bigendian = TRUE;
+#else
+	bigendian = FALSE;
+#endif
+
+	enc = analog->encoding;
+	if (enc->unitsize > 1 && enc->is_bigendian != bigendian)
+		return FALSE;
+	if (!enc->scale.p || !enc->scale.q || !enc->offset.q)
+		return FALSE;
+
+	if (enc->is_float) {
+		if (enc->unitsize != sizeof(float)
+				|| enc->scale.p != (int64_t)enc->scale.q
+				|| enc->offset.p)
+			return FALSE;
+		rs->kind = SCAN_FLOAT;
+	} else if (enc->unitsize == 1) {
+		rs->kind = enc->is_signed ? SCAN_S8 : SCAN_U8;
+	} else if (enc->unitsize == 2) {
+		rs->kind = enc->is_signed ? SCAN_S16 : SCAN_U16;
+	} else if (enc->unitsize == 4) {
+		rs->kind = enc->is_signed ? SCAN_S32 : SCAN_U32;
+	} else {
+		return FALSE;
+	}
+
+	rs->data = (const uint8_t *)analog->data + col * enc->unitsize;
+	if ((uintptr_t)rs->data % enc->unitsize)
+		return FALSE;
+	rs->stride = num_channels;
+	rs->num_samples = analog->num_samples;
+	rs->scale = enc->scale.p / (float)enc->scale.q;
+	rs->offset = enc->offset.p / (float)enc->offset.q;
+
+	return TRUE;
+}
+
+/* Whether a raw value is on the wanted side, as sr_analog_to_float() has it. */
+static gboolean raw_cond(const struct raw_scan *rs, int64_t raw, float value,
+		gboolean above, gboolean strict)
+{
+	float x;
+
+	x = rs->scale * raw;
+	x += rs->offset;
+	if (above)
+		return strict ? x > value : x >= value;
+	else
+		return strict ? x < value : x <= value;
+}
+
+/* The bound for a physical value above (or below) value. */
+static void raw_bound_init(const struct raw_scan *rs, struct raw_bound *b,
+		float value, gboolean above, gboolean strict)
+{
+	int64_t min, max, i;
+	double t;
+
+	b->never = b->always = FALSE;
+
+	if (rs->kind == SCAN_FLOAT) {
+		b->ge = above;
+		b->f = value;
+		if (strict)
+			b->f = nextafterf(value, above ? INFINITY : -INFINITY);
+		return;
+	}
+
+	t = (value - (double)rs->offset) / rs->scale;
+	if (isnan(t)) {
+		b->never = TRUE;
+		return;
+	}
+
+	/*
+	 * Estimate the bound, then settle it against the conversion in
+	 * single precision, which may round across the exact threshold.
+	 */
+	min = scan_limits[rs->kind][0];
+	max = scan_limits[rs->kind][1];
+	i = CLAMP(t, min - 1, max + 1);
+	b->ge = above == (rs->scale > 0);
+	if (b->ge) {
+		while (i > min && raw_cond(rs, i - 1, value, above, strict))
+			i--;
+		while (i <= max && !raw_cond(rs, i, value, above, strict))
+			i++;
+		b->never = i > max;
+		b->always = i <= min;
+	} else {
+		while (i < max && raw_cond(rs, i + 1, value, above, strict))
+			i++;
+		while (i >= min && !raw_cond(rs, i, value, above, strict))
+			i--;
+		b->never = i < min;
+		b->always = i >= max;
+	}
+	b->i = i;
+}
+
+/* The first sample from the given one which is within the bound. */
+static uint64_t raw_find(const struct raw_scan *rs, const struct raw_bound *b,
+		uint64_t from)
+{
+	if (from >= rs->num_samples || b->never)
+		return rs->num_samples;
+	if (b->always)
+		return from;
+
+	switch (rs->kind) {
+	case SCAN_U8:
+		return scan_u8(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	case SCAN_S8:
+		return scan_s8(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	case SCAN_U16:
+		return scan_u16(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	case SCAN_S16:
+		return scan_s16(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	case SCAN_U32:
+		return scan_u32(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	case SCAN_S32:
+		return scan_s32(rs->data, rs->stride, from, rs->num_samples, b->ge, b->i);
+	default:
+		return scan_float(rs->data, rs->stride, from, rs->num_samples, b->ge, b->f);
+	}
+}
+
+/*
+ * A single level match is checked on the raw samples, without converting
+ * them. Returns FALSE if this can't be done for the packet.
+ */
+static gboolean raw_check(struct analog_match *m,
+		const struct sr_datafeed_analog *analog, unsigned int num_channels,
+		int *offset)
+{
+	struct raw_scan rs;
+	struct raw_bound arm, trig;
+	gboolean *armed;
+	uint64_t i;
+
+	if (m->type != SR_TRIGGER_OVER && m->type != SR_TRIGGER_UNDER
+			&& m->type != SR_TRIGGER_RISING
+			&& m->type != SR_TRIGGER_FALLING)
+		return FALSE;
+	if (!raw_scan_init(&rs, analog, m->col, num_channels))
+		return FALSE;
+
+	switch (m->type) {
+	case SR_TRIGGER_OVER:
+		raw_bound_init(&rs, &trig, m->value, TRUE, TRUE);
+		i = raw_find(&rs, &trig, 0);
+		break;
+	case SR_TRIGGER_UNDER:
+		raw_bound_init(&rs, &trig, m->value, FALSE, TRUE);
+		i = raw_find(&rs, &trig, 0);
+		break;
+	default:
+		if (m->type == SR_TRIGGER_RISING) {
+			raw_bound_init(&rs, &arm, m->value - m->hysteresis,
+				FALSE, TRUE);
+			raw_bound_init(&rs, &trig, m->value, TRUE, FALSE);
+			armed = &m->armed_rising;
+		} else {
+			raw_bound_init(&rs, &arm, m->value + m->hysteresis,
+				TRUE, TRUE);
+			raw_bound_init(&rs, &trig, m->value, FALSE, FALSE);
+			armed = &m->armed_falling;
+		}
+		i = 0;
+		if (!*armed) {
+			i = raw_find(&rs, &arm, 0);
+			*armed = i < rs.num_samples;
+		}
+		if (*armed) {
+			i = raw_find(&rs, &trig, i);
+			if (i < rs.num_samples)
+				*armed = FALSE;
+		}
+		break;
+	}
+
+	*offset = i < rs.num_samples ? (int)i : -1;
+
+	return TRUE;
+}
+
+/* Returns the offset of the trigger within the packet, or -1. */
+static int check_packet(struct soft_trigger_analog *sta,
+		const struct sr_datafeed_packet *packet)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct analog_match *m;
+	const uint8_t *sample;
+	uint64_t num_samples, i, size;
+	unsigned int num_channels;
+	int j, found, bit;
+	float x;
+
+	logic = NULL;
+	analog = NULL;
+	num_channels = 0;
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		num_samples = logic->length / logic->unitsize;
+	} else {
+		analog = packet->payload;
+		num_samples = analog->num_samples;
+		num_channels = g_slist_length(analog->meaning->channels);
+	}
+
+	/* Where the channels of the matches are in this packet. */
+	found = 0;
+	for (j = 0; j < sta->num_matches; j++) {
+		m = &sta->matches[j];
+		m->col = -1;
+		if (logic && m->channel->type == SR_CHANNEL_LOGIC
+				&& m->channel->index < 8 * (int)logic->unitsize)
+			m->col = m->channel->index;
+		else if (analog && m->channel->type == SR_CHANNEL_ANALOG)
+			m->col = g_slist_index(analog->meaning->channels,
+				m->channel);
+		if (m->col >= 0)
+			found++;
+	}
+	if (!found || !num_samples)
+		return -1;
+
+	if (analog && sta->num_stages == 1 && sta->num_matches == 1
+			&& raw_check(&sta->matches[0], analog, num_channels, &j))
+		return j;
+
+	if (analog) {
+		size = num_samples * num_channels;
+		if (size > sta->values_size) {
+			sta->values = g_realloc(sta->values, sizeof(float) * size);
+			sta->values_size = size;
+		}
+		if (sr_analog_to_float(analog, sta->values) != SR_OK)
+			return -1;
+	}
+
+	for (i = 0; i < num_samples; i++) {
+		for (j = 0; j < sta->num_matches; j++) {
+			m = &sta->matches[j];
+			if (m->col < 0)
+				continue;
+			if (logic) {
+				sample = (const uint8_t *)logic->data
+					+ i * logic->unitsize;
+				bit = sample[m->col / 8] & (1 << (m->col % 8));
+				x = bit ? 1 : 0;
+			} else {
+				x = sta->values[i * num_channels + m->col];
+			}
+			m->result = match_update(m, x);
+		}
+
+		if (!stage_matched(sta, sta->cur_stage)) {
+			if (sta->cur_stage == 0)
+				continue;
+			/* Start over, this sample may begin the sequence. */
+			sta->cur_stage = 0;
+			if (!stage_matched(sta, 0))
+				continue;
+		}
+		if (sta->cur_stage == sta->num_stages - 1)
+			return i;
+		sta->cur_stage++;
+	}
+
+	return -1;
+}
+
+/*
+ * Feed a logic or analog packet to the analog soft trigger. Returns the
+ * offset (in samples) within the packet of where the trigger occurred,
+ * or -1 if not triggered. Once the trigger has fired, packets are to be
+ * sent in full, and 0 is returned.
+ */
+SR_PRIV int soft_trigger_analog_check(struct soft_trigger_analog *sta,
+		struct sr_datafeed_packet *packet, int *pre_trigger_samples)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct analog_stream *s;
+	const uint8_t *data;
+	uint64_t num_samples, position;
+	int offset;
+
+	if (pre_trigger_samples)
+		*pre_trigger_samples = 0;
+	if (sta->fired)
+		return 0;
+
+	if (packet->type == SR_DF_LOGIC) {
+		logic = packet->payload;
+		if (!logic->unitsize)
+			return SR_ERR_ARG;
+		data = logic->data;
+		num_samples = logic->length / logic->unitsize;
+	} else if (packet->type == SR_DF_ANALOG) {
+		analog = packet->payload;
+		if (!analog->data || !analog->encoding || !analog->meaning
+				|| !analog->meaning->channels)
+			return SR_ERR_ARG;
+		data = analog->data;
+		num_samples = analog->num_samples;
+	} else {
+		return -1;
+	}
+
+	s = stream_get(sta, packet);
+	position = s->pos;
+	offset = check_packet(sta, packet);
+	stream_append(s, sta->pre_trigger_samples, data, num_samples);
+	if (offset >= 0)
+		fire(sta, s, position + offset, pre_trigger_samples);
 
 	return offset;
 }
@@ -0,0 +1,735 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <math.h>
+#include <string.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "transform/decimate"
+
+enum {
+	MODE_FIR,
+	MODE_MEAN,
+	MODE_MIN,
+	MODE_MAX,
+	MODE_PEAK,
+};
+
+static const char *mode_names[] = {
+	[MODE_FIR] = "fir",
+	[MODE_MEAN] = "mean",
+	[MODE_MIN] = "min",
+	[MODE_MAX] = "max",
+	[MODE_PEAK] = "peak",
+};
+
+/* FIR length per decimation factor, and the cutoff relative to Nyquist. */
+#define FIR_TAPS_PER_FACTOR 4
+#define FIR_CUTOFF 0.8
+#define MAX_FIR_FACTOR 1024
+
+/* FIR dot products are computed in blocks of this many taps. */
+#define TAP_BLOCK 8
+
+/* Input samples of one set of analog channels. */
+struct stream {
+	GSList *channels;
+	unsigned int num_channels;
+	/* The samples of channel c start at buf + c * size. */
+	float *buf;
+	int64_t *timestamps;
+	unsigned int size;
+	unsigned int len;
+	/* End of the input window of the next output sample. */
+	unsigned int next;
+	float *fdata;
+	size_t fdata_size;
+	float *out;
+	int64_t *out_timestamps;
+	size_t out_size;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct sr_datafeed_packet packet;
+};
+
+struct context {
+	int mode;
+	unsigned int factor;
+	/* Output samples per block of factor input samples. */
+	unsigned int per_block;
+	/* Input samples each output sample is computed from. */
+	unsigned int window;
+	float *coeffs;
+	GSList *streams;
+	/* Logic samples to skip before the next one kept. */
+	uint64_t logic_skip;
+	uint8_t *logic_buf;
+	uint64_t logic_size;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_packet logic_packet;
+	struct sr_datafeed_meta meta;
+	struct sr_datafeed_packet meta_packet;
+	/* SR_CONF_ANALOG_TIMESTAMPS of the next analog packet, or NULL. */
+	GVariant *timestamps;
+};
+
+/*
+ * Blackman windowed sinc lowpass. The taps are right-aligned in the
+ * window, which is a multiple of TAP_BLOCK, and the leading ones zero.
+ */
+static void fir_design(struct context *ctx)
+{
+	unsigned int i, taps;
+	double fc, x, h, w, sum;
+
+	taps = FIR_TAPS_PER_FACTOR * ctx->factor + 1;
+	ctx->window = (taps + TAP_BLOCK - 1) / TAP_BLOCK * TAP_BLOCK;
+	ctx->coeffs = g_malloc0(sizeof(float) * ctx->window);
+
+	/* Cutoff in cycles per input sample. */
+	fc = FIR_CUTOFF * 0.5 / ctx->factor;
+	sum = 0;
+	for (i = 0; i < taps; i++) {
+		x = i - (taps - 1) / 2.0;
+		h = x == 0 ? 2 * fc : sin(2 * G_PI * fc * x) / (G_PI * x);
+		w = 0.42 - 0.5 * cos(2 * G_PI * i / (taps - 1))
+			+ 0.08 * cos(4 * G_PI * i / (taps - 1));
+		ctx->coeffs[ctx->window - taps + i] = h * w;
+		sum += h * w;
+	}
+	/* Unity gain at DC. */
+	for (i = 0; i < ctx->window; i++)
+		ctx->coeffs[i] /= sum;
+}
+
+static int init(struct sr_transform *t, GHashTable *options)
+{
+	struct context *ctx;
+	const char *mode;
+	unsigned int i;
+
+	if (!t || !t->sdi || !options)
+		return SR_ERR_ARG;
+
+	t->priv = ctx = g_malloc0(sizeof(struct context));
+
+	ctx->factor = g_variant_get_uint32(g_hash_table_lookup(options, "factor"));
+	mode = g_variant_get_string(g_hash_table_lookup(options, "mode"), NULL);
+	for (i = 0; i < G_N_ELEMENTS(mode_names); i++) {
+		if (!strcmp(mode, mode_names[i]))
+			break;
+	}
+	if (i == G_N_ELEMENTS(mode_names)) {
+		sr_err("Unknown decimation mode '%s'.", mode);
+		goto err;
+	}
+	ctx->mode = i;
+
+	if (!ctx->factor) {
+		sr_err("Invalid decimation factor 0.");
+		goto err;
+	}
+	if (ctx->mode == MODE_FIR && ctx->factor > MAX_FIR_FACTOR) {
+		sr_err("FIR decimation supports factors up to %d.",
+			MAX_FIR_FACTOR);
+		goto err;
+	}
+
+	ctx->per_block = ctx->mode == MODE_PEAK ? 2 : 1;
+	if (ctx->mode == MODE_FIR)
+		fir_design(ctx);
+	else
+		ctx->window = ctx->factor;
+
+	return SR_OK;
+
+err:
+	g_free(ctx);
+	t->priv = NULL;
+	return SR_ERR_ARG;
+}
+
+static void stream_free(void *data)
+{
+	struct stream *stream;
+
+	stream = data;
+	g_slist_free(stream->channels);
+	g_free(stream->buf);
+	g_free(stream->timestamps);
+	g_free(stream->fdata);
+	g_free(stream->out);
+	g_free(stream->out_timestamps);
+	g_free(stream);
+}
+
+static gboolean same_channels(const GSList *a, const GSList *b)
+{
+	while (a && b && a->data == b->data) {
+		a = a->next;
+		b = b->next;
+	}
+
+	return !a && !b;
+}
+
+/* Forget the input samples held back, and where logic stands. */
+static void state_reset(struct context *ctx)
+{
+	g_slist_free_full(ctx->streams, stream_free);
+	ctx->streams = NULL;
+	ctx->logic_skip = 0;
+}
+
+static struct stream *stream_get(struct context *ctx, const GSList *channels)
+{
+	struct stream *stream;
+	GSList *l;
+
+	for (l = ctx->streams; l; l = l->next) {
+		stream = l->data;
+		if (same_channels(stream->channels, channels))
+			return stream;
+	}
+
+	stream = g_malloc0(sizeof(struct stream));
+	stream->channels = g_slist_copy((GSList *)channels);
+	stream->num_channels = g_slist_length(stream->channels);
+	ctx->streams = g_slist_append(ctx->streams, stream);
+
+	return stream;
+}
+
+/* Make room for num_samples more input samples per channel. */
+static void stream_grow(struct stream *stream, unsigned int num_samples)
+{
+	unsigned int c, size;
+	float *buf;
+
+	if (stream->len + num_samples <= stream->size)
+		return;
+
+	size = MAX(stream->size * 2, stream->len + num_samples);
+	buf = g_malloc(sizeof(float) * size * stream->num_channels);
+	for (c = 0; c < stream->num_channels && stream->buf; c++)
+		memcpy(buf + c * size, stream->buf + c * stream->size,
+			sizeof(float) * stream->len);
+	g_free(stream->buf);
+	stream->buf = buf;
+	stream->timestamps = g_renew(int64_t, stream->timestamps, size);
+	stream->size = size;
+}
+
+/* The summing loop is split into independent lanes, for vectorization. */
+static float fir(const float *restrict coeffs, const float *restrict x,
+		unsigned int n)
+{
+	float acc[TAP_BLOCK];
+	float sum;
+	unsigned int i, j;
+
+	for (j = 0; j < TAP_BLOCK; j++)
+		acc[j] = 0;
+	for (i = 0; i < n; i += TAP_BLOCK) {
+		for (j = 0; j < TAP_BLOCK; j++)
+			acc[j] += coeffs[i + j] * x[i + j];
+	}
+
+	sum = 0;
+	for (j = 0; j < TAP_BLOCK; j++)
+		sum += acc[j];
+
+	return sum;
+}
+
+static float mean(const float *x, unsigned int n)
+{
+	float sum;
+	unsigned int i;
+
+	sum = 0;
+	for (i = 0; i < n; i++)
+		sum += x[i];
+
+	return sum / n;
+}
+
+static float minimum(const float *x, unsigned int n)
+{
+	float min;
+	unsigned int i;
+
+	min = x[0];
+	for (i = 1; i < n; i++)
+		min = x[i] < min ? x[i] : min;
+
+	return min;
+}
+
+static float maximum(const float *x, unsigned int n)
+{
+	float max;
+	unsigned int i;
+
+	max = x[0];
+	for (i = 1; i < n; i++)
+		max = x[i] > max ? x[i] : max;
+
+	return max;
+}
+
+/* Compute the output samples of one channel. */
+static void decimate_channel(const struct context *ctx,
+		const struct stream *stream, unsigned int c,
+		unsigned int num_out)
+{
+	const float *in;
+	float *out;
+	unsigned int o, k, n;
+
+	k = stream->num_channels;
+	n = ctx->window;
+	in = stream->buf + c * stream->size + stream->next - n;
+	out = stream->out + c;
+
+	for (o = 0; o < num_out; o++, in += ctx->factor) {
+		switch (ctx->mode) {
+		case MODE_FIR:
+			*out = fir(ctx->coeffs, in, n);
+			break;
+		case MODE_MEAN:
+			*out = mean(in, n);
+			break;
+		case MODE_MIN:
+			*out = minimum(in, n);
+			break;
+		case MODE_MAX:
+			*out = maximum(in, n);
+			break;
+		case MODE_PEAK:
+			*out = minimum(in, n);
+			out += k;
+			*out = maximum(in, n);
+			break;
+		}
+		out += k;
+	}
+}
+
+/* Announce the timestamps of the decimated samples. */
+static int send_timestamps(const struct sr_transform *t,
+		const int64_t *timestamps, unsigned int num_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+	int ret;
+
+	src = sr_config_new(SR_CONF_ANALOG_TIMESTAMPS,
+		g_variant_new_fixed_array(G_VARIANT_TYPE_INT64, timestamps,
+			num_samples, sizeof(int64_t)));
+	meta.config = g_slist_append(NULL, src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	ret = sr_session_send_from(t, &packet);
+	g_slist_free(meta.config);
+	sr_config_free(src);
+
+	return ret;
+}
+
+static int decimate_analog(const struct sr_transform *t,
+		struct context *ctx, struct stream *stream,
+		const struct sr_datafeed_analog *analog,
+		struct sr_datafeed_packet **packet_out)
+{
+	unsigned int c, i, k, n, o, num_out, drop;
+	const int64_t *timestamps;
+	gsize num_timestamps;
+	size_t size;
+	float *buf;
+	int ret;
+
+	/* Timestamps only apply to the packet right after them. */
+	timestamps = NULL;
+	if (ctx->timestamps) {
+		timestamps = g_variant_get_fixed_array(ctx->timestamps,
+			&num_timestamps, sizeof(int64_t));
+		if (num_timestamps != analog->num_samples) {
+			sr_warn("Got %" G_GSIZE_FORMAT " timestamps for %"
+				PRIu32 " samples, ignoring them.",
+				num_timestamps, analog->num_samples);
+			timestamps = NULL;
+		}
+	}
+
+	k = stream->num_channels;
+	n = analog->num_samples;
+	if (!k || !n) {
+		*packet_out = NULL;
+		ret = SR_OK;
+		goto done;
+	}
+
+	size = (size_t)n * k;
+	if (size > stream->fdata_size) {
+		stream->fdata = g_renew(float, stream->fdata, size);
+		stream->fdata_size = size;
+	}
+	if ((ret = sr_analog_to_float(analog, stream->fdata)) != SR_OK)
+		goto done;
+
+	if (!stream->size) {
+		/*
+		 * Start with the first samples repeated, rather than with
+		 * zeroes which would show as a step through the filter.
+		 */
+		stream_grow(stream, ctx->window - ctx->factor + n);
+		stream->len = ctx->window - ctx->factor;
+		for (c = 0; c < k; c++) {
+			buf = stream->buf + c * stream->size;
+			for (i = 0; i < stream->len; i++)
+				buf[i] = stream->fdata[c];
+		}
+		for (i = 0; i < stream->len; i++)
+			stream->timestamps[i] = timestamps ? timestamps[0] : 0;
+		stream->next = ctx->window;
+	}
+
+	/* Append the new samples, one channel after the other. */
+	stream_grow(stream, n);
+	for (c = 0; c < k; c++) {
+		buf = stream->buf + c * stream->size + stream->len;
+		for (i = 0; i < n; i++)
+			buf[i] = stream->fdata[i * k + c];
+	}
+	for (i = 0; i < n; i++)
+		stream->timestamps[stream->len + i] = timestamps
+			? timestamps[i] : 0;
+	stream->len += n;
+
+	num_out = 0;
+	if (stream->next <= stream->len)
+		num_out = (stream->len - stream->next) / ctx->factor + 1;
+
+	if (num_out) {
+		size = (size_t)num_out * ctx->per_block * k;
+		if (size > stream->out_size) {
+			stream->out = g_renew(float, stream->out, size);
+			stream->out_timestamps = g_renew(int64_t,
+				stream->out_timestamps, size / k);
+			stream->out_size = size;
+		}
+		for (c = 0; c < k; c++)
+			decimate_channel(ctx, stream, c, num_out);
+		for (o = 0; o < num_out * ctx->per_block; o++)
+			stream->out_timestamps[o] = stream->timestamps[stream->next
+				+ (o / ctx->per_block) * ctx->factor - 1];
+		stream->next += num_out * ctx->factor;
+	}
+
+	/* Only keep what the next output window needs. */
+	drop = stream->next - ctx->window;
+	if (drop) {
+		for (c = 0; c < k; c++) {
+			buf = stream->buf + c * stream->size;
+			memmove(buf, buf + drop,
+				sizeof(float) * (stream->len - drop));
+		}
+		memmove(stream->timestamps, stream->timestamps + drop,
+			sizeof(int64_t) * (stream->len - drop));
+		stream->len -= drop;
+		stream->next -= drop;
+	}
+
+	if (!num_out) {
+		*packet_out = NULL;
+		ret = SR_OK;
+		goto done;
+	}
+
+	if (timestamps && (ret = send_timestamps(t, stream->out_timestamps,
+			num_out * ctx->per_block)) != SR_OK)
+		goto done;
+
+	sr_analog_init(&stream->analog, &stream->encoding, &stream->meaning,
+			&stream->spec, analog->encoding->digits);
+	stream->encoding.is_digits_decimal = analog->encoding->is_digits_decimal;
+	stream->meaning.mq = analog->meaning->mq;
+	stream->meaning.unit = analog->meaning->unit;
+	stream->meaning.mqflags = analog->meaning->mqflags;
+	stream->meaning.channels = stream->channels;
+	stream->spec.spec_digits = analog->spec->spec_digits;
+	stream->analog.data = stream->out;
+	stream->analog.num_samples = num_out * ctx->per_block;
+	stream->packet.type = SR_DF_ANALOG;
+	stream->packet.payload = &stream->analog;
+	*packet_out = &stream->packet;
+
+done:
+	if (ctx->timestamps) {
+		g_variant_unref(ctx->timestamps);
+		ctx->timestamps = NULL;
+	}
+
+	return ret;
+}
+
+/*
+ * Keep every factor-th logic sample, so logic stays in step. Where each
+ * block of analog samples gives several output samples, the logic sample
+ * is repeated as often.
+ */
+static void decimate_logic(struct context *ctx,
+		const struct sr_datafeed_logic *logic,
+		struct sr_datafeed_packet **packet_out)
+{
+	const uint8_t *in;
+	uint8_t *out;
+	uint64_t i, n, num_out, size;
+	unsigned int j;
+
+	n = logic->unitsize ? logic->length / logic->unitsize : 0;
+	if (ctx->logic_skip >= n) {
+		ctx->logic_skip -= n;
+		*packet_out = NULL;
+		return;
+	}
+
+	num_out = (n - 1 - ctx->logic_skip) / ctx->factor + 1;
+	size = num_out * ctx->per_block * logic->unitsize;
+	if (size > ctx->logic_size) {
+		ctx->logic_buf = g_realloc(ctx->logic_buf, size);
+		ctx->logic_size = size;
+	}
+
+	in = (const uint8_t *)logic->data + ctx->logic_skip * logic->unitsize;
+	out = ctx->logic_buf;
+	for (i = 0; i < num_out; i++) {
+		for (j = 0; j < ctx->per_block; j++) {
+			memcpy(out, in, logic->unitsize);
+			out += logic->unitsize;
+		}
+		in += ctx->factor * logic->unitsize;
+	}
+	ctx->logic_skip = ctx->logic_skip + num_out * ctx->factor - n;
+
+	ctx->logic.length = size;
+	ctx->logic.unitsize = logic->unitsize;
+	ctx->logic.data = ctx->logic_buf;
+	ctx->logic_packet.type = SR_DF_LOGIC;
+	ctx->logic_packet.payload = &ctx->logic;
+	*packet_out = &ctx->logic_packet;
+}
+
+static GVariant *output_samplerate(const struct context *ctx,
+		GVariant *samplerate)
+{
+	uint64_t rate;
+
+	rate = g_variant_get_uint64(samplerate);
+
+	return g_variant_new_uint64(rate * ctx->per_block / ctx->factor);
+}
+
+static void meta_clear(struct context *ctx)
+{
+	g_slist_free_full(ctx->meta.config, (GDestroyNotify)sr_config_free);
+	ctx->meta.config = NULL;
+}
+
+/*
+ * Pass on the metadata with the samplerate reduced. A new samplerate
+ * starts the decimation over, so that no filter window spans samples of
+ * both rates. Sample timestamps are held back, and sent along with the
+ * decimated samples of the next packet.
+ */
+static void decimate_meta(struct context *ctx,
+		const struct sr_datafeed_meta *meta,
+		struct sr_datafeed_packet **packet_out)
+{
+	const struct sr_config *src;
+	GSList *l;
+	GVariant *data;
+
+	for (l = meta->config; l; l = l->next) {
+		src = l->data;
+		if (src->key == SR_CONF_SAMPLERATE
+				|| src->key == SR_CONF_ANALOG_TIMESTAMPS)
+			break;
+	}
+	if (!l)
+		return;
+
+	meta_clear(ctx);
+	for (l = meta->config; l; l = l->next) {
+		src = l->data;
+		data = src->data;
+		if (src->key == SR_CONF_ANALOG_TIMESTAMPS) {
+			if (ctx->timestamps)
+				g_variant_unref(ctx->timestamps);
+			ctx->timestamps = g_variant_ref(data);
+			continue;
+		}
+		if (src->key == SR_CONF_SAMPLERATE) {
+			state_reset(ctx);
+			data = output_samplerate(ctx, data);
+		}
+		ctx->meta.config = g_slist_append(ctx->meta.config,
+				sr_config_new(src->key, data));
+	}
+	if (!ctx->meta.config) {
+		*packet_out = NULL;
+		return;
+	}
+	ctx->meta_packet.type = SR_DF_META;
+	ctx->meta_packet.payload = &ctx->meta;
+	*packet_out = &ctx->meta_packet;
+}
+
+/* Announce the reduced samplerate right after the header. */
+static int send_header(const struct sr_transform *t,
+		struct sr_datafeed_packet *header)
+{
+	struct context *ctx;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+	GVariant *samplerate;
+	int ret;
+
+	ctx = t->priv;
+	if ((ret = sr_session_send_from(t, header)) != SR_OK)
+		return ret;
+
+	if (sr_config_get(t->sdi->driver, t->sdi, NULL, SR_CONF_SAMPLERATE,
+			&samplerate) != SR_OK)
+		return SR_OK;
+
+	src = sr_config_new(SR_CONF_SAMPLERATE,
+			output_samplerate(ctx, samplerate));
+	g_variant_unref(samplerate);
+	meta.config = g_slist_append(NULL, src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	ret = sr_session_send_from(t, &packet);
+	g_slist_free(meta.config);
+	sr_config_free(src);
+
+	return ret;
+}
+
+static int receive(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	const struct sr_datafeed_analog *analog;
+	struct stream *stream;
+	int ret;
+
+	if (!t || !t->sdi || !packet_in || !packet_out)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	*packet_out = packet_in;
+	if (ctx->factor == 1 && ctx->per_block == 1)
+		return SR_OK;
+
+	switch (packet_in->type) {
+	case SR_DF_HEADER:
+		if ((ret = send_header(t, packet_in)) != SR_OK)
+			return ret;
+		*packet_out = NULL;
+		break;
+	case SR_DF_META:
+		decimate_meta(ctx, packet_in->payload, packet_out);
+		break;
+	case SR_DF_FRAME_BEGIN:
+		/* Frames are decimated independently. */
+		state_reset(ctx);
+		break;
+	case SR_DF_LOGIC:
+		decimate_logic(ctx, packet_in->payload, packet_out);
+		break;
+	case SR_DF_ANALOG:
+		analog = packet_in->payload;
+		stream = stream_get(ctx, analog->meaning->channels);
+		return decimate_analog(t, ctx, stream, analog, packet_out);
+	default:
+		break;
+	}
+
+	return SR_OK;
+}
+
+static int cleanup(struct sr_transform *t)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	g_slist_free_full(ctx->streams, stream_free);
+	meta_clear(ctx);
+	if (ctx->timestamps)
+		g_variant_unref(ctx->timestamps);
+	g_free(ctx->coeffs);
+	g_free(ctx->logic_buf);
+	g_free(ctx);
+	t->priv = NULL;
+
+	return SR_OK;
+}
+
+static struct sr_option options[] = {
+	{ "factor", "Factor", "Number of input samples per output sample", NULL, NULL },
+	{ "mode", "Mode", "Decimation filter (fir, mean, min, max, peak)", NULL, NULL },
+	ALL_ZERO
+};
+
+static const struct sr_option *get_options(void)
+{
+	unsigned int i;
+
+	if (!options[0].def) {
+		options[0].def = g_variant_ref_sink(g_variant_new_uint32(10));
+		options[1].def = g_variant_ref_sink(g_variant_new_string("fir"));
+		for (i = 0; i < G_N_ELEMENTS(mode_names); i++)
+			options[1].values = g_slist_append(options[1].values,
+				g_variant_ref_sink(g_variant_new_string(mode_names[i])));
+	}
+
+	return options;
+}
+
+SR_PRIV struct sr_transform_module transform_decimate = {
+	.id = "decimate",
+	.name = "Decimate",
+	.desc = "Reduce the samplerate by an integer factor",
+	.options = get_options,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
@@ -0,0 +1,309 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#if defined(__BMI2__) && !defined(WORDS_BIGENDIAN)
+#include <immintrin.h>
+#define HAVE_PEXT 1
+#endif
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+
+#define LOG_PREFIX "transform/repack"
+
+/* Packed samples are gathered in a 64-bit word. */
+#define MAX_CHANNELS 64
+
+struct context {
+	/* Input bit of each output bit, in channel order. */
+	unsigned int bits[MAX_CHANNELS];
+	unsigned int num_channels;
+	gboolean active;
+	unsigned int unitsize;
+	/* Set up for samples of this many bytes. */
+	unsigned int in_unitsize;
+	/* The samples hold the enabled channels only, in order. */
+	gboolean identity;
+	/* As above, but the top byte has bits of disabled channels to clear. */
+	gboolean masked;
+	uint8_t top_mask;
+	/* The input bytes holding enabled channels, and their output bits. */
+	unsigned int *bytes;
+	unsigned int num_bytes;
+	uint64_t *table;
+#ifdef HAVE_PEXT
+	/* Enabled channels in ascending bit order can be gathered at once. */
+	gboolean ordered;
+	uint64_t mask;
+#endif
+	uint8_t *buf;
+	uint64_t bufsize;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_packet packet;
+};
+
+static int init(struct sr_transform *t, GHashTable *options)
+{
+	struct context *ctx;
+	struct sr_channel *ch;
+	GSList *l;
+	unsigned int n;
+
+	(void)options;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+
+	t->priv = ctx = g_malloc0(sizeof(struct context));
+
+	n = 0;
+	for (l = t->sdi->channels; l; l = l->next) {
+		ch = l->data;
+		if (ch->type != SR_CHANNEL_LOGIC || !ch->enabled)
+			continue;
+		if (n < MAX_CHANNELS)
+			ctx->bits[n] = ch->index;
+		n++;
+	}
+
+	if (n > MAX_CHANNELS) {
+		sr_warn("Can't pack %u channels, at most %d are supported.",
+			n, MAX_CHANNELS);
+		return SR_OK;
+	}
+
+	ctx->num_channels = n;
+	ctx->unitsize = (n + 7) / 8;
+	ctx->active = n > 0;
+
+	return SR_OK;
+}
+
+/* Build the gather tables for samples of the given size. */
+static void setup(struct context *ctx, unsigned int in_unitsize)
+{
+	unsigned int i, j, k, byte;
+	uint64_t *entry;
+	gboolean in_order;
+
+	ctx->in_unitsize = in_unitsize;
+
+	in_order = in_unitsize == ctx->unitsize;
+	for (j = 0; j < ctx->num_channels; j++)
+		in_order = in_order && ctx->bits[j] == j;
+	ctx->top_mask = 0xff >> (8 * ctx->unitsize - ctx->num_channels);
+	ctx->identity = in_order && ctx->top_mask == 0xff;
+	ctx->masked = in_order && !ctx->identity;
+
+	g_free(ctx->bytes);
+	g_free(ctx->table);
+	ctx->bytes = g_malloc(sizeof(unsigned int) * in_unitsize);
+	ctx->num_bytes = 0;
+	for (i = 0; i < in_unitsize; i++) {
+		for (j = 0; j < ctx->num_channels; j++) {
+			if (ctx->bits[j] / 8 == i) {
+				ctx->bytes[ctx->num_bytes++] = i;
+				break;
+			}
+		}
+	}
+
+	/*
+	 * For each input byte and value, the output bits it contributes.
+	 * Channels beyond the sample width always read as low.
+	 */
+	ctx->table = g_malloc0(sizeof(uint64_t) * 256 * MAX(ctx->num_bytes, 1));
+	for (k = 0; k < ctx->num_bytes; k++) {
+		byte = ctx->bytes[k];
+		entry = ctx->table + k * 256;
+		for (i = 0; i < 256; i++) {
+			for (j = 0; j < ctx->num_channels; j++) {
+				if (ctx->bits[j] / 8 == byte
+						&& i & (1 << (ctx->bits[j] % 8)))
+					entry[i] |= UINT64_C(1) << j;
+			}
+		}
+	}
+
+#ifdef HAVE_PEXT
+	ctx->ordered = in_unitsize <= 8;
+	ctx->mask = 0;
+	for (j = 0; j < ctx->num_channels; j++) {
+		if (j > 0 && ctx->bits[j] <= ctx->bits[j - 1])
+			ctx->ordered = FALSE;
+		if (ctx->bits[j] < 64)
+			ctx->mask |= UINT64_C(1) << ctx->bits[j];
+	}
+#endif
+
+	sr_dbg("Packing %u channels from %u into %u bytes per sample.",
+		ctx->num_channels, in_unitsize, ctx->unitsize);
+}
+
+static inline uint64_t gather(const struct context *ctx, const uint8_t *in)
+{
+	uint64_t v;
+	unsigned int k;
+
+#ifdef HAVE_PEXT
+	if (ctx->ordered) {
+		v = 0;
+		memcpy(&v, in, ctx->in_unitsize);
+		return _pext_u64(v, ctx->mask);
+	}
+#endif
+
+	v = 0;
+	for (k = 0; k < ctx->num_bytes; k++)
+		v |= ctx->table[k * 256 + in[ctx->bytes[k]]];
+
+	return v;
+}
+
+static void pack(const struct context *ctx, const uint8_t *in,
+		uint8_t *out, uint64_t num_samples)
+{
+	uint64_t i, v;
+	unsigned int b;
+
+	if (ctx->masked) {
+		memcpy(out, in, num_samples * ctx->unitsize);
+		for (i = 0; i < num_samples; i++)
+			out[i * ctx->unitsize + ctx->unitsize - 1] &= ctx->top_mask;
+		return;
+	}
+
+	if (ctx->unitsize == 1) {
+		for (i = 0; i < num_samples; i++, in += ctx->in_unitsize)
+			out[i] = gather(ctx, in);
+		return;
+	}
+
+	for (i = 0; i < num_samples; i++, in += ctx->in_unitsize) {
+		v = gather(ctx, in);
+		for (b = 0; b < ctx->unitsize; b++)
+			*out++ = v >> (8 * b);
+	}
+}
+
+/* Announce the packed layout right after the header. */
+static int send_header(const struct sr_transform *t,
+		struct sr_datafeed_packet *header)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+	int ret;
+
+	if ((ret = sr_session_send_from(t, header)) != SR_OK)
+		return ret;
+
+	src = sr_config_new(SR_CONF_LOGIC_PACKED, g_variant_new_boolean(TRUE));
+	meta.config = g_slist_append(NULL, src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	ret = sr_session_send_from(t, &packet);
+	g_slist_free(meta.config);
+	sr_config_free(src);
+
+	return ret;
+}
+
+static int receive(const struct sr_transform *t,
+		struct sr_datafeed_packet *packet_in,
+		struct sr_datafeed_packet **packet_out)
+{
+	struct context *ctx;
+	const struct sr_datafeed_logic *logic;
+	uint64_t num_samples, size;
+	int ret;
+
+	if (!t || !t->sdi || !packet_in || !packet_out)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	*packet_out = packet_in;
+	if (!ctx->active)
+		return SR_OK;
+
+	switch (packet_in->type) {
+	case SR_DF_HEADER:
+		/* The header and the layout have already been passed on. */
+		if ((ret = send_header(t, packet_in)) != SR_OK)
+			return ret;
+		*packet_out = NULL;
+		break;
+	case SR_DF_LOGIC:
+		logic = packet_in->payload;
+		if (!logic->unitsize)
+			return SR_ERR_ARG;
+		if (logic->unitsize != ctx->in_unitsize)
+			setup(ctx, logic->unitsize);
+		if (ctx->identity)
+			break;
+
+		num_samples = logic->length / logic->unitsize;
+		size = num_samples * ctx->unitsize;
+		if (size > ctx->bufsize) {
+			ctx->buf = g_realloc(ctx->buf, size);
+			ctx->bufsize = size;
+		}
+		pack(ctx, logic->data, ctx->buf, num_samples);
+
+		ctx->logic.length = size;
+		ctx->logic.unitsize = ctx->unitsize;
+		ctx->logic.data = ctx->buf;
+		ctx->packet.type = SR_DF_LOGIC;
+		ctx->packet.payload = &ctx->logic;
+		*packet_out = &ctx->packet;
+		break;
+	default:
+		break;
+	}
+
+	return SR_OK;
+}
+
+static int cleanup(struct sr_transform *t)
+{
+	struct context *ctx;
+
+	if (!t || !t->sdi)
+		return SR_ERR_ARG;
+	ctx = t->priv;
+
+	g_free(ctx->bytes);
+	g_free(ctx->table);
+	g_free(ctx->buf);
+	g_free(ctx);
+	t->priv = NULL;
+
+	return SR_OK;
+}
+
+SR_PRIV struct sr_transform_module transform_repack = {
+	.id = "repack",
+	.name = "Repack",
+	.desc = "Pack the enabled logic channels into the smallest sample width",
+	.options = NULL,
+	.init = init,
+	.receive = receive,
+	.cleanup = cleanup,
+};
@@ -58,8 +58,12 @@ static int receive(const struct sr_transform *t,
 	switch (packet_in->type) {
 	case SR_DF_ANALOG:
 		analog = packet_in->payload;
-		analog->encoding->scale.p *= ctx->factor.p;
-		analog->encoding->scale.q *= ctx->factor.q;
+		/* Integer encodings may have an offset, which scales too. */
+		if (sr_rational_mult(&analog->encoding->scale,
+				&analog->encoding->scale, &ctx->factor) != SR_OK
+				|| sr_rational_mult(&analog->encoding->offset,
+				&analog->encoding->offset, &ctx->factor) != SR_OK)
+			return SR_ERR;
 		break;
 	default:
 		sr_spew("Unsupported packet type %d, ignoring.", packet_in->type);
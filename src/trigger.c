@@ -119,27 +119,8 @@ SR_API struct sr_trigger_stage *sr_trigger_stage_add(struct sr_trigger *trig)
 	return stage;
 }
 
-/**
- * Allocate a new trigger match and add it to the specified trigger stage.
- *
- * The caller is responsible to free the trigger (including all stages and
- * matches) using sr_trigger_free() once it is no longer needed.
- *
- * @param stage The trigger stage to add the match to. Must not be NULL.
- * @param ch The channel for this trigger match. Must not be NULL. Must be
- *           either of type SR_CHANNEL_LOGIC or SR_CHANNEL_ANALOG.
- * @param trigger_match The type of trigger match. Must be a valid trigger
- *                      type from enum sr_trigger_matches. The trigger type
- *                      must be valid for the respective channel type as well.
- * @param value Trigger value.
- *
- * @retval SR_OK Success.
- * @retval SR_ERR_ARG Invalid argument(s) were passed to this functions.
- *
- * @since 0.4.0
- */
-SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
-		struct sr_channel *ch, int trigger_match, float value)
+static int match_add(struct sr_trigger_stage *stage, struct sr_channel *ch,
+		int trigger_match, float value, float hysteresis, int num_samples)
 {
 	struct sr_trigger_match *match;
 
@@ -160,7 +141,9 @@ SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
 				trigger_match != SR_TRIGGER_FALLING &&
 				trigger_match != SR_TRIGGER_EDGE &&
 				trigger_match != SR_TRIGGER_OVER &&
-				trigger_match != SR_TRIGGER_UNDER) {
+				trigger_match != SR_TRIGGER_UNDER &&
+				trigger_match != SR_TRIGGER_SLOPE_UP &&
+				trigger_match != SR_TRIGGER_SLOPE_DOWN) {
 			sr_err("Invalid trigger match for an analog channel.");
 			return SR_ERR_ARG;
 		}
@@ -173,9 +156,72 @@ SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
 	match->channel = ch;
 	match->match = trigger_match;
 	match->value = value;
+	match->hysteresis = hysteresis;
+	match->num_samples = num_samples;
 	stage->matches = g_slist_append(stage->matches, match);
 
 	return SR_OK;
 }
 
+/**
+ * Allocate a new trigger match and add it to the specified trigger stage.
+ *
+ * The caller is responsible to free the trigger (including all stages and
+ * matches) using sr_trigger_free() once it is no longer needed.
+ *
+ * @param stage The trigger stage to add the match to. Must not be NULL.
+ * @param ch The channel for this trigger match. Must not be NULL. Must be
+ *           either of type SR_CHANNEL_LOGIC or SR_CHANNEL_ANALOG.
+ * @param trigger_match The type of trigger match. Must be a valid trigger
+ *                      type from enum sr_trigger_matches. The trigger type
+ *                      must be valid for the respective channel type as well.
+ * @param value Trigger value.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument(s) were passed to this functions.
+ *
+ * @since 0.4.0
+ */
+SR_API int sr_trigger_match_add(struct sr_trigger_stage *stage,
+		struct sr_channel *ch, int trigger_match, float value)
+{
+	return match_add(stage, ch, trigger_match, value, 0, 1);
+}
+
+/**
+ * Allocate a new analog trigger match and add it to the specified stage.
+ *
+ * Unlike sr_trigger_match_add(), this also sets the hysteresis of edge
+ * matches and the number of samples slope matches are measured over.
+ *
+ * @param stage The trigger stage to add the match to. Must not be NULL.
+ * @param ch The channel for this trigger match. Must not be NULL. Must be
+ *           of type SR_CHANNEL_ANALOG.
+ * @param trigger_match The type of trigger match. Must be valid for an
+ *                      analog channel.
+ * @param value The level for edges, over and under matches, or the minimum
+ *              change of the value for slope matches.
+ * @param hysteresis How far the value must have been on the other side of
+ *                   the level before an edge matches. Must not be negative.
+ * @param num_samples The number of samples a slope is measured over.
+ *                    Must be at least 1.
+ *
+ * @retval SR_OK Success.
+ * @retval SR_ERR_ARG Invalid argument(s) were passed to this functions.
+ *
+ * @since 0.6.0
+ */
+SR_API int sr_trigger_analog_match_add(struct sr_trigger_stage *stage,
+		struct sr_channel *ch, int trigger_match, float value,
+		float hysteresis, int num_samples)
+{
+	if (!ch || ch->type != SR_CHANNEL_ANALOG)
+		return SR_ERR_ARG;
+	if (!(hysteresis >= 0) || num_samples < 1)
+		return SR_ERR_ARG;
+
+	return match_add(stage, ch, trigger_match, value,
+		hysteresis, num_samples);
+}
+
 /** @} */
@@ -86,6 +86,38 @@ START_TEST(test_analog_to_float)
 }
 END_TEST
 
+/* Check the conversion of raw 8-bit ADC codes, as sent by scope drivers. */
+START_TEST(test_analog_to_float_uint8)
+{
+	int ret;
+	unsigned int i;
+	float fout[3];
+	struct sr_channel ch;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	const uint8_t codes[] = {0, 128, 255};
+	const float v[] = {-10, 0, 9.921875};
+
+	sr_analog_init_(&analog, &encoding, &meaning, &spec, 2);
+	encoding.unitsize = 1;
+	encoding.is_float = FALSE;
+	encoding.is_signed = FALSE;
+	sr_rational_set(&encoding.scale, 5, 64);
+	sr_rational_set(&encoding.offset, -10, 1);
+	analog.num_samples = ARRAY_SIZE(codes);
+	analog.data = (void *)codes;
+	meaning.channels = g_slist_append(NULL, &ch);
+
+	ret = sr_analog_to_float(&analog, fout);
+	fail_unless(ret == SR_OK, "sr_analog_to_float() failed: %d.", ret);
+	for (i = 0; i < ARRAY_SIZE(v); i++)
+		fail_unless(fabs(v[i] - fout[i]) <= 0.0001, "%f != %f", v[i], fout[i]);
+	g_slist_free(meaning.channels);
+}
+END_TEST
+
 START_TEST(test_analog_to_float_null)
 {
 	int ret;
@@ -384,6 +416,7 @@ Suite *suite_analog(void)
 
 	tc = tcase_create("analog_to_float");
 	tcase_add_test(tc, test_analog_to_float);
+	tcase_add_test(tc, test_analog_to_float_uint8);
 	tcase_add_test(tc, test_analog_to_float_null);
 	tcase_add_test(tc, test_analog_si_prefix);
 	tcase_add_test(tc, test_analog_si_prefix_null);
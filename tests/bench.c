@@ -0,0 +1,901 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * Throughput benchmarks for the session bus, the input, output and
+ * transform modules, and the soft trigger.
+ *
+ * All datasets are generated deterministically, so results of different
+ * builds can be compared. Every benchmark prints one JSON object per line
+ * (to stdout, or to the file given with -o), see report().
+ *
+ * Usage: bench [-n samples] [-o results-file] [name-filter]
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <libsigrok/libsigrok.h>
+
+#define DEFAULT_NUM_SAMPLES	(1024 * 1024)
+#define NUM_LOGIC_CHANNELS	16
+#define LOGIC_UNITSIZE		((NUM_LOGIC_CHANNELS + 7) / 8)
+#define SAMPLERATE		SR_MHZ(1)
+/* Number of samples per packet when feeding outputs. */
+#define CHUNK_SAMPLES		(64 * 1024)
+/* Number of bytes per sr_input_send() call. */
+#define CHUNK_BYTES		(256 * 1024)
+
+struct bench_result {
+	char *name;
+	const char *status;
+	uint64_t samples;
+	uint64_t bytes;
+	int64_t usec;
+	uint64_t allocs;
+};
+
+struct feed_stats {
+	uint64_t samples;
+	uint64_t bytes;
+};
+
+static struct sr_context *ctx;
+static FILE *results;
+static const char *filter;
+static uint64_t num_samples = DEFAULT_NUM_SAMPLES;
+static uint8_t *logic_data;
+static float *analog_data;
+static struct sr_dev_inst *bench_sdi;
+
+#ifdef __GLIBC__
+/*
+ * Count heap allocations by interposing the allocator. GLib and the
+ * library itself allocate through malloc(), so this sees everything.
+ */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static uint64_t num_allocs;
+static gboolean have_alloc_count = TRUE;
+
+/* Allocations happen from other threads, too. */
+#define ALLOC_COUNT_INC() __atomic_fetch_add(&num_allocs, 1, __ATOMIC_RELAXED)
+#define ALLOC_COUNT_GET() __atomic_load_n(&num_allocs, __ATOMIC_RELAXED)
+
+void *malloc(size_t size)
+{
+	ALLOC_COUNT_INC();
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	ALLOC_COUNT_INC();
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	ALLOC_COUNT_INC();
+	return __libc_realloc(ptr, size);
+}
+#else
+static gboolean have_alloc_count = FALSE;
+
+#define ALLOC_COUNT_GET() ((uint64_t)0)
+#endif
+
+static gboolean bench_wanted(const char *name)
+{
+	return !filter || strstr(name, filter);
+}
+
+static void bench_begin(struct bench_result *r, const char *group,
+		const char *id)
+{
+	memset(r, 0, sizeof(*r));
+	r->name = g_strdup_printf("%s/%s", group, id);
+	r->status = "ok";
+	r->allocs = ALLOC_COUNT_GET();
+	r->usec = g_get_monotonic_time();
+}
+
+static void bench_end(struct bench_result *r)
+{
+	r->usec = g_get_monotonic_time() - r->usec;
+	r->allocs = ALLOC_COUNT_GET() - r->allocs;
+}
+
+static void report(struct bench_result *r)
+{
+	double secs;
+
+	secs = MAX(r->usec, 1) / (double)G_USEC_PER_SEC;
+	fprintf(results, "{\"benchmark\": \"%s\", \"status\": \"%s\", "
+		"\"samples\": %" PRIu64 ", \"bytes\": %" PRIu64 ", "
+		"\"seconds\": %.6f, \"samples_per_sec\": %.0f, "
+		"\"bytes_per_sec\": %.0f, ", r->name, r->status,
+		r->samples, r->bytes, secs, r->samples / secs, r->bytes / secs);
+	if (have_alloc_count && r->samples)
+		fprintf(results, "\"allocs_per_sample\": %.6f}\n",
+			r->allocs / (double)r->samples);
+	else
+		fprintf(results, "\"allocs_per_sample\": null}\n");
+	fflush(results);
+
+	g_free(r->name);
+}
+
+static void report_skipped(const char *group, const char *id,
+		const char *status)
+{
+	struct bench_result r;
+
+	bench_begin(&r, group, id);
+	r.status = status;
+	r.usec = 0;
+	report(&r);
+}
+
+/* xorshift64, the datasets only need to be reproducible. */
+static uint64_t prng_next(uint64_t *state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+
+	return *state;
+}
+
+static void datasets_init(void)
+{
+	uint64_t i, state;
+	uint16_t sample;
+
+	/* Logic: a few channels toggling now and then, like real signals. */
+	logic_data = g_malloc(num_samples * LOGIC_UNITSIZE);
+	state = 1;
+	sample = 0;
+	for (i = 0; i < num_samples; i++) {
+		if ((prng_next(&state) & 0x07) == 0)
+			sample ^= 1 << ((state >> 8) % NUM_LOGIC_CHANNELS);
+		logic_data[i * LOGIC_UNITSIZE] = sample & 0xff;
+		logic_data[i * LOGIC_UNITSIZE + 1] = sample >> 8;
+	}
+
+	/* Analog: a sine wave. */
+	analog_data = g_malloc(num_samples * sizeof(float));
+	for (i = 0; i < num_samples; i++)
+		analog_data[i] = 5.0 * sin(2 * G_PI * i / 1000.0);
+}
+
+/* A device instance which describes the datasets to the outputs. */
+static struct sr_dev_inst *bench_dev_new(void)
+{
+	struct sr_dev_inst *sdi;
+	char name[16];
+	int i;
+
+	sdi = sr_dev_inst_user_new("sigrok", "Benchmark", NULL);
+	for (i = 0; i < NUM_LOGIC_CHANNELS; i++) {
+		snprintf(name, sizeof(name), "D%d", i);
+		sr_dev_inst_channel_add(sdi, i, SR_CHANNEL_LOGIC, name);
+	}
+	sr_dev_inst_channel_add(sdi, NUM_LOGIC_CHANNELS, SR_CHANNEL_ANALOG, "A0");
+
+	return sdi;
+}
+
+static GSList *analog_channels(const struct sr_dev_inst *sdi)
+{
+	struct sr_channel *ch;
+	GSList *l;
+
+	for (l = sr_dev_inst_channels_get(sdi); l; l = l->next) {
+		ch = l->data;
+		if (ch->type == SR_CHANNEL_ANALOG)
+			return g_slist_append(NULL, ch);
+	}
+
+	return NULL;
+}
+
+static int output_send(const struct sr_output *o,
+		const struct sr_datafeed_packet *packet, GString *collect,
+		uint64_t *out_bytes)
+{
+	GString *out;
+	int ret;
+
+	out = NULL;
+	ret = sr_output_send(o, packet, &out);
+	if (out) {
+		*out_bytes += out->len;
+		if (collect)
+			g_string_append_len(collect, out->str, out->len);
+		g_string_free(out, TRUE);
+	}
+
+	return ret;
+}
+
+/*
+ * Run the logic and/or analog dataset through an output instance, in
+ * the same packet sequence a device would produce.
+ */
+static int output_feed(const struct sr_output *o, gboolean logic,
+		gboolean analog, GString *collect, uint64_t *out_bytes)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_header header;
+	struct sr_datafeed_meta meta;
+	struct sr_datafeed_logic dl;
+	struct sr_datafeed_analog da;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct sr_config src;
+	uint64_t pos, len;
+	int ret;
+
+	ret = SR_OK;
+
+	header.feed_version = 1;
+	gettimeofday(&header.starttime, NULL);
+	packet.type = SR_DF_HEADER;
+	packet.payload = &header;
+	ret |= output_send(o, &packet, collect, out_bytes);
+
+	src.key = SR_CONF_SAMPLERATE;
+	src.data = g_variant_new_uint64(SAMPLERATE);
+	meta.config = g_slist_append(NULL, &src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	ret |= output_send(o, &packet, collect, out_bytes);
+	g_slist_free(meta.config);
+	g_variant_unref(src.data);
+
+	memset(&encoding, 0, sizeof(encoding));
+	encoding.unitsize = sizeof(float);
+	encoding.is_signed = TRUE;
+	encoding.is_float = TRUE;
+	encoding.digits = 3;
+	encoding.is_digits_decimal = TRUE;
+	sr_rational_set(&encoding.scale, 1, 1);
+	sr_rational_set(&encoding.offset, 0, 1);
+	memset(&meaning, 0, sizeof(meaning));
+	meaning.mq = SR_MQ_VOLTAGE;
+	meaning.unit = SR_UNIT_VOLT;
+	meaning.channels = analog_channels(bench_sdi);
+	spec.spec_digits = 3;
+	da.encoding = &encoding;
+	da.meaning = &meaning;
+	da.spec = &spec;
+
+	for (pos = 0; pos < num_samples && ret == SR_OK; pos += len) {
+		len = MIN(CHUNK_SAMPLES, num_samples - pos);
+		if (logic) {
+			dl.length = len * LOGIC_UNITSIZE;
+			dl.unitsize = LOGIC_UNITSIZE;
+			dl.data = logic_data + pos * LOGIC_UNITSIZE;
+			packet.type = SR_DF_LOGIC;
+			packet.payload = &dl;
+			ret |= output_send(o, &packet, collect, out_bytes);
+		}
+		if (analog) {
+			da.data = analog_data + pos;
+			da.num_samples = len;
+			packet.type = SR_DF_ANALOG;
+			packet.payload = &da;
+			ret |= output_send(o, &packet, collect, out_bytes);
+		}
+	}
+	g_slist_free(meaning.channels);
+
+	packet.type = SR_DF_END;
+	packet.payload = NULL;
+	ret |= output_send(o, &packet, collect, out_bytes);
+
+	return ret;
+}
+
+static char *temp_filename(const char *id)
+{
+	char *basename, *filename;
+
+	basename = g_strdup_printf("sigrok-bench-%s.tmp", id);
+	filename = g_build_filename(g_get_tmp_dir(), basename, NULL);
+	g_free(basename);
+
+	return filename;
+}
+
+static void bench_outputs(void)
+{
+	const struct sr_output_module **omods, *omod;
+	const struct sr_output *o;
+	struct bench_result r;
+	uint64_t out_bytes;
+	char *filename;
+	int i, ret;
+
+	omods = sr_output_list();
+	for (i = 0; omods[i]; i++) {
+		omod = omods[i];
+		filename = temp_filename(sr_output_id_get(omod));
+		bench_begin(&r, "output", sr_output_id_get(omod));
+		if (!bench_wanted(r.name)) {
+			g_free(r.name);
+			g_free(filename);
+			continue;
+		}
+		out_bytes = 0;
+		o = sr_output_new(omod, NULL, bench_sdi, filename);
+		if (o) {
+			ret = output_feed(o, TRUE, TRUE, NULL, &out_bytes);
+			sr_output_free(o);
+		} else {
+			ret = SR_ERR;
+		}
+		bench_end(&r);
+		g_unlink(filename);
+		g_free(filename);
+
+		r.samples = num_samples;
+		r.bytes = num_samples * (LOGIC_UNITSIZE + sizeof(float));
+		if (ret != SR_OK)
+			r.status = "error";
+		report(&r);
+	}
+}
+
+static void datafeed_count(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct feed_stats *stats;
+
+	(void)sdi;
+
+	stats = cb_data;
+	switch (packet->type) {
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		stats->samples += logic->length / logic->unitsize;
+		stats->bytes += logic->length;
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		stats->samples += analog->num_samples;
+		stats->bytes += analog->num_samples * analog->encoding->unitsize;
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Input datasets are produced by the output module of the same format,
+ * so every input parses something realistic.
+ */
+static const struct {
+	const char *input;
+	const char *output;
+	gboolean logic;
+	gboolean analog;
+	const char *option;
+	const char *value;
+} input_datasets[] = {
+	{ "binary", "binary", TRUE, FALSE, NULL, NULL },
+	{ "chronovu-la8", "chronovu-la8", TRUE, FALSE, NULL, NULL },
+	{ "csv", "csv", TRUE, FALSE, NULL, NULL },
+	{ "vcd", "vcd", TRUE, FALSE, NULL, NULL },
+	{ "wav", "wav", FALSE, TRUE, NULL, NULL },
+	{ "raw_analog", NULL, FALSE, TRUE, "format", "FLOAT_LE" },
+};
+
+static GString *input_dataset(int idx)
+{
+	const struct sr_output_module *omod;
+	const struct sr_output *o;
+	GString *data;
+	uint64_t out_bytes;
+
+	if (!input_datasets[idx].output)
+		return g_string_new_len((const char *)analog_data,
+				num_samples * sizeof(float));
+
+	omod = sr_output_find((char *)input_datasets[idx].output);
+	if (!omod || !(o = sr_output_new(omod, NULL, bench_sdi, NULL)))
+		return NULL;
+	data = g_string_sized_new(num_samples * LOGIC_UNITSIZE);
+	out_bytes = 0;
+	output_feed(o, input_datasets[idx].logic, input_datasets[idx].analog,
+			data, &out_bytes);
+	sr_output_free(o);
+
+	return data;
+}
+
+static int input_feed(const struct sr_input_module *imod, GHashTable *options,
+		GString *data, struct feed_stats *stats)
+{
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	struct sr_input *in;
+	GString *chunk;
+	gsize pos, len;
+	gboolean added;
+	int ret;
+
+	if (!(in = sr_input_new(imod, options)))
+		return SR_ERR;
+	sr_session_new(ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_count, stats);
+
+	ret = SR_OK;
+	added = FALSE;
+	chunk = g_string_sized_new(CHUNK_BYTES);
+	for (pos = 0; pos < data->len && ret == SR_OK; pos += len) {
+		/* Some modules only create their device on the first chunk. */
+		if (!added && (sdi = sr_input_dev_inst_get(in))) {
+			sr_session_dev_add(session, sdi);
+			added = TRUE;
+		}
+		len = MIN(CHUNK_BYTES, data->len - pos);
+		g_string_truncate(chunk, 0);
+		g_string_append_len(chunk, data->str + pos, len);
+		ret = sr_input_send(in, chunk);
+	}
+	if (!added && (sdi = sr_input_dev_inst_get(in)))
+		sr_session_dev_add(session, sdi);
+	if (ret == SR_OK)
+		ret = sr_input_end(in);
+	g_string_free(chunk, TRUE);
+
+	sr_session_destroy(session);
+	sr_input_free(in);
+
+	return ret;
+}
+
+static void bench_inputs(void)
+{
+	const struct sr_input_module **imods, *imod;
+	struct bench_result r;
+	struct feed_stats stats;
+	GHashTable *options;
+	GString *data;
+	const char *id;
+	unsigned int i, j;
+	int ret;
+
+	imods = sr_input_list();
+	for (i = 0; imods[i]; i++) {
+		imod = imods[i];
+		id = sr_input_id_get(imod);
+		for (j = 0; j < G_N_ELEMENTS(input_datasets); j++) {
+			if (!strcmp(input_datasets[j].input, id))
+				break;
+		}
+		bench_begin(&r, "input", id);
+		if (!bench_wanted(r.name)) {
+			g_free(r.name);
+			continue;
+		}
+		g_free(r.name);
+		if (j == G_N_ELEMENTS(input_datasets)) {
+			report_skipped("input", id, "no-dataset");
+			continue;
+		}
+
+		options = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				(GDestroyNotify)g_variant_unref);
+		if (input_datasets[j].option)
+			g_hash_table_insert(options, g_strdup(input_datasets[j].option),
+				g_variant_ref_sink(g_variant_new_string(input_datasets[j].value)));
+		data = input_dataset(j);
+		if (!data) {
+			g_hash_table_destroy(options);
+			report_skipped("input", id, "error");
+			continue;
+		}
+
+		memset(&stats, 0, sizeof(stats));
+		bench_begin(&r, "input", id);
+		ret = input_feed(imod, options, data, &stats);
+		bench_end(&r);
+
+		r.samples = stats.samples;
+		r.bytes = data->len;
+		if (ret != SR_OK)
+			r.status = "error";
+		report(&r);
+
+		g_string_free(data, TRUE);
+		g_hash_table_destroy(options);
+	}
+}
+
+static struct sr_dev_driver *demo_driver(void)
+{
+	static struct sr_dev_driver *driver;
+	struct sr_dev_driver **drivers;
+	int i;
+
+	if (driver)
+		return driver;
+
+	drivers = sr_driver_list(ctx);
+	for (i = 0; drivers && drivers[i]; i++) {
+		if (strcmp(drivers[i]->name, "demo"))
+			continue;
+		if (sr_driver_init(ctx, drivers[i]) == SR_OK)
+			driver = drivers[i];
+		break;
+	}
+
+	return driver;
+}
+
+static struct sr_dev_inst *demo_dev_new(int num_logic, int num_analog)
+{
+	struct sr_dev_driver *driver;
+	struct sr_config logic_opt, analog_opt;
+	struct sr_dev_inst *sdi;
+	GSList *options, *devices;
+
+	if (!(driver = demo_driver()))
+		return NULL;
+
+	logic_opt.key = SR_CONF_NUM_LOGIC_CHANNELS;
+	logic_opt.data = g_variant_new_int32(num_logic);
+	analog_opt.key = SR_CONF_NUM_ANALOG_CHANNELS;
+	analog_opt.data = g_variant_new_int32(num_analog);
+	options = g_slist_append(NULL, &logic_opt);
+	options = g_slist_append(options, &analog_opt);
+	devices = sr_driver_scan(driver, options);
+	g_slist_free(options);
+	g_variant_unref(logic_opt.data);
+	g_variant_unref(analog_opt.data);
+
+	if (!devices)
+		return NULL;
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	if (sr_dev_open(sdi) != SR_OK)
+		return NULL;
+
+	/* Send as fast as the session takes it, in large packets. */
+	sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE,
+			g_variant_new_uint64(SAMPLERATE));
+	sr_config_set(sdi, NULL, SR_CONF_FREE_RUNNING,
+			g_variant_new_boolean(TRUE));
+	sr_config_set(sdi, NULL, SR_CONF_BUFFERSIZE,
+			g_variant_new_uint64(CHUNK_SAMPLES * LOGIC_UNITSIZE));
+
+	return sdi;
+}
+
+static void demo_logic_pattern_set(struct sr_dev_inst *sdi, const char *pattern)
+{
+	struct sr_channel_group *cg;
+	GSList *l;
+
+	for (l = sr_dev_inst_channel_groups_get(sdi); l; l = l->next) {
+		cg = l->data;
+		if (!strcmp(cg->name, "Logic"))
+			sr_config_set(sdi, cg, SR_CONF_PATTERN_MODE,
+					g_variant_new_string(pattern));
+	}
+}
+
+/*
+ * Run the demo device in free-running mode through a session, with the
+ * given transform (if any, with its options) and trigger (if any) applied.
+ */
+static int demo_run(struct sr_dev_inst *sdi,
+		const struct sr_transform_module *tmod, GHashTable *options,
+		struct sr_trigger *trigger, struct feed_stats *stats)
+{
+	struct sr_session *session;
+	const struct sr_transform *t;
+	int ret;
+
+	sr_session_new(ctx, &session);
+	sr_session_dev_add(session, sdi);
+	sr_session_datafeed_callback_add(session, datafeed_count, stats);
+	if (trigger)
+		sr_session_trigger_set(session, trigger);
+
+	t = NULL;
+	if (tmod && !(t = sr_transform_new(tmod, options, sdi))) {
+		sr_session_destroy(session);
+		return SR_ERR;
+	}
+
+	if ((ret = sr_session_start(session)) == SR_OK)
+		ret = sr_session_run(session);
+
+	if (t)
+		sr_transform_free(t);
+	sr_session_destroy(session);
+
+	return ret;
+}
+
+static void bench_session(void)
+{
+	static const struct {
+		const char *id;
+		int num_logic;
+		int num_analog;
+	} configs[] = {
+		{ "demo-logic", NUM_LOGIC_CHANNELS, 0 },
+		{ "demo-analog", 0, 1 },
+		{ "demo-mixed", NUM_LOGIC_CHANNELS, 1 },
+	};
+	struct sr_dev_inst *sdi;
+	struct bench_result r;
+	struct feed_stats stats;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < G_N_ELEMENTS(configs); i++) {
+		bench_begin(&r, "session", configs[i].id);
+		if (!bench_wanted(r.name)) {
+			g_free(r.name);
+			continue;
+		}
+		g_free(r.name);
+		if (!(sdi = demo_dev_new(configs[i].num_logic, configs[i].num_analog))) {
+			report_skipped("session", configs[i].id, "no-device");
+			continue;
+		}
+		sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+				g_variant_new_uint64(num_samples));
+
+		memset(&stats, 0, sizeof(stats));
+		bench_begin(&r, "session", configs[i].id);
+		ret = demo_run(sdi, NULL, NULL, NULL, &stats);
+		bench_end(&r);
+		sr_dev_close(sdi);
+
+		r.samples = stats.samples;
+		r.bytes = stats.bytes;
+		if (ret != SR_OK)
+			r.status = "error";
+		report(&r);
+	}
+}
+
+static void bench_transforms(void)
+{
+	const struct sr_transform_module **tmods, *tmod;
+	struct sr_dev_inst *sdi;
+	struct bench_result r;
+	struct feed_stats stats;
+	int i, ret;
+
+	tmods = sr_transform_list();
+	for (i = 0; tmods[i]; i++) {
+		tmod = tmods[i];
+		bench_begin(&r, "transform", sr_transform_id_get(tmod));
+		if (!bench_wanted(r.name)) {
+			g_free(r.name);
+			continue;
+		}
+		g_free(r.name);
+		if (!(sdi = demo_dev_new(NUM_LOGIC_CHANNELS, 1))) {
+			report_skipped("transform", sr_transform_id_get(tmod),
+					"no-device");
+			continue;
+		}
+		sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+				g_variant_new_uint64(num_samples));
+
+		memset(&stats, 0, sizeof(stats));
+		bench_begin(&r, "transform", sr_transform_id_get(tmod));
+		ret = demo_run(sdi, tmod, NULL, NULL, &stats);
+		bench_end(&r);
+		sr_dev_close(sdi);
+
+		r.samples = stats.samples;
+		r.bytes = stats.bytes;
+		if (ret != SR_OK)
+			r.status = "error";
+		report(&r);
+	}
+}
+
+/*
+ * Decimate an analog stream in each mode. Throughput is given for the
+ * input samples, to compare with device samplerates.
+ */
+static void bench_decimate(void)
+{
+	static const char *modes[] = { "fir", "mean", "peak" };
+	const struct sr_transform_module *tmod;
+	struct sr_dev_inst *sdi;
+	struct bench_result r;
+	struct feed_stats stats;
+	GHashTable *options;
+	unsigned int i;
+	int ret;
+
+	if (!(tmod = sr_transform_find("decimate")))
+		return;
+
+	for (i = 0; i < G_N_ELEMENTS(modes); i++) {
+		bench_begin(&r, "decimate", modes[i]);
+		if (!bench_wanted(r.name)) {
+			g_free(r.name);
+			continue;
+		}
+		g_free(r.name);
+		if (!(sdi = demo_dev_new(0, 1))) {
+			report_skipped("decimate", modes[i], "no-device");
+			continue;
+		}
+		sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+				g_variant_new_uint64(num_samples));
+
+		options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+				(GDestroyNotify)g_variant_unref);
+		g_hash_table_insert(options, "factor",
+				g_variant_ref_sink(g_variant_new_uint32(16)));
+		g_hash_table_insert(options, "mode",
+				g_variant_ref_sink(g_variant_new_string(modes[i])));
+
+		memset(&stats, 0, sizeof(stats));
+		bench_begin(&r, "decimate", modes[i]);
+		ret = demo_run(sdi, tmod, options, NULL, &stats);
+		bench_end(&r);
+		sr_dev_close(sdi);
+		g_hash_table_destroy(options);
+
+		r.samples = num_samples;
+		r.bytes = num_samples * sizeof(float);
+		if (ret != SR_OK)
+			r.status = "error";
+		report(&r);
+	}
+}
+
+/*
+ * The soft trigger benchmark scans data which never matches, so the
+ * whole run is spent in the trigger check. A time limit is used since
+ * no samples are ever sent; in free-running mode it refers to the
+ * sample time. With a capture ratio, the soft trigger also keeps that
+ * share of the sample limit as pre-trigger data.
+ */
+static void bench_soft_trigger(const char *variant, uint64_t capture_ratio)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+	struct sr_channel *ch;
+	struct bench_result r;
+	struct feed_stats stats;
+	uint64_t msec;
+	int ret;
+
+	bench_begin(&r, "soft-trigger", variant);
+	if (!bench_wanted(r.name)) {
+		g_free(r.name);
+		return;
+	}
+	g_free(r.name);
+	if (!(sdi = demo_dev_new(NUM_LOGIC_CHANNELS, 0))) {
+		report_skipped("soft-trigger", variant, "no-device");
+		return;
+	}
+	demo_logic_pattern_set(sdi, "all-low");
+	msec = MAX(num_samples * 1000 / SAMPLERATE, 1);
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_MSEC, g_variant_new_uint64(msec));
+	if (capture_ratio) {
+		sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+			g_variant_new_uint64(num_samples));
+		sr_config_set(sdi, NULL, SR_CONF_CAPTURE_RATIO,
+			g_variant_new_uint64(capture_ratio));
+	}
+
+	ch = sr_dev_inst_channels_get(sdi)->data;
+	trigger = sr_trigger_new("bench");
+	stage = sr_trigger_stage_add(trigger);
+	sr_trigger_match_add(stage, ch, SR_TRIGGER_RISING, 0);
+
+	memset(&stats, 0, sizeof(stats));
+	bench_begin(&r, "soft-trigger", variant);
+	ret = demo_run(sdi, NULL, NULL, trigger, &stats);
+	bench_end(&r);
+	sr_dev_close(sdi);
+	sr_trigger_free(trigger);
+
+	r.samples = msec * SAMPLERATE / 1000;
+	r.bytes = r.samples * LOGIC_UNITSIZE;
+	if (ret != SR_OK)
+		r.status = "error";
+	report(&r);
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-n samples] [-o results-file] "
+		"[name-filter]\n", prog);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *outfile;
+	int i;
+
+	outfile = NULL;
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-n") && i + 1 < argc)
+			num_samples = g_ascii_strtoull(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+			outfile = argv[++i];
+		else if (argv[i][0] == '-')
+			usage(argv[0]);
+		else
+			filter = argv[i];
+	}
+	if (!num_samples)
+		usage(argv[0]);
+
+	results = stdout;
+	if (outfile && !(results = fopen(outfile, "w"))) {
+		fprintf(stderr, "Failed to open '%s'.\n", outfile);
+		return 1;
+	}
+
+	if (sr_init(&ctx) != SR_OK)
+		return 1;
+	sr_log_loglevel_set(SR_LOG_WARN);
+
+	datasets_init();
+	bench_sdi = bench_dev_new();
+
+	bench_session();
+	bench_transforms();
+	bench_decimate();
+	bench_soft_trigger("logic-rising", 0);
+	bench_soft_trigger("logic-rising-pretrigger", 50);
+	bench_outputs();
+	bench_inputs();
+
+	sr_exit(ctx);
+	g_free(logic_data);
+	g_free(analog_data);
+	if (results != stdout)
+		fclose(results);
+
+	return 0;
+}
@@ -20,7 +20,9 @@
 
 #include <config.h>
 #include <string.h>
+#include <unistd.h>
 #include <check.h>
+#include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
 
@@ -62,6 +64,66 @@ START_TEST(test_channel_add)
 }
 END_TEST
 
+/*
+ * Check whether devices saved to a cache file are found again, and
+ * whether entries of unknown drivers and user devices are skipped.
+ */
+START_TEST(test_cache_reconnect)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	GSList *devices;
+	char *filename, *contents, *bogus;
+	const char *other;
+	int fd, ret;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	devices = g_slist_append(devices,
+		sr_dev_inst_user_new("Vendor", "Model", "Version"));
+
+	fd = g_file_open_tmp("sigrok-devcache-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	close(fd);
+
+	fail_unless(sr_dev_cache_save(NULL, devices) == SR_ERR_ARG);
+	ret = sr_dev_cache_save(filename, devices);
+	fail_unless(ret == SR_OK, "sr_dev_cache_save() failed: %d.", ret);
+	g_slist_free(devices);
+
+	g_file_get_contents(filename, &contents, NULL, NULL);
+	fail_unless(strstr(contents, "driver=demo") != NULL);
+	fail_unless(strstr(contents, "Vendor") == NULL, "User device saved.");
+	bogus = g_strconcat(contents, "[device 2]\ndriver=no-such-driver\n", NULL);
+	g_file_set_contents(filename, bogus, -1, NULL);
+	g_free(bogus);
+	g_free(contents);
+
+	devices = sr_dev_cache_reconnect(srtest_ctx, filename);
+	fail_unless(g_slist_length(devices) == 1, "Cached device not found.");
+	fail_unless(!strcmp(sr_dev_inst_model_get(devices->data),
+		sr_dev_inst_model_get(sdi)));
+	g_slist_free(devices);
+	fail_unless(g_slist_length(sr_dev_list(driver)) == 2,
+		"Unused instances were kept.");
+
+	/* The full scan finds a device, but not the cached one. */
+	other = "[device 1]\ndriver=demo\nmodel=No such model\n";
+	g_file_set_contents(filename, other, -1, NULL);
+	fail_unless(sr_dev_cache_reconnect(srtest_ctx, filename) == NULL);
+	fail_unless(g_slist_length(sr_dev_list(driver)) == 2,
+		"Unused instances were kept.");
+
+	g_remove(filename);
+	fail_unless(sr_dev_cache_reconnect(srtest_ctx, filename) == NULL);
+	fail_unless(sr_dev_cache_reconnect(NULL, filename) == NULL);
+	g_free(filename);
+}
+END_TEST
+
 Suite *suite_device(void)
 {
 	Suite *s;
@@ -77,5 +139,10 @@ Suite *suite_device(void)
 	tcase_add_test(tc, test_channel_add);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("sr_dev_cache");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_cache_reconnect);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
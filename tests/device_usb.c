@@ -0,0 +1,195 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <config.h>
+#include <string.h>
+#include <unistd.h>
+#include <check.h>
+#include <glib/gstdio.h>
+#include <libsigrok/libsigrok.h>
+#include "lib.h"
+
+#if defined(__GLIBC__) && defined(HAVE_LIBUSB_1_0) && defined(HAVE_HW_UNI_T_UT32X)
+
+#include <libusb.h>
+
+/*
+ * A fake USB bus with a single device on it. The library's libusb calls
+ * for listing devices end up here, since tests/transport links these in
+ * place of libusb's.
+ */
+struct libusb_device {
+	uint8_t bus;
+	uint8_t address;
+	uint8_t port;
+};
+
+static struct libusb_device fake_usb_device;
+/* Whether the device is plugged in. */
+static gboolean fake_usb_present;
+
+ssize_t libusb_get_device_list(libusb_context *ctx, libusb_device ***list)
+{
+	(void)ctx;
+
+	*list = g_malloc0(2 * sizeof(libusb_device *));
+	if (!fake_usb_present)
+		return 0;
+	(*list)[0] = &fake_usb_device;
+
+	return 1;
+}
+
+void libusb_free_device_list(libusb_device **list, int unref_devices)
+{
+	(void)unref_devices;
+
+	g_free(list);
+}
+
+int libusb_get_device_descriptor(libusb_device *dev,
+		struct libusb_device_descriptor *desc)
+{
+	(void)dev;
+
+	memset(desc, 0, sizeof(*desc));
+	desc->idVendor = 0x10c4;
+	desc->idProduct = 0xea80;
+
+	return 0;
+}
+
+uint8_t libusb_get_bus_number(libusb_device *dev)
+{
+	return dev->bus;
+}
+
+uint8_t libusb_get_device_address(libusb_device *dev)
+{
+	return dev->address;
+}
+
+int libusb_get_port_numbers(libusb_device *dev, uint8_t *port_numbers,
+		int port_numbers_len)
+{
+	(void)port_numbers_len;
+
+	port_numbers[0] = dev->port;
+
+	return 1;
+}
+
+static struct sr_dev_inst *usb_scan(struct sr_dev_driver *driver,
+		const char *conn)
+{
+	struct sr_config src;
+	struct sr_dev_inst *sdi;
+	GSList *options, *devices;
+
+	src.key = SR_CONF_CONN;
+	src.data = g_variant_new_string(conn);
+	options = g_slist_append(NULL, &src);
+	devices = sr_driver_scan(driver, options);
+	g_slist_free(options);
+	g_variant_unref(src.data);
+
+	if (!devices)
+		return NULL;
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	return sdi;
+}
+
+/*
+ * A cached USB device is found again by its bus and address, without
+ * a full scan. Once it got another address, it can't be found there.
+ */
+START_TEST(test_cache_reconnect_usb)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	GSList *devices;
+	char *filename, *contents;
+	int fd, ret;
+
+	fake_usb_device.bus = 3;
+	fake_usb_device.address = 7;
+	fake_usb_device.port = 2;
+	fake_usb_present = TRUE;
+
+	driver = srtest_driver_get("uni-t-ut32x");
+	srtest_driver_init(srtest_ctx, driver);
+	sdi = usb_scan(driver, "10c4.ea80");
+	fail_unless(sdi != NULL, "No USB device found.");
+
+	fd = g_file_open_tmp("sigrok-devcache-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	close(fd);
+
+	devices = g_slist_append(NULL, sdi);
+	ret = sr_dev_cache_save(filename, devices);
+	fail_unless(ret == SR_OK, "sr_dev_cache_save() failed: %d.", ret);
+	g_slist_free(devices);
+
+	g_file_get_contents(filename, &contents, NULL, NULL);
+	fail_unless(strstr(contents, "conn=3.7\n") != NULL,
+		"Bus and address not saved.");
+	fail_unless(strstr(contents, "connection_id=usb/3-2\n") != NULL,
+		"Port path not saved.");
+	g_free(contents);
+
+	devices = sr_dev_cache_reconnect(srtest_ctx, filename);
+	fail_unless(g_slist_length(devices) == 1, "Cached device not found.");
+	fail_unless(devices->data != sdi);
+	fail_unless(!strcmp(sr_dev_inst_connid_get(devices->data), "usb/3-2"));
+	g_slist_free(devices);
+	fail_unless(g_slist_length(sr_dev_list(driver)) == 2);
+
+	/* Replugged, so it has another address on the same port. */
+	fake_usb_device.address = 8;
+	fail_unless(sr_dev_cache_reconnect(srtest_ctx, filename) == NULL,
+		"Device found at a stale address.");
+	fail_unless(g_slist_length(sr_dev_list(driver)) == 2);
+
+	fake_usb_present = FALSE;
+	g_remove(filename);
+	g_free(filename);
+}
+END_TEST
+
+#endif
+
+Suite *suite_device_usb(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("device-usb");
+
+	tc = tcase_create("sr_dev_cache");
+#if defined(__GLIBC__) && defined(HAVE_LIBUSB_1_0) && defined(HAVE_HW_UNI_T_UT32X)
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_cache_reconnect_usb);
+#endif
+	suite_add_tcase(s, tc);
+
+	return s;
+}
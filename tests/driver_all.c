@@ -20,9 +20,14 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
+#include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
+#ifdef HAVE_HW_BAYLIBRE_ACME
+#include "hardware/baylibre-acme/protocol.h"
+#endif
 
 /* Check whether at least one driver is available. */
 START_TEST(test_driver_available)
@@ -60,6 +65,327 @@ START_TEST(test_config_get_set_samplerate)
 END_TEST
 #endif
 
+static int (*driver_config_get)(uint32_t key, GVariant **data,
+		const struct sr_dev_inst *sdi, const struct sr_channel_group *cg);
+static gint num_config_get;
+
+/* Count the calls reaching the driver. */
+static int counting_config_get(uint32_t key, GVariant **data,
+		const struct sr_dev_inst *sdi, const struct sr_channel_group *cg)
+{
+	g_atomic_int_inc(&num_config_get);
+
+	return driver_config_get(key, data, sdi, cg);
+}
+
+static uint64_t get_samplerate(struct sr_dev_inst *sdi)
+{
+	GVariant *gvar;
+	uint64_t samplerate;
+	int ret;
+
+	ret = sr_config_get(sr_dev_inst_driver_get(sdi), sdi, NULL,
+			SR_CONF_SAMPLERATE, &gvar);
+	fail_unless(ret == SR_OK, "Failed to get SR_CONF_SAMPLERATE: %d.", ret);
+	samplerate = g_variant_get_uint64(gvar);
+	g_variant_unref(gvar);
+
+	return samplerate;
+}
+
+static gpointer cache_thread(gpointer data)
+{
+	struct sr_dev_inst *sdi;
+	unsigned int i;
+
+	sdi = data;
+	for (i = 0; i < 1000; i++) {
+		if (i % 100 == 0)
+			sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE,
+				g_variant_new_uint64(SR_KHZ(50)));
+		if (get_samplerate(sdi) != SR_KHZ(50))
+			return GUINT_TO_POINTER(1);
+	}
+
+	return NULL;
+}
+
+/*
+ * Check whether the config value cache returns the cached value without
+ * calling the driver, and is invalidated by sr_config_set().
+ */
+START_TEST(test_config_cache)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	GSList *devices;
+	GThread *threads[4];
+	unsigned int i;
+	int ret;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	driver_config_get = driver->config_get;
+	driver->config_get = counting_config_get;
+
+	fail_unless(sr_config_cache_enable(NULL, TRUE) == SR_ERR_ARG);
+
+	/* Without the cache, every query reaches the driver. */
+	sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE, g_variant_new_uint64(SR_KHZ(20)));
+	num_config_get = 0;
+	fail_unless(get_samplerate(sdi) == SR_KHZ(20));
+	fail_unless(get_samplerate(sdi) == SR_KHZ(20));
+	fail_unless(num_config_get == 2, "Driver called %d times.", num_config_get);
+
+	ret = sr_config_cache_enable(sdi, TRUE);
+	fail_unless(ret == SR_OK, "sr_config_cache_enable() failed: %d.", ret);
+
+	num_config_get = 0;
+	fail_unless(get_samplerate(sdi) == SR_KHZ(20));
+	fail_unless(get_samplerate(sdi) == SR_KHZ(20));
+	fail_unless(get_samplerate(sdi) == SR_KHZ(20));
+	fail_unless(num_config_get == 1, "Driver called %d times.", num_config_get);
+
+	/* Setting any key must invalidate the cache. */
+	sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE, g_variant_new_uint64(SR_KHZ(50)));
+	fail_unless(get_samplerate(sdi) == SR_KHZ(50));
+	fail_unless(num_config_get == 2, "Driver called %d times.", num_config_get);
+
+	/* Concurrent queries and invalidations must be safe. */
+	for (i = 0; i < G_N_ELEMENTS(threads); i++)
+		threads[i] = g_thread_new("cache-test", cache_thread, sdi);
+	for (i = 0; i < G_N_ELEMENTS(threads); i++)
+		fail_unless(g_thread_join(threads[i]) == NULL,
+			"Wrong samplerate in thread %u.", i);
+
+	/* Unknown keys must still be rejected with the cached capabilities. */
+	ret = sr_config_set(sdi, NULL, SR_CONF_CENTER_FREQUENCY,
+			g_variant_new_double(1.0));
+	fail_unless(ret == SR_ERR_ARG, "Unsupported key was accepted.");
+
+	sr_config_cache_enable(sdi, FALSE);
+	driver->config_get = driver_config_get;
+}
+END_TEST
+
+#ifdef HAVE_HW_BAYLIBRE_ACME
+/* Files of a fake sysfs tree with one revision B ACME power probe. */
+static const char *acme_files[] = {
+	"class/i2c-adapter/i2c-1/1-0040/name",
+	"class/i2c-dev/i2c-1/device/1-0050/eeprom",
+	"class/hwmon/hwmon0/power1_input",
+	"class/hwmon/hwmon0/curr1_input",
+	"class/hwmon/hwmon0/in1_input",
+};
+
+static const char *acme_dirs[] = {
+	"class/i2c-adapter/i2c-1/1-0040/hwmon/hwmon0",
+	"class/i2c-adapter/i2c-1/1-0040/hwmon",
+	"class/i2c-adapter/i2c-1/1-0040",
+	"class/i2c-adapter/i2c-1",
+	"class/i2c-adapter",
+	"class/i2c-dev/i2c-1/device/1-0050",
+	"class/i2c-dev/i2c-1/device",
+	"class/i2c-dev/i2c-1",
+	"class/i2c-dev",
+	"class/hwmon/hwmon0",
+	"class/hwmon",
+	"class",
+};
+
+static void acme_file_set(const char *root, const char *name,
+		const char *contents, gssize len)
+{
+	char *path, *dir;
+
+	path = g_build_filename(root, name, NULL);
+	dir = g_path_get_dirname(path);
+	g_mkdir_with_parents(dir, 0755);
+	fail_unless(g_file_set_contents(path, contents, len, NULL),
+		"Failed to create %s.", path);
+	g_free(dir);
+	g_free(path);
+}
+
+static char *acme_sysfs_new(void)
+{
+	char eeprom[61], *root, *path;
+
+	root = g_dir_make_tmp("sigrok-acme-XXXXXX", NULL);
+	fail_unless(root != NULL, "Failed to create temporary directory.");
+
+	/* Type USB, revision 'B', default shunt, no power switch. */
+	memset(eeprom, 0, sizeof(eeprom));
+	eeprom[3] = 1;
+	eeprom[7] = 'B';
+	acme_file_set(root, acme_files[0], "ina226\n", -1);
+	acme_file_set(root, acme_files[1], eeprom, sizeof(eeprom));
+	acme_file_set(root, acme_files[2], "1500000\n", -1);
+	acme_file_set(root, acme_files[3], "250\n", -1);
+	acme_file_set(root, acme_files[4], "5000\n", -1);
+	path = g_build_filename(root, acme_dirs[0], NULL);
+	g_mkdir_with_parents(path, 0755);
+	g_free(path);
+
+	return root;
+}
+
+static void acme_sysfs_free(char *root)
+{
+	char *path;
+	unsigned int i;
+
+	for (i = 0; i < G_N_ELEMENTS(acme_files); i++) {
+		path = g_build_filename(root, acme_files[i], NULL);
+		g_remove(path);
+		g_free(path);
+	}
+	for (i = 0; i < G_N_ELEMENTS(acme_dirs); i++) {
+		path = g_build_filename(root, acme_dirs[i], NULL);
+		g_rmdir(path);
+		g_free(path);
+	}
+	g_rmdir(root);
+	g_free(root);
+}
+
+struct acme_feed {
+	uint64_t samples;
+	uint64_t frames;
+	gboolean in_frame;
+	/* SR_CONF_ANALOG_TIMESTAMPS of the next analog packet. */
+	GVariant *timestamps;
+	int64_t last_timestamp;
+	float last_value;
+};
+
+static void datafeed_acme(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_analog *analog;
+	const struct sr_config *src;
+	const struct sr_channel *ch;
+	struct acme_feed *feed;
+	const int64_t *timestamps;
+	gsize i, num_timestamps;
+	GSList *l;
+
+	(void)sdi;
+
+	feed = cb_data;
+	if (packet->type == SR_DF_META) {
+		meta = packet->payload;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			if (src->key != SR_CONF_ANALOG_TIMESTAMPS)
+				continue;
+			fail_unless(feed->timestamps == NULL,
+				"Timestamps without samples.");
+			feed->timestamps = g_variant_ref(src->data);
+		}
+		return;
+	}
+	if (packet->type == SR_DF_FRAME_BEGIN) {
+		fail_unless(!feed->in_frame, "Nested frame.");
+		feed->in_frame = TRUE;
+		feed->frames++;
+		return;
+	}
+	if (packet->type == SR_DF_FRAME_END) {
+		fail_unless(feed->in_frame, "Frame end without a beginning.");
+		feed->in_frame = FALSE;
+		return;
+	}
+	if (packet->type != SR_DF_ANALOG)
+		return;
+
+	fail_unless(feed->in_frame, "Samples outside a frame.");
+	fail_unless(feed->timestamps != NULL, "Samples without timestamps.");
+	timestamps = g_variant_get_fixed_array(feed->timestamps,
+		&num_timestamps, sizeof(int64_t));
+	analog = packet->payload;
+	fail_unless(num_timestamps == analog->num_samples,
+		"Got %" G_GSIZE_FORMAT " timestamps for %u samples.",
+		num_timestamps, analog->num_samples);
+	ch = analog->meaning->channels->data;
+	if (!strcmp(ch->name, "P1_ENRG_VOL")) {
+		for (i = 0; i < num_timestamps; i++) {
+			fail_unless(timestamps[i] >= feed->last_timestamp,
+				"Timestamps out of order.");
+			feed->last_timestamp = timestamps[i];
+		}
+		feed->last_value = ((const float *)analog->data)
+			[analog->num_samples - 1];
+		feed->samples += analog->num_samples;
+	}
+	g_variant_unref(feed->timestamps);
+	feed->timestamps = NULL;
+}
+
+/*
+ * Check whether the BayLibre ACME driver finds a probe in a fake sysfs
+ * tree, and acquires exactly the requested number of samples from it.
+ */
+START_TEST(test_baylibre_acme_fake_sysfs)
+{
+	struct sr_dev_driver **drivers, *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_session *sess;
+	struct acme_feed feed;
+	GSList *devices;
+	char *root;
+	int i;
+
+	driver = NULL;
+	drivers = sr_driver_list(srtest_ctx);
+	for (i = 0; drivers && drivers[i]; i++) {
+		if (!strcmp(drivers[i]->name, "baylibre-acme"))
+			driver = drivers[i];
+	}
+	if (!driver)
+		return;
+
+	root = acme_sysfs_new();
+	bl_acme_set_sysfs_root(root);
+
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No ACME device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+	fail_unless(g_slist_length(sr_dev_inst_channels_get(sdi)) == 3);
+
+	sr_dev_open(sdi);
+	sr_config_set(sdi, NULL, SR_CONF_SAMPLERATE, g_variant_new_uint64(500));
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES, g_variant_new_uint64(123));
+
+	memset(&feed, 0, sizeof(feed));
+	sr_session_new(srtest_ctx, &sess);
+	sr_session_dev_add(sess, sdi);
+	sr_session_datafeed_callback_add(sess, datafeed_acme, &feed);
+	sr_session_start(sess);
+	sr_session_run(sess);
+	sr_session_destroy(sess);
+
+	fail_unless(feed.samples == 123, "Got %" PRIu64 " samples.",
+		feed.samples);
+	fail_unless(feed.frames == 123, "Got %" PRIu64 " frames.",
+		feed.frames);
+	fail_unless(feed.last_value == 5.0, "Wrong voltage reading.");
+
+	sr_dev_close(sdi);
+	bl_acme_set_sysfs_root(NULL);
+	acme_sysfs_free(root);
+}
+END_TEST
+#endif
+
 Suite *suite_driver_all(void)
 {
 	Suite *s;
@@ -73,6 +399,14 @@ Suite *suite_driver_all(void)
 	tcase_add_test(tc, test_driver_init_all);
 	// TODO: Currently broken.
 	// tcase_add_test(tc, test_config_get_set_samplerate);
+	tcase_add_test(tc, test_config_cache);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("baylibre-acme");
+#ifdef HAVE_HW_BAYLIBRE_ACME
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_baylibre_acme_fake_sysfs);
+#endif
 	suite_add_tcase(s, tc);
 
 	return s;
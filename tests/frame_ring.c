@@ -0,0 +1,467 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+#define NUM_CHANNELS 2
+#define NUM_SAMPLES 5
+
+/* A packet sent by the frame ring. */
+struct sent_packet {
+	int type;
+	struct sr_frame_info info;
+	struct sr_channel *channel;
+	uint32_t num_samples;
+	uint16_t data[NUM_SAMPLES];
+};
+
+static struct sr_session *session;
+static struct sr_dev_inst fake_sdi;
+static struct sr_channel fake_channels[NUM_CHANNELS];
+static GSList *channels;
+static GArray *sent;
+
+static void datafeed_in(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_analog *analog;
+	const struct sr_config *src;
+	struct sent_packet p;
+	GSList *l;
+
+	(void)cb_data;
+
+	fail_unless(sdi == &fake_sdi, "Packet sent for another device.");
+
+	memset(&p, 0, sizeof(p));
+	p.type = packet->type;
+	switch (packet->type) {
+	case SR_DF_FRAME_BEGIN:
+		fail_unless(packet->payload == NULL, "Frame begin with payload.");
+		break;
+	case SR_DF_META:
+		meta = packet->payload;
+		p.info.trigger_offset = -1;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			switch (src->key) {
+			case SR_CONF_FRAME_INDEX:
+				p.info.index = g_variant_get_uint64(src->data);
+				break;
+			case SR_CONF_FRAME_TIMESTAMP:
+				p.info.timestamp = g_variant_get_uint64(src->data);
+				break;
+			case SR_CONF_FRAME_TRIGGER_OFFSET:
+				p.info.trigger_offset = g_variant_get_uint64(src->data);
+				break;
+			}
+		}
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		fail_unless(analog->num_samples == NUM_SAMPLES);
+		fail_unless(analog->encoding->unitsize == sizeof(uint16_t));
+		fail_unless(g_slist_length(analog->meaning->channels) == 1);
+		p.channel = analog->meaning->channels->data;
+		p.num_samples = analog->num_samples;
+		memcpy(p.data, analog->data, sizeof(p.data));
+		break;
+	}
+	g_array_append_val(sent, p);
+}
+
+static void setup(void)
+{
+	unsigned int i;
+	int ret;
+
+	srtest_setup();
+	ret = sr_session_new(srtest_ctx, &session);
+	fail_unless(ret == SR_OK, "sr_session_new() failed: %d.", ret);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+	sr_session_metrics_enable(session, TRUE);
+	memset(&fake_sdi, 0, sizeof(fake_sdi));
+	fake_sdi.session = session;
+
+	channels = NULL;
+	for (i = 0; i < NUM_CHANNELS; i++)
+		channels = g_slist_append(channels, &fake_channels[i]);
+	sent = g_array_new(FALSE, FALSE, sizeof(struct sent_packet));
+}
+
+static void teardown(void)
+{
+	g_slist_free(channels);
+	g_array_free(sent, TRUE);
+	sr_session_destroy(session);
+	srtest_teardown();
+}
+
+/* The number of dropped frames, as counted in the session metrics. */
+static uint64_t frames_dropped(void)
+{
+	const struct sr_metrics_stage *stage;
+	GSList *stages, *l;
+	uint64_t dropped;
+
+	fail_unless(sr_session_metrics_get(session, &stages) == SR_OK);
+	dropped = 0;
+	for (l = stages; l; l = l->next) {
+		stage = l->data;
+		if (stage->type == SR_METRICS_DEVICE)
+			dropped += stage->frames_dropped;
+	}
+	sr_session_metrics_free(stages);
+
+	return dropped;
+}
+
+static void ring_start(struct sr_frame_ring *ring, unsigned int num_frames,
+		gboolean drop_frames)
+{
+	int ret;
+
+	sr_frame_ring_init(ring);
+	ret = sr_frame_ring_acquisition_start(ring, num_frames, channels,
+		NUM_SAMPLES, sizeof(uint16_t), drop_frames);
+	fail_unless(ret == SR_OK, "Failed to start: %d.", ret);
+}
+
+static uint16_t sample_value(uint64_t index, unsigned int channel,
+		unsigned int sample)
+{
+	return index * 100 + channel * 10 + sample;
+}
+
+/* Fill a frame with samples telling its index, and commit it. */
+static gboolean frame_commit(struct sr_frame_ring *ring)
+{
+	struct sr_frame *frame;
+	uint16_t *data;
+	unsigned int i, j;
+
+	if (!(frame = sr_frame_ring_begin(ring, &fake_sdi)))
+		return FALSE;
+
+	for (i = 0; i < NUM_CHANNELS; i++) {
+		data = frame->channels[i].data;
+		for (j = 0; j < NUM_SAMPLES; j++)
+			data[j] = sample_value(frame->info.index, i, j);
+	}
+	frame->num_samples = NUM_SAMPLES;
+	frame->info.trigger_offset = frame->info.index % NUM_SAMPLES;
+	sr_frame_ring_commit(ring, frame);
+
+	return TRUE;
+}
+
+/* Check that exactly the frames with the given indices were sent. */
+static void check_sent(const uint64_t *indices, unsigned int num_frames)
+{
+	struct sent_packet *p;
+	unsigned int f, i, j;
+
+	fail_unless(sent->len == num_frames * (NUM_CHANNELS + 3),
+		"Sent %u packets for %u frames.", sent->len, num_frames);
+
+	p = (struct sent_packet *)sent->data;
+	for (f = 0; f < num_frames; f++) {
+		fail_unless(p->type == SR_DF_FRAME_BEGIN);
+		p++;
+		fail_unless(p->type == SR_DF_META, "No frame information.");
+		fail_unless(p->info.index == indices[f],
+			"Sent frame %" PRIu64 ", expected %" PRIu64 ".",
+			p->info.index, indices[f]);
+		fail_unless(p->info.trigger_offset == (int64_t)(indices[f]
+			% NUM_SAMPLES));
+		fail_unless(p->info.timestamp > 0);
+		p++;
+		for (i = 0; i < NUM_CHANNELS; i++, p++) {
+			fail_unless(p->type == SR_DF_ANALOG);
+			fail_unless(p->channel == &fake_channels[i],
+				"Channels sent out of order.");
+			for (j = 0; j < NUM_SAMPLES; j++)
+				fail_unless(p->data[j]
+					== sample_value(indices[f], i, j),
+					"Frame %" PRIu64 " has wrong data.",
+					indices[f]);
+		}
+		fail_unless(p->type == SR_DF_FRAME_END);
+		p++;
+	}
+}
+
+static void set_limit(struct sr_frame_ring *ring, uint64_t limit_frames)
+{
+	GVariant *data;
+	int ret;
+
+	data = g_variant_ref_sink(g_variant_new_uint64(limit_frames));
+	ret = sr_frame_ring_config_set(ring, SR_CONF_LIMIT_FRAMES, data);
+	fail_unless(ret == SR_OK, "Failed to set the frame limit: %d.", ret);
+	g_variant_unref(data);
+}
+
+static unsigned int ring_pending(struct sr_frame_ring *ring)
+{
+	unsigned int pending;
+
+	g_mutex_lock(&ring->mutex);
+	pending = ring->pending;
+	g_mutex_unlock(&ring->mutex);
+
+	return pending;
+}
+
+/* Wait until the producer thread filled the ring, or gave up. */
+static void wait_full(struct sr_frame_ring *ring)
+{
+	unsigned int i;
+
+	for (i = 0; i < 1000; i++) {
+		if (ring_pending(ring) == ring->num_frames)
+			return;
+		g_usleep(1000);
+	}
+	fail("The producer didn't fill the ring.");
+}
+
+/* Commit frames until sr_frame_ring_begin() refuses. */
+static gpointer producer(gpointer data)
+{
+	unsigned int num_frames;
+
+	for (num_frames = 0; frame_commit(data); num_frames++)
+		;
+
+	return GUINT_TO_POINTER(num_frames);
+}
+
+START_TEST(test_send)
+{
+	const uint64_t indices[] = { 0, 1, 2 };
+	struct sr_frame_ring ring;
+	struct sr_frame *frame;
+
+	ring_start(&ring, 4, FALSE);
+
+	/* A frame which isn't committed is reused. */
+	frame = sr_frame_ring_begin(&ring, &fake_sdi);
+	fail_unless(frame != NULL);
+	fail_unless(sr_frame_ring_begin(&ring, &fake_sdi) == frame);
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 0);
+	fail_unless(sent->len == 0, "Uncommitted frame was sent.");
+
+	/* Start counting from zero for the check below. */
+	fail_unless(sr_frame_ring_acquisition_start(&ring, 4, channels,
+		NUM_SAMPLES, sizeof(uint16_t), FALSE) == SR_OK);
+	fail_unless(frame_commit(&ring));
+	fail_unless(frame_commit(&ring));
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 2);
+	fail_unless(frame_commit(&ring));
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 1);
+	check_sent(indices, ARRAY_SIZE(indices));
+	fail_unless(ring.frames_sent == 3);
+	fail_unless(frames_dropped() == 0);
+
+	sr_frame_ring_acquisition_stop(&ring);
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+/* Frames are dropped while the ring is full, but keep their index. */
+START_TEST(test_drop)
+{
+	const uint64_t indices[] = { 0, 1, 3, 4 };
+	struct sr_frame_ring ring;
+
+	ring_start(&ring, 2, TRUE);
+
+	fail_unless(frame_commit(&ring));
+	fail_unless(frame_commit(&ring));
+	fail_unless(!frame_commit(&ring), "Frame not dropped.");
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 2);
+	fail_unless(frame_commit(&ring));
+	fail_unless(frame_commit(&ring));
+	fail_unless(!frame_commit(&ring), "Frame not dropped.");
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 2);
+
+	check_sent(indices, ARRAY_SIZE(indices));
+	fail_unless(ring.frames_dropped == 2,
+		"%" PRIu64 " frames dropped.", ring.frames_dropped);
+	fail_unless(frames_dropped() == 2, "Dropped frames not counted.");
+
+	sr_frame_ring_acquisition_stop(&ring);
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+/*
+ * Without dropping, a producer waits for the ring to have room, and
+ * all its frames are sent in order.
+ */
+START_TEST(test_backpressure)
+{
+	uint64_t indices[10];
+	struct sr_frame_ring ring;
+	GThread *thread;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(indices); i++)
+		indices[i] = i;
+
+	ring_start(&ring, 3, FALSE);
+	set_limit(&ring, ARRAY_SIZE(indices));
+	thread = g_thread_new("producer", producer, &ring);
+
+	while (!sr_frame_ring_limit_reached(&ring)) {
+		if (ring.frames_sent + ring.num_frames <= ARRAY_SIZE(indices)) {
+			wait_full(&ring);
+			/* The producer waits, rather than dropping frames. */
+			g_usleep(10000);
+			fail_unless(ring_pending(&ring) == ring.num_frames);
+		}
+		sr_frame_ring_send(&ring, &fake_sdi);
+	}
+	fail_unless(GPOINTER_TO_UINT(g_thread_join(thread))
+		== ARRAY_SIZE(indices));
+
+	check_sent(indices, ARRAY_SIZE(indices));
+	fail_unless(ring.frames_dropped == 0);
+	fail_unless(frames_dropped() == 0);
+
+	sr_frame_ring_acquisition_stop(&ring);
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+/* Stopping wakes up a waiting producer, and discards queued frames. */
+START_TEST(test_stop)
+{
+	struct sr_frame_ring ring;
+	GThread *thread;
+
+	ring_start(&ring, 2, FALSE);
+	thread = g_thread_new("producer", producer, &ring);
+	wait_full(&ring);
+	g_usleep(10000);
+
+	sr_frame_ring_acquisition_stop(&ring);
+	fail_unless(GPOINTER_TO_UINT(g_thread_join(thread)) == 2);
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 0);
+	fail_unless(sent->len == 0, "Frames sent after stopping.");
+	fail_unless(!frame_commit(&ring), "Frame started after stopping.");
+
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+/* The limit counts committed frames, and is reached once they're sent. */
+START_TEST(test_limit)
+{
+	const uint64_t indices[] = { 0, 1, 2 };
+	struct sr_frame_ring ring;
+	GVariant *data;
+
+	ring_start(&ring, 4, TRUE);
+	set_limit(&ring, 3);
+	fail_unless(sr_frame_ring_config_get(&ring, SR_CONF_LIMIT_FRAMES,
+		&data) == SR_OK);
+	fail_unless(g_variant_get_uint64(data) == 3);
+	g_variant_unref(g_variant_ref_sink(data));
+
+	fail_unless(frame_commit(&ring));
+	fail_unless(frame_commit(&ring));
+	fail_unless(frame_commit(&ring));
+	fail_unless(!frame_commit(&ring), "Frame beyond the limit.");
+	fail_unless(frames_dropped() == 0, "Frame beyond the limit dropped.");
+	fail_unless(!sr_frame_ring_limit_reached(&ring));
+	fail_unless(sr_frame_ring_send(&ring, &fake_sdi) == 3);
+	fail_unless(sr_frame_ring_limit_reached(&ring));
+	check_sent(indices, ARRAY_SIZE(indices));
+
+	sr_frame_ring_acquisition_stop(&ring);
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+/* Buffers are kept for the same layout, and replaced for another one. */
+START_TEST(test_restart)
+{
+	struct sr_frame_ring ring;
+	void *data;
+
+	ring_start(&ring, 2, FALSE);
+	data = ring.frames[0].channels[0].data;
+	fail_unless(frame_commit(&ring));
+	sr_frame_ring_acquisition_stop(&ring);
+
+	fail_unless(sr_frame_ring_acquisition_start(&ring, 2, channels,
+		NUM_SAMPLES, sizeof(uint16_t), FALSE) == SR_OK);
+	fail_unless(ring.frames[0].channels[0].data == data);
+	fail_unless(ring.pending == 0 && ring.frames_started == 0);
+	fail_unless(g_slist_length(ring.frames[1].channels[1].meaning.channels)
+		== 1, "Channel list not reset.");
+	sr_frame_ring_acquisition_stop(&ring);
+
+	fail_unless(sr_frame_ring_acquisition_start(&ring, 3, channels->next,
+		NUM_SAMPLES, sizeof(uint16_t), FALSE) == SR_OK);
+	fail_unless(ring.num_frames == 3 && ring.num_channels == 1);
+	fail_unless(ring.frames[0].channels[0].meaning.channels->data
+		== &fake_channels[1]);
+	sr_frame_ring_acquisition_stop(&ring);
+
+	fail_unless(sr_frame_ring_acquisition_start(&ring, 0, channels,
+		NUM_SAMPLES, sizeof(uint16_t), FALSE) == SR_ERR_ARG);
+	fail_unless(sr_frame_ring_acquisition_start(&ring, 2, NULL,
+		NUM_SAMPLES, sizeof(uint16_t), FALSE) == SR_ERR_ARG);
+
+	sr_frame_ring_clear(&ring);
+}
+END_TEST
+
+Suite *suite_frame_ring(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("frame_ring");
+
+	tc = tcase_create("send");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_send);
+	tcase_add_test(tc, test_limit);
+	tcase_add_test(tc, test_restart);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("full");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_drop);
+	tcase_add_test(tc, test_backpressure);
+	tcase_add_test(tc, test_stop);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
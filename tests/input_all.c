@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -34,6 +35,101 @@ START_TEST(test_input_available)
 }
 END_TEST
 
+static void datafeed_collect(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_logic *logic;
+
+	(void)sdi;
+
+	if (packet->type != SR_DF_LOGIC)
+		return;
+	logic = packet->payload;
+	g_byte_array_append(cb_data, logic->data, logic->length);
+}
+
+/* Feed the text to an input module, and return the logic data. */
+static GByteArray *parse_text(char *id, int threads, GString *text)
+{
+	struct sr_input *in;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	GHashTable *options;
+	GByteArray *samples;
+	GString *empty;
+	int ret;
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, g_strdup("threads"),
+			g_variant_ref_sink(g_variant_new_int32(threads)));
+	in = sr_input_new(sr_input_find(id), options);
+	g_hash_table_destroy(options);
+	fail_unless(in != NULL, "Failed to create %s input.", id);
+
+	ret = sr_input_send(in, text);
+	fail_unless(ret == SR_OK, "sr_input_send() error: %d", ret);
+	sdi = sr_input_dev_inst_get(in);
+	fail_unless(sdi != NULL, "Device instance not ready.");
+
+	samples = g_byte_array_new();
+	sr_session_new(srtest_ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_collect, samples);
+	sr_session_dev_add(session, sdi);
+
+	empty = g_string_new(NULL);
+	ret = sr_input_send(in, empty);
+	fail_unless(ret == SR_OK, "sr_input_send() error: %d", ret);
+	sr_input_end(in);
+	g_string_free(empty, TRUE);
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+
+	return samples;
+}
+
+static void check_parallel(char *id, GString *text)
+{
+	GByteArray *seq, *par;
+
+	seq = parse_text(id, 1, text);
+	par = parse_text(id, 4, text);
+	fail_unless(seq->len > 0, "No samples from %s input.", id);
+	fail_unless(seq->len == par->len && !memcmp(seq->data, par->data, seq->len),
+		"Parallel %s parsing differs from sequential parsing.", id);
+	g_byte_array_free(seq, TRUE);
+	g_byte_array_free(par, TRUE);
+}
+
+/* Check that parallel parsing yields the same data as sequential parsing. */
+START_TEST(test_input_parallel)
+{
+	GString *text;
+	unsigned int i;
+
+	text = g_string_new(NULL);
+	for (i = 0; i < 200000; i++)
+		g_string_append_printf(text, "%u,%u,%u\n",
+			i & 1, (i >> 3) & 1, (i % 7) == 0);
+	check_parallel("csv", text);
+	g_string_free(text, TRUE);
+
+	text = g_string_new("$timescale 1 ns $end\n"
+		"$var wire 1 ! a $end\n$var wire 1 \" b $end\n"
+		"$enddefinitions $end\n");
+	for (i = 0; i < 200000; i++) {
+		g_string_append_printf(text, "#%u\n%u!\n", i * 3, i & 1);
+		if (i % 5 == 0)
+			g_string_append_printf(text, "%u\"\n", (i >> 2) & 1);
+		if (i % 1000 == 0)
+			g_string_append(text, "$comment\n#1 1! $end\n");
+	}
+	check_parallel("vcd", text);
+	g_string_free(text, TRUE);
+}
+END_TEST
+
 Suite *suite_input_all(void)
 {
 	Suite *s;
@@ -45,5 +141,11 @@ Suite *suite_input_all(void)
 	tcase_add_test(tc, test_input_available);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("parallel");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_input_parallel);
+	tcase_set_timeout(tc, 60);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
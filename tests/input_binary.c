@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <check.h>
+#include <unistd.h>
 #include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -309,6 +310,111 @@ START_TEST(test_input_binary_hello_world)
 }
 END_TEST
 
+START_TEST(test_input_binary_load_file)
+{
+	int ret;
+	struct sr_input *in;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	char *filename;
+	gint fd;
+
+	fd = g_file_open_tmp("sr-input-binary-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	close(fd);
+	fail_unless(g_file_set_contents(filename, "Hello world", 11, NULL));
+
+	df_packet_counter = sample_counter = 0;
+	have_seen_df_end = FALSE;
+	check_to_perform = CHECK_HELLO_WORLD;
+	expected_samples = 11;
+	expected_samplerate = NULL;
+
+	in = sr_input_new(sr_input_find("binary"), NULL);
+	fail_unless(in != NULL, "Failed to create input instance.");
+
+	/* The first call only makes the device instance ready. */
+	ret = sr_input_load_file(in, filename);
+	fail_unless(ret == SR_OK, "sr_input_load_file() error: %d", ret);
+	sdi = sr_input_dev_inst_get(in);
+	fail_unless(sdi != NULL, "Device instance not ready.");
+	fail_unless(sample_counter == 0);
+
+	sr_session_new(srtest_ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+	sr_session_dev_add(session, sdi);
+
+	ret = sr_input_load_file(in, filename);
+	fail_unless(ret == SR_OK, "sr_input_load_file() error: %d", ret);
+	ret = sr_input_end(in);
+	fail_unless(ret == SR_OK, "sr_input_end() error: %d", ret);
+	fail_unless(have_seen_df_end, "No SR_DF_END packet was sent.");
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+	g_unlink(filename);
+	g_free(filename);
+}
+END_TEST
+
+/*
+ * A trailing partial unit at the end of a mapped file must neither get
+ * sent as a sample nor break the end of the input.
+ */
+START_TEST(test_input_binary_load_file_partial)
+{
+	int ret;
+	struct sr_input *in;
+	struct sr_session *session;
+	struct sr_dev_inst *sdi;
+	GHashTable *options;
+	char *filename;
+	gint fd;
+
+	fd = g_file_open_tmp("sr-input-binary-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	close(fd);
+	fail_unless(g_file_set_contents(filename, "Hello world", 11, NULL));
+
+	df_packet_counter = sample_counter = 0;
+	have_seen_df_end = FALSE;
+	check_to_perform = -1;
+	/* 16 channels, so the last of the 11 bytes is left over. */
+	expected_samples = 5;
+	expected_samplerate = NULL;
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, g_strdup("numchannels"),
+		g_variant_ref_sink(g_variant_new_int32(16)));
+	in = sr_input_new(sr_input_find("binary"), options);
+	fail_unless(in != NULL, "Failed to create input instance.");
+	g_hash_table_destroy(options);
+
+	ret = sr_input_load_file(in, filename);
+	fail_unless(ret == SR_OK, "sr_input_load_file() error: %d", ret);
+	sdi = sr_input_dev_inst_get(in);
+	fail_unless(sdi != NULL, "Device instance not ready.");
+
+	sr_session_new(srtest_ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+	sr_session_dev_add(session, sdi);
+
+	ret = sr_input_load_file(in, filename);
+	fail_unless(ret == SR_OK, "sr_input_load_file() error: %d", ret);
+	fail_unless(sample_counter == 5, "Got %" PRIu64 " samples.",
+		sample_counter);
+	ret = sr_input_end(in);
+	fail_unless(ret == SR_OK, "sr_input_end() error: %d", ret);
+	fail_unless(have_seen_df_end, "No SR_DF_END packet was sent.");
+
+	sr_input_free(in);
+	sr_session_destroy(session);
+	g_unlink(filename);
+	g_free(filename);
+}
+END_TEST
+
 Suite *suite_input_binary(void)
 {
 	Suite *s;
@@ -322,6 +428,8 @@ Suite *suite_input_binary(void)
 	tcase_add_test(tc, test_input_binary_all_high);
 	tcase_add_loop_test(tc, test_input_binary_all_high_loop, 1, 10);
 	tcase_add_test(tc, test_input_binary_hello_world);
+	tcase_add_test(tc, test_input_binary_load_file);
+	tcase_add_test(tc, test_input_binary_load_file_partial);
 	suite_add_tcase(s, tc);
 
 	return s;
@@ -54,5 +54,9 @@ Suite *suite_version(void);
 Suite *suite_device(void);
 Suite *suite_trigger(void);
 Suite *suite_analog(void);
+Suite *suite_serial_dmm(void);
+Suite *suite_device_usb(void);
+Suite *suite_frame_ring(void);
+Suite *suite_soft_trigger(void);
 
 #endif
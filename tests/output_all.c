@@ -20,7 +20,9 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
+#include <glib/gstdio.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
 
@@ -97,6 +99,888 @@ START_TEST(test_output_options)
 }
 END_TEST
 
+static GString *csv_send(const struct sr_output *o, int type,
+		const void *payload, GString *collect)
+{
+	struct sr_datafeed_packet packet;
+	GString *out;
+
+	packet.type = type;
+	packet.payload = payload;
+	out = NULL;
+	fail_unless(sr_output_send(o, &packet, &out) == SR_OK,
+		"Failed to send packet to CSV output.");
+	if (out) {
+		g_string_append_len(collect, out->str, out->len);
+		g_string_free(out, TRUE);
+	}
+
+	return collect;
+}
+
+static const struct sr_output *csv_new(const struct sr_dev_inst *sdi,
+		const char *value, gboolean trigger)
+{
+	const struct sr_output *o;
+	GHashTable *options;
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "value", g_variant_ref_sink(
+			g_variant_new_string(value)));
+	g_hash_table_insert(options, "header", g_variant_ref_sink(
+			g_variant_new_boolean(FALSE)));
+	g_hash_table_insert(options, "label", g_variant_ref_sink(
+			g_variant_new_string("channel")));
+	g_hash_table_insert(options, "time", g_variant_ref_sink(
+			g_variant_new_boolean(FALSE)));
+	g_hash_table_insert(options, "trigger", g_variant_ref_sink(
+			g_variant_new_boolean(trigger)));
+	o = sr_output_new(sr_output_find("csv"), options, sdi, NULL);
+	g_hash_table_destroy(options);
+	fail_unless(o != NULL, "Failed to create CSV output.");
+
+	return o;
+}
+
+/* Check the CSV output of logic and mixed logic/analog data. */
+START_TEST(test_output_csv)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_channel *ch;
+	const struct sr_output *o;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	GString *s;
+	GSList *l;
+	uint8_t logic_data[] = { 0x00, 0x05, 0x0b, 0x0f };
+	float analog_data[] = { 1.5, -0.25, 1234567, 0.000125 };
+	char name[8];
+	int i;
+
+	/* D0-D3, D2 disabled. */
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	for (i = 0; i < 4; i++) {
+		snprintf(name, sizeof(name), "D%d", i);
+		sr_dev_inst_channel_add(sdi, i, SR_CHANNEL_LOGIC, name);
+	}
+	ch = g_slist_nth_data(sr_dev_inst_channels_get(sdi), 2);
+	ch->enabled = FALSE;
+
+	logic.length = sizeof(logic_data);
+	logic.unitsize = 1;
+	logic.data = logic_data;
+
+	/* Logic only: rows are output for every packet. */
+	o = csv_new(sdi, "; ", FALSE);
+	s = csv_send(o, SR_DF_LOGIC, &logic, g_string_new(NULL));
+	fail_unless(!strcmp(s->str, "D0; D1; D3\n0; 0; 0\n1; 0; 0\n"
+		"1; 1; 1\n1; 1; 1\n"), "Unexpected logic CSV output: '%s'.",
+		s->str);
+	g_string_free(s, TRUE);
+	sr_output_free(o);
+
+	/* Mixed: rows are output once all channels were seen. */
+	sr_dev_inst_channel_add(sdi, 4, SR_CHANNEL_ANALOG, "A0");
+	memset(&encoding, 0, sizeof(encoding));
+	encoding.unitsize = sizeof(float);
+	encoding.is_signed = TRUE;
+	encoding.is_float = TRUE;
+	sr_rational_set(&encoding.scale, 1, 1);
+	sr_rational_set(&encoding.offset, 0, 1);
+	memset(&meaning, 0, sizeof(meaning));
+	meaning.mq = SR_MQ_VOLTAGE;
+	meaning.unit = SR_UNIT_VOLT;
+	for (l = sr_dev_inst_channels_get(sdi); l; l = l->next) {
+		ch = l->data;
+		if (ch->type == SR_CHANNEL_ANALOG)
+			meaning.channels = g_slist_append(NULL, ch);
+	}
+	analog.data = analog_data;
+	analog.num_samples = 4;
+	analog.encoding = &encoding;
+	analog.meaning = &meaning;
+	analog.spec = &spec;
+
+	o = csv_new(sdi, ",", TRUE);
+	s = csv_send(o, SR_DF_TRIGGER, NULL, g_string_new(NULL));
+	csv_send(o, SR_DF_LOGIC, &logic, s);
+	fail_unless(s->len == 0, "Unexpected output before analog data.");
+	csv_send(o, SR_DF_ANALOG, &analog, s);
+	fail_unless(!strcmp(s->str, "D0,D1,D3,A0,Trigger\n0,0,0,1.5,1\n"
+		"1,0,0,-0.25,0\n1,1,1,1.23457e+06,0\n1,1,1,0.000125,0\n"),
+		"Unexpected mixed CSV output: '%s'.", s->str);
+	g_string_free(s, TRUE);
+	sr_output_free(o);
+
+	g_slist_free(meaning.channels);
+}
+END_TEST
+
+static GString *text_output(const char *id, const struct sr_dev_inst *sdi,
+		uint8_t *data, int len)
+{
+	const struct sr_output *o;
+	struct sr_datafeed_logic logic;
+	GHashTable *options;
+	GString *s;
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "width", g_variant_ref_sink(
+			g_variant_new_uint32(8)));
+	o = sr_output_new(sr_output_find((char *)id), options, sdi, NULL);
+	g_hash_table_destroy(options);
+	fail_unless(o != NULL, "Failed to create '%s' output.", id);
+
+	logic.length = len;
+	logic.unitsize = 1;
+	logic.data = data;
+	s = csv_send(o, SR_DF_LOGIC, &logic, g_string_new(NULL));
+	csv_send(o, SR_DF_END, NULL, s);
+	sr_output_free(o);
+
+	return s;
+}
+
+/* Check the output of the bits, hex and ascii modules. */
+START_TEST(test_output_text)
+{
+	struct sr_dev_inst *sdi;
+	uint8_t data[] = { 1, 3, 2, 0, 1, 1, 3, 2, 0, 1 };
+	const char *expected[][2] = {
+		{ "bits", "D0:11001110\nD1:01100011\nD0:01\nD1:00\n" },
+		{ "hex", "D0:ce \nD1:63 \nD0:40 \nD1:00 \n" },
+		{ "ascii", "D0:\"\"\\./\"\"\\\nD1:./\"\\../\"\nD0:./\nD1:..\n" },
+	};
+	unsigned int i;
+	GString *s;
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	sr_dev_inst_channel_add(sdi, 0, SR_CHANNEL_LOGIC, "D0");
+	sr_dev_inst_channel_add(sdi, 1, SR_CHANNEL_LOGIC, "D1");
+
+	for (i = 0; i < ARRAY_SIZE(expected); i++) {
+		s = text_output(expected[i][0], sdi, data, sizeof(data));
+		/* Skip the header. */
+		fail_unless(strstr(s->str, "D0:") &&
+			!strcmp(strstr(s->str, "D0:"), expected[i][1]),
+			"Unexpected '%s' output: '%s'.", expected[i][0], s->str);
+		g_string_free(s, TRUE);
+	}
+}
+END_TEST
+
+static GString *raw_output(const char *id, const struct sr_dev_inst *sdi,
+		uint8_t *data, int len, gboolean packed)
+{
+	const struct sr_output *o;
+	struct sr_datafeed_header header;
+	struct sr_datafeed_meta meta;
+	struct sr_datafeed_logic logic;
+	struct sr_config src;
+	GString *s;
+
+	o = sr_output_new(sr_output_find((char *)id), NULL, sdi, NULL);
+	fail_unless(o != NULL, "Failed to create '%s' output.", id);
+
+	memset(&header, 0, sizeof(header));
+	s = csv_send(o, SR_DF_HEADER, &header, g_string_new(NULL));
+	if (packed) {
+		src.key = SR_CONF_LOGIC_PACKED;
+		src.data = g_variant_ref_sink(g_variant_new_boolean(TRUE));
+		meta.config = g_slist_append(NULL, &src);
+		csv_send(o, SR_DF_META, &meta, s);
+		g_slist_free(meta.config);
+		g_variant_unref(src.data);
+	}
+	logic.length = len;
+	logic.unitsize = 1;
+	logic.data = data;
+	csv_send(o, SR_DF_LOGIC, &logic, s);
+	csv_send(o, SR_DF_END, NULL, s);
+	sr_output_free(o);
+
+	return s;
+}
+
+/*
+ * Modules which write the samples as they are must write packed samples
+ * like the unpacked samples they came from.
+ */
+START_TEST(test_output_unpack)
+{
+	const char *ids[] = { "ols", "chronovu-la8" };
+	/* D0, D1 and D3, with D2 disabled. */
+	uint8_t unpacked[] = { 0x0b, 0x09, 0x00, 0x02 };
+	uint8_t packed[] = { 0x07, 0x05, 0x00, 0x02 };
+	struct sr_dev_inst *sdi;
+	struct sr_channel *ch;
+	GString *s, *expected;
+	unsigned int i;
+	char name[8];
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	for (i = 0; i < 4; i++) {
+		snprintf(name, sizeof(name), "D%d", i);
+		sr_dev_inst_channel_add(sdi, i, SR_CHANNEL_LOGIC, name);
+	}
+	ch = g_slist_nth_data(sr_dev_inst_channels_get(sdi), 2);
+	ch->enabled = FALSE;
+
+	for (i = 0; i < ARRAY_SIZE(ids); i++) {
+		expected = raw_output(ids[i], sdi, unpacked, sizeof(unpacked),
+			FALSE);
+		s = raw_output(ids[i], sdi, packed, sizeof(packed), TRUE);
+		fail_unless(expected->len > 0, "No '%s' output.", ids[i]);
+		fail_unless(s->len == expected->len
+			&& !memcmp(s->str, expected->str, s->len),
+			"Packed '%s' output differs.", ids[i]);
+		g_string_free(s, TRUE);
+		g_string_free(expected, TRUE);
+	}
+}
+END_TEST
+
+/* Check that the writer thread produces the same output as the module. */
+START_TEST(test_output_writer)
+{
+	struct sr_dev_inst *sdi;
+	const struct sr_output *o;
+	struct sr_output_writer *w;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	GHashTable *options;
+	GString *s;
+	char *dir, *filename, *contents;
+	uint8_t data[] = { 1, 3, 2, 0, 1, 1, 3, 2, 0, 1 };
+	const int flags[] = { 0, SR_OUTPUT_WRITER_DIRECT };
+	unsigned int i;
+	int ret;
+
+	dir = g_dir_make_tmp("sigrok-writer-XXXXXX", NULL);
+	fail_unless(dir != NULL, "Failed to create temporary directory.");
+	filename = g_build_filename(dir, "test.txt", NULL);
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	sr_dev_inst_channel_add(sdi, 0, SR_CHANNEL_LOGIC, "D0");
+	sr_dev_inst_channel_add(sdi, 1, SR_CHANNEL_LOGIC, "D1");
+	s = text_output("bits", sdi, data, sizeof(data));
+
+	logic.length = sizeof(data);
+	logic.unitsize = 1;
+	logic.data = data;
+
+	for (i = 0; i < ARRAY_SIZE(flags); i++) {
+		options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+				(GDestroyNotify)g_variant_unref);
+		g_hash_table_insert(options, "width", g_variant_ref_sink(
+				g_variant_new_uint32(8)));
+		o = sr_output_new(sr_output_find("bits"), options, sdi, NULL);
+		g_hash_table_destroy(options);
+		fail_unless(o != NULL, "Failed to create 'bits' output.");
+
+		/* A single queue slot, so the sender has to wait. */
+		w = sr_output_writer_new(o, filename, 1, flags[i]);
+		fail_unless(w != NULL, "Failed to create output writer.");
+		packet.type = SR_DF_LOGIC;
+		packet.payload = &logic;
+		ret = sr_output_writer_send(w, &packet);
+		fail_unless(ret == SR_OK, "Failed to send logic packet: %d.", ret);
+		packet.type = SR_DF_END;
+		packet.payload = NULL;
+		ret = sr_output_writer_send(w, &packet);
+		fail_unless(ret == SR_OK, "Failed to send end packet: %d.", ret);
+		ret = sr_output_writer_free(w);
+		fail_unless(ret == SR_OK, "Failed to free output writer: %d.", ret);
+		sr_output_free(o);
+
+		fail_unless(g_file_get_contents(filename, &contents, NULL, NULL),
+			"Failed to read back the output.");
+		/* Skip the header, which has the time of the acquisition. */
+		fail_unless(strstr(contents, "D0:") && !strcmp(
+			strstr(contents, "D0:"), strstr(s->str, "D0:")),
+			"Unexpected writer output: '%s'.", contents);
+		g_free(contents);
+	}
+	g_string_free(s, TRUE);
+
+	g_unlink(filename);
+	g_rmdir(dir);
+	g_free(filename);
+	g_free(dir);
+}
+END_TEST
+
+static void planar_check(const char *filename, const char *channel,
+		const uint8_t *expected, gsize len)
+{
+	char *path, *contents;
+	gsize size;
+
+	path = g_strdup_printf("%s.%s", filename, channel);
+	fail_unless(g_file_get_contents(path, &contents, &size, NULL),
+		"Failed to read back channel %s.", channel);
+	fail_unless(size == len && !memcmp(contents, expected, len),
+		"Unexpected data for channel %s.", channel);
+	g_unlink(path);
+	g_free(contents);
+	g_free(path);
+}
+
+/* Check that the binary output writes each channel to a file of its own. */
+START_TEST(test_output_binary_planar)
+{
+	struct sr_dev_inst *sdi;
+	const struct sr_output *o;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	GHashTable *options;
+	GString *s, *out;
+	GSList *l;
+	char *dir, *filename;
+	uint8_t data[] = { 1, 3, 2, 0, 1, 1, 3, 2, 0, 1 };
+	uint8_t samples[] = { 0, 64, 128, 192, 255, 1 };
+	const uint8_t d0[] = { 0xce, 0x40 }, d1[] = { 0x63, 0x00 };
+	const uint8_t a0[] = { 0, 128, 255 }, a1[] = { 64, 192, 1 };
+	int ret;
+
+	dir = g_dir_make_tmp("sigrok-binary-XXXXXX", NULL);
+	fail_unless(dir != NULL, "Failed to create temporary directory.");
+	filename = g_build_filename(dir, "test.bin", NULL);
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	sr_dev_inst_channel_add(sdi, 0, SR_CHANNEL_LOGIC, "D0");
+	sr_dev_inst_channel_add(sdi, 1, SR_CHANNEL_LOGIC, "D1");
+	sr_dev_inst_channel_add(sdi, 2, SR_CHANNEL_ANALOG, "A0");
+	sr_dev_inst_channel_add(sdi, 3, SR_CHANNEL_ANALOG, "A1");
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "planar", g_variant_ref_sink(
+			g_variant_new_boolean(TRUE)));
+	o = sr_output_new(sr_output_find("binary"), options, sdi, filename);
+	g_hash_table_destroy(options);
+	fail_unless(o != NULL, "Failed to create binary output.");
+
+	/* Samples split across packets, not at a byte boundary. */
+	logic.unitsize = 1;
+	logic.data = data;
+	logic.length = 3;
+	s = csv_send(o, SR_DF_LOGIC, &logic, g_string_new(NULL));
+	logic.data = data + 3;
+	logic.length = sizeof(data) - 3;
+	csv_send(o, SR_DF_LOGIC, &logic, s);
+
+	/* Interleaved samples of both analog channels. */
+	memset(&encoding, 0, sizeof(encoding));
+	encoding.unitsize = 1;
+	sr_rational_set(&encoding.scale, 1, 1);
+	sr_rational_set(&encoding.offset, 0, 1);
+	memset(&meaning, 0, sizeof(meaning));
+	meaning.mq = SR_MQ_VOLTAGE;
+	meaning.unit = SR_UNIT_VOLT;
+	for (l = sr_dev_inst_channels_get(sdi); l; l = l->next) {
+		if (((struct sr_channel *)l->data)->type == SR_CHANNEL_ANALOG)
+			meaning.channels = g_slist_append(meaning.channels, l->data);
+	}
+	memset(&spec, 0, sizeof(spec));
+	memset(&analog, 0, sizeof(analog));
+	analog.data = samples;
+	analog.num_samples = 3;
+	analog.encoding = &encoding;
+	analog.meaning = &meaning;
+	analog.spec = &spec;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	out = NULL;
+	ret = sr_output_send(o, &packet, &out);
+	fail_unless(ret == SR_OK, "Failed to send analog packet: %d.", ret);
+	g_slist_free(meaning.channels);
+
+	csv_send(o, SR_DF_END, NULL, s);
+	fail_unless(s->len == 0 && !out, "Unexpected output in planar mode.");
+	g_string_free(s, TRUE);
+	sr_output_free(o);
+
+	planar_check(filename, "D0", d0, sizeof(d0));
+	planar_check(filename, "D1", d1, sizeof(d1));
+	planar_check(filename, "A0", a0, sizeof(a0));
+	planar_check(filename, "A1", a1, sizeof(a1));
+
+	g_rmdir(dir);
+	g_free(filename);
+	g_free(dir);
+}
+END_TEST
+
+/*
+ * A reader of the Thrift compact protocol, enough to walk the Parquet
+ * metadata. A reader is positioned at the fields of a struct, and looked
+ * up fields are searched from there.
+ */
+struct thrift_reader {
+	const uint8_t *p;
+	const uint8_t *end;
+};
+
+#define T_BOOL_TRUE 1
+#define T_BOOL_FALSE 2
+#define T_BYTE 3
+#define T_DOUBLE 7
+#define T_I32 5
+#define T_I64 6
+#define T_BINARY 8
+#define T_LIST 9
+#define T_STRUCT 12
+
+static uint64_t thrift_varint(struct thrift_reader *r)
+{
+	uint64_t v;
+	unsigned int shift;
+
+	v = 0;
+	for (shift = 0; shift < 64; shift += 7) {
+		fail_unless(r->p < r->end, "Thrift data truncated.");
+		v |= (uint64_t)(*r->p & 0x7f) << shift;
+		if (!(*r->p++ & 0x80))
+			return v;
+	}
+	fail("Thrift varint too long.");
+
+	return 0;
+}
+
+static int64_t thrift_int(struct thrift_reader *r)
+{
+	uint64_t v;
+
+	v = thrift_varint(r);
+
+	return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static unsigned int thrift_list(struct thrift_reader *r, int *type)
+{
+	unsigned int n;
+
+	fail_unless(r->p < r->end, "Thrift data truncated.");
+	*type = *r->p & 0x0f;
+	n = *r->p++ >> 4;
+	if (n == 15)
+		n = thrift_varint(r);
+
+	return n;
+}
+
+static void thrift_skip(struct thrift_reader *r, int type)
+{
+	unsigned int n, i;
+	int t;
+
+	switch (type) {
+	case T_BOOL_TRUE:
+	case T_BOOL_FALSE:
+		break;
+	case T_BYTE:
+		r->p++;
+		break;
+	case T_DOUBLE:
+		r->p += 8;
+		break;
+	case T_I32:
+	case T_I64:
+		thrift_varint(r);
+		break;
+	case T_BINARY:
+		n = thrift_varint(r);
+		r->p += n;
+		break;
+	case T_LIST:
+		n = thrift_list(r, &t);
+		for (i = 0; i < n; i++)
+			thrift_skip(r, t == T_BOOL_TRUE ? T_BYTE : t);
+		break;
+	case T_STRUCT:
+		while (r->p < r->end && *r->p) {
+			t = *r->p & 0x0f;
+			if (!(*r->p++ >> 4))
+				thrift_int(r);
+			thrift_skip(r, t);
+		}
+		r->p++;
+		break;
+	default:
+		fail("Unknown Thrift type %d.", type);
+	}
+	fail_unless(r->p <= r->end, "Thrift data truncated.");
+}
+
+/* The value of a field of the struct, which must have the given type. */
+static struct thrift_reader thrift_field(struct thrift_reader r,
+		int16_t id, int type)
+{
+	int16_t cur;
+	int t;
+
+	cur = 0;
+	while (r.p < r.end && *r.p) {
+		t = *r.p & 0x0f;
+		if (*r.p++ >> 4)
+			cur += r.p[-1] >> 4;
+		else
+			cur = thrift_int(&r);
+		if (cur == id) {
+			fail_unless(t == type, "Thrift field %d has type %d.",
+				id, t);
+			return r;
+		}
+		thrift_skip(&r, t);
+	}
+	fail("Thrift field %d not found.", id);
+
+	return r;
+}
+
+static int64_t thrift_field_int(struct thrift_reader r, int16_t id, int type)
+{
+	r = thrift_field(r, id, type);
+
+	return thrift_int(&r);
+}
+
+/* The n-th element of a list field of structs. */
+static struct thrift_reader thrift_element(struct thrift_reader r,
+		int16_t id, unsigned int index, unsigned int *n)
+{
+	unsigned int i;
+	int type;
+
+	r = thrift_field(r, id, T_LIST);
+	*n = thrift_list(&r, &type);
+	fail_unless(type == T_STRUCT, "Thrift list of type %d.", type);
+	fail_unless(index < *n, "Thrift list of %u elements.", *n);
+	for (i = 0; i < index; i++)
+		thrift_skip(&r, T_STRUCT);
+
+	return r;
+}
+
+static uint32_t parquet_u32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* Data pages expected in the Parquet output. */
+static const struct {
+	unsigned int group;
+	unsigned int column;
+	unsigned int num_rows;
+	/* Definition levels, then the RLE/bit-packed or plain values. */
+	const char *levels;
+	unsigned int levels_len;
+	const char *values;
+	unsigned int values_len;
+} parquet_pages[] = {
+	/* 1011 0010 is bit packed, then a run of 8 values of 1. */
+	{ 0, 0, 16, "\x20\x01", 2, "\x03\x4d\x10\x01", 4 },
+	/* A run of 12 values of 0, then 1011 is bit packed. */
+	{ 0, 1, 16, "\x20\x01", 2, "\x18\x00\x03\x0d", 4 },
+	{ 1, 0, 4, "\x08\x01", 2, "\x03\x00", 2 },
+	{ 1, 1, 4, "\x08\x01", 2, "\x03\x0f", 2 },
+	/* The analog channel is short of 2 samples, padded with nulls. */
+	{ 1, 2, 4, "\x04\x01\x04\x00", 4, NULL, 8 },
+};
+
+/* Check the Parquet output, decoding its metadata and data pages. */
+START_TEST(test_output_parquet)
+{
+	struct sr_dev_inst *sdi;
+	const struct sr_output *o;
+	struct sr_datafeed_logic logic;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct thrift_reader footer, r, group, column, meta, page;
+	GHashTable *options;
+	GString *s;
+	const char *names[] = { "D0", "D1", "A0" };
+	const int types[] = { 0, 0, 4 };
+	const uint64_t group_rows[] = { 16, 4 };
+	uint8_t data[] = {
+		1, 0, 1, 1, 0, 0, 1, 0, 1, 1, 1, 1, 3, 1, 3, 3, 2, 2, 2, 2,
+	};
+	float values[18], x;
+	const uint8_t *p;
+	uint64_t offset;
+	uint32_t len, u;
+	unsigned int n, i, j;
+
+	for (i = 0; i < ARRAY_SIZE(values); i++)
+		values[i] = i;
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	sr_dev_inst_channel_add(sdi, 0, SR_CHANNEL_LOGIC, "D0");
+	sr_dev_inst_channel_add(sdi, 1, SR_CHANNEL_LOGIC, "D1");
+	sr_dev_inst_channel_add(sdi, 2, SR_CHANNEL_ANALOG, "A0");
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "rows", g_variant_ref_sink(
+			g_variant_new_uint64(16)));
+	o = sr_output_new(sr_output_find("parquet"), options, sdi, NULL);
+	g_hash_table_destroy(options);
+	fail_unless(o != NULL, "Failed to create Parquet output.");
+
+	logic.length = sizeof(data);
+	logic.unitsize = 1;
+	logic.data = data;
+	s = csv_send(o, SR_DF_LOGIC, &logic, g_string_new(NULL));
+
+	memset(&encoding, 0, sizeof(encoding));
+	encoding.unitsize = sizeof(float);
+	encoding.is_float = TRUE;
+	encoding.is_signed = TRUE;
+#ifdef WORDS_BIGENDIAN
+	encoding.is_bigendian = TRUE;
+#endif
+	sr_rational_set(&encoding.scale, 1, 1);
+	sr_rational_set(&encoding.offset, 0, 1);
+	memset(&meaning, 0, sizeof(meaning));
+	meaning.mq = SR_MQ_VOLTAGE;
+	meaning.unit = SR_UNIT_VOLT;
+	meaning.channels = g_slist_append(NULL,
+		g_slist_nth_data(sr_dev_inst_channels_get(sdi), 2));
+	memset(&spec, 0, sizeof(spec));
+	memset(&analog, 0, sizeof(analog));
+	analog.data = values;
+	analog.num_samples = ARRAY_SIZE(values);
+	analog.encoding = &encoding;
+	analog.meaning = &meaning;
+	analog.spec = &spec;
+	csv_send(o, SR_DF_ANALOG, &analog, s);
+	g_slist_free(meaning.channels);
+
+	/* One row group of 16 rows is complete. */
+	fail_unless(s->len > 4 && !memcmp(s->str, "PAR1", 4),
+		"Row groups not written while receiving samples.");
+
+	csv_send(o, SR_DF_END, NULL, s);
+	sr_output_free(o);
+
+	/* The file metadata is followed by its length and the magic. */
+	fail_unless(s->len > 12 && !memcmp(s->str + s->len - 4, "PAR1", 4),
+		"Missing Parquet footer.");
+	p = (const uint8_t *)s->str + s->len - 8;
+	len = parquet_u32(p);
+	fail_unless(len > 0 && len + 12 <= s->len,
+		"Invalid Parquet metadata length %u.", len);
+	footer.p = p - len;
+	footer.end = p;
+	r = footer;
+	thrift_skip(&r, T_STRUCT);
+	fail_unless(r.p == footer.end, "Parquet metadata of the wrong size.");
+
+	/* A root schema element, and one for each column. */
+	fail_unless(thrift_field_int(footer, 1, T_I32) == 1);
+	r = thrift_element(footer, 2, 0, &n);
+	fail_unless(n == 4, "%u schema elements.", n);
+	fail_unless(thrift_field_int(r, 5, T_I32) == 3,
+		"Wrong number of columns.");
+	for (i = 0; i < 3; i++) {
+		r = thrift_element(footer, 2, i + 1, &n);
+		fail_unless(thrift_field_int(r, 1, T_I32) == types[i]);
+		fail_unless(thrift_field_int(r, 3, T_I32) == 1,
+			"Column %u isn't optional.", i);
+		r = thrift_field(r, 4, T_BINARY);
+		fail_unless(thrift_varint(&r) == 2 && !memcmp(r.p, names[i], 2),
+			"Wrong name of column %u.", i);
+	}
+	fail_unless(thrift_field_int(footer, 3, T_I64) == 20);
+
+	for (i = 0; i < ARRAY_SIZE(group_rows); i++) {
+		group = thrift_element(footer, 4, i, &n);
+		fail_unless(n == ARRAY_SIZE(group_rows), "%u row groups.", n);
+		fail_unless(thrift_field_int(group, 3, T_I64)
+			== (int64_t)group_rows[i], "Wrong rows in row group %u.", i);
+		thrift_element(group, 1, 0, &n);
+		fail_unless(n == 3, "%u columns in row group %u.", n, i);
+	}
+
+	/* The padded column counts its nulls. */
+	column = thrift_element(thrift_element(footer, 4, 1, &n), 1, 2, &n);
+	meta = thrift_field(column, 3, T_STRUCT);
+	fail_unless(thrift_field_int(meta, 5, T_I64) == 4);
+	fail_unless(thrift_field_int(thrift_field(meta, 12, T_STRUCT),
+		3, T_I64) == 2, "Wrong null count.");
+
+	for (i = 0; i < ARRAY_SIZE(parquet_pages); i++) {
+		group = thrift_element(footer, 4, parquet_pages[i].group, &n);
+		column = thrift_element(group, 1, parquet_pages[i].column, &n);
+		meta = thrift_field(column, 3, T_STRUCT);
+		offset = thrift_field_int(meta, 9, T_I64);
+		fail_unless(offset == (uint64_t)thrift_field_int(column, 2, T_I64));
+		fail_unless(offset < s->len, "Page beyond the end of the file.");
+
+		page.p = (const uint8_t *)s->str + offset;
+		page.end = footer.p;
+		fail_unless(thrift_field_int(page, 1, T_I32) == 0,
+			"Page %u isn't a data page.", i);
+		len = thrift_field_int(page, 3, T_I32);
+		fail_unless(thrift_field_int(thrift_field(page, 5, T_STRUCT),
+			1, T_I32) == parquet_pages[i].num_rows);
+		thrift_skip(&page, T_STRUCT);
+		p = page.p;
+		fail_unless(len == 4 + parquet_pages[i].levels_len
+			+ (parquet_pages[i].values ? 4 : 0)
+			+ parquet_pages[i].values_len,
+			"Page %u has %u bytes.", i, len);
+
+		fail_unless(parquet_u32(p) == parquet_pages[i].levels_len
+			&& !memcmp(p + 4, parquet_pages[i].levels,
+			parquet_pages[i].levels_len),
+			"Wrong definition levels in page %u.", i);
+		p += 4 + parquet_pages[i].levels_len;
+
+		if (parquet_pages[i].values) {
+			fail_unless(parquet_u32(p) == parquet_pages[i].values_len
+				&& !memcmp(p + 4, parquet_pages[i].values,
+				parquet_pages[i].values_len),
+				"Wrong values in page %u.", i);
+		} else {
+			/* The last samples, after a row group of 16. */
+			for (j = 0; j < parquet_pages[i].values_len / 4; j++) {
+				u = parquet_u32(p + 4 * j);
+				memcpy(&x, &u, sizeof(x));
+				fail_unless(x == 16 + j, "Wrong value %f in "
+					"page %u.", x, i);
+			}
+		}
+	}
+
+	g_string_free(s, TRUE);
+}
+END_TEST
+
+struct srzip_readback {
+	float values[2][3];
+	unsigned int num_samples[2];
+	gboolean native;
+};
+
+static void srzip_datafeed(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_analog *analog;
+	struct srzip_readback *rb;
+	struct sr_channel *ch;
+	unsigned int i;
+
+	(void)sdi;
+
+	if (packet->type != SR_DF_ANALOG)
+		return;
+
+	rb = cb_data;
+	analog = packet->payload;
+	ch = analog->meaning->channels->data;
+	i = ch->name[1] - '0';
+	fail_unless(i < 2 && analog->num_samples + rb->num_samples[i] <= 3,
+		"Unexpected analog packet.");
+	rb->native = analog->encoding->unitsize == 1
+		&& !analog->encoding->is_float;
+	sr_analog_to_float(analog, rb->values[i] + rb->num_samples[i]);
+	rb->num_samples[i] += analog->num_samples;
+}
+
+/* Check that srzip keeps integer samples of multi-channel packets. */
+START_TEST(test_output_srzip_analog)
+{
+	struct sr_dev_inst *sdi;
+	struct sr_session *session;
+	const struct sr_output *o;
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct srzip_readback rb;
+	GString *out;
+	char *dir, *filename;
+	uint8_t data[] = { 0, 64, 128, 192, 255, 1 };
+	const float expected[2][3] = {
+		{ -10, 0, 9.921875 },
+		{ -5, 5, -9.921875 },
+	};
+	unsigned int i, j;
+	int ret;
+
+	dir = g_dir_make_tmp("sigrok-srzip-XXXXXX", NULL);
+	fail_unless(dir != NULL, "Failed to create temporary directory.");
+	filename = g_build_filename(dir, "test.sr", NULL);
+
+	sdi = sr_dev_inst_user_new("sigrok", "Test", NULL);
+	sr_dev_inst_channel_add(sdi, 0, SR_CHANNEL_ANALOG, "A0");
+	sr_dev_inst_channel_add(sdi, 1, SR_CHANNEL_ANALOG, "A1");
+
+	memset(&encoding, 0, sizeof(encoding));
+	encoding.unitsize = 1;
+	encoding.digits = 3;
+	sr_rational_set(&encoding.scale, 5, 64);
+	sr_rational_set(&encoding.offset, -10, 1);
+	memset(&meaning, 0, sizeof(meaning));
+	meaning.mq = SR_MQ_VOLTAGE;
+	meaning.unit = SR_UNIT_VOLT;
+	meaning.channels = g_slist_copy(sr_dev_inst_channels_get(sdi));
+	memset(&spec, 0, sizeof(spec));
+	memset(&analog, 0, sizeof(analog));
+	analog.data = data;
+	analog.num_samples = 3;
+	analog.encoding = &encoding;
+	analog.meaning = &meaning;
+	analog.spec = &spec;
+
+	o = sr_output_new(sr_output_find("srzip"), NULL, sdi, filename);
+	fail_unless(o != NULL, "Failed to create srzip output.");
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	ret = sr_output_send(o, &packet, &out);
+	fail_unless(ret == SR_OK, "Failed to send analog packet: %d.", ret);
+	sr_output_free(o);
+	g_slist_free(meaning.channels);
+
+	ret = sr_session_load(srtest_ctx, filename, &session);
+	fail_unless(ret == SR_OK, "Failed to load session file: %d.", ret);
+	memset(&rb, 0, sizeof(rb));
+	sr_session_datafeed_callback_add(session, srzip_datafeed, &rb);
+	sr_session_start(session);
+	sr_session_run(session);
+	sr_session_destroy(session);
+
+	fail_unless(rb.native, "Samples not sent in their native encoding.");
+	for (i = 0; i < 2; i++) {
+		fail_unless(rb.num_samples[i] == 3, "Channel A%u: %u samples.",
+			i, rb.num_samples[i]);
+		for (j = 0; j < 3; j++)
+			fail_unless(rb.values[i][j] == expected[i][j],
+				"Channel A%u sample %u: %f.", i, j, rb.values[i][j]);
+	}
+
+	g_unlink(filename);
+	g_rmdir(dir);
+	g_free(filename);
+	g_free(dir);
+}
+END_TEST
+
 Suite *suite_output_all(void)
 {
 	Suite *s;
@@ -111,6 +995,17 @@ Suite *suite_output_all(void)
 	tcase_add_test(tc, test_output_desc);
 	tcase_add_test(tc, test_output_find);
 	tcase_add_test(tc, test_output_options);
+	tcase_add_test(tc, test_output_csv);
+	tcase_add_test(tc, test_output_text);
+	tcase_add_test(tc, test_output_unpack);
+	tcase_add_test(tc, test_output_writer);
+	tcase_add_test(tc, test_output_binary_planar);
+	tcase_add_test(tc, test_output_parquet);
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("srzip");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_output_srzip_analog);
 	suite_add_tcase(s, tc);
 
 	return s;
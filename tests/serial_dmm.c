@@ -0,0 +1,724 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "lib.h"
+
+#if defined(__GLIBC__) && defined(HAVE_LIBSERIALPORT) && defined(HAVE_HW_SERIAL_DMM)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <libserialport.h>
+
+#define NUM_PACKETS 40
+
+/*
+ * A fake serial port. The library's libserialport calls end up here,
+ * since tests/transport links these in place of libserialport's. Data
+ * fed to the port is passed through a pipe, so the session can poll it,
+ * and is returned in reads of varying sizes.
+ */
+struct sp_port {
+	int fds[2];
+};
+
+struct sp_port_config {
+	int unused;
+};
+
+/* The open port, or NULL. */
+static struct sp_port *fake_port;
+/* Data fed while the port isn't open yet. */
+static GByteArray *fake_pending;
+static size_t fake_bytes_read;
+static unsigned int fake_num_reads;
+
+/* Split the data into reads of these sizes, in turn. */
+static const size_t fake_read_sizes[] = { 1, 7, 3, 16, 2, 29, 5, 64, 11 };
+
+static void fake_write(const uint8_t *data, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = write(fake_port->fds[1], data, len);
+		fail_unless(ret > 0, "Failed to write to the fake port.");
+		data += ret;
+		len -= ret;
+	}
+}
+
+static void fake_feed(const uint8_t *data, size_t len)
+{
+	if (fake_port)
+		fake_write(data, len);
+	else
+		g_byte_array_append(fake_pending, data, len);
+}
+
+static void fake_reset(void)
+{
+	if (fake_pending)
+		g_byte_array_free(fake_pending, TRUE);
+	fake_pending = g_byte_array_new();
+	fake_bytes_read = 0;
+	fake_num_reads = 0;
+}
+
+enum sp_return sp_get_port_by_name(const char *portname,
+		struct sp_port **port_ptr)
+{
+	(void)portname;
+
+	*port_ptr = g_malloc0(sizeof(struct sp_port));
+	(*port_ptr)->fds[0] = (*port_ptr)->fds[1] = -1;
+
+	return SP_OK;
+}
+
+void sp_free_port(struct sp_port *port)
+{
+	g_free(port);
+}
+
+enum sp_return sp_open(struct sp_port *port, enum sp_mode flags)
+{
+	(void)flags;
+
+	if (pipe(port->fds) < 0)
+		return SP_ERR_FAIL;
+	fcntl(port->fds[0], F_SETFL, O_NONBLOCK);
+	fake_port = port;
+	fake_write(fake_pending->data, fake_pending->len);
+	g_byte_array_set_size(fake_pending, 0);
+
+	return SP_OK;
+}
+
+enum sp_return sp_close(struct sp_port *port)
+{
+	close(port->fds[0]);
+	close(port->fds[1]);
+	if (fake_port == port)
+		fake_port = NULL;
+
+	return SP_OK;
+}
+
+enum sp_return sp_new_config(struct sp_port_config **config_ptr)
+{
+	*config_ptr = g_malloc0(sizeof(struct sp_port_config));
+
+	return SP_OK;
+}
+
+void sp_free_config(struct sp_port_config *config)
+{
+	g_free(config);
+}
+
+enum sp_return sp_set_config(struct sp_port *port,
+		const struct sp_port_config *config)
+{
+	(void)port;
+	(void)config;
+
+	return SP_OK;
+}
+
+#define FAKE_CONFIG_SET(name, type) \
+	enum sp_return sp_set_config_##name(struct sp_port_config *config, \
+			type value) \
+	{ \
+		(void)config; \
+		(void)value; \
+		return SP_OK; \
+	}
+
+FAKE_CONFIG_SET(baudrate, int)
+FAKE_CONFIG_SET(bits, int)
+FAKE_CONFIG_SET(parity, enum sp_parity)
+FAKE_CONFIG_SET(stopbits, int)
+FAKE_CONFIG_SET(rts, enum sp_rts)
+FAKE_CONFIG_SET(cts, enum sp_cts)
+FAKE_CONFIG_SET(dtr, enum sp_dtr)
+FAKE_CONFIG_SET(dsr, enum sp_dsr)
+FAKE_CONFIG_SET(xon_xoff, enum sp_xonxoff)
+
+/* The test only feeds data once the port is set up, keep it. */
+enum sp_return sp_flush(struct sp_port *port, enum sp_buffer buffers)
+{
+	(void)port;
+	(void)buffers;
+
+	return SP_OK;
+}
+
+enum sp_return sp_nonblocking_read(struct sp_port *port, void *buf,
+		size_t count)
+{
+	ssize_t ret;
+
+	count = MIN(count, fake_read_sizes[fake_num_reads++
+			% ARRAY_SIZE(fake_read_sizes)]);
+	if ((ret = read(port->fds[0], buf, count)) < 0)
+		return (errno == EAGAIN) ? 0 : SP_ERR_FAIL;
+	fake_bytes_read += ret;
+
+	return ret;
+}
+
+/* Packet requests are ignored, the data is there anyway. */
+enum sp_return sp_nonblocking_write(struct sp_port *port, const void *buf,
+		size_t count)
+{
+	(void)port;
+	(void)buf;
+
+	return count;
+}
+
+enum sp_return sp_new_event_set(struct sp_event_set **result_ptr)
+{
+	*result_ptr = g_malloc0(sizeof(struct sp_event_set));
+
+	return SP_OK;
+}
+
+enum sp_return sp_add_port_events(struct sp_event_set *event_set,
+		const struct sp_port *port, enum sp_event mask)
+{
+	event_set->handles = g_malloc(sizeof(int));
+	event_set->masks = g_malloc(sizeof(enum sp_event));
+	((int *)event_set->handles)[0] = port->fds[0];
+	event_set->masks[0] = mask;
+	event_set->count = 1;
+
+	return SP_OK;
+}
+
+void sp_free_event_set(struct sp_event_set *event_set)
+{
+	g_free(event_set->handles);
+	g_free(event_set->masks);
+	g_free(event_set);
+}
+
+/* FS9721: 14 bytes of LCD segments, value in DC mV. */
+static void fs9721_packet(uint8_t *buf, int value)
+{
+	static const uint8_t segments[] = {
+		0x7d, 0x05, 0x5b, 0x1f, 0x27, 0x3e, 0x7e, 0x15, 0x7f, 0x3f,
+	};
+	int i, digit;
+
+	buf[0] = 0x15; /* DC, RS232 */
+	for (i = 0; i < 4; i++) {
+		digit = segments[value / (int)pow(10, 3 - i) % 10];
+		buf[1 + 2 * i] = ((2 + 2 * i) << 4) | (digit >> 4);
+		buf[2 + 2 * i] = ((3 + 2 * i) << 4) | (digit & 0x0f);
+	}
+	buf[3] |= 0x08; /* Decimal point after the first digit. */
+	buf[9] = 0xa0;
+	buf[10] = 0xb0;
+	buf[11] = 0xc0;
+	buf[12] = 0xd4; /* Volt */
+	buf[13] = 0xe0;
+}
+
+/* ES519xx, 2400 baud: 11 bytes sent twice, value in DC 100 uV. */
+static void es519xx_packet(uint8_t *buf, int value)
+{
+	char s[12];
+
+	g_snprintf(s, sizeof(s), "0%04d\x3b\x30\x30\x38\r\n", value);
+	memcpy(buf, s, 11);
+	memcpy(buf + 11, s, 11);
+}
+
+/* Metex: a line of text, value in DC mV. */
+static void metex14_packet(uint8_t *buf, int value)
+{
+	char s[15];
+
+	g_snprintf(s, sizeof(s), "DC%7.3f   V\r", value / 1000.0);
+	memcpy(buf, s, 14);
+}
+
+static const struct {
+	const char *driver;
+	size_t packet_size;
+	void (*packet)(uint8_t *buf, int value);
+	double scale;
+} dmms[] = {
+	{ "tekpower-tp4000ZC", 14, fs9721_packet, 1e-3 },
+	{ "iso-tech-idm103n", 22, es519xx_packet, 1e-4 },
+	{ "mastech-mas345", 14, metex14_packet, 1e-3 },
+};
+
+/*
+ * Bytes between packets. They contain sync bytes and line feeds, so they
+ * produce packet candidates which fail validation. There is no CR, as
+ * the Metex validation accepts anything which ends in one.
+ */
+static const uint8_t garbage[] = {
+	0x00, '\n', 0x15, 0xff, 0x1d, '\n', 0x10, 0x2f, 0x3b, 0x80, 0x1e,
+};
+
+/* Garbage, including the start of a packet cut short. */
+static size_t garbage_append(GByteArray *stream, unsigned int dmm,
+		unsigned int i)
+{
+	uint8_t packet[32];
+	size_t partial, len;
+
+	dmms[dmm].packet(packet, 1111);
+	partial = i % dmms[dmm].packet_size;
+	len = i % (sizeof(garbage) + 1);
+	g_byte_array_append(stream, garbage, len);
+	g_byte_array_append(stream, packet, partial);
+
+	return len + partial;
+}
+
+static int packet_value(unsigned int i)
+{
+	return 1000 + 37 * i;
+}
+
+/* What the session received. */
+static struct {
+	/* All sample values, in order. */
+	GArray *values;
+	/* Number of samples in each analog packet. */
+	GArray *sizes;
+	/* Time [µs] each analog packet arrived, since the session start. */
+	GArray *arrivals;
+	int64_t start_time;
+	/* Timestamps announced for the next analog packet. */
+	GVariant *timestamps;
+	unsigned int num_timestamped;
+	int64_t last_timestamp;
+	gboolean have_seen_df_end;
+} feed;
+
+static void feed_meta(const struct sr_datafeed_meta *meta)
+{
+	const struct sr_config *src;
+	GSList *l;
+
+	for (l = meta->config; l; l = l->next) {
+		src = l->data;
+		if (src->key != SR_CONF_ANALOG_TIMESTAMPS)
+			continue;
+		fail_unless(feed.timestamps == NULL,
+			"Timestamps without samples.");
+		feed.timestamps = g_variant_ref(src->data);
+	}
+}
+
+static void feed_analog(const struct sr_datafeed_analog *analog)
+{
+	const int64_t *timestamps;
+	gsize i, num_timestamps;
+	int64_t arrival;
+	float *values;
+
+	fail_unless(!feed.have_seen_df_end, "Samples after SR_DF_END.");
+
+	values = g_malloc(sizeof(float) * analog->num_samples);
+	fail_unless(sr_analog_to_float(analog, values) == SR_OK);
+	g_array_append_vals(feed.values, values, analog->num_samples);
+	g_free(values);
+	g_array_append_val(feed.sizes, analog->num_samples);
+	arrival = g_get_monotonic_time() - feed.start_time;
+	g_array_append_val(feed.arrivals, arrival);
+
+	if (!feed.timestamps)
+		return;
+	timestamps = g_variant_get_fixed_array(feed.timestamps,
+		&num_timestamps, sizeof(int64_t));
+	fail_unless(num_timestamps == analog->num_samples,
+		"Got %" G_GSIZE_FORMAT " timestamps for %u samples.",
+		num_timestamps, analog->num_samples);
+	for (i = 0; i < num_timestamps; i++) {
+		fail_unless(timestamps[i] >= feed.last_timestamp,
+			"Timestamps out of order.");
+		feed.last_timestamp = timestamps[i];
+	}
+	feed.num_timestamped++;
+	g_variant_unref(feed.timestamps);
+	feed.timestamps = NULL;
+}
+
+static void datafeed_in(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	(void)sdi;
+	(void)cb_data;
+
+	switch (packet->type) {
+	case SR_DF_META:
+		feed_meta(packet->payload);
+		break;
+	case SR_DF_ANALOG:
+		feed_analog(packet->payload);
+		break;
+	case SR_DF_END:
+		feed.have_seen_df_end = TRUE;
+		break;
+	default:
+		break;
+	}
+}
+
+static struct sr_dev_inst *dmm_scan(struct sr_dev_driver *driver)
+{
+	struct sr_config conn;
+	struct sr_dev_inst *sdi;
+	GSList *options, *devices;
+
+	conn.key = SR_CONF_CONN;
+	conn.data = g_variant_new_string("/dev/fake");
+	options = g_slist_append(NULL, &conn);
+	devices = sr_driver_scan(driver, options);
+	g_slist_free(options);
+	g_variant_unref(conn.data);
+
+	if (!devices)
+		return NULL;
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	return sdi;
+}
+
+/* Find and open a DMM, with nothing left to read. */
+static struct sr_dev_inst *dmm_open(unsigned int dmm)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	uint8_t packet[32];
+	int ret;
+
+	driver = srtest_driver_get(dmms[dmm].driver);
+	srtest_driver_init(srtest_ctx, driver);
+
+	fake_reset();
+	dmms[dmm].packet(packet, packet_value(0));
+	fake_feed(packet, dmms[dmm].packet_size);
+	sdi = dmm_scan(driver);
+	fail_unless(sdi != NULL, "%s: No device found.", dmms[dmm].driver);
+
+	fake_reset();
+	ret = sr_dev_open(sdi);
+	fail_unless(ret == SR_OK, "sr_dev_open() failed: %d.", ret);
+
+	return sdi;
+}
+
+/* Feed packets of increasing value, with garbage in between. */
+static void dmm_feed(unsigned int dmm, unsigned int num_packets)
+{
+	GByteArray *stream;
+	uint8_t packet[32];
+	unsigned int i;
+
+	stream = g_byte_array_new();
+	for (i = 0; i < num_packets; i++) {
+		garbage_append(stream, dmm, i);
+		dmms[dmm].packet(packet, packet_value(i));
+		g_byte_array_append(stream, packet, dmms[dmm].packet_size);
+	}
+	fake_feed(stream->data, stream->len);
+	g_byte_array_free(stream, TRUE);
+}
+
+static void dmm_run(struct sr_dev_inst *sdi)
+{
+	struct sr_session *session;
+	int ret;
+
+	feed.values = g_array_new(FALSE, FALSE, sizeof(float));
+	feed.sizes = g_array_new(FALSE, FALSE, sizeof(uint32_t));
+	feed.arrivals = g_array_new(FALSE, FALSE, sizeof(int64_t));
+	feed.timestamps = NULL;
+	feed.num_timestamped = 0;
+	feed.last_timestamp = 0;
+	feed.have_seen_df_end = FALSE;
+
+	sr_session_new(srtest_ctx, &session);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+	sr_session_dev_add(session, sdi);
+	feed.start_time = g_get_monotonic_time();
+	ret = sr_session_start(session);
+	fail_unless(ret == SR_OK, "sr_session_start() failed: %d.", ret);
+	sr_session_run(session);
+	sr_session_destroy(session);
+
+	fail_unless(feed.have_seen_df_end, "No SR_DF_END packet was sent.");
+	fail_unless(feed.timestamps == NULL, "Timestamps without samples.");
+}
+
+static void dmm_check_values(unsigned int dmm, unsigned int num_packets)
+{
+	unsigned int i;
+	float value, expected;
+
+	fail_unless(feed.values->len == num_packets, "%s: Got %u values.",
+		dmms[dmm].driver, feed.values->len);
+	for (i = 0; i < num_packets; i++) {
+		value = g_array_index(feed.values, float, i);
+		expected = packet_value(i) * dmms[dmm].scale;
+		fail_unless(fabs(value - expected) < expected * 1e-5,
+			"%s: Value %u is %f, expected %f.", dmms[dmm].driver,
+			i, value, expected);
+	}
+}
+
+static void feed_free(void)
+{
+	g_array_free(feed.values, TRUE);
+	g_array_free(feed.sizes, TRUE);
+	g_array_free(feed.arrivals, TRUE);
+}
+
+/*
+ * Scanning must find the packet behind some garbage, with the data
+ * split across reads, and must not read beyond that packet.
+ */
+START_TEST(test_serial_dmm_scan)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	GByteArray *stream;
+	uint8_t packet[32];
+	size_t skipped;
+
+	driver = srtest_driver_get(dmms[_i].driver);
+	srtest_driver_init(srtest_ctx, driver);
+
+	fake_reset();
+	stream = g_byte_array_new();
+	skipped = garbage_append(stream, _i, sizeof(garbage));
+	skipped += garbage_append(stream, _i, dmms[_i].packet_size - 1);
+	dmms[_i].packet(packet, packet_value(0));
+	g_byte_array_append(stream, packet, dmms[_i].packet_size);
+	dmms[_i].packet(packet, packet_value(1));
+	g_byte_array_append(stream, packet, dmms[_i].packet_size);
+	fake_feed(stream->data, stream->len);
+	g_byte_array_free(stream, TRUE);
+
+	sdi = dmm_scan(driver);
+	fail_unless(sdi != NULL, "%s: No device found.", dmms[_i].driver);
+	fail_unless(fake_bytes_read == skipped + dmms[_i].packet_size,
+		"%s: Read %zu bytes, expected %zu.", dmms[_i].driver,
+		fake_bytes_read, skipped + dmms[_i].packet_size);
+}
+END_TEST
+
+/*
+ * A cached DMM is found again by scanning only the port it was on. A
+ * different device on that port isn't taken for it, and isn't kept.
+ */
+START_TEST(test_serial_dmm_cache)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	GSList *devices;
+	uint8_t packet[32];
+	char *filename, *contents, *other;
+	unsigned int num_devices;
+	int fd, ret;
+
+	driver = srtest_driver_get(dmms[0].driver);
+	srtest_driver_init(srtest_ctx, driver);
+	dmms[0].packet(packet, packet_value(0));
+
+	fake_reset();
+	fake_feed(packet, dmms[0].packet_size);
+	sdi = dmm_scan(driver);
+	fail_unless(sdi != NULL, "%s: No device found.", dmms[0].driver);
+	num_devices = g_slist_length(sr_dev_list(driver));
+
+	fd = g_file_open_tmp("sigrok-devcache-XXXXXX", &filename, NULL);
+	fail_unless(fd >= 0, "Failed to create temporary file.");
+	close(fd);
+
+	devices = g_slist_append(NULL, sdi);
+	ret = sr_dev_cache_save(filename, devices);
+	fail_unless(ret == SR_OK, "sr_dev_cache_save() failed: %d.", ret);
+	g_slist_free(devices);
+
+	g_file_get_contents(filename, &contents, NULL, NULL);
+	fail_unless(strstr(contents, "conn=/dev/fake\n") != NULL,
+		"Port not saved.");
+
+	fake_reset();
+	fake_feed(packet, dmms[0].packet_size);
+	devices = sr_dev_cache_reconnect(srtest_ctx, filename);
+	fail_unless(g_slist_length(devices) == 1, "Cached device not found.");
+	fail_unless(devices->data != sdi);
+	fail_unless(fake_bytes_read == dmms[0].packet_size,
+		"Port wasn't scanned.");
+	g_slist_free(devices);
+	fail_unless(g_slist_length(sr_dev_list(driver)) == num_devices + 1,
+		"Reconnecting added %u devices.",
+		g_slist_length(sr_dev_list(driver)) - num_devices);
+
+	other = g_strconcat(contents, "serial_num=12345\n", NULL);
+	g_file_set_contents(filename, other, -1, NULL);
+	fake_reset();
+	fake_feed(packet, dmms[0].packet_size);
+	fail_unless(sr_dev_cache_reconnect(srtest_ctx, filename) == NULL,
+		"Device with another serial number found.");
+	fail_unless(fake_bytes_read == dmms[0].packet_size,
+		"Port wasn't scanned.");
+	fail_unless(g_slist_length(sr_dev_list(driver)) == num_devices + 1,
+		"Unused instance was kept.");
+
+	g_remove(filename);
+	g_free(filename);
+	g_free(contents);
+	g_free(other);
+}
+END_TEST
+
+/*
+ * Acquisition must deliver every packet in the stream exactly once, in
+ * order. The stream is several times the size of the driver's receive
+ * buffer, so the leftover data gets moved around, and packets are split
+ * across reads in all sorts of places.
+ */
+START_TEST(test_serial_dmm_acquisition)
+{
+	struct sr_dev_inst *sdi;
+
+	sdi = dmm_open(_i);
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+		g_variant_new_uint64(NUM_PACKETS));
+	/* Don't hang if packets get lost. */
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_MSEC, g_variant_new_uint64(5000));
+	dmm_feed(_i, NUM_PACKETS);
+	dmm_run(sdi);
+
+	dmm_check_values(_i, NUM_PACKETS);
+	fail_unless(feed.sizes->len == NUM_PACKETS,
+		"Readings were batched.");
+	fail_unless(feed.num_timestamped == 0,
+		"Unbatched readings have timestamps.");
+	feed_free();
+}
+END_TEST
+
+/*
+ * Readings are sent in packets of the batch size, with their timestamps.
+ * The last, partial batch is sent when the acquisition stops, before
+ * SR_DF_END.
+ */
+START_TEST(test_serial_dmm_batch_samples)
+{
+	const uint32_t expected[] = { 16, 16, 8 };
+	struct sr_dev_inst *sdi;
+	unsigned int i;
+
+	sdi = dmm_open(0);
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+		g_variant_new_uint64(NUM_PACKETS));
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_MSEC, g_variant_new_uint64(5000));
+	sr_config_set(sdi, NULL, SR_CONF_ANALOG_BATCH_SAMPLES,
+		g_variant_new_uint64(16));
+	dmm_feed(0, NUM_PACKETS);
+	dmm_run(sdi);
+
+	dmm_check_values(0, NUM_PACKETS);
+	fail_unless(feed.sizes->len == ARRAY_SIZE(expected),
+		"Got %u packets.", feed.sizes->len);
+	for (i = 0; i < ARRAY_SIZE(expected); i++)
+		fail_unless(g_array_index(feed.sizes, uint32_t, i)
+			== expected[i], "Packet %u has %u samples.", i,
+			g_array_index(feed.sizes, uint32_t, i));
+	fail_unless(feed.num_timestamped == feed.sizes->len,
+		"Batched readings without timestamps.");
+	feed_free();
+}
+END_TEST
+
+/*
+ * A time limited batch is sent once it is old enough, even though no
+ * further readings arrive, rather than when the acquisition stops.
+ */
+START_TEST(test_serial_dmm_batch_msec)
+{
+	struct sr_dev_inst *sdi;
+	int64_t arrival;
+
+	sdi = dmm_open(0);
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_MSEC, g_variant_new_uint64(1000));
+	sr_config_set(sdi, NULL, SR_CONF_ANALOG_BATCH_MSEC,
+		g_variant_new_uint64(100));
+	dmm_feed(0, 5);
+	dmm_run(sdi);
+
+	dmm_check_values(0, 5);
+	fail_unless(feed.sizes->len == 1, "Got %u packets.", feed.sizes->len);
+	arrival = g_array_index(feed.arrivals, int64_t, 0);
+	fail_unless(arrival >= 100 * 1000 && arrival < 600 * 1000,
+		"Batch arrived after %" PRIi64 " µs.", arrival);
+	fail_unless(feed.num_timestamped == 1,
+		"Batched readings without timestamps.");
+	feed_free();
+}
+END_TEST
+
+#endif
+
+Suite *suite_serial_dmm(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("serial-dmm");
+
+	tc = tcase_create("sync");
+#if defined(__GLIBC__) && defined(HAVE_LIBSERIALPORT) && defined(HAVE_HW_SERIAL_DMM)
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_loop_test(tc, test_serial_dmm_scan, 0, ARRAY_SIZE(dmms));
+	tcase_add_loop_test(tc, test_serial_dmm_acquisition, 0, ARRAY_SIZE(dmms));
+	tcase_add_test(tc, test_serial_dmm_cache);
+#endif
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("batch");
+#if defined(__GLIBC__) && defined(HAVE_LIBSERIALPORT) && defined(HAVE_HW_SERIAL_DMM)
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_serial_dmm_batch_samples);
+	tcase_add_test(tc, test_serial_dmm_batch_msec);
+#endif
+	suite_add_tcase(s, tc);
+
+	return s;
+}
@@ -20,6 +20,7 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
 #include "lib.h"
@@ -186,6 +187,93 @@ START_TEST(test_session_trigger_get_null)
 }
 END_TEST
 
+static void datafeed_nop(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	(void)sdi;
+	(void)packet;
+	(void)cb_data;
+}
+
+/* Check whether the metrics functions fail for bogus parameters. */
+START_TEST(test_session_metrics_bogus)
+{
+	struct sr_session *sess;
+	GSList *stages;
+
+	fail_unless(sr_session_metrics_enable(NULL, TRUE) == SR_ERR_ARG);
+	fail_unless(sr_session_metrics_reset(NULL) == SR_ERR_ARG);
+	fail_unless(sr_session_metrics_get(NULL, &stages) == SR_ERR_ARG);
+
+	sr_session_new(srtest_ctx, &sess);
+	fail_unless(sr_session_metrics_get(sess, NULL) == SR_ERR_ARG);
+	sr_session_destroy(sess);
+}
+END_TEST
+
+/*
+ * Check whether metrics are collected for the device and the datafeed
+ * callback while running a demo acquisition, and only when enabled.
+ */
+START_TEST(test_session_metrics_demo)
+{
+	int ret;
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_session *sess;
+	struct sr_metrics_stage *stage;
+	GSList *devices, *stages, *l;
+	gboolean have_device, have_callback;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+	sr_dev_open(sdi);
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES, g_variant_new_uint64(1000));
+
+	sr_session_new(srtest_ctx, &sess);
+	sr_session_dev_add(sess, sdi);
+	sr_session_datafeed_callback_add(sess, datafeed_nop, NULL);
+
+	/* Disabled by default. */
+	sr_session_start(sess);
+	sr_session_run(sess);
+	ret = sr_session_metrics_get(sess, &stages);
+	fail_unless(ret == SR_OK, "sr_session_metrics_get() failed: %d.", ret);
+	fail_unless(stages == NULL, "Metrics collected while disabled.");
+
+	sr_session_metrics_enable(sess, TRUE);
+	sr_session_start(sess);
+	sr_session_run(sess);
+	sr_session_metrics_get(sess, &stages);
+	have_device = have_callback = FALSE;
+	for (l = stages; l; l = l->next) {
+		stage = l->data;
+		fail_unless(stage->packets > 0);
+		if (stage->type == SR_METRICS_DEVICE) {
+			fail_unless(!strcmp(stage->name, "demo"));
+			fail_unless(stage->bytes > 0);
+			have_device = TRUE;
+		} else if (stage->type == SR_METRICS_CALLBACK) {
+			fail_unless(stage->index == 0);
+			have_callback = TRUE;
+		}
+	}
+	fail_unless(have_device && have_callback, "Missing metrics stage.");
+	sr_session_metrics_free(stages);
+
+	sr_session_metrics_reset(sess);
+	sr_session_metrics_get(sess, &stages);
+	fail_unless(stages == NULL, "Metrics not reset.");
+
+	sr_session_destroy(sess);
+	sr_dev_close(sdi);
+}
+END_TEST
+
 Suite *suite_session(void)
 {
 	Suite *s;
@@ -210,5 +298,11 @@ Suite *suite_session(void)
 	tcase_add_test(tc, test_session_trigger_get_null);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("metrics");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_test(tc, test_session_metrics_bogus);
+	tcase_add_test(tc, test_session_metrics_demo);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
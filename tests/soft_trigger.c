@@ -0,0 +1,632 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
+#include "lib.h"
+
+#define NUM_SAMPLES 8
+#define MAX_SAMPLES 32
+
+enum {
+	CH_L0,
+	CH_L1,
+	CH_A0,
+	CH_A1,
+	NUM_CHANNELS,
+};
+
+/* A packet sent by the soft trigger. */
+struct sent_packet {
+	int type;
+	unsigned int num_channels;
+	uint64_t num_samples;
+	uint8_t logic[MAX_SAMPLES];
+	float values[MAX_SAMPLES];
+};
+
+static struct sr_session *session;
+static struct sr_dev_inst fake_sdi;
+static struct sr_channel fake_channels[NUM_CHANNELS];
+static GArray *sent;
+
+/* Record the packets sent by the soft trigger, analog ones as floats. */
+static void datafeed_in(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	const struct sr_datafeed_logic *logic;
+	const struct sr_datafeed_analog *analog;
+	struct sent_packet p;
+
+	(void)cb_data;
+
+	fail_unless(sdi == &fake_sdi, "Packet sent for another device.");
+
+	memset(&p, 0, sizeof(p));
+	p.type = packet->type;
+	switch (packet->type) {
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		fail_unless(logic->unitsize == 1);
+		fail_unless(logic->length <= MAX_SAMPLES);
+		p.num_samples = logic->length;
+		memcpy(p.logic, logic->data, logic->length);
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		p.num_channels = g_slist_length(analog->meaning->channels);
+		p.num_samples = analog->num_samples;
+		fail_unless(p.num_samples * p.num_channels <= MAX_SAMPLES);
+		fail_unless(sr_analog_to_float(analog, p.values) == SR_OK);
+		break;
+	case SR_DF_TRIGGER:
+		break;
+	default:
+		fail("Unexpected packet type %d.", packet->type);
+	}
+	g_array_append_val(sent, p);
+}
+
+static void setup(void)
+{
+	const char *names[] = { "L0", "L1", "A0", "A1" };
+	struct sr_channel *ch;
+	unsigned int i;
+	int ret;
+
+	srtest_setup();
+	ret = sr_session_new(srtest_ctx, &session);
+	fail_unless(ret == SR_OK, "sr_session_new() failed: %d.", ret);
+	sr_session_datafeed_callback_add(session, datafeed_in, NULL);
+
+	memset(&fake_sdi, 0, sizeof(fake_sdi));
+	fake_sdi.session = session;
+	for (i = 0; i < NUM_CHANNELS; i++) {
+		ch = &fake_channels[i];
+		memset(ch, 0, sizeof(*ch));
+		ch->sdi = &fake_sdi;
+		ch->index = i;
+		ch->type = i < CH_A0 ? SR_CHANNEL_LOGIC : SR_CHANNEL_ANALOG;
+		ch->enabled = TRUE;
+		ch->name = (char *)names[i];
+		fake_sdi.channels = g_slist_append(fake_sdi.channels, ch);
+	}
+	sent = g_array_new(FALSE, FALSE, sizeof(struct sent_packet));
+}
+
+static void teardown(void)
+{
+	g_slist_free(fake_sdi.channels);
+	g_array_free(sent, TRUE);
+	sr_session_destroy(session);
+	srtest_teardown();
+}
+
+/* A trigger with a single match in a single stage. */
+static struct sr_trigger *trigger_new(int channel, int match, float value,
+		float hysteresis, int num_samples)
+{
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+
+	trigger = sr_trigger_new(NULL);
+	stage = sr_trigger_stage_add(trigger);
+	fail_unless(sr_trigger_analog_match_add(stage, &fake_channels[channel],
+		match, value, hysteresis, num_samples) == SR_OK);
+
+	return trigger;
+}
+
+/* Feed a packet of floats on the given analog channels. */
+static int check_floats(struct soft_trigger_analog *sta, GSList *channels,
+		const float *values, uint64_t num_samples, int *pre_trigger_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+
+	sr_analog_init(&analog, &encoding, &meaning, &spec, 3);
+	analog.data = (void *)values;
+	analog.num_samples = num_samples;
+	meaning.channels = channels;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+
+	return soft_trigger_analog_check(sta, &packet, pre_trigger_samples);
+}
+
+/* Feed a packet of floats on A0. */
+static int check_a0(struct soft_trigger_analog *sta, const float *values,
+		int *pre_trigger_samples)
+{
+	GSList *channels;
+	int offset;
+
+	channels = g_slist_append(NULL, &fake_channels[CH_A0]);
+	offset = check_floats(sta, channels, values, NUM_SAMPLES,
+		pre_trigger_samples);
+	g_slist_free(channels);
+
+	return offset;
+}
+
+static int check_logic(struct soft_trigger_analog *sta, const uint8_t *data,
+		uint64_t num_samples, int *pre_trigger_samples)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_logic logic;
+
+	logic.length = num_samples;
+	logic.unitsize = 1;
+	logic.data = (void *)data;
+	packet.type = SR_DF_LOGIC;
+	packet.payload = &logic;
+
+	return soft_trigger_analog_check(sta, &packet, pre_trigger_samples);
+}
+
+/* The index of the trigger packet among the sent ones, or -1. */
+static int sent_trigger(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < sent->len; i++) {
+		if (g_array_index(sent, struct sent_packet, i).type
+				== SR_DF_TRIGGER)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * Check the samples of one packet type sent before the trigger, or
+ * after it. A ring which wraps may send them in more than one packet.
+ */
+static void check_sent(int type, gboolean after, const float *values,
+		uint64_t num_values)
+{
+	struct sent_packet *p;
+	unsigned int i, first, last;
+	uint64_t j, n;
+	float x;
+
+	fail_unless(sent_trigger() >= 0, "The trigger wasn't sent.");
+	first = after ? sent_trigger() + 1 : 0;
+	last = after ? sent->len : (unsigned int)sent_trigger();
+
+	n = 0;
+	for (i = first; i < last; i++) {
+		p = &g_array_index(sent, struct sent_packet, i);
+		if (p->type != type)
+			continue;
+		for (j = 0; j < p->num_samples; j++, n++) {
+			fail_unless(n < num_values, "Sent too many samples.");
+			x = type == SR_DF_LOGIC ? p->logic[j] : p->values[j];
+			fail_unless(x == values[n], "Sample %" PRIu64 " is %f, "
+				"expected %f.", n, x, values[n]);
+		}
+	}
+	fail_unless(n == num_values, "Sent %" PRIu64 " samples, expected "
+		"%" PRIu64 ".", n, num_values);
+}
+
+/*
+ * Edges with hysteresis. The value crosses the level in the first packet
+ * without having been beyond the hysteresis, and goes beyond it at the
+ * end of that packet, so only the crossing in the second packet counts.
+ */
+static const struct {
+	int match;
+	float data[2][NUM_SAMPLES];
+	int offset;
+} edge_tests[] = {
+	{ SR_TRIGGER_RISING,
+		{ { 1.2, 0.9, 1.1, 0.8, 1.0, 0.6, 1.3, 0.4 },
+		{ 0.9, 1.0, 1.1, 1.2, 0.2, 1.5, 1.5, 1.5 } }, 1 },
+	{ SR_TRIGGER_FALLING,
+		{ { 0.8, 1.1, 0.9, 1.2, 1.0, 1.4, 0.7, 1.6 },
+		{ 1.1, 1.0, 0.9, 0.8, 1.8, 0.5, 0.5, 0.5 } }, 1 },
+	{ SR_TRIGGER_EDGE,
+		{ { 1.2, 0.9, 1.1, 0.8, 1.0, 0.6, 1.3, 0.4 },
+		{ 0.9, 1.0, 1.1, 1.2, 0.2, 1.5, 1.5, 1.5 } }, 1 },
+};
+
+START_TEST(test_edge)
+{
+	struct sr_trigger *trigger;
+	struct soft_trigger_analog *sta;
+	float before[4];
+	int offset, pre;
+
+	trigger = trigger_new(CH_A0, edge_tests[_i].match, 1.0, 0.5, 1);
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 4);
+
+	offset = check_a0(sta, edge_tests[_i].data[0], &pre);
+	fail_unless(offset == -1, "Triggered within the hysteresis at %d.",
+		offset);
+	fail_unless(sent->len == 0);
+
+	offset = check_a0(sta, edge_tests[_i].data[1], &pre);
+	fail_unless(offset == edge_tests[_i].offset, "Triggered at %d.", offset);
+	fail_unless(pre == 4);
+	memcpy(before, edge_tests[_i].data[0] + 5, 3 * sizeof(float));
+	before[3] = edge_tests[_i].data[1][0];
+	check_sent(SR_DF_ANALOG, FALSE, before, 4);
+	fail_unless(sent_trigger() == (int)sent->len - 1);
+
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+/* Slopes are measured over samples of the previous packet, too. */
+START_TEST(test_slope)
+{
+	const float data[2][NUM_SAMPLES] = {
+		{ 0.0, 0.2, 0.4, 0.6, 0.8, 1.0, 1.2, 1.4 },
+		{ 1.6, 1.8, 2.5, 2.6, 2.6, 2.6, 2.6, 2.6 },
+	};
+	struct sr_trigger *trigger;
+	struct soft_trigger_analog *sta;
+	float values[2][NUM_SAMPLES], sign;
+	int offset, pre, i, j;
+
+	/* Both directions, the change needs to be 1.0 within 3 samples. */
+	sign = _i ? -1 : 1;
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < NUM_SAMPLES; j++)
+			values[i][j] = sign * data[i][j];
+	trigger = trigger_new(CH_A0, _i ? SR_TRIGGER_SLOPE_DOWN
+		: SR_TRIGGER_SLOPE_UP, 1.0, 0, 3);
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 0);
+
+	fail_unless(check_a0(sta, values[0], &pre) == -1);
+	offset = check_a0(sta, values[1], &pre);
+	fail_unless(offset == 2, "Triggered at %d.", offset);
+	fail_unless(pre == 0);
+	fail_unless(sent->len == 1 && sent_trigger() == 0);
+
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+/* Over and under matches on the same channel form a window. */
+START_TEST(test_window)
+{
+	const float data[2][NUM_SAMPLES] = {
+		{ 0.5, 2.5, 3.0, 0.0, 1.0, 2.0, 0.9, 2.1 },
+		{ 2.2, 0.1, 1.5, 1.7, 1.2, 0.0, 0.0, 0.0 },
+	};
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+	struct soft_trigger_analog *sta;
+	int offset, pre;
+
+	trigger = sr_trigger_new(NULL);
+	stage = sr_trigger_stage_add(trigger);
+	sr_trigger_match_add(stage, &fake_channels[CH_A0], SR_TRIGGER_OVER, 1.0);
+	sr_trigger_match_add(stage, &fake_channels[CH_A0], SR_TRIGGER_UNDER, 2.0);
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 2);
+
+	fail_unless(check_a0(sta, data[0], &pre) == -1,
+		"Triggered outside of the window.");
+	offset = check_a0(sta, data[1], &pre);
+	fail_unless(offset == 2, "Triggered at %d.", offset);
+	fail_unless(pre == 2);
+	check_sent(SR_DF_ANALOG, FALSE, data[1], 2);
+
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+/*
+ * Stages match on consecutive samples. A sample which breaks the
+ * sequence starts it over, and may be its first stage itself.
+ */
+START_TEST(test_stages)
+{
+	const float data[][NUM_SAMPLES] = {
+		{ 0.0, 2.0, 0.5, 2.0, 0.5, 0.5, 0.5, 2.0 },
+		{ 3.0, -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+		{ 0.0, 2.0, 0.5, 0.0, 0.0, 0.0, 0.0, 2.0 },
+		{ -1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 },
+	};
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+	struct soft_trigger_analog *sta;
+	int offset, pre;
+
+	trigger = sr_trigger_new(NULL);
+	stage = sr_trigger_stage_add(trigger);
+	sr_trigger_match_add(stage, &fake_channels[CH_A0], SR_TRIGGER_OVER, 1.0);
+	stage = sr_trigger_stage_add(trigger);
+	sr_trigger_match_add(stage, &fake_channels[CH_A0], SR_TRIGGER_UNDER, 0.0);
+
+	/* The sequence restarts on the first sample of the second packet. */
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 0);
+	fail_unless(check_a0(sta, data[0], &pre) == -1);
+	offset = check_a0(sta, data[1], &pre);
+	fail_unless(offset == 1, "Triggered at %d.", offset);
+	soft_trigger_analog_free(sta);
+
+	/* The last stage matches on the first sample of the second packet. */
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 0);
+	fail_unless(check_a0(sta, data[2], &pre) == -1);
+	offset = check_a0(sta, data[3], &pre);
+	fail_unless(offset == 0, "Triggered at %d.", offset);
+	soft_trigger_analog_free(sta);
+
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+/*
+ * Single level matches are checked on the raw samples of most integer
+ * encodings and plain floats. The same samples, with an always true
+ * match on another channel added, go through sr_analog_to_float().
+ * Both have to trigger on the same sample. The matched channel is the
+ * second one of the packet.
+ */
+static const float raw_values[NUM_SAMPLES] = { 2, 1, 3, 0, 2, 5, 4, 2 };
+
+static const struct {
+	unsigned int unitsize;
+	gboolean is_signed;
+	gboolean is_float;
+	struct sr_rational scale;
+	struct sr_rational offset;
+	gboolean exact;
+} raw_encodings[] = {
+	/* A negative scale turns the bounds around. */
+	{ 1, TRUE, FALSE, { -1, 2 }, { 0, 1 }, TRUE },
+	{ 2, FALSE, FALSE, { 1, 4 }, { -100, 1 }, TRUE },
+	/*
+	 * A scale which isn't exact in single precision, 3 becomes a bit
+	 * more. Only both checks have to agree on the rounding.
+	 */
+	{ 4, TRUE, FALSE, { 1, 1000 }, { -3, 1 }, FALSE },
+	{ 4, TRUE, TRUE, { 1, 1 }, { 0, 1 }, TRUE },
+};
+
+static const struct {
+	int match;
+	float value;
+	float hysteresis;
+	int offset;
+} raw_matches[] = {
+	/* Over and under are strict. */
+	{ SR_TRIGGER_OVER, 3, 0, 5 },
+	{ SR_TRIGGER_UNDER, 1, 0, 3 },
+	{ SR_TRIGGER_UNDER, -1, 0, -1 },
+	/* Edges are armed beyond the hysteresis, and reach the level. */
+	{ SR_TRIGGER_RISING, 2, 1, 4 },
+	{ SR_TRIGGER_RISING, 3, 0, 2 },
+	{ SR_TRIGGER_FALLING, 2, 2, 7 },
+	{ SR_TRIGGER_FALLING, 1, 1, 3 },
+};
+
+/* Encode the values of the channels, interleaved. */
+static void raw_encode(void *buf, unsigned int e, const float *values)
+{
+	unsigned int i;
+	double raw;
+
+	for (i = 0; i < 2 * NUM_SAMPLES; i++) {
+		raw = values[i] - raw_encodings[e].offset.p
+			/ (double)raw_encodings[e].offset.q;
+		raw = raw * raw_encodings[e].scale.q / raw_encodings[e].scale.p;
+		if (raw_encodings[e].is_float)
+			((float *)buf)[i] = raw;
+		else if (raw_encodings[e].unitsize == 1)
+			((int8_t *)buf)[i] = raw;
+		else if (raw_encodings[e].unitsize == 2)
+			((uint16_t *)buf)[i] = raw;
+		else
+			((int32_t *)buf)[i] = raw;
+	}
+}
+
+static int check_raw(unsigned int e, unsigned int t, gboolean raw)
+{
+	struct sr_datafeed_packet packet;
+	struct sr_datafeed_analog analog;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	struct sr_trigger *trigger;
+	struct sr_trigger_stage *stage;
+	struct soft_trigger_analog *sta;
+	GSList *channels;
+	float values[2 * NUM_SAMPLES];
+	int32_t buf[2 * NUM_SAMPLES];
+	unsigned int i;
+	int offset;
+
+	for (i = 0; i < NUM_SAMPLES; i++) {
+		values[2 * i] = 50;
+		values[2 * i + 1] = raw_values[i];
+	}
+	raw_encode(buf, e, values);
+
+	trigger = trigger_new(CH_A1, raw_matches[t].match, raw_matches[t].value,
+		raw_matches[t].hysteresis, 1);
+	if (!raw) {
+		stage = trigger->stages->data;
+		sr_trigger_match_add(stage, &fake_channels[CH_A0],
+			SR_TRIGGER_OVER, -1000);
+	}
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 0);
+
+	channels = g_slist_append(NULL, &fake_channels[CH_A0]);
+	channels = g_slist_append(channels, &fake_channels[CH_A1]);
+	sr_analog_init(&analog, &encoding, &meaning, &spec, 3);
+	analog.data = buf;
+	analog.num_samples = NUM_SAMPLES;
+	encoding.unitsize = raw_encodings[e].unitsize;
+	encoding.is_signed = raw_encodings[e].is_signed;
+	encoding.is_float = raw_encodings[e].is_float;
+	encoding.scale = raw_encodings[e].scale;
+	encoding.offset = raw_encodings[e].offset;
+	meaning.channels = channels;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+	offset = soft_trigger_analog_check(sta, &packet, NULL);
+
+	g_slist_free(channels);
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+
+	return offset;
+}
+
+START_TEST(test_raw)
+{
+	unsigned int t;
+	int raw, converted;
+
+	for (t = 0; t < ARRAY_SIZE(raw_matches); t++) {
+		raw = check_raw(_i, t, TRUE);
+		converted = check_raw(_i, t, FALSE);
+		fail_unless(raw == converted, "Match %u: the raw check "
+			"triggered at %d, the converted one at %d.",
+			t, raw, converted);
+		fail_unless(!raw_encodings[_i].exact
+			|| raw == raw_matches[t].offset, "Match %u "
+			"triggered at %d.", t, raw);
+	}
+}
+END_TEST
+
+/*
+ * On trigger, the pre-trigger samples of all streams go out, then the
+ * trigger, then what the other streams have beyond the trigger.
+ */
+START_TEST(test_replay)
+{
+	const uint8_t logic[2][4] = {
+		{ 0x10, 0x11, 0x12, 0x13 },
+		{ 0x14, 0x15, 0x16, 0x17 },
+	};
+	const float analog[2][4] = {
+		{ 0.0, 0.1, 0.2, 0.3 },
+		{ 0.4, 0.5, 1.0, 1.1 },
+	};
+	const float logic_before[] = { 0x11, 0x12, 0x13, 0x14, 0x15 };
+	const float logic_after[] = { 0x16, 0x17 };
+	const float analog_before[] = { 0.1, 0.2, 0.3, 0.4, 0.5 };
+	struct sr_trigger *trigger;
+	struct soft_trigger_analog *sta;
+	GSList *channels;
+	int offset, pre;
+
+	trigger = trigger_new(CH_A0, SR_TRIGGER_RISING, 0.75, 0, 1);
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 5);
+	channels = g_slist_append(NULL, &fake_channels[CH_A0]);
+
+	/* The logic stream runs ahead of the analog one. */
+	fail_unless(check_logic(sta, logic[0], 4, &pre) == -1);
+	fail_unless(check_floats(sta, channels, analog[0], 4, &pre) == -1);
+	fail_unless(check_logic(sta, logic[1], 4, &pre) == -1);
+	fail_unless(sent->len == 0);
+	offset = check_floats(sta, channels, analog[1], 4, &pre);
+	fail_unless(offset == 2, "Triggered at %d.", offset);
+	fail_unless(pre == 5);
+
+	check_sent(SR_DF_LOGIC, FALSE, logic_before, 5);
+	check_sent(SR_DF_ANALOG, FALSE, analog_before, 5);
+	check_sent(SR_DF_LOGIC, TRUE, logic_after, 2);
+	check_sent(SR_DF_ANALOG, TRUE, NULL, 0);
+
+	/* The caller sends all packets after the trigger. */
+	g_array_set_size(sent, 0);
+	fail_unless(check_logic(sta, logic[0], 4, &pre) == 0);
+	fail_unless(check_floats(sta, channels, analog[0], 4, &pre) == 0);
+	fail_unless(pre == 0 && sent->len == 0);
+
+	g_slist_free(channels);
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+/* The ring keeps the last samples across packets, and wraps around. */
+START_TEST(test_replay_wrap)
+{
+	const float data[3][4] = {
+		{ 0, 1, 2, 3 },
+		{ 4, 5, 6, 7 },
+		{ 8, 9, 10, 11 },
+	};
+	const float before[] = { 5, 6, 7, 8, 9 };
+	struct sr_trigger *trigger;
+	struct soft_trigger_analog *sta;
+	GSList *channels;
+	int offset, pre, i;
+
+	trigger = trigger_new(CH_A0, SR_TRIGGER_OVER, 9.5, 0, 1);
+	sta = soft_trigger_analog_new(&fake_sdi, trigger, 5);
+	channels = g_slist_append(NULL, &fake_channels[CH_A0]);
+
+	for (i = 0; i < 2; i++)
+		fail_unless(check_floats(sta, channels, data[i], 4, &pre) == -1);
+	offset = check_floats(sta, channels, data[2], 4, &pre);
+	fail_unless(offset == 2, "Triggered at %d.", offset);
+	fail_unless(pre == 5);
+	fail_unless(sent_trigger() == 2, "Wrapped ring sent in %d packets.",
+		sent_trigger());
+	check_sent(SR_DF_ANALOG, FALSE, before, 5);
+
+	g_slist_free(channels);
+	soft_trigger_analog_free(sta);
+	sr_trigger_free(trigger);
+}
+END_TEST
+
+Suite *suite_soft_trigger(void)
+{
+	Suite *s;
+	TCase *tc;
+
+	s = suite_create("soft_trigger");
+
+	tc = tcase_create("match");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_loop_test(tc, test_edge, 0, ARRAY_SIZE(edge_tests));
+	tcase_add_loop_test(tc, test_slope, 0, 2);
+	tcase_add_test(tc, test_window);
+	tcase_add_test(tc, test_stages);
+	tcase_add_loop_test(tc, test_raw, 0, ARRAY_SIZE(raw_encodings));
+	suite_add_tcase(s, tc);
+
+	tc = tcase_create("replay");
+	tcase_add_checked_fixture(tc, setup, teardown);
+	tcase_add_test(tc, test_replay);
+	tcase_add_test(tc, test_replay_wrap);
+	suite_add_tcase(s, tc);
+
+	return s;
+}
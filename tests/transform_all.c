@@ -20,8 +20,10 @@
 
 #include <config.h>
 #include <stdlib.h>
+#include <string.h>
 #include <check.h>
 #include <libsigrok/libsigrok.h>
+#include "libsigrok-internal.h"
 #include "lib.h"
 
 /* Check whether at least one transform module is available. */
@@ -97,6 +99,377 @@ START_TEST(test_transform_options)
 }
 END_TEST
 
+/*
+ * Enabled logic channels of the demo device, by index, and the packed
+ * samples when all of them are high.
+ */
+static const struct {
+	uint8_t channels;
+	uint8_t value;
+} repack_tests[] = {
+	/* D1 and D3 are packed into the low bits. */
+	{ 0x0a, 0x03 },
+	/* D0-D2 are in place, the disabled channels are cleared. */
+	{ 0x07, 0x07 },
+	/* All channels are passed on as they are. */
+	{ 0xff, 0xff },
+};
+
+struct repack_stats {
+	gboolean header, packed, packed_early;
+	uint8_t value;
+	uint64_t samples;
+	gboolean wrong_unitsize, wrong_data;
+};
+
+static void repack_datafeed(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct repack_stats *stats;
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_config *src;
+	GSList *l;
+	uint64_t i;
+
+	(void)sdi;
+
+	stats = cb_data;
+	switch (packet->type) {
+	case SR_DF_HEADER:
+		stats->header = TRUE;
+		break;
+	case SR_DF_META:
+		meta = packet->payload;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			if (src->key != SR_CONF_LOGIC_PACKED)
+				continue;
+			stats->packed = g_variant_get_boolean(src->data);
+			stats->packed_early = stats->header && !stats->samples;
+		}
+		break;
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		if (logic->unitsize != 1)
+			stats->wrong_unitsize = TRUE;
+		/* All channels are high, only the enabled ones remain. */
+		for (i = 0; i < logic->length; i++) {
+			if (((uint8_t *)logic->data)[i] != stats->value)
+				stats->wrong_data = TRUE;
+		}
+		stats->samples += logic->length / logic->unitsize;
+		break;
+	}
+}
+
+/* Check whether the 'repack' module packs the enabled logic channels. */
+START_TEST(test_transform_repack)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_session *session;
+	struct sr_channel *ch;
+	struct sr_channel_group *cg;
+	const struct sr_transform *t;
+	struct repack_stats stats;
+	GSList *devices, *l;
+	int ret;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+	fail_unless(sr_dev_open(sdi) == SR_OK);
+
+	for (l = sr_dev_inst_channels_get(sdi); l; l = l->next) {
+		ch = l->data;
+		sr_dev_channel_enable(ch, ch->type == SR_CHANNEL_LOGIC
+				&& repack_tests[_i].channels & (1 << ch->index));
+	}
+	for (l = sr_dev_inst_channel_groups_get(sdi); l; l = l->next) {
+		cg = l->data;
+		if (!strcmp(cg->name, "Logic"))
+			sr_config_set(sdi, cg, SR_CONF_PATTERN_MODE,
+					g_variant_new_string("all-high"));
+	}
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+			g_variant_new_uint64(1000));
+
+	memset(&stats, 0, sizeof(stats));
+	stats.value = repack_tests[_i].value;
+	sr_session_new(srtest_ctx, &session);
+	sr_session_dev_add(session, sdi);
+	sr_session_datafeed_callback_add(session, repack_datafeed, &stats);
+	t = sr_transform_new(sr_transform_find("repack"), NULL, sdi);
+	fail_unless(t != NULL, "Couldn't create the 'repack' transform.");
+
+	ret = sr_session_start(session);
+	fail_unless(ret == SR_OK, "Failed to start session: %d.", ret);
+	sr_session_run(session);
+
+	fail_unless(stats.packed, "Packed layout not announced.");
+	fail_unless(stats.packed_early, "Packed layout announced too late.");
+	fail_unless(stats.samples == 1000, "Got %" PRIu64 " samples.",
+			stats.samples);
+	fail_unless(!stats.wrong_unitsize, "Samples weren't packed.");
+	fail_unless(!stats.wrong_data, "Samples of channels 0x%02x were "
+			"packed wrongly.", repack_tests[_i].channels);
+
+	sr_transform_free(t);
+	sr_session_destroy(session);
+	sr_dev_close(sdi);
+}
+END_TEST
+
+/* Decimation modes, and the output samples per block of input samples. */
+static const struct {
+	const char *mode;
+	unsigned int per_block;
+} decimate_tests[] = {
+	{ "mean", 1 },
+	/* The minimum and maximum, with each logic sample repeated. */
+	{ "peak", 2 },
+};
+
+struct decimate_stats {
+	unsigned int per_block;
+	uint64_t samplerate;
+	uint64_t analog_samples;
+	uint64_t logic_samples;
+	gboolean wrong_peaks, wrong_logic;
+};
+
+static void decimate_datafeed(const struct sr_dev_inst *sdi,
+		const struct sr_datafeed_packet *packet, void *cb_data)
+{
+	struct decimate_stats *stats;
+	const struct sr_datafeed_meta *meta;
+	const struct sr_datafeed_analog *analog;
+	const struct sr_datafeed_logic *logic;
+	const struct sr_config *src;
+	const uint8_t *data;
+	GSList *l;
+	float *values;
+	uint64_t i, n;
+
+	(void)sdi;
+
+	stats = cb_data;
+	switch (packet->type) {
+	case SR_DF_META:
+		meta = packet->payload;
+		for (l = meta->config; l; l = l->next) {
+			src = l->data;
+			if (src->key == SR_CONF_SAMPLERATE)
+				stats->samplerate = g_variant_get_uint64(src->data);
+		}
+		break;
+	case SR_DF_ANALOG:
+		analog = packet->payload;
+		stats->analog_samples += analog->num_samples;
+		if (stats->per_block != 2)
+			break;
+		/* Each block gives its minimum, then its maximum. */
+		if (analog->num_samples % 2)
+			stats->wrong_peaks = TRUE;
+		values = g_malloc(sizeof(float) * analog->num_samples);
+		sr_analog_to_float(analog, values);
+		for (i = 0; i + 1 < analog->num_samples; i += 2) {
+			if (values[i] > values[i + 1])
+				stats->wrong_peaks = TRUE;
+		}
+		g_free(values);
+		break;
+	case SR_DF_LOGIC:
+		logic = packet->payload;
+		n = logic->length / logic->unitsize;
+		stats->logic_samples += n;
+		if (n % stats->per_block)
+			stats->wrong_logic = TRUE;
+		data = logic->data;
+		for (i = 0; i < n; i++) {
+			if (memcmp(data + i * logic->unitsize,
+					data + (i - i % stats->per_block)
+					* logic->unitsize, logic->unitsize))
+				stats->wrong_logic = TRUE;
+		}
+		break;
+	}
+}
+
+/* Check whether the 'decimate' module reduces the samplerate. */
+START_TEST(test_transform_decimate)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_session *session;
+	struct sr_channel *ch;
+	const struct sr_transform *t;
+	struct decimate_stats stats;
+	GHashTable *options;
+	GVariant *gvar;
+	GSList *devices, *l;
+	uint64_t samplerate;
+	unsigned int per_block;
+	gboolean first;
+	int ret;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+	fail_unless(sr_dev_open(sdi) == SR_OK);
+
+	/* Keep the first analog channel and D0 only. */
+	first = TRUE;
+	for (l = sr_dev_inst_channels_get(sdi); l; l = l->next) {
+		ch = l->data;
+		sr_dev_channel_enable(ch, (first && ch->type == SR_CHANNEL_ANALOG)
+				|| (ch->type == SR_CHANNEL_LOGIC && ch->index == 0));
+		if (ch->type == SR_CHANNEL_ANALOG)
+			first = FALSE;
+	}
+	sr_config_set(sdi, NULL, SR_CONF_LIMIT_SAMPLES,
+			g_variant_new_uint64(1000));
+	fail_unless(sr_config_get(driver, sdi, NULL, SR_CONF_SAMPLERATE,
+			&gvar) == SR_OK);
+	samplerate = g_variant_get_uint64(gvar);
+	g_variant_unref(gvar);
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "factor",
+			g_variant_ref_sink(g_variant_new_uint32(10)));
+	g_hash_table_insert(options, "mode", g_variant_ref_sink(
+			g_variant_new_string(decimate_tests[_i].mode)));
+	per_block = decimate_tests[_i].per_block;
+
+	memset(&stats, 0, sizeof(stats));
+	stats.per_block = per_block;
+	sr_session_new(srtest_ctx, &session);
+	sr_session_dev_add(session, sdi);
+	sr_session_datafeed_callback_add(session, decimate_datafeed, &stats);
+	t = sr_transform_new(sr_transform_find("decimate"), options, sdi);
+	fail_unless(t != NULL, "Couldn't create the 'decimate' transform.");
+	g_hash_table_destroy(options);
+
+	ret = sr_session_start(session);
+	fail_unless(ret == SR_OK, "Failed to start session: %d.", ret);
+	sr_session_run(session);
+
+	fail_unless(stats.samplerate == samplerate * per_block / 10,
+			"Wrong samplerate %" PRIu64 ".", stats.samplerate);
+	fail_unless(stats.analog_samples == 100 * per_block,
+			"Got %" PRIu64 " analog samples.", stats.analog_samples);
+	fail_unless(stats.logic_samples == 100 * per_block,
+			"Got %" PRIu64 " logic samples.", stats.logic_samples);
+	fail_unless(!stats.wrong_peaks, "Wrong minimum and maximum.");
+	fail_unless(!stats.wrong_logic, "Logic samples weren't repeated.");
+
+	sr_transform_free(t);
+	sr_session_destroy(session);
+	sr_dev_close(sdi);
+}
+END_TEST
+
+static void decimate_meta_samplerate(const struct sr_transform *t,
+		uint64_t samplerate)
+{
+	struct sr_datafeed_packet packet, *packet_out;
+	struct sr_datafeed_meta meta;
+	struct sr_config *src;
+
+	src = sr_config_new(SR_CONF_SAMPLERATE, g_variant_new_uint64(samplerate));
+	meta.config = g_slist_append(NULL, src);
+	packet.type = SR_DF_META;
+	packet.payload = &meta;
+	fail_unless(t->module->receive(t, &packet, &packet_out) == SR_OK);
+	fail_unless(packet_out != NULL, "Samplerate wasn't passed on.");
+	g_slist_free(meta.config);
+	sr_config_free(src);
+}
+
+/*
+ * Check whether a new samplerate makes the 'decimate' module start over,
+ * rather than average samples taken at both rates.
+ */
+START_TEST(test_transform_decimate_samplerate)
+{
+	struct sr_dev_driver *driver;
+	struct sr_dev_inst *sdi;
+	struct sr_session *session;
+	const struct sr_transform *t;
+	struct sr_datafeed_packet packet, *packet_out;
+	struct sr_datafeed_analog analog;
+	const struct sr_datafeed_analog *analog_out;
+	struct sr_analog_encoding encoding;
+	struct sr_analog_meaning meaning;
+	struct sr_analog_spec spec;
+	GHashTable *options;
+	GSList *devices, channels;
+	float values[10], value;
+	unsigned int i;
+
+	driver = srtest_driver_get("demo");
+	srtest_driver_init(srtest_ctx, driver);
+	devices = sr_driver_scan(driver, NULL);
+	fail_unless(devices != NULL, "No demo device found.");
+	sdi = devices->data;
+	g_slist_free(devices);
+
+	options = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+			(GDestroyNotify)g_variant_unref);
+	g_hash_table_insert(options, "factor",
+			g_variant_ref_sink(g_variant_new_uint32(10)));
+	g_hash_table_insert(options, "mode",
+			g_variant_ref_sink(g_variant_new_string("mean")));
+	sr_session_new(srtest_ctx, &session);
+	sr_session_dev_add(session, sdi);
+	t = sr_transform_new(sr_transform_find("decimate"), options, sdi);
+	fail_unless(t != NULL, "Couldn't create the 'decimate' transform.");
+	g_hash_table_destroy(options);
+
+	sr_analog_init(&analog, &encoding, &meaning, &spec, 3);
+	channels.data = sr_dev_inst_channels_get(sdi)->data;
+	channels.next = NULL;
+	meaning.channels = &channels;
+	analog.data = values;
+	packet.type = SR_DF_ANALOG;
+	packet.payload = &analog;
+
+	/* Half a block at the first rate. */
+	decimate_meta_samplerate(t, SR_KHZ(1));
+	for (i = 0; i < 5; i++)
+		values[i] = 1.0;
+	analog.num_samples = 5;
+	fail_unless(t->module->receive(t, &packet, &packet_out) == SR_OK);
+	fail_unless(packet_out == NULL, "Sent a sample of half a block.");
+
+	/* A whole block at the second rate. */
+	decimate_meta_samplerate(t, SR_KHZ(2));
+	for (i = 0; i < 10; i++)
+		values[i] = 3.0;
+	analog.num_samples = 10;
+	fail_unless(t->module->receive(t, &packet, &packet_out) == SR_OK);
+	fail_unless(packet_out != NULL && packet_out->type == SR_DF_ANALOG,
+			"No sample for a whole block.");
+	analog_out = packet_out->payload;
+	fail_unless(analog_out->num_samples == 1,
+			"Got %" PRIu32 " samples.", analog_out->num_samples);
+	fail_unless(sr_analog_to_float(analog_out, &value) == SR_OK);
+	fail_unless(value == 3.0, "Samples of both rates were averaged: %f.",
+			value);
+
+	sr_transform_free(t);
+	sr_session_destroy(session);
+}
+END_TEST
+
 Suite *suite_transform_all(void)
 {
 	Suite *s;
@@ -113,5 +486,14 @@ Suite *suite_transform_all(void)
 	tcase_add_test(tc, test_transform_options);
 	suite_add_tcase(s, tc);
 
+	tc = tcase_create("modules");
+	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
+	tcase_add_loop_test(tc, test_transform_repack, 0,
+			ARRAY_SIZE(repack_tests));
+	tcase_add_loop_test(tc, test_transform_decimate, 0,
+			ARRAY_SIZE(decimate_tests));
+	tcase_add_test(tc, test_transform_decimate_samplerate);
+	suite_add_tcase(s, tc);
+
 	return s;
 }
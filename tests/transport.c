@@ -0,0 +1,51 @@
+/*
+ * This file is part of the libsigrok project.
+ *
+ * Copyright (C) 2026 The sigrok project developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+/*
+ * The testsuites which run drivers against faked transports. They define
+ * the libserialport and libusb functions the library calls, so they get
+ * a program of their own, instead of taking the real ones away from the
+ * rest of the tests.
+ */
+
+#include <config.h>
+#include <stdlib.h>
+#include <check.h>
+#include <libsigrok/libsigrok.h>
+#include "lib.h"
+
+int main(void)
+{
+	int ret;
+	Suite *s;
+	SRunner *srunner;
+
+	s = suite_create("transportsuite");
+	srunner = srunner_create(s);
+
+	srunner_add_suite(srunner, suite_serial_dmm());
+	srunner_add_suite(srunner, suite_device_usb());
+
+	srunner_run_all(srunner, CK_VERBOSE);
+	ret = srunner_ntests_failed(srunner);
+	srunner_free(srunner);
+
+	return (ret == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
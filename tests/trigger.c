@@ -250,6 +250,77 @@ START_TEST(test_trigger_match_add_bogus)
 }
 END_TEST
 
+/* Check whether sr_trigger_analog_match_add() keeps the analog settings. */
+START_TEST(test_trigger_analog_match_add)
+{
+	int ret;
+	struct sr_trigger *t;
+	struct sr_trigger_stage *s;
+	struct sr_trigger_match *m;
+	struct sr_channel *chl, *cha;
+
+	t = sr_trigger_new("T");
+	s = sr_trigger_stage_add(t);
+	chl = g_malloc0(sizeof(struct sr_channel));
+	chl->index = 0;
+	chl->type = SR_CHANNEL_LOGIC;
+	chl->enabled = TRUE;
+	chl->name = g_strdup("L0");
+	cha = g_malloc0(sizeof(struct sr_channel));
+	cha->index = 1;
+	cha->type = SR_CHANNEL_ANALOG;
+	cha->enabled = TRUE;
+	cha->name = g_strdup("A0");
+
+	/* Plain matches measure slopes over one sample, without hysteresis. */
+	ret = sr_trigger_match_add(s, cha, SR_TRIGGER_SLOPE_UP, 0.5);
+	fail_unless(ret == SR_OK);
+	m = g_slist_last(s->matches)->data;
+	fail_unless(m->hysteresis == 0);
+	fail_unless(m->num_samples == 1);
+
+	ret = sr_trigger_analog_match_add(s, cha, SR_TRIGGER_RISING,
+		1.5, 0.25, 1);
+	fail_unless(ret == SR_OK);
+	m = g_slist_last(s->matches)->data;
+	fail_unless(m->channel == cha);
+	fail_unless(m->match == SR_TRIGGER_RISING);
+	fail_unless(m->value == 1.5);
+	fail_unless(m->hysteresis == 0.25);
+
+	ret = sr_trigger_analog_match_add(s, cha, SR_TRIGGER_SLOPE_DOWN,
+		2, 0, 16);
+	fail_unless(ret == SR_OK);
+	m = g_slist_last(s->matches)->data;
+	fail_unless(m->match == SR_TRIGGER_SLOPE_DOWN);
+	fail_unless(m->num_samples == 16);
+	fail_unless(g_slist_length(s->matches) == 3);
+
+	/* Slopes are for analog channels only. */
+	ret = sr_trigger_match_add(s, chl, SR_TRIGGER_SLOPE_UP, 0);
+	fail_unless(ret == SR_ERR_ARG);
+	ret = sr_trigger_analog_match_add(s, chl, SR_TRIGGER_RISING, 0, 0, 1);
+	fail_unless(ret == SR_ERR_ARG);
+
+	/* Bogus hysteresis or slope lengths. */
+	ret = sr_trigger_analog_match_add(s, cha, SR_TRIGGER_RISING, 0, -1, 1);
+	fail_unless(ret == SR_ERR_ARG);
+	ret = sr_trigger_analog_match_add(s, cha, SR_TRIGGER_SLOPE_UP, 0, 0, 0);
+	fail_unless(ret == SR_ERR_ARG);
+	ret = sr_trigger_analog_match_add(s, cha, SR_TRIGGER_ZERO, 0, 0, 1);
+	fail_unless(ret == SR_ERR_ARG);
+	ret = sr_trigger_analog_match_add(NULL, cha, SR_TRIGGER_OVER, 0, 0, 1);
+	fail_unless(ret == SR_ERR_ARG);
+	fail_unless(g_slist_length(s->matches) == 3);
+
+	sr_trigger_free(t);
+	g_free(chl->name);
+	g_free(chl);
+	g_free(cha->name);
+	g_free(cha);
+}
+END_TEST
+
 Suite *suite_trigger(void)
 {
 	Suite *s;
@@ -275,6 +346,7 @@ Suite *suite_trigger(void)
 	tcase_add_checked_fixture(tc, srtest_setup, srtest_teardown);
 	tcase_add_test(tc, test_trigger_match_add);
 	tcase_add_test(tc, test_trigger_match_add_bogus);
+	tcase_add_test(tc, test_trigger_analog_match_add);
 	suite_add_tcase(s, tc);
 
 	return s;